@@ -0,0 +1,887 @@
+/*
+ *  compactmodel.c
+ *
+ *  Copyright (C) 2016 Andrea Zagli <azagli@libero.it>
+ *
+ *  This file is part of libgdaex.
+ *
+ *  libgdaex is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  libgdaex is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with libgdaex; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+	#include <config.h>
+#endif
+
+#include <string.h>
+
+#include <glib/gi18n-lib.h>
+
+#include <libgda/sql-parser/gda-sql-parser.h>
+
+#include "compactmodel.h"
+
+static void gdaex_compact_model_class_init (GdaExCompactModelClass *klass);
+static void gdaex_compact_model_data_model_init (GdaDataModelIface *iface);
+static void gdaex_compact_model_init (GdaExCompactModel *gdaex_compact_model);
+
+static void gdaex_compact_model_finalize (GObject *object);
+
+static void gdaex_compact_model_set_property (GObject *object,
+                               guint property_id,
+                               const GValue *value,
+                               GParamSpec *pspec);
+static void gdaex_compact_model_get_property (GObject *object,
+                               guint property_id,
+                               GValue *value,
+                               GParamSpec *pspec);
+
+static gint gdaex_compact_model_get_n_rows (GdaDataModel *model);
+static gint gdaex_compact_model_get_n_columns (GdaDataModel *model);
+static GdaColumn *gdaex_compact_model_describe_column (GdaDataModel *model, gint col);
+static GdaDataModelAccessFlags gdaex_compact_model_get_access_flags (GdaDataModel *model);
+static const GValue *gdaex_compact_model_get_value_at (GdaDataModel *model, gint col, gint row, GError **error);
+static GdaValueAttribute gdaex_compact_model_get_attributes_at (GdaDataModel *model, gint col, gint row);
+
+
+#define GDAEX_COMPACT_MODEL_GET_PRIVATE(obj) (G_TYPE_INSTANCE_GET_PRIVATE ((obj), GDAEX_TYPE_COMPACT_MODEL, GdaExCompactModelPrivate))
+
+typedef enum
+{
+	GDAEX_COMPACT_KIND_UNKNOWN,   /* only NULLs so far */
+	GDAEX_COMPACT_KIND_INTEGER,   /* the width of the type, signed */
+	GDAEX_COMPACT_KIND_REAL,      /* gdouble */
+	GDAEX_COMPACT_KIND_BOOLEAN,   /* guint8 */
+	GDAEX_COMPACT_KIND_DATE,      /* guint32, julian day */
+	GDAEX_COMPACT_KIND_STRING,    /* guint32, offset into the arena */
+	GDAEX_COMPACT_KIND_BOXED      /* GValue * */
+} GdaExCompactKind;
+
+typedef struct _GdaExCompactColumn GdaExCompactColumn;
+struct _GdaExCompactColumn
+{
+	GdaColumn *column;
+	GType gtype;
+	GdaExCompactKind kind;
+
+	GArray *data;
+	GArray *nulls;   /* a bit for every row */
+
+	/* KIND_STRING: every string once, NUL terminated; with the dictionary,
+	 * equal strings share the same offset */
+	GByteArray *arena;
+	GHashTable *dictionary;
+
+	/* the last value returned for the column */
+	GValue value;
+};
+
+typedef struct _GdaExCompactModelPrivate GdaExCompactModelPrivate;
+struct _GdaExCompactModelPrivate
+{
+	guint n_rows;
+	guint n_columns;
+	GdaExCompactColumn *columns;
+};
+
+G_DEFINE_TYPE_WITH_CODE (GdaExCompactModel, gdaex_compact_model, G_TYPE_OBJECT,
+                         G_IMPLEMENT_INTERFACE (GDA_TYPE_DATA_MODEL, gdaex_compact_model_data_model_init))
+
+static void
+gdaex_compact_model_class_init (GdaExCompactModelClass *klass)
+{
+	GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+	g_type_class_add_private (object_class, sizeof (GdaExCompactModelPrivate));
+
+	object_class->set_property = gdaex_compact_model_set_property;
+	object_class->get_property = gdaex_compact_model_get_property;
+	object_class->finalize = gdaex_compact_model_finalize;
+}
+
+static void
+gdaex_compact_model_data_model_init (GdaDataModelIface *iface)
+{
+	iface->i_get_n_rows = gdaex_compact_model_get_n_rows;
+	iface->i_get_n_columns = gdaex_compact_model_get_n_columns;
+	iface->i_describe_column = gdaex_compact_model_describe_column;
+	iface->i_get_access_flags = gdaex_compact_model_get_access_flags;
+	iface->i_get_value_at = gdaex_compact_model_get_value_at;
+	iface->i_get_attributes_at = gdaex_compact_model_get_attributes_at;
+}
+
+static void
+gdaex_compact_model_init (GdaExCompactModel *gdaex_compact_model)
+{
+	GdaExCompactModelPrivate *priv = GDAEX_COMPACT_MODEL_GET_PRIVATE (gdaex_compact_model);
+
+	priv->n_rows = 0;
+	priv->n_columns = 0;
+	priv->columns = NULL;
+}
+
+static GdaExCompactKind
+gdaex_compact_model_get_kind (GType gtype)
+{
+	if (gtype == G_TYPE_INT
+	    || gtype == G_TYPE_UINT
+	    || gtype == G_TYPE_INT64
+	    || gtype == G_TYPE_UINT64
+	    || gtype == G_TYPE_LONG
+	    || gtype == G_TYPE_ULONG
+	    || gtype == G_TYPE_CHAR
+	    || gtype == G_TYPE_UCHAR
+	    || gtype == GDA_TYPE_SHORT
+	    || gtype == GDA_TYPE_USHORT)
+		{
+			return GDAEX_COMPACT_KIND_INTEGER;
+		}
+	else if (gtype == G_TYPE_DOUBLE
+	         || gtype == G_TYPE_FLOAT)
+		{
+			return GDAEX_COMPACT_KIND_REAL;
+		}
+	else if (gtype == G_TYPE_BOOLEAN)
+		{
+			return GDAEX_COMPACT_KIND_BOOLEAN;
+		}
+	else if (gtype == G_TYPE_DATE)
+		{
+			return GDAEX_COMPACT_KIND_DATE;
+		}
+	else if (gtype == G_TYPE_STRING)
+		{
+			return GDAEX_COMPACT_KIND_STRING;
+		}
+	else if (gtype == G_TYPE_INVALID
+	         || gtype == GDA_TYPE_NULL)
+		{
+			return GDAEX_COMPACT_KIND_UNKNOWN;
+		}
+
+	return GDAEX_COMPACT_KIND_BOXED;
+}
+
+/* the size of an integer type: the unsigned ones are stored in the signed
+ * type of the same width, and cast back when read */
+static guint
+gdaex_compact_model_get_integer_size (GType gtype)
+{
+	if (gtype == G_TYPE_CHAR
+	    || gtype == G_TYPE_UCHAR)
+		{
+			return sizeof (gint8);
+		}
+	else if (gtype == GDA_TYPE_SHORT
+	         || gtype == GDA_TYPE_USHORT)
+		{
+			return sizeof (gint16);
+		}
+	else if (gtype == G_TYPE_INT
+	         || gtype == G_TYPE_UINT)
+		{
+			return sizeof (gint32);
+		}
+	else if (gtype == G_TYPE_LONG
+	         || gtype == G_TYPE_ULONG)
+		{
+			return sizeof (glong);
+		}
+
+	return sizeof (gint64);
+}
+
+static void
+gdaex_compact_column_boxed_free (gpointer data)
+{
+	GValue *gval = *(GValue **)data;
+
+	if (gval != NULL)
+		{
+			gda_value_free (gval);
+		}
+}
+
+/* the storage is chosen by the type; the rows read so far (all NULL) get a slot */
+static void
+gdaex_compact_column_set_type (GdaExCompactColumn *c, GType gtype, guint n_rows, gboolean dictionary)
+{
+	guint size;
+
+	c->gtype = gtype;
+	c->kind = gdaex_compact_model_get_kind (gtype);
+
+	switch (c->kind)
+		{
+			case GDAEX_COMPACT_KIND_INTEGER:
+				size = gdaex_compact_model_get_integer_size (gtype);
+				break;
+
+			case GDAEX_COMPACT_KIND_REAL:
+				size = sizeof (gdouble);
+				break;
+
+			case GDAEX_COMPACT_KIND_BOOLEAN:
+				size = sizeof (guint8);
+				break;
+
+			case GDAEX_COMPACT_KIND_DATE:
+			case GDAEX_COMPACT_KIND_STRING:
+				size = sizeof (guint32);
+				break;
+
+			case GDAEX_COMPACT_KIND_BOXED:
+				size = sizeof (GValue *);
+				break;
+
+			default:
+				return;
+		}
+
+	c->data = g_array_sized_new (FALSE, TRUE, size, n_rows);
+	g_array_set_size (c->data, n_rows);
+	if (c->kind == GDAEX_COMPACT_KIND_BOXED)
+		{
+			g_array_set_clear_func (c->data, gdaex_compact_column_boxed_free);
+		}
+	else if (c->kind == GDAEX_COMPACT_KIND_STRING)
+		{
+			c->arena = g_byte_array_new ();
+			if (dictionary)
+				{
+					c->dictionary = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+				}
+		}
+}
+
+static guint32
+gdaex_compact_column_add_string (GdaExCompactColumn *c, const gchar *str)
+{
+	gpointer offset;
+	guint32 ret;
+
+	if (c->dictionary != NULL
+	    && g_hash_table_lookup_extended (c->dictionary, str, NULL, &offset))
+		{
+			return GPOINTER_TO_UINT (offset);
+		}
+
+	ret = c->arena->len;
+	g_byte_array_append (c->arena, (const guint8 *)str, strlen (str) + 1);
+
+	if (c->dictionary != NULL)
+		{
+			g_hash_table_insert (c->dictionary, g_strdup (str), GUINT_TO_POINTER (ret));
+		}
+
+	return ret;
+}
+
+static void
+gdaex_compact_column_append_integer (GdaExCompactColumn *c, gint64 i64)
+{
+	gint8 i8;
+	gint16 i16;
+	gint32 i32;
+
+	switch (g_array_get_element_size (c->data))
+		{
+			case sizeof (gint8):
+				i8 = (gint8)i64;
+				g_array_append_val (c->data, i8);
+				break;
+
+			case sizeof (gint16):
+				i16 = (gint16)i64;
+				g_array_append_val (c->data, i16);
+				break;
+
+			case sizeof (gint32):
+				i32 = (gint32)i64;
+				g_array_append_val (c->data, i32);
+				break;
+
+			default:
+				g_array_append_val (c->data, i64);
+				break;
+		}
+}
+
+static gint64
+gdaex_compact_column_get_integer (GdaExCompactColumn *c, gint row)
+{
+	switch (g_array_get_element_size (c->data))
+		{
+			case sizeof (gint8):
+				return g_array_index (c->data, gint8, row);
+
+			case sizeof (gint16):
+				return g_array_index (c->data, gint16, row);
+
+			case sizeof (gint32):
+				return g_array_index (c->data, gint32, row);
+
+			default:
+				return g_array_index (c->data, gint64, row);
+		}
+}
+
+static void
+gdaex_compact_column_append (GdaExCompactColumn *c, guint row, const GValue *gval, gboolean dictionary)
+{
+	GValue tmp = G_VALUE_INIT;
+	gboolean is_null;
+	gint64 i64;
+	gdouble d;
+	guint8 b;
+	guint32 u32;
+	GValue *boxed;
+
+	is_null = (gval == NULL || gda_value_is_null (gval));
+
+	if (!is_null
+	    && c->kind == GDAEX_COMPACT_KIND_UNKNOWN)
+		{
+			gdaex_compact_column_set_type (c, G_VALUE_TYPE (gval), row, dictionary);
+		}
+
+	/* mixed types (e.g. SQLite) are converted to the type of the column */
+	if (!is_null
+	    && G_VALUE_TYPE (gval) != c->gtype)
+		{
+			g_value_init (&tmp, c->gtype);
+			if (g_value_transform (gval, &tmp))
+				{
+					gval = &tmp;
+				}
+			else
+				{
+					g_warning (_("Unable to convert a value of type «%s» to «%s»: stored as NULL."),
+					           g_type_name (G_VALUE_TYPE (gval)), g_type_name (c->gtype));
+					is_null = TRUE;
+				}
+		}
+
+	/* julian 0 isn't a valid date */
+	if (!is_null
+	    && c->kind == GDAEX_COMPACT_KIND_DATE
+	    && (g_value_get_boxed (gval) == NULL
+	        || !g_date_valid ((GDate *)g_value_get_boxed (gval))))
+		{
+			is_null = TRUE;
+		}
+
+	if (c->nulls->len <= row / 8)
+		{
+			g_array_set_size (c->nulls, row / 8 + 1);
+		}
+	if (is_null)
+		{
+			g_array_index (c->nulls, guint8, row / 8) |= 1 << (row % 8);
+		}
+
+	switch (c->kind)
+		{
+			case GDAEX_COMPACT_KIND_INTEGER:
+				i64 = 0;
+				if (!is_null)
+					{
+						if (c->gtype == G_TYPE_INT)
+							i64 = g_value_get_int (gval);
+						else if (c->gtype == G_TYPE_UINT)
+							i64 = g_value_get_uint (gval);
+						else if (c->gtype == G_TYPE_INT64)
+							i64 = g_value_get_int64 (gval);
+						else if (c->gtype == G_TYPE_UINT64)
+							i64 = (gint64)g_value_get_uint64 (gval);
+						else if (c->gtype == G_TYPE_LONG)
+							i64 = g_value_get_long (gval);
+						else if (c->gtype == G_TYPE_ULONG)
+							i64 = (gint64)g_value_get_ulong (gval);
+						else if (c->gtype == G_TYPE_CHAR)
+							i64 = g_value_get_schar (gval);
+						else if (c->gtype == G_TYPE_UCHAR)
+							i64 = g_value_get_uchar (gval);
+						else if (c->gtype == GDA_TYPE_SHORT)
+							i64 = gda_value_get_short (gval);
+						else if (c->gtype == GDA_TYPE_USHORT)
+							i64 = gda_value_get_ushort (gval);
+					}
+				gdaex_compact_column_append_integer (c, i64);
+				break;
+
+			case GDAEX_COMPACT_KIND_REAL:
+				d = 0.0;
+				if (!is_null)
+					{
+						d = c->gtype == G_TYPE_FLOAT ? g_value_get_float (gval) : g_value_get_double (gval);
+					}
+				g_array_append_val (c->data, d);
+				break;
+
+			case GDAEX_COMPACT_KIND_BOOLEAN:
+				b = !is_null && g_value_get_boolean (gval);
+				g_array_append_val (c->data, b);
+				break;
+
+			case GDAEX_COMPACT_KIND_DATE:
+				u32 = 0;
+				if (!is_null)
+					{
+						u32 = g_date_get_julian ((GDate *)g_value_get_boxed (gval));
+					}
+				g_array_append_val (c->data, u32);
+				break;
+
+			case GDAEX_COMPACT_KIND_STRING:
+				u32 = 0;
+				if (!is_null)
+					{
+						u32 = gdaex_compact_column_add_string (c, g_value_get_string (gval) != NULL ? g_value_get_string (gval) : "");
+					}
+				g_array_append_val (c->data, u32);
+				break;
+
+			case GDAEX_COMPACT_KIND_BOXED:
+				boxed = is_null ? NULL : gda_value_copy (gval);
+				g_array_append_val (c->data, boxed);
+				break;
+
+			default:
+				break;
+		}
+
+	if (G_IS_VALUE (&tmp))
+		{
+			g_value_unset (&tmp);
+		}
+}
+
+static GdaDataModel
+*gdaex_compact_model_new_from_iter (GdaDataModel *model, GdaDataModelIter *iter, gboolean dictionary)
+{
+	GdaExCompactModel *gdaex_compact_model;
+	GdaExCompactColumn *c;
+	GdaColumn *column;
+	guint col;
+
+	gdaex_compact_model = GDAEX_COMPACT_MODEL (g_object_new (gdaex_compact_model_get_type (), NULL));
+
+	GdaExCompactModelPrivate *priv = GDAEX_COMPACT_MODEL_GET_PRIVATE (gdaex_compact_model);
+
+	priv->n_columns = gda_data_model_get_n_columns (model);
+	priv->columns = g_new0 (GdaExCompactColumn, priv->n_columns);
+	for (col = 0; col < priv->n_columns; col++)
+		{
+			c = &priv->columns[col];
+			column = gda_data_model_describe_column (model, col);
+			c->column = gda_column_copy (column);
+			c->nulls = g_array_new (FALSE, TRUE, sizeof (guint8));
+			c->kind = GDAEX_COMPACT_KIND_UNKNOWN;
+			c->gtype = GDA_TYPE_NULL;
+			gdaex_compact_column_set_type (c, gda_column_get_g_type (column), 0, dictionary);
+		}
+
+	while (gda_data_model_iter_move_next (iter))
+		{
+			for (col = 0; col < priv->n_columns; col++)
+				{
+					gdaex_compact_column_append (&priv->columns[col],
+					                             priv->n_rows,
+					                             gda_data_model_iter_get_value_at (iter, col),
+					                             dictionary);
+				}
+			priv->n_rows++;
+		}
+
+	/* the dictionaries are needed only while filling */
+	for (col = 0; col < priv->n_columns; col++)
+		{
+			c = &priv->columns[col];
+			if (c->dictionary != NULL)
+				{
+					g_hash_table_destroy (c->dictionary);
+					c->dictionary = NULL;
+				}
+			if (c->kind != GDAEX_COMPACT_KIND_UNKNOWN)
+				{
+					gda_column_set_g_type (c->column, c->gtype);
+				}
+		}
+
+	return GDA_DATA_MODEL (gdaex_compact_model);
+}
+
+/**
+ * gdaex_compact_model_new_from_model:
+ * @model: a #GdaDataModel.
+ * @dictionary: TRUE to store only once equal strings of the same column.
+ *
+ * Copies @model into a column-major model: numbers, booleans and dates in
+ * fixed-width arrays, the strings of every column in one memory block,
+ * NULLs in bitmaps. @model is read once with an iterator, so it can also be
+ * a forward-only cursor.
+ *
+ * Returns: (transfer full): a new #GdaDataModel.
+ */
+GdaDataModel
+*gdaex_compact_model_new_from_model (GdaDataModel *model, gboolean dictionary)
+{
+	GdaDataModelIter *iter;
+	GdaDataModel *ret;
+
+	g_return_val_if_fail (GDA_IS_DATA_MODEL (model), NULL);
+
+	iter = gda_data_model_create_iter (model);
+	ret = gdaex_compact_model_new_from_iter (model, iter, dictionary);
+	g_object_unref (iter);
+
+	return ret;
+}
+
+/**
+ * gdaex_compact_model_new_from_sql:
+ * @gdaex: a #GdaEx object.
+ * @sql: the sql text of a selection query.
+ * @dictionary: TRUE to store only once equal strings of the same column.
+ *
+ * Executes @sql with a forward-only cursor and streams its rows into a
+ * #GdaExCompactModel, without keeping the whole provider's result in memory.
+ *
+ * Returns: (transfer full): a new #GdaDataModel, or #NULL if query fails.
+ */
+GdaDataModel
+*gdaex_compact_model_new_from_sql (GdaEx *gdaex, const gchar *sql, gboolean dictionary)
+{
+	GError *error;
+	GdaStatement *stmt;
+	GdaStatement *pstmt;
+	GdaDataModel *cursor;
+	GdaDataModel *ret;
+
+	g_return_val_if_fail (IS_GDAEX (gdaex), NULL);
+
+	error = NULL;
+	stmt = gda_sql_parser_parse_string ((GdaSqlParser *)gdaex_get_sql_parser (gdaex), sql, NULL, &error);
+	if (!GDA_IS_STATEMENT (stmt))
+		{
+			g_warning (_("Error parsing query string: %s\n%s"),
+			           error != NULL && error->message != NULL ? error->message : _("no details"), sql);
+			g_clear_error (&error);
+			return NULL;
+		}
+
+	pstmt = gdaex_prepare_statement (gdaex, stmt);
+	g_object_unref (stmt);
+
+	ret = NULL;
+
+	/* the cursor uses the connection until its last row */
+	gdaex_lock (gdaex);
+	cursor = gda_connection_statement_execute_select_full ((GdaConnection *)gdaex_get_gdaconnection (gdaex),
+	                                                       pstmt, NULL,
+	                                                       GDA_STATEMENT_MODEL_CURSOR_FORWARD,
+	                                                       NULL, &error);
+	if (!GDA_IS_DATA_MODEL (cursor))
+		{
+			g_warning (_("Error executing selection query: %s\n%s"),
+			           error != NULL && error->message != NULL ? error->message : _("no details"), sql);
+			g_clear_error (&error);
+		}
+	else
+		{
+			ret = gdaex_compact_model_new_from_model (cursor, dictionary);
+			g_object_unref (cursor);
+		}
+	gdaex_unlock (gdaex);
+
+	g_object_unref (pstmt);
+
+	return ret;
+}
+
+/**
+ * gdaex_compact_model_get_memory_size:
+ * @model: a #GdaExCompactModel object.
+ *
+ * Returns: the number of bytes used by the values of @model (boxed values
+ * of other types are counted by their pointers only).
+ */
+gsize
+gdaex_compact_model_get_memory_size (GdaExCompactModel *model)
+{
+	GdaExCompactColumn *c;
+	gsize ret;
+	guint col;
+
+	g_return_val_if_fail (GDAEX_IS_COMPACT_MODEL (model), 0);
+
+	GdaExCompactModelPrivate *priv = GDAEX_COMPACT_MODEL_GET_PRIVATE (model);
+
+	ret = 0;
+	for (col = 0; col < priv->n_columns; col++)
+		{
+			c = &priv->columns[col];
+			if (c->data != NULL)
+				{
+					ret += c->data->len * g_array_get_element_size (c->data);
+				}
+			ret += c->nulls->len;
+			if (c->arena != NULL)
+				{
+					ret += c->arena->len;
+				}
+		}
+
+	return ret;
+}
+
+static gint
+gdaex_compact_model_get_n_rows (GdaDataModel *model)
+{
+	GdaExCompactModelPrivate *priv = GDAEX_COMPACT_MODEL_GET_PRIVATE (model);
+
+	return priv->n_rows;
+}
+
+static gint
+gdaex_compact_model_get_n_columns (GdaDataModel *model)
+{
+	GdaExCompactModelPrivate *priv = GDAEX_COMPACT_MODEL_GET_PRIVATE (model);
+
+	return priv->n_columns;
+}
+
+static GdaColumn
+*gdaex_compact_model_describe_column (GdaDataModel *model, gint col)
+{
+	GdaExCompactModelPrivate *priv = GDAEX_COMPACT_MODEL_GET_PRIVATE (model);
+
+	if (col < 0 || col >= (gint)priv->n_columns)
+		{
+			return NULL;
+		}
+
+	return priv->columns[col].column;
+}
+
+static GdaDataModelAccessFlags
+gdaex_compact_model_get_access_flags (GdaDataModel *model)
+{
+	return GDA_DATA_MODEL_ACCESS_RANDOM
+	       | GDA_DATA_MODEL_ACCESS_CURSOR_FORWARD
+	       | GDA_DATA_MODEL_ACCESS_CURSOR_BACKWARD;
+}
+
+static gboolean
+gdaex_compact_column_is_null (GdaExCompactColumn *c, gint row)
+{
+	return c->kind == GDAEX_COMPACT_KIND_UNKNOWN
+	       || (g_array_index (c->nulls, guint8, row / 8) & (1 << (row % 8))) != 0;
+}
+
+/* the returned value is valid until the next call for the same column */
+static const GValue
+*gdaex_compact_model_get_value_at (GdaDataModel *model, gint col, gint row, GError **error)
+{
+	GdaExCompactColumn *c;
+	GValue *gval;
+	gint64 i64;
+
+	GdaExCompactModelPrivate *priv = GDAEX_COMPACT_MODEL_GET_PRIVATE (model);
+
+	if (col < 0 || col >= (gint)priv->n_columns)
+		{
+			g_set_error (error, GDA_DATA_MODEL_ERROR, GDA_DATA_MODEL_COLUMN_OUT_OF_RANGE_ERROR,
+			             _("Column %d out of range (0-%d)"), col, priv->n_columns - 1);
+			return NULL;
+		}
+	if (row < 0 || row >= (gint)priv->n_rows)
+		{
+			g_set_error (error, GDA_DATA_MODEL_ERROR, GDA_DATA_MODEL_ROW_OUT_OF_RANGE_ERROR,
+			             _("Row %d out of range (0-%d)"), row, priv->n_rows - 1);
+			return NULL;
+		}
+
+	c = &priv->columns[col];
+	gval = &c->value;
+
+	/* the GDate of the previous read is reused */
+	if (c->kind == GDAEX_COMPACT_KIND_DATE
+	    && G_VALUE_HOLDS (gval, G_TYPE_DATE)
+	    && !gdaex_compact_column_is_null (c, row))
+		{
+			g_date_set_julian ((GDate *)g_value_get_boxed (gval), g_array_index (c->data, guint32, row));
+			return gval;
+		}
+
+	if (G_IS_VALUE (gval))
+		{
+			g_value_unset (gval);
+		}
+
+	if (gdaex_compact_column_is_null (c, row))
+		{
+			g_value_init (gval, GDA_TYPE_NULL);
+			return gval;
+		}
+
+	switch (c->kind)
+		{
+			case GDAEX_COMPACT_KIND_INTEGER:
+				g_value_init (gval, c->gtype);
+				i64 = gdaex_compact_column_get_integer (c, row);
+				if (c->gtype == G_TYPE_INT)
+					g_value_set_int (gval, (gint)i64);
+				else if (c->gtype == G_TYPE_UINT)
+					g_value_set_uint (gval, (guint)i64);
+				else if (c->gtype == G_TYPE_INT64)
+					g_value_set_int64 (gval, i64);
+				else if (c->gtype == G_TYPE_UINT64)
+					g_value_set_uint64 (gval, (guint64)i64);
+				else if (c->gtype == G_TYPE_LONG)
+					g_value_set_long (gval, (glong)i64);
+				else if (c->gtype == G_TYPE_ULONG)
+					g_value_set_ulong (gval, (gulong)i64);
+				else if (c->gtype == G_TYPE_CHAR)
+					g_value_set_schar (gval, (gint8)i64);
+				else if (c->gtype == G_TYPE_UCHAR)
+					g_value_set_uchar (gval, (guchar)i64);
+				else if (c->gtype == GDA_TYPE_SHORT)
+					gda_value_set_short (gval, (gshort)i64);
+				else if (c->gtype == GDA_TYPE_USHORT)
+					gda_value_set_ushort (gval, (gushort)i64);
+				break;
+
+			case GDAEX_COMPACT_KIND_REAL:
+				g_value_init (gval, c->gtype);
+				if (c->gtype == G_TYPE_FLOAT)
+					{
+						g_value_set_float (gval, (gfloat)g_array_index (c->data, gdouble, row));
+					}
+				else
+					{
+						g_value_set_double (gval, g_array_index (c->data, gdouble, row));
+					}
+				break;
+
+			case GDAEX_COMPACT_KIND_BOOLEAN:
+				g_value_init (gval, G_TYPE_BOOLEAN);
+				g_value_set_boolean (gval, g_array_index (c->data, guint8, row) != 0);
+				break;
+
+			case GDAEX_COMPACT_KIND_DATE:
+				g_value_init (gval, G_TYPE_DATE);
+				g_value_take_boxed (gval, g_date_new_julian (g_array_index (c->data, guint32, row)));
+				break;
+
+			case GDAEX_COMPACT_KIND_STRING:
+				g_value_init (gval, G_TYPE_STRING);
+				g_value_set_static_string (gval, (const gchar *)c->arena->data + g_array_index (c->data, guint32, row));
+				break;
+
+			case GDAEX_COMPACT_KIND_BOXED:
+				return g_array_index (c->data, GValue *, row);
+
+			default:
+				g_value_init (gval, GDA_TYPE_NULL);
+				break;
+		}
+
+	return gval;
+}
+
+static GdaValueAttribute
+gdaex_compact_model_get_attributes_at (GdaDataModel *model, gint col, gint row)
+{
+	GdaValueAttribute ret;
+
+	GdaExCompactModelPrivate *priv = GDAEX_COMPACT_MODEL_GET_PRIVATE (model);
+
+	ret = GDA_VALUE_ATTR_NO_MODIF;
+	if (col >= 0 && col < (gint)priv->n_columns
+	    && row >= 0 && row < (gint)priv->n_rows
+	    && gdaex_compact_column_is_null (&priv->columns[col], row))
+		{
+			ret |= GDA_VALUE_ATTR_IS_NULL;
+		}
+
+	return ret;
+}
+
+/* PRIVATE */
+static void
+gdaex_compact_model_finalize (GObject *object)
+{
+	GdaExCompactModel *gdaex_compact_model = GDAEX_COMPACT_MODEL (object);
+	GdaExCompactModelPrivate *priv = GDAEX_COMPACT_MODEL_GET_PRIVATE (gdaex_compact_model);
+
+	GdaExCompactColumn *c;
+	guint col;
+
+	for (col = 0; col < priv->n_columns; col++)
+		{
+			c = &priv->columns[col];
+			g_object_unref (c->column);
+			if (c->data != NULL)
+				{
+					g_array_unref (c->data);
+				}
+			g_array_unref (c->nulls);
+			if (c->arena != NULL)
+				{
+					g_byte_array_unref (c->arena);
+				}
+			if (c->dictionary != NULL)
+				{
+					g_hash_table_destroy (c->dictionary);
+				}
+			if (G_IS_VALUE (&c->value))
+				{
+					g_value_unset (&c->value);
+				}
+		}
+	g_free (priv->columns);
+
+	G_OBJECT_CLASS (gdaex_compact_model_parent_class)->finalize (object);
+}
+
+static void
+gdaex_compact_model_set_property (GObject *object, guint property_id, const GValue *value, GParamSpec *pspec)
+{
+	GdaExCompactModel *gdaex_compact_model = GDAEX_COMPACT_MODEL (object);
+	GdaExCompactModelPrivate *priv = GDAEX_COMPACT_MODEL_GET_PRIVATE (gdaex_compact_model);
+
+	switch (property_id)
+		{
+			default:
+				G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+				break;
+		}
+}
+
+static void
+gdaex_compact_model_get_property (GObject *object, guint property_id, GValue *value, GParamSpec *pspec)
+{
+	GdaExCompactModel *gdaex_compact_model = GDAEX_COMPACT_MODEL (object);
+	GdaExCompactModelPrivate *priv = GDAEX_COMPACT_MODEL_GET_PRIVATE (gdaex_compact_model);
+
+	switch (property_id)
+		{
+			default:
+				G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+				break;
+		}
+}
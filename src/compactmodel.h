@@ -0,0 +1,67 @@
+/*
+ *  compactmodel.h
+ *
+ *  Copyright (C) 2016 Andrea Zagli <azagli@libero.it>
+ *
+ *  This file is part of libgdaex.
+ *
+ *  libgdaex is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  libgdaex is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with libgdaex; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#ifndef __GDAEX_COMPACT_MODEL_H__
+#define __GDAEX_COMPACT_MODEL_H__
+
+#include <glib.h>
+#include <glib-object.h>
+
+#include "gdaex.h"
+
+G_BEGIN_DECLS
+
+
+#define GDAEX_TYPE_COMPACT_MODEL                 (gdaex_compact_model_get_type ())
+#define GDAEX_COMPACT_MODEL(obj)                 (G_TYPE_CHECK_INSTANCE_CAST ((obj), GDAEX_TYPE_COMPACT_MODEL, GdaExCompactModel))
+#define GDAEX_COMPACT_MODEL_CLASS(klass)         (G_TYPE_CHECK_CLASS_CAST ((klass), GDAEX_TYPE_COMPACT_MODEL, GdaExCompactModelClass))
+#define GDAEX_IS_COMPACT_MODEL(obj)              (G_TYPE_CHECK_INSTANCE_TYPE ((obj), GDAEX_TYPE_COMPACT_MODEL))
+#define GDAEX_IS_COMPACT_MODEL_CLASS(klass)      (G_TYPE_CHECK_CLASS_TYPE ((klass), GDAEX_TYPE_COMPACT_MODEL))
+#define GDAEX_COMPACT_MODEL_GET_CLASS(obj)       (G_TYPE_INSTANCE_GET_CLASS ((obj), GDAEX_TYPE_COMPACT_MODEL, GdaExCompactModelClass))
+
+
+typedef struct _GdaExCompactModel GdaExCompactModel;
+typedef struct _GdaExCompactModelClass GdaExCompactModelClass;
+
+struct _GdaExCompactModel
+	{
+		GObject parent;
+	};
+
+struct _GdaExCompactModelClass
+	{
+		GObjectClass parent_class;
+	};
+
+GType gdaex_compact_model_get_type (void) G_GNUC_CONST;
+
+
+GdaDataModel *gdaex_compact_model_new_from_model (GdaDataModel *model, gboolean dictionary);
+GdaDataModel *gdaex_compact_model_new_from_sql (GdaEx *gdaex, const gchar *sql, gboolean dictionary);
+
+gsize gdaex_compact_model_get_memory_size (GdaExCompactModel *model);
+
+
+G_END_DECLS
+
+#endif /* __GDAEX_COMPACT_MODEL_H__ */
@@ -28,6 +28,11 @@
 #include <stdarg.h>
 #include <string.h>
 
+#ifdef HAVE_LANGINFO_H
+	#include <locale.h>
+	#include <langinfo.h>
+#endif
+
 #include <glib/gi18n-lib.h>
 
 #include <gio/gio.h>
@@ -38,20 +43,15 @@
 
 #include "gdaex.h"
 
-static guint debug;
-static gchar *log_file;
-
-static GOptionEntry entries[] =
-{
-	{ "gdaex-debug-level", 0, 0, G_OPTION_ARG_INT, &debug, "Sets the debug level", NULL },
-	{ "gdaex-log-file", 0, 0, G_OPTION_ARG_FILENAME, &log_file, "Path to file where to write debug info (or stdout or stderr)", NULL },
-	{ NULL }
-};
-
 static void gdaex_class_init (GdaExClass *klass);
 static void gdaex_init (GdaEx *gdaex);
 
 static void gdaex_create_connection_parser (GdaEx *gdaex);
+static GdaSqlParser *gdaex_get_parser (GdaEx *gdaex);
+
+static void gdaex_pool_close (gpointer clone);
+
+static void gdaex_finalize (GObject *object);
 
 static void gdaex_set_property (GObject *object,
                                guint property_id,
@@ -78,8 +78,51 @@ struct _GdaExPrivate
 
 		guint debug;
 		GFileOutputStream *log_file;
+
+		/* the values of the command line options, before gdaex_post_parse_options () */
+		gint opt_debug;
+		gchar *opt_log_file;
+
+		/* thread-safe mode: a fair (ticket) recursive lock around
+		 * the connection and a parser for every thread; the mode is
+		 * frozen by the first gdaex_lock (), so locks and unlocks
+		 * always agree on it */
+		gboolean thread_safe;
+		gint thread_safe_frozen;
+		GMutex lock_mutex;
+		GCond lock_cond;
+		guint64 lock_next_ticket;
+		guint64 lock_now_serving;
+		GThread *lock_owner;
+		guint lock_depth;
+		guint64 lock_acquisitions;
+		guint64 lock_contentions;
+		gint64 lock_wait_usec;
+
+		/* key of the parsers of the threads, never reused */
+		guint serial;
+
+		/* idle connections for gdaex_batch_query_parallel () */
+		GAsyncQueue *pool;
+		GMutex pool_mutex;
+		guint pool_opened;
 	};
 
+/* the log file can be written from any thread */
+static GMutex log_mutex;
+
+/* in thread-safe mode every thread has its own parsers: serial => GdaExThreadParser */
+typedef struct
+	{
+		GWeakRef gdaex;
+		GdaSqlParser *parser;
+	} GdaExThreadParser;
+
+static void gdaex_thread_parser_free (GdaExThreadParser *tp);
+
+static GPrivate thread_parsers = G_PRIVATE_INIT ((GDestroyNotify)g_hash_table_destroy);
+static guint thread_parsers_serial = 0;
+
 G_DEFINE_TYPE (GdaEx, gdaex, G_TYPE_OBJECT)
 
 static void
@@ -91,6 +134,7 @@ gdaex_class_init (GdaExClass *klass)
 
 	object_class->set_property = gdaex_set_property;
 	object_class->get_property = gdaex_get_property;
+	object_class->finalize = gdaex_finalize;
 
 	/**
 	 * GdaEx::before-execute:
@@ -133,6 +177,26 @@ gdaex_init (GdaEx *gdaex)
 	priv->tables_name_prefix = NULL;
 	priv->debug = 0;
 	priv->log_file = 0;
+	priv->opt_debug = 0;
+	priv->opt_log_file = NULL;
+
+	priv->thread_safe = FALSE;
+	priv->thread_safe_frozen = FALSE;
+	g_mutex_init (&priv->lock_mutex);
+	g_cond_init (&priv->lock_cond);
+	priv->lock_next_ticket = 0;
+	priv->lock_now_serving = 0;
+	priv->lock_owner = NULL;
+	priv->lock_depth = 0;
+	priv->lock_acquisitions = 0;
+	priv->lock_contentions = 0;
+	priv->lock_wait_usec = 0;
+
+	priv->serial = (guint)g_atomic_int_add (&thread_parsers_serial, 1) + 1;
+
+	priv->pool = g_async_queue_new_full (gdaex_pool_close);
+	g_mutex_init (&priv->pool_mutex);
+	priv->pool_opened = 0;
 }
 
 static GdaEx
@@ -383,12 +447,20 @@ gdaex_log_handler (const gchar *log_domain,
 
 	msg = g_strdup_printf ("%s **: %s\n\n", log_domain, message);
 
+	error = NULL;
+	g_mutex_lock (&log_mutex);
 	if (g_output_stream_write (G_OUTPUT_STREAM (priv->log_file),
 	    msg, strlen (msg), NULL, &error) < 0)
 		{
+			g_mutex_unlock (&log_mutex);
 			g_warning (_("Error on writing on log file: %s"),
 			           error != NULL && error->message != NULL ? error->message : _("no details."));
 		}
+	else
+		{
+			g_mutex_unlock (&log_mutex);
+		}
+	g_free (msg);
 }
 
 static gboolean
@@ -401,14 +473,14 @@ gdaex_post_parse_options (GOptionContext *context,
 
 	GError *my_error;
 
-	priv->debug = debug;
-	if (log_file == NULL)
+	priv->debug = (guint)MAX (priv->opt_debug, 0);
+	if (priv->opt_log_file == NULL)
 		{
 			priv->log_file = 0;
 		}
 	else if (priv->debug > 0)
 		{
-			gchar *filename = g_strstrip (g_strdup (log_file));
+			gchar *filename = g_strstrip (g_strdup (priv->opt_log_file));
 			if (g_ascii_strncasecmp (filename, "stdout", 6) == 0
 			    || g_ascii_strncasecmp (filename, "stderr", 6) == 0)
 				{
@@ -446,7 +518,19 @@ GOptionGroup
 {
 	GOptionGroup *ret;
 
-	ret = g_option_group_new ("gdaex", "GdaEx", "GdaEx", (gpointer)gdaex, g_free);
+	g_return_val_if_fail (IS_GDAEX (gdaex), NULL);
+
+	GdaExPrivate *priv = GDAEX_GET_PRIVATE (gdaex);
+
+	/* the options are parsed into the instance: the entries are copied by the group */
+	GOptionEntry entries[] =
+	{
+		{ "gdaex-debug-level", 0, 0, G_OPTION_ARG_INT, &priv->opt_debug, "Sets the debug level", NULL },
+		{ "gdaex-log-file", 0, 0, G_OPTION_ARG_FILENAME, &priv->opt_log_file, "Path to file where to write debug info (or stdout or stderr)", NULL },
+		{ NULL }
+	};
+
+	ret = g_option_group_new ("gdaex", "GdaEx", "GdaEx", (gpointer)gdaex, NULL);
 	if (ret != NULL)
 		{
 			g_option_group_add_entries (ret, entries);
@@ -499,9 +583,180 @@ const GdaSqlParser
 {
 	g_return_val_if_fail (IS_GDAEX (gdaex), NULL);
 
+	return gdaex_get_parser (gdaex);
+}
+
+/**
+ * gdaex_set_thread_safe:
+ * @gdaex: a #GdaEx object.
+ * @thread_safe:
+ *
+ * In thread-safe mode every thread gets its own sql parser and the use of
+ * the connection is serialized by a fair lock, so many threads can share
+ * the same #GdaEx. The data models returned by the queries are fetched
+ * entirely under the lock, so they can be read from any thread.
+ *
+ * The mode can be set only before the #GdaEx is used: after the first query
+ * (more exactly, the first gdaex_lock()) the call is ignored with a warning.
+ */
+void
+gdaex_set_thread_safe (GdaEx *gdaex, gboolean thread_safe)
+{
+	g_return_if_fail (IS_GDAEX (gdaex));
+
+	GdaExPrivate *priv = GDAEX_GET_PRIVATE (gdaex);
+
+	g_mutex_lock (&priv->lock_mutex);
+	if (g_atomic_int_get (&priv->thread_safe_frozen))
+		{
+			g_mutex_unlock (&priv->lock_mutex);
+			if (priv->thread_safe != thread_safe)
+				{
+					g_warning (_("The thread-safe mode can't be changed after the GdaEx is used."));
+				}
+			return;
+		}
+	priv->thread_safe = thread_safe;
+	g_mutex_unlock (&priv->lock_mutex);
+}
+
+/**
+ * gdaex_get_thread_safe:
+ * @gdaex: a #GdaEx object.
+ *
+ * Returns: TRUE if @gdaex is in thread-safe mode.
+ */
+gboolean
+gdaex_get_thread_safe (GdaEx *gdaex)
+{
+	g_return_val_if_fail (IS_GDAEX (gdaex), FALSE);
+
+	GdaExPrivate *priv = GDAEX_GET_PRIVATE (gdaex);
+
+	return priv->thread_safe;
+}
+
+/**
+ * gdaex_lock:
+ * @gdaex: a #GdaEx object.
+ *
+ * In thread-safe mode, takes the lock of the connection; threads get it in
+ * the order they asked for it. It is recursive: use it to keep the
+ * connection for a sequence of calls, e.g. a whole transaction.
+ * Does nothing if @gdaex isn't in thread-safe mode.
+ */
+void
+gdaex_lock (GdaEx *gdaex)
+{
+	guint64 ticket;
+	gint64 start;
+
+	g_return_if_fail (IS_GDAEX (gdaex));
+
+	GdaExPrivate *priv = GDAEX_GET_PRIVATE (gdaex);
+
+	if (!g_atomic_int_get (&priv->thread_safe_frozen))
+		{
+			g_mutex_lock (&priv->lock_mutex);
+			g_atomic_int_set (&priv->thread_safe_frozen, TRUE);
+			g_mutex_unlock (&priv->lock_mutex);
+		}
+
+	if (!priv->thread_safe)
+		{
+			return;
+		}
+
+	g_mutex_lock (&priv->lock_mutex);
+	if (priv->lock_owner == g_thread_self ())
+		{
+			priv->lock_depth++;
+			g_mutex_unlock (&priv->lock_mutex);
+			return;
+		}
+
+	ticket = priv->lock_next_ticket++;
+	priv->lock_acquisitions++;
+	if (ticket != priv->lock_now_serving)
+		{
+			priv->lock_contentions++;
+			start = g_get_monotonic_time ();
+			while (ticket != priv->lock_now_serving)
+				{
+					g_cond_wait (&priv->lock_cond, &priv->lock_mutex);
+				}
+			priv->lock_wait_usec += g_get_monotonic_time () - start;
+		}
+	priv->lock_owner = g_thread_self ();
+	priv->lock_depth = 1;
+	g_mutex_unlock (&priv->lock_mutex);
+}
+
+/**
+ * gdaex_unlock:
+ * @gdaex: a #GdaEx object.
+ *
+ * Releases the lock taken with gdaex_lock().
+ */
+void
+gdaex_unlock (GdaEx *gdaex)
+{
+	g_return_if_fail (IS_GDAEX (gdaex));
+
+	GdaExPrivate *priv = GDAEX_GET_PRIVATE (gdaex);
+
+	if (!priv->thread_safe)
+		{
+			return;
+		}
+
+	g_mutex_lock (&priv->lock_mutex);
+	if (priv->lock_owner != g_thread_self ())
+		{
+			g_mutex_unlock (&priv->lock_mutex);
+			g_warning (_("The connection lock isn't held by this thread."));
+			return;
+		}
+
+	priv->lock_depth--;
+	if (priv->lock_depth == 0)
+		{
+			priv->lock_owner = NULL;
+			priv->lock_now_serving++;
+			g_cond_broadcast (&priv->lock_cond);
+		}
+	g_mutex_unlock (&priv->lock_mutex);
+}
+
+/**
+ * gdaex_get_lock_stats:
+ * @gdaex: a #GdaEx object.
+ * @acquisitions: (out) (allow-none): how many times the lock was taken.
+ * @contentions: (out) (allow-none): how many times a thread had to wait for it.
+ * @wait_usec: (out) (allow-none): the total time spent waiting, in microseconds.
+ *
+ */
+void
+gdaex_get_lock_stats (GdaEx *gdaex, guint64 *acquisitions, guint64 *contentions, gint64 *wait_usec)
+{
+	g_return_if_fail (IS_GDAEX (gdaex));
+
 	GdaExPrivate *priv = GDAEX_GET_PRIVATE (gdaex);
 
-	return priv->gda_parser;
+	g_mutex_lock (&priv->lock_mutex);
+	if (acquisitions != NULL)
+		{
+			*acquisitions = priv->lock_acquisitions;
+		}
+	if (contentions != NULL)
+		{
+			*contentions = priv->lock_contentions;
+		}
+	if (wait_usec != NULL)
+		{
+			*wait_usec = priv->lock_wait_usec;
+		}
+	g_mutex_unlock (&priv->lock_mutex);
 }
 
 /**
@@ -677,6 +932,35 @@ gdaex_set_tables_name_prefix_into_statement (GdaEx *gdaex, GdaStatement **stmt)
 	g_free (sstmt);
 }
 
+/* in thread-safe mode the data model is fetched entirely under the lock:
+ * it never goes back to the connection, that other threads are using */
+static GdaDataModel
+*gdaex_statement_execute_select (GdaEx *gdaex, GdaStatement *stmt, GdaSet *params, GError **error)
+{
+	GdaDataModel *dm;
+
+	GdaExPrivate *priv = GDAEX_GET_PRIVATE (gdaex);
+
+	gdaex_lock (gdaex);
+	if (priv->thread_safe)
+		{
+			dm = gda_connection_statement_execute_select_full (priv->gda_conn, stmt, params,
+			                                                   GDA_STATEMENT_MODEL_RANDOM_ACCESS,
+			                                                   NULL, error);
+			if (GDA_IS_DATA_MODEL (dm))
+				{
+					gda_data_model_get_n_rows (dm);
+				}
+		}
+	else
+		{
+			dm = gda_connection_statement_execute_select (priv->gda_conn, stmt, params, error);
+		}
+	gdaex_unlock (gdaex);
+
+	return dm;
+}
+
 /**
  * gdaex_query:
  * @gdaex: a #GdaEx object.
@@ -699,7 +983,7 @@ GdaDataModel
 	GdaExPrivate *priv = GDAEX_GET_PRIVATE (gdaex);
 
 	error = NULL;
-	stmt = gda_sql_parser_parse_string (priv->gda_parser, sql, NULL, &error);
+	stmt = gda_sql_parser_parse_string (gdaex_get_parser (gdaex), sql, NULL, &error);
 	if (!GDA_IS_STATEMENT (stmt))
 		{
 			g_warning (_("Error parsing query string: %s\n%s"),
@@ -714,7 +998,7 @@ GdaDataModel
 		}
 
 	error = NULL;
-	dm = gda_connection_statement_execute_select (priv->gda_conn, stmt, NULL, &error);
+	dm = gdaex_statement_execute_select (gdaex, stmt, NULL, &error);
 	g_object_unref (stmt);
 
 	if (!GDA_IS_DATA_MODEL (dm))
@@ -2580,6 +2864,7 @@ gdaex_begin (GdaEx *gdaex)
 	GdaExPrivate *priv = GDAEX_GET_PRIVATE (gdaex);
 
 	error = NULL;
+	gdaex_lock (gdaex);
 	ret = gda_connection_begin_transaction (priv->gda_conn, "gdaex",
 	                                        GDA_TRANSACTION_ISOLATION_SERIALIZABLE,
 	                                        &error);
@@ -2606,6 +2891,7 @@ gdaex_begin (GdaEx *gdaex)
 					g_message (_("Transaction opened."));
 				}
 		}
+	gdaex_unlock (gdaex);
 
 	return ret;
 }
@@ -2634,7 +2920,7 @@ gdaex_execute (GdaEx *gdaex, const gchar *sql)
 	GdaExClass *klass = GDAEX_GET_CLASS (gdaex);
 
 	error = NULL;
-	stmt = gda_sql_parser_parse_string (priv->gda_parser, sql, &remain, &error);
+	stmt = gda_sql_parser_parse_string (gdaex_get_parser (gdaex), sql, &remain, &error);
 	if (remain)
 		{
 			g_warning (_("REMAINS:\n%s\nfrom\n%s"), remain, sql);
@@ -2657,7 +2943,9 @@ gdaex_execute (GdaEx *gdaex, const gchar *sql)
 		}
 
 	error = NULL;
+	gdaex_lock (gdaex);
 	nrecs = gda_connection_statement_execute_non_select (priv->gda_conn, stmt, NULL, NULL, &error);
+	gdaex_unlock (gdaex);
 
 	if (error != NULL)
 		{
@@ -2680,6 +2968,153 @@ gdaex_execute (GdaEx *gdaex, const gchar *sql)
 	return nrecs;
 }
 
+/**
+ * gdaex_prepare_statement:
+ * @gdaex: a #GdaEx object.
+ * @stmt: a #GdaStatement.
+ *
+ * Applies the tables name prefix to a copy of @stmt (if a prefix is set) and
+ * prepares it on the connection, so that it can be executed many times with
+ * gdaex_query_statement() or gdaex_execute_statement() changing only the values
+ * of its parameters.
+ *
+ * Returns: (transfer full): the #GdaStatement to execute, or #NULL on error.
+ */
+GdaStatement
+*gdaex_prepare_statement (GdaEx *gdaex, GdaStatement *stmt)
+{
+	GError *error;
+	GdaStatement *ret;
+	gboolean prepared;
+
+	g_return_val_if_fail (IS_GDAEX (gdaex), NULL);
+	g_return_val_if_fail (GDA_IS_STATEMENT (stmt), NULL);
+
+	GdaExPrivate *priv = GDAEX_GET_PRIVATE (gdaex);
+
+	if (priv->tables_name_prefix != NULL
+	    && g_strcmp0 (priv->tables_name_prefix, "") != 0)
+		{
+			ret = gda_statement_copy (stmt);
+			gdaex_set_tables_name_prefix_into_statement (gdaex, &ret);
+		}
+	else
+		{
+			ret = g_object_ref (stmt);
+		}
+
+	error = NULL;
+	gdaex_lock (gdaex);
+	prepared = gda_connection_statement_prepare (priv->gda_conn, ret, &error);
+	gdaex_unlock (gdaex);
+	if (!prepared)
+		{
+			/* not every provider can prepare every statement: it will be prepared on execution */
+			if (priv->debug > 0)
+				{
+					g_message (_("Unable to prepare the statement: %s"),
+					           error != NULL && error->message != NULL ? error->message : _("no details"));
+				}
+			g_clear_error (&error);
+		}
+
+	return ret;
+}
+
+/**
+ * gdaex_query_statement:
+ * @gdaex: a #GdaEx object.
+ * @stmt: a #GdaStatement, usually returned by gdaex_prepare_statement().
+ * @params: (allow-none): the values for the parameters of @stmt.
+ *
+ * Execute a selection statement without rendering and parsing it again.
+ * The tables name prefix is not applied: see gdaex_prepare_statement().
+ *
+ * Returns: a #GdaDataModel, or #NULL if query fails.
+ */
+GdaDataModel
+*gdaex_query_statement (GdaEx *gdaex, GdaStatement *stmt, GdaSet *params)
+{
+	GError *error;
+	GdaDataModel *dm;
+
+	g_return_val_if_fail (IS_GDAEX (gdaex), NULL);
+	g_return_val_if_fail (GDA_IS_STATEMENT (stmt), NULL);
+
+	GdaExPrivate *priv = GDAEX_GET_PRIVATE (gdaex);
+
+	error = NULL;
+	dm = gdaex_statement_execute_select (gdaex, stmt, params, &error);
+	if (!GDA_IS_DATA_MODEL (dm))
+		{
+			g_warning (_("Error executing selection query: %s"),
+			           error != NULL && error->message != NULL ? error->message : _("no details"));
+			return NULL;
+		}
+	else if (priv->debug > 0)
+		{
+			gchar *sql;
+
+			sql = gda_statement_to_sql_extended (stmt, priv->gda_conn, params,
+			                                     GDA_STATEMENT_SQL_PARAMS_AS_VALUES, NULL, NULL);
+			g_message (_("Selection query executed: %s"), sql);
+			g_free (sql);
+		}
+
+	return dm;
+}
+
+/**
+ * gdaex_execute_statement:
+ * @gdaex: a #GdaEx object.
+ * @stmt: a #GdaStatement, usually returned by gdaex_prepare_statement().
+ * @params: (allow-none): the values for the parameters of @stmt.
+ *
+ * Execute a command statement (INSERT, UPDATE, DELETE) without rendering and
+ * parsing it again.
+ * The tables name prefix is not applied: see gdaex_prepare_statement().
+ *
+ * Returns: number of records affected by the query execution.
+ */
+gint
+gdaex_execute_statement (GdaEx *gdaex, GdaStatement *stmt, GdaSet *params)
+{
+	GError *error;
+	gint nrecs;
+
+	g_return_val_if_fail (IS_GDAEX (gdaex), -1);
+	g_return_val_if_fail (GDA_IS_STATEMENT (stmt), -1);
+
+	GdaExPrivate *priv = GDAEX_GET_PRIVATE (gdaex);
+	GdaExClass *klass = GDAEX_GET_CLASS (gdaex);
+
+	g_signal_emit (gdaex, klass->before_execute_signal_id, 0, stmt);
+
+	error = NULL;
+	gdaex_lock (gdaex);
+	nrecs = gda_connection_statement_execute_non_select (priv->gda_conn, stmt, params, NULL, &error);
+	gdaex_unlock (gdaex);
+	if (error != NULL)
+		{
+			g_warning (_("Error executing command query: %s"),
+			           error->message != NULL ? error->message : _("no details"));
+			return -1;
+		}
+	else if (priv->debug > 0)
+		{
+			gchar *sql;
+
+			sql = gda_statement_to_sql_extended (stmt, priv->gda_conn, params,
+			                                     GDA_STATEMENT_SQL_PARAMS_AS_VALUES, NULL, NULL);
+			g_message (_("Query executed: %s"), sql);
+			g_free (sql);
+		}
+
+	g_signal_emit (gdaex, klass->after_execute_signal_id, 0, stmt);
+
+	return nrecs;
+}
+
 /**
  * gdaex_batch_execute:
  * @gdaex: a #GdaEx object.
@@ -2706,16 +3141,21 @@ GSList
 
 	ret = NULL;
 
+	/* the whole batch keeps the connection */
+	gdaex_lock (gdaex);
+
 	va_start (ap, gdaex);
 
 	while ((sql = va_arg (ap, gchar *)) != NULL)
 		{
 			error = NULL;
-			stmt = gda_sql_parser_parse_string (priv->gda_parser, sql, NULL, &error);
+			stmt = gda_sql_parser_parse_string (gdaex_get_parser (gdaex), sql, NULL, &error);
 			if (error != NULL)
 				{
 					g_warning (_("Error parsing sql: %s\n%s"),
 					           error->message != NULL ? error->message : _("no details"), sql);
+					va_end (ap);
+					gdaex_unlock (gdaex);
 					return NULL;
 				}
 
@@ -2733,29 +3173,292 @@ GSList
 
 	va_end (ap);
 
+	gdaex_unlock (gdaex);
+
 	return ret;
 }
 
+G_DEFINE_QUARK (gdaex-error-quark, gdaex_error)
+
+typedef struct
+	{
+		GdaEx *gdaex;
+		guint n_connections;
+		GPtrArray *sqls;
+		GPtrArray *results;
+	} GdaExParallelBatch;
+
 /**
- * gdaex_commit:
- * @gdaex: a #GdaEx object.
- *
- * Commit a transaction.
+ * gdaex_batch_result_free:
+ * @result:
  *
- * Returns: TRUE if there isn't errors.
  */
-gboolean
-gdaex_commit (GdaEx *gdaex)
+void
+gdaex_batch_result_free (GdaExBatchResult *result)
 {
-	gboolean ret;
-	GError *error;
-	GdaExPrivate *priv;
-	GdaTransactionStatus *tstatus;
+	if (result == NULL)
+		{
+			return;
+		}
 
-	g_return_val_if_fail (IS_GDAEX (gdaex), FALSE);
+	if (result->dm != NULL)
+		{
+			g_object_unref (result->dm);
+		}
+	if (result->error != NULL)
+		{
+			g_error_free (result->error);
+		}
+	g_free (result);
+}
+
+/* pushed in the pool when a connection can't be opened, to wake up a
+ * thread waiting for it */
+static gint gdaex_pool_failed;
+#define GDAEX_POOL_FAILED ((gpointer)&gdaex_pool_failed)
+
+/* a #GdaEx on @conn for the pool: without the locale, gettext and gui
+ * setup of gdaex_new_(), that can't be done out of the main thread */
+static GdaEx
+*gdaex_pool_new (GdaConnection *conn)
+{
+	GdaEx *gdaex;
+	GdaExPrivate *priv;
+
+	gdaex = GDAEX (g_object_new (gdaex_get_type (), NULL));
+
+	priv = GDAEX_GET_PRIVATE (gdaex);
+
+	priv->gda_conn = conn;
+
+	gdaex_create_connection_parser (gdaex);
+
+	return gdaex;
+}
+
+/* a connection of the pool, opened like the one of @gdaex */
+static GdaEx
+*gdaex_pool_open (GdaEx *gdaex, GError **error)
+{
+	GdaConnection *cnc;
+	GdaEx *clone;
+
+	GdaExPrivate *priv = GDAEX_GET_PRIVATE (gdaex);
+
+	cnc = gda_connection_open_from_string (gda_connection_get_provider_name (priv->gda_conn),
+	                                       gda_connection_get_cnc_string (priv->gda_conn),
+	                                       gda_connection_get_authentication (priv->gda_conn),
+	                                       GDA_CONNECTION_OPTIONS_READ_ONLY,
+	                                       error);
+	if (cnc == NULL)
+		{
+			return NULL;
+		}
+
+	clone = gdaex_pool_new (cnc);
+	gdaex_set_tables_name_prefix (clone, priv->tables_name_prefix);
+
+	return clone;
+}
+
+static void
+gdaex_pool_close (gpointer clone)
+{
+	GdaConnection *cnc;
+
+	if (clone == GDAEX_POOL_FAILED)
+		{
+			return;
+		}
+
+	cnc = (GdaConnection *)gdaex_get_gdaconnection ((GdaEx *)clone);
+	gdaex_free ((GdaEx *)clone);
+	g_object_unref (clone);
+	g_object_unref (cnc);
+}
+
+static void
+gdaex_batch_query_parallel_thread (gpointer data, gpointer user_data)
+{
+	GdaExParallelBatch *batch = (GdaExParallelBatch *)user_data;
+	guint i = GPOINTER_TO_UINT (data) - 1;
+
+	GdaExBatchResult *result;
+	GdaEx *clone;
+	GdaStatement *stmt;
+	GdaStatement *pstmt;
+	const gchar *sql;
+	gboolean open;
+
+	GdaExPrivate *priv = GDAEX_GET_PRIVATE (batch->gdaex);
+
+	result = g_ptr_array_index (batch->results, i);
+	sql = g_ptr_array_index (batch->sqls, i);
+
+	/* an idle connection, or a new one up to n_connections; after a failed
+	 * opening its place is free again */
+	clone = g_async_queue_try_pop (priv->pool);
+	while (clone == NULL || clone == GDAEX_POOL_FAILED)
+		{
+			g_mutex_lock (&priv->pool_mutex);
+			open = priv->pool_opened < batch->n_connections;
+			if (open)
+				{
+					priv->pool_opened++;
+				}
+			g_mutex_unlock (&priv->pool_mutex);
+
+			if (open)
+				{
+					clone = gdaex_pool_open (batch->gdaex, &result->error);
+					if (clone == NULL)
+						{
+							g_mutex_lock (&priv->pool_mutex);
+							priv->pool_opened--;
+							g_mutex_unlock (&priv->pool_mutex);
+							g_async_queue_push (priv->pool, GDAEX_POOL_FAILED);
+							return;
+						}
+				}
+			else
+				{
+					clone = g_async_queue_pop (priv->pool);
+				}
+		}
+
+	stmt = gda_sql_parser_parse_string (gdaex_get_parser (clone), sql, NULL, &result->error);
+	if (stmt != NULL)
+		{
+			if (gda_statement_get_statement_type (stmt) != GDA_SQL_STATEMENT_SELECT)
+				{
+					g_set_error (&result->error, GDAEX_ERROR, GDAEX_ERROR_NOT_A_SELECT,
+					             _("Only selection queries can run in parallel: %s"), sql);
+				}
+			else
+				{
+					pstmt = gdaex_prepare_statement (clone, stmt);
+					result->dm = gda_connection_statement_execute_select ((GdaConnection *)gdaex_get_gdaconnection (clone),
+					                                                      pstmt, NULL, &result->error);
+					if (result->dm != NULL)
+						{
+							/* every row is read before the clone goes back to the pool */
+							gda_data_model_get_n_rows (result->dm);
+						}
+					g_object_unref (pstmt);
+				}
+			g_object_unref (stmt);
+		}
+
+	g_async_queue_push (priv->pool, clone);
+}
+
+/**
+ * gdaex_batch_query_parallel:
+ * @gdaex: a #GdaEx object.
+ * @n_connections: the maximum number of connections to use.
+ * @...: a #NULL terminated list of independent selection queries.
+ *
+ * Runs the queries at the same time on up to @n_connections read-only
+ * connections opened like the one of @gdaex (and kept for the next calls).
+ * The queries must not depend on each other nor on the current transaction
+ * of @gdaex.
+ *
+ * Returns: (transfer full): a #GPtrArray of #GdaExBatchResult, in the order
+ * of the queries; every result has the #GdaDataModel or the #GError.
+ */
+GPtrArray
+*gdaex_batch_query_parallel (GdaEx *gdaex, guint n_connections, ...)
+{
+	GdaExParallelBatch batch;
+	GThreadPool *pool;
+	GPtrArray *clones;
+	gpointer clone;
+	GError *error;
+	va_list ap;
+	gchar *sql;
+	guint i;
+
+	g_return_val_if_fail (IS_GDAEX (gdaex), NULL);
+
+	GdaExPrivate *priv = GDAEX_GET_PRIVATE (gdaex);
+
+	batch.gdaex = gdaex;
+	batch.n_connections = MAX (n_connections, 1);
+	batch.sqls = g_ptr_array_new ();
+	batch.results = g_ptr_array_new_with_free_func ((GDestroyNotify)gdaex_batch_result_free);
+
+	va_start (ap, n_connections);
+	while ((sql = va_arg (ap, gchar *)) != NULL)
+		{
+			g_ptr_array_add (batch.sqls, sql);
+			g_ptr_array_add (batch.results, g_new0 (GdaExBatchResult, 1));
+		}
+	va_end (ap);
+
+	error = NULL;
+	pool = g_thread_pool_new (gdaex_batch_query_parallel_thread, &batch,
+	                          MIN (batch.n_connections, MAX (batch.sqls->len, 1)),
+	                          FALSE, &error);
+	if (pool == NULL)
+		{
+			g_warning (_("Unable to create the thread pool: %s"),
+			           error != NULL && error->message != NULL ? error->message : _("no details"));
+			g_clear_error (&error);
+			g_ptr_array_unref (batch.sqls);
+			g_ptr_array_unref (batch.results);
+			return NULL;
+		}
+
+	for (i = 0; i < batch.sqls->len; i++)
+		{
+			g_thread_pool_push (pool, GUINT_TO_POINTER (i + 1), NULL);
+		}
+
+	/* waits for every query */
+	g_thread_pool_free (pool, FALSE, TRUE);
+
+	g_ptr_array_unref (batch.sqls);
+
+	/* drops the failures that nobody waited for */
+	clones = g_ptr_array_new ();
+	while ((clone = g_async_queue_try_pop (priv->pool)) != NULL)
+		{
+			if (clone != GDAEX_POOL_FAILED)
+				{
+					g_ptr_array_add (clones, clone);
+				}
+		}
+	for (i = 0; i < clones->len; i++)
+		{
+			g_async_queue_push (priv->pool, g_ptr_array_index (clones, i));
+		}
+	g_ptr_array_unref (clones);
+
+	return batch.results;
+}
+
+/**
+ * gdaex_commit:
+ * @gdaex: a #GdaEx object.
+ *
+ * Commit a transaction.
+ *
+ * Returns: TRUE if there isn't errors.
+ */
+gboolean
+gdaex_commit (GdaEx *gdaex)
+{
+	gboolean ret;
+	GError *error;
+	GdaExPrivate *priv;
+	GdaTransactionStatus *tstatus;
+
+	g_return_val_if_fail (IS_GDAEX (gdaex), FALSE);
 
 	priv = GDAEX_GET_PRIVATE (gdaex);
 
+	gdaex_lock (gdaex);
+
 	tstatus = gda_connection_get_transaction_status (priv->gda_conn);
 
 	if (tstatus == NULL)
@@ -2783,6 +3486,8 @@ gdaex_commit (GdaEx *gdaex)
 				}
 		}
 
+	gdaex_unlock (gdaex);
+
 	return ret;
 }
 
@@ -2806,6 +3511,8 @@ gdaex_rollback (GdaEx *gdaex)
 
 	priv = GDAEX_GET_PRIVATE (gdaex);
 
+	gdaex_lock (gdaex);
+
 	tstatus = gda_connection_get_transaction_status (priv->gda_conn);
 
 	if (tstatus == NULL)
@@ -2836,6 +3543,8 @@ gdaex_rollback (GdaEx *gdaex)
 				}
 		}
 
+	gdaex_unlock (gdaex);
+
 	return ret;
 }
 
@@ -2845,8 +3554,17 @@ gdaex_free (GdaEx *gdaex)
 {
 	g_return_if_fail (IS_GDAEX (gdaex));
 
+	GdaEx *clone;
+
 	GdaExPrivate *priv = GDAEX_GET_PRIVATE (gdaex);
 
+	/* close the connections of the pool */
+	while ((clone = g_async_queue_try_pop (priv->pool)) != NULL)
+		{
+			gdaex_pool_close (clone);
+		}
+	priv->pool_opened = 0;
+
 	/* close connection */
 	if (gda_connection_is_opened (priv->gda_conn))
 		{
@@ -2933,6 +3651,108 @@ GtkBuilder
 	return priv->gtkbuilder;
 }
 
+/* the shadow column of a sort column id, with its type resolved once */
+typedef struct
+	{
+		guint shadow_col;
+		GType gtype;
+	} GdaExSortShadow;
+
+static gint
+gdaex_treemodel_sort_shadow_compare (GtkTreeModel *model,
+                                     GtkTreeIter *a,
+                                     GtkTreeIter *b,
+                                     gpointer user_data)
+{
+	GdaExSortShadow *shadow;
+	GValue va = G_VALUE_INIT;
+	GValue vb = G_VALUE_INIT;
+	gint ret;
+
+	shadow = (GdaExSortShadow *)user_data;
+
+	/* the shadow types are all scalars: reading them allocates nothing
+	 * and needs no unset */
+	gtk_tree_model_get_value (model, a, shadow->shadow_col, &va);
+	gtk_tree_model_get_value (model, b, shadow->shadow_col, &vb);
+
+	switch (shadow->gtype)
+		{
+			case G_TYPE_INT:
+				ret = (g_value_get_int (&va) > g_value_get_int (&vb)) - (g_value_get_int (&va) < g_value_get_int (&vb));
+				break;
+
+			case G_TYPE_FLOAT:
+				ret = (g_value_get_float (&va) > g_value_get_float (&vb)) - (g_value_get_float (&va) < g_value_get_float (&vb));
+				break;
+
+			case G_TYPE_DOUBLE:
+				ret = (g_value_get_double (&va) > g_value_get_double (&vb)) - (g_value_get_double (&va) < g_value_get_double (&vb));
+				break;
+
+			case G_TYPE_BOOLEAN:
+				ret = (g_value_get_boolean (&va) ? 1 : 0) - (g_value_get_boolean (&vb) ? 1 : 0);
+				break;
+
+			default:
+				ret = 0;
+				break;
+		}
+
+	return ret;
+}
+
+/**
+ * gdaex_treemodel_set_sort_shadow_column:
+ * @store: a #GtkListStore or #GtkTreeStore.
+ * @col: the column filled with formatted text (e.g. by gdaex_format_money()).
+ * @shadow_col: a hidden column of type G_TYPE_INT, G_TYPE_FLOAT, G_TYPE_DOUBLE
+ * or G_TYPE_BOOLEAN.
+ *
+ * Declares @shadow_col as the typed companion of @col: the fill functions
+ * store in it the raw value of the data model's column @col, and sorting
+ * @store by the sort column id @col compares those raw values instead of
+ * the formatted text.
+ */
+void
+gdaex_treemodel_set_sort_shadow_column (GtkTreeModel *store,
+                                        guint col,
+                                        guint shadow_col)
+{
+	GHashTable *shadows;
+	GdaExSortShadow *shadow;
+	GType gtype;
+
+	g_return_if_fail (GTK_IS_LIST_STORE (store) || GTK_IS_TREE_STORE (store));
+	g_return_if_fail (shadow_col < (guint)gtk_tree_model_get_n_columns (store));
+
+	gtype = gtk_tree_model_get_column_type (store, shadow_col);
+	if (gtype != G_TYPE_INT
+	    && gtype != G_TYPE_FLOAT
+	    && gtype != G_TYPE_DOUBLE
+	    && gtype != G_TYPE_BOOLEAN)
+		{
+			g_warning (_("Column %d cannot be used as sort shadow column: unsupported type %s."),
+			           shadow_col, g_type_name (gtype));
+			return;
+		}
+
+	shadows = (GHashTable *)g_object_get_data (G_OBJECT (store), "gdaex_sort_shadows");
+	if (shadows == NULL)
+		{
+			shadows = g_hash_table_new (g_direct_hash, g_direct_equal);
+			g_object_set_data_full (G_OBJECT (store), "gdaex_sort_shadows", shadows, (GDestroyNotify)g_hash_table_destroy);
+		}
+	g_hash_table_insert (shadows, GUINT_TO_POINTER (shadow_col), GUINT_TO_POINTER (col));
+
+	shadow = g_new0 (GdaExSortShadow, 1);
+	shadow->shadow_col = shadow_col;
+	shadow->gtype = gtype;
+	gtk_tree_sortable_set_sort_func (GTK_TREE_SORTABLE (store), col,
+	                                 gdaex_treemodel_sort_shadow_compare,
+	                                 shadow, g_free);
+}
+
 void
 gdaex_fill_treemodel_from_sql_with_missing_func (GdaEx *gdaex,
                                                  GtkTreeModel *store,
@@ -2958,246 +3778,1065 @@ gdaex_fill_treemodel_from_sql_with_missing_func (GdaEx *gdaex,
 	g_object_unref (dm);
 }
 
-void
-gdaex_fill_treemodel_from_datamodel_with_missing_func (GdaEx *gdaex,
-                                                       GtkTreeModel *store,
-                                                       GdaDataModel *dm,
-                                                       guint *cols_formatted,
-                                                       gchar *(*cols_format_func) (GdaDataModelIter *, guint),
-                                                       GdaExFillTreeModelMissingFunc missing_func, gpointer user_data)
-{
-	GtkTreeIter iter;
+typedef struct
+	{
+		guint cols;
 
-	GdaDataModelIter *gda_iter;
+		gint *columns;
+		GValue *values;
 
-	guint cols;
-	guint col;
+		GType *col_gtypes;
+		GType *gcol_gtypes;
+		gboolean *col_missings;
+		guint *col_sources;
+		GdaExDateFormatter **col_formatters;
 
-	GdaColumn *gdacolumn;
+		gboolean call_missing_func;
 
-	GType *col_gtypes;
-	GType *gcol_gtypes;
-	gboolean *col_missings;
-	gboolean call_missing_func;
+		gchar *(*cols_format_func) (GdaDataModelIter *, guint);
+		gboolean format_in_main;	/* cols_format_func left to the main thread */
+	} GdaExFillInfo;
 
-	gint *columns;
-	GValue *values;
+/* caching of the store's columns types, shared by the fill functions */
+static GdaExFillInfo
+*gdaex_fill_info_new_for_store (GtkTreeModel *store,
+                                gchar *(*cols_format_func) (GdaDataModelIter *, guint))
+{
+	GdaExFillInfo *info;
 
-	gint ival;
-	gdouble dval;
-	GDateTime *gdatetime;
+	guint col;
+	GHashTable *shadows;
+	gpointer source;
 
-	g_return_if_fail (IS_GDAEX (gdaex));
-	g_return_if_fail (GTK_IS_TREE_MODEL (store));
-	g_return_if_fail (GDA_IS_DATA_MODEL (dm));
+	info = g_new0 (GdaExFillInfo, 1);
 
-	if (GTK_IS_LIST_STORE (store))
-		{
-			gtk_list_store_clear (GTK_LIST_STORE (store));
-		}
-	else /* GTK_IS_TREE_STORE */
-		{
-			gtk_tree_store_clear (GTK_TREE_STORE (store));
-		}
+	info->cols = gtk_tree_model_get_n_columns (store);
+	info->cols_format_func = cols_format_func;
+	info->call_missing_func = FALSE;
 
-	cols = gtk_tree_model_get_n_columns (store);
-	if (cols == 0)
-		{
-			return;
-		}
+	info->columns = (gint *)g_new0 (gint, info->cols);
+	info->values = (GValue *)g_new0 (GValue, info->cols);
+	info->col_gtypes = (GType *)g_new0 (GType, info->cols);
+	info->gcol_gtypes = (GType *)g_new0 (GType, info->cols);
+	info->col_missings = (gboolean *)g_new0 (gboolean, info->cols);
+	info->col_sources = (guint *)g_new0 (guint, info->cols);
+	info->col_formatters = (GdaExDateFormatter **)g_new0 (GdaExDateFormatter *, info->cols);
 
-	gda_iter = gda_data_model_create_iter (dm);
-	if (gda_iter == NULL)
+	shadows = (GHashTable *)g_object_get_data (G_OBJECT (store), "gdaex_sort_shadows");
+
+	for (col = 0; col < info->cols; col++)
 		{
-			return;
+			info->columns[col] = col;
+			info->col_gtypes[col] = gtk_tree_model_get_column_type (store, col);
+
+			/* a sort shadow column takes the raw value of its formatted column */
+			info->col_sources[col] = col;
+			if (shadows != NULL
+			    && g_hash_table_lookup_extended (shadows, GUINT_TO_POINTER (col), NULL, &source))
+				{
+					info->col_sources[col] = GPOINTER_TO_UINT (source);
+				}
 		}
 
-	columns = (gint *)g_new0 (gint, cols);
-	values = (GValue *)g_new0 (GValue, cols);
-	col_gtypes = (GType *)g_new0 (GType, cols);
-	gcol_gtypes = (GType *)g_new0 (GType, cols);
-	col_missings = (gboolean *)g_new0 (gboolean, cols);
+	return info;
+}
 
-	call_missing_func = FALSE;
+/* caching of the data model's columns types and formatters;
+ * it doesn't touch the store, so it can run outside the main thread */
+static void
+gdaex_fill_info_describe (GdaExFillInfo *info, GdaDataModel *dm)
+{
+	guint col;
+	GdaColumn *gdacolumn;
 
-	/* caching of columns types */
-	for (col = 0; col < cols; col++)
+	for (col = 0; col < info->cols; col++)
 		{
-			col_gtypes[col] = gtk_tree_model_get_column_type (store, col);
-
-			gdacolumn = gda_data_model_describe_column (dm, col);
+			gdacolumn = gda_data_model_describe_column (dm, info->col_sources[col]);
 			if (gdacolumn == NULL)
 				{
-					col_missings[col] = TRUE;
-					gcol_gtypes[col] = 0;
-					call_missing_func = TRUE;
+					info->col_missings[col] = TRUE;
+					info->gcol_gtypes[col] = 0;
+					info->call_missing_func = TRUE;
 				}
 			else
 				{
-					col_missings[col] = FALSE;
-					gcol_gtypes[col] = gda_column_get_g_type (gdacolumn);
+					info->col_missings[col] = FALSE;
+					info->gcol_gtypes[col] = gda_column_get_g_type (gdacolumn);
+
+					if (info->col_gtypes[col] == G_TYPE_STRING
+					    && info->cols_format_func == NULL
+					    && (info->gcol_gtypes[col] == G_TYPE_DATE
+					        || info->gcol_gtypes[col] == GDA_TYPE_TIMESTAMP
+					        || info->gcol_gtypes[col] == G_TYPE_DATE_TIME
+					        || info->gcol_gtypes[col] == GDA_TYPE_TIME))
+						{
+							info->col_formatters[col] = gdaex_date_formatter_new (info->gcol_gtypes[col]);
+						}
 				}
 		}
+}
 
-	while (gda_data_model_iter_move_next (gda_iter))
+/* TRUE if the value of col is made by cols_format_func */
+static gboolean
+gdaex_fill_info_uses_format_func (GdaExFillInfo *info, guint col)
+{
+	if (info->cols_format_func == NULL
+	    || info->col_gtypes[col] != G_TYPE_STRING
+	    || info->col_missings[col])
 		{
-			if (GTK_IS_LIST_STORE (store))
-				{
-					gtk_list_store_append (GTK_LIST_STORE (store), &iter);
-				}
-			else /* GTK_IS_TREE_STORE */
-				{
-					gtk_tree_store_append (GTK_TREE_STORE (store), &iter, NULL);
-				}
+			return FALSE;
+		}
 
-			for (col = 0; col < cols; col++)
-				{
-					columns[col] = col;
+	switch (info->gcol_gtypes[col])
+		{
+			case G_TYPE_STRING:
+			case G_TYPE_BOOLEAN:
+			case G_TYPE_INT:
+			case G_TYPE_FLOAT:
+			case G_TYPE_DOUBLE:
+				return FALSE;
 
-					GValue gval = {0};
-					g_value_init (&gval, col_gtypes[col]);
-					switch (col_gtypes[col])
-						{
-							case G_TYPE_STRING:
-								if (col_missings[col])
-									{
-										g_value_set_string (&gval, "");
-									}
-								else
-									{
-										switch (gcol_gtypes[col])
-											{
-												case G_TYPE_STRING:
-													g_value_set_string (&gval, gdaex_data_model_iter_get_value_stringify_at (gda_iter, col));
-													break;
-
-												case G_TYPE_BOOLEAN:
-													g_value_set_string (&gval, gdaex_data_model_iter_get_value_boolean_at (gda_iter, col) ? "X" : "");
-													break;
-
-												case G_TYPE_INT:
-													ival = gdaex_data_model_iter_get_value_integer_at (gda_iter, col);
-													g_value_set_string (&gval, gdaex_format_money ((gdouble)ival, 0, FALSE));
-													break;
-
-												case G_TYPE_FLOAT:
-												case G_TYPE_DOUBLE:
-													dval = gdaex_data_model_iter_get_value_double_at (gda_iter, col);
-													g_value_set_string (&gval, gdaex_format_money (dval, -1, FALSE));
-													break;
-
-												default:
-													if (cols_format_func != NULL)
-														{
-															g_value_set_string (&gval, (*cols_format_func) (gda_iter, col));
-														}
-													else if (gcol_gtypes[col] == G_TYPE_DATE
-													         || gcol_gtypes[col] == GDA_TYPE_TIMESTAMP
-													         || gcol_gtypes[col] == G_TYPE_DATE_TIME)
-														{
-															gdatetime = gdaex_data_model_iter_get_value_gdatetime_at (gda_iter, col);
-															/* TODO find default format from locale */
-															g_value_set_string (&gval, g_date_time_format (gdatetime, gcol_gtypes[col] == G_TYPE_DATE ? "%d/%m/%Y" : "%d/%m/%Y %H.%M.%S"));
-														}
-													else
-														{
-															g_value_set_string (&gval, gda_value_stringify (gda_data_model_iter_get_value_at (gda_iter, col)));
-														}
-													break;
-											}
-									}
+			default:
+				return TRUE;
+		}
+}
 
-								values[col] = gval;
-								break;
+static GdaExFillInfo
+*gdaex_fill_info_new (GtkTreeModel *store,
+                      GdaDataModel *dm,
+                      gchar *(*cols_format_func) (GdaDataModelIter *, guint))
+{
+	GdaExFillInfo *info;
 
-							case G_TYPE_INT:
-								if (col_missings[col])
-									{
-										g_value_set_int (&gval, 0);
-									}
-								else
-									{
-										g_value_set_int (&gval, gdaex_data_model_iter_get_value_integer_at (gda_iter, col));
-									}
-								values[col] = gval;
-								break;
+	info = gdaex_fill_info_new_for_store (store, cols_format_func);
+	gdaex_fill_info_describe (info, dm);
 
-							case G_TYPE_FLOAT:
-								if (col_missings[col])
-									{
-										g_value_set_float (&gval, 0.0);
-									}
-								else
-									{
-										g_value_set_float (&gval, gdaex_data_model_iter_get_value_float_at (gda_iter, col));
-									}
-								values[col] = gval;
-								break;
+	return info;
+}
 
-							case G_TYPE_DOUBLE:
-								if (col_missings[col])
-									{
-										g_value_set_double (&gval, 0.0);
-									}
-								else
-									{
-										g_value_set_double (&gval, gdaex_data_model_iter_get_value_double_at (gda_iter, col));
-									}
-								values[col] = gval;
-								break;
+static void
+gdaex_fill_info_free (GdaExFillInfo *info)
+{
+	guint col;
 
-							case G_TYPE_BOOLEAN:
-								if (col_missings[col])
-									{
-										g_value_set_boolean (&gval, FALSE);
-									}
-								else
+	for (col = 0; col < info->cols; col++)
+		{
+			if (G_IS_VALUE (&info->values[col]))
+				{
+					g_value_unset (&info->values[col]);
+				}
+			gdaex_date_formatter_free (info->col_formatters[col]);
+		}
+
+	g_free (info->columns);
+	g_free (info->values);
+	g_free (info->col_gtypes);
+	g_free (info->gcol_gtypes);
+	g_free (info->col_missings);
+	g_free (info->col_sources);
+	g_free (info->col_formatters);
+	g_free (info);
+}
+
+/* converts the current row of @gda_iter into @info->values */
+static void
+gdaex_fill_info_convert_row (GdaExFillInfo *info, GdaDataModelIter *gda_iter)
+{
+	guint col;
+	guint src;
+
+	gint ival;
+	gdouble dval;
+
+	for (col = 0; col < info->cols; col++)
+		{
+			src = info->col_sources[col];
+
+			if (G_IS_VALUE (&info->values[col]))
+				{
+					g_value_unset (&info->values[col]);
+				}
+
+			GValue gval = {0};
+			g_value_init (&gval, info->col_gtypes[col]);
+			switch (info->col_gtypes[col])
+				{
+					case G_TYPE_STRING:
+						if (info->col_missings[col])
+							{
+								g_value_set_string (&gval, "");
+							}
+						else
+							{
+								switch (info->gcol_gtypes[col])
 									{
-										g_value_set_boolean (&gval, gdaex_data_model_iter_get_value_boolean_at (gda_iter, col));
+										case G_TYPE_STRING:
+											g_value_take_string (&gval, gdaex_data_model_iter_get_value_stringify_at (gda_iter, src));
+											break;
+
+										case G_TYPE_BOOLEAN:
+											g_value_set_string (&gval, gdaex_data_model_iter_get_value_boolean_at (gda_iter, src) ? "X" : "");
+											break;
+
+										case G_TYPE_INT:
+											ival = gdaex_data_model_iter_get_value_integer_at (gda_iter, src);
+											g_value_set_string (&gval, gdaex_format_money ((gdouble)ival, 0, FALSE));
+											break;
+
+										case G_TYPE_FLOAT:
+										case G_TYPE_DOUBLE:
+											dval = gdaex_data_model_iter_get_value_double_at (gda_iter, src);
+											g_value_set_string (&gval, gdaex_format_money (dval, -1, FALSE));
+											break;
+
+										default:
+											if (info->cols_format_func != NULL)
+												{
+													if (!info->format_in_main)
+														{
+															g_value_take_string (&gval, (*info->cols_format_func) (gda_iter, src));
+														}
+												}
+											else if (info->col_formatters[col] != NULL)
+												{
+													g_value_set_string (&gval,
+													                    gdaex_date_formatter_format_value (info->col_formatters[col],
+													                                                       gda_data_model_iter_get_value_at (gda_iter, src)));
+												}
+											else
+												{
+													g_value_take_string (&gval, gda_value_stringify (gda_data_model_iter_get_value_at (gda_iter, src)));
+												}
+											break;
 									}
-								values[col] = gval;
-								break;
+							}
+						break;
+
+					case G_TYPE_INT:
+						if (info->col_missings[col])
+							{
+								g_value_set_int (&gval, 0);
+							}
+						else
+							{
+								g_value_set_int (&gval, gdaex_data_model_iter_get_value_integer_at (gda_iter, src));
+							}
+						break;
+
+					case G_TYPE_FLOAT:
+						if (info->col_missings[col])
+							{
+								g_value_set_float (&gval, 0.0);
+							}
+						else
+							{
+								g_value_set_float (&gval, gdaex_data_model_iter_get_value_float_at (gda_iter, src));
+							}
+						break;
 
-							default:
-								values[col] = *gda_value_new_from_string (gdaex_data_model_iter_get_value_stringify_at (gda_iter, col), col_gtypes[col]);
-								break;
+					case G_TYPE_DOUBLE:
+						if (info->col_missings[col])
+							{
+								g_value_set_double (&gval, 0.0);
+							}
+						else
+							{
+								g_value_set_double (&gval, gdaex_data_model_iter_get_value_double_at (gda_iter, src));
+							}
+						break;
+
+					case G_TYPE_BOOLEAN:
+						if (info->col_missings[col])
+							{
+								g_value_set_boolean (&gval, FALSE);
+							}
+						else
+							{
+								g_value_set_boolean (&gval, gdaex_data_model_iter_get_value_boolean_at (gda_iter, src));
+							}
+						break;
+
+					default:
+						{
+							GValue *tmp;
+							gchar *str;
+
+							str = gdaex_data_model_iter_get_value_stringify_at (gda_iter, src);
+							tmp = gda_value_new_from_string (str, info->col_gtypes[col]);
+							g_free (str);
+							if (tmp != NULL)
+								{
+									g_value_unset (&gval);
+									gval = *tmp;
+									g_free (tmp);
+								}
 						}
+						break;
 				}
 
+			info->values[col] = gval;
+		}
+}
+
+static void
+gdaex_fill_info_set_row (GdaExFillInfo *info, GtkTreeModel *store, GtkTreeIter *iter)
+{
+	if (GTK_IS_LIST_STORE (store))
+		{
+			gtk_list_store_set_valuesv (GTK_LIST_STORE (store), iter, info->columns, info->values, info->cols);
+		}
+	else /* GTK_IS_TREE_STORE */
+		{
+			gtk_tree_store_set_valuesv (GTK_TREE_STORE (store), iter, info->columns, info->values, info->cols);
+		}
+}
+
+void
+gdaex_fill_treemodel_from_datamodel_with_missing_func (GdaEx *gdaex,
+                                                       GtkTreeModel *store,
+                                                       GdaDataModel *dm,
+                                                       guint *cols_formatted,
+                                                       gchar *(*cols_format_func) (GdaDataModelIter *, guint),
+                                                       GdaExFillTreeModelMissingFunc missing_func, gpointer user_data)
+{
+	GtkTreeIter iter;
+
+	GdaDataModelIter *gda_iter;
+
+	GdaExFillInfo *info;
+
+	g_return_if_fail (IS_GDAEX (gdaex));
+	g_return_if_fail (GTK_IS_TREE_MODEL (store));
+	g_return_if_fail (GDA_IS_DATA_MODEL (dm));
+
+	if (GTK_IS_LIST_STORE (store))
+		{
+			gtk_list_store_clear (GTK_LIST_STORE (store));
+		}
+	else /* GTK_IS_TREE_STORE */
+		{
+			gtk_tree_store_clear (GTK_TREE_STORE (store));
+		}
+
+	if (gtk_tree_model_get_n_columns (store) == 0)
+		{
+			return;
+		}
+
+	gda_iter = gda_data_model_create_iter (dm);
+	if (gda_iter == NULL)
+		{
+			return;
+		}
+
+	info = gdaex_fill_info_new (store, dm, cols_format_func);
+
+	while (gda_data_model_iter_move_next (gda_iter))
+		{
 			if (GTK_IS_LIST_STORE (store))
 				{
-					gtk_list_store_set_valuesv (GTK_LIST_STORE (store), &iter, columns, values, cols);
+					gtk_list_store_append (GTK_LIST_STORE (store), &iter);
 				}
 			else /* GTK_IS_TREE_STORE */
 				{
-					gtk_tree_store_set_valuesv (GTK_TREE_STORE (store), &iter, columns, values, cols);
+					gtk_tree_store_append (GTK_TREE_STORE (store), &iter, NULL);
 				}
-			if (call_missing_func
+
+			gdaex_fill_info_convert_row (info, gda_iter);
+			gdaex_fill_info_set_row (info, store, &iter);
+
+			if (info->call_missing_func
 			    && missing_func != NULL)
 				{
 					missing_func (store, &iter, user_data);
 				}
 		}
-}
 
-void
-gdaex_fill_treemodel_from_sql (GdaEx *gdaex,
-                               GtkTreeModel *store,
-                               const gchar *sql,
-                               guint *cols_formatted,
-                               gchar *(*cols_format_func) (GdaDataModelIter *, guint))
-{
-	gdaex_fill_treemodel_from_sql_with_missing_func (gdaex, store, sql, cols_formatted, cols_format_func, NULL, NULL);
+	gdaex_fill_info_free (info);
+	g_object_unref (gda_iter);
+}
+
+/* a row read from the data model, kept by value until its parent is read */
+typedef struct
+	{
+		gchar *id;
+		gchar *parent_id;	/* NULL for a root row */
+		guint cols;
+		GValue *values;
+	} GdaExFillTreeStoreRow;
+
+static GdaExFillTreeStoreRow
+*gdaex_fill_treestore_row_new (GdaExFillInfo *info,
+                               GdaDataModelIter *gda_iter,
+                               guint id_col,
+                               guint parent_id_col)
+{
+	GdaExFillTreeStoreRow *row;
+
+	row = g_new0 (GdaExFillTreeStoreRow, 1);
+
+	row->id = gdaex_data_model_iter_get_value_stringify_at (gda_iter, id_col);
+	row->parent_id = gdaex_data_model_iter_get_value_stringify_at (gda_iter, parent_id_col);
+	if (g_strcmp0 (row->parent_id, "") == 0)
+		{
+			g_free (row->parent_id);
+			row->parent_id = NULL;
+		}
+
+	/* the converted values are taken from info */
+	gdaex_fill_info_convert_row (info, gda_iter);
+	row->cols = info->cols;
+	row->values = info->values;
+	info->values = (GValue *)g_new0 (GValue, info->cols);
+
+	return row;
+}
+
+static void
+gdaex_fill_treestore_row_free (GdaExFillTreeStoreRow *row)
+{
+	guint col;
+
+	for (col = 0; col < row->cols; col++)
+		{
+			if (G_IS_VALUE (&row->values[col]))
+				{
+					g_value_unset (&row->values[col]);
+				}
+		}
+
+	g_free (row->values);
+	g_free (row->id);
+	g_free (row->parent_id);
+	g_free (row);
+}
+
+static void
+gdaex_fill_treestore_hierarchical_add_row (GtkTreeStore *tstore,
+                                           GdaExFillInfo *info,
+                                           GdaExFillTreeStoreRow *row,
+                                           GtkTreeIter *parent,
+                                           GHashTable *ht_nodes,
+                                           GdaExFillTreeModelMissingFunc missing_func, gpointer user_data)
+{
+	GtkTreeIter iter;
+
+	gtk_tree_store_append (tstore, &iter, parent);
+	gtk_tree_store_set_valuesv (tstore, &iter, info->columns, row->values, row->cols);
+
+	if (info->call_missing_func
+	    && missing_func != NULL)
+		{
+			missing_func (GTK_TREE_MODEL (tstore), &iter, user_data);
+		}
+
+	if (row->id != NULL)
+		{
+			g_hash_table_replace (ht_nodes, g_strdup (row->id), gtk_tree_iter_copy (&iter));
+		}
+}
+
+/* adds @row under its parent (at the root with @at_root) and then the rows
+ * that were waiting for it; the rows whose parent isn't read yet are put
+ * in @ht_orphans, the others are freed */
+static void
+gdaex_fill_treestore_hierarchical_add_pending (GtkTreeStore *tstore,
+                                               GdaExFillInfo *info,
+                                               GdaExFillTreeStoreRow *row,
+                                               gboolean at_root,
+                                               GHashTable *ht_nodes,
+                                               GHashTable *ht_orphans,
+                                               GdaExFillTreeModelMissingFunc missing_func, gpointer user_data)
+{
+	GtkTreeIter *parent;
+
+	GSList *orphans;
+	GSList *orphan;
+	GSList *pending;
+
+	GdaExFillTreeStoreRow *cur;
+
+	pending = g_slist_prepend (NULL, row);
+	while (pending != NULL)
+		{
+			cur = (GdaExFillTreeStoreRow *)pending->data;
+			pending = g_slist_delete_link (pending, pending);
+
+			parent = NULL;
+			if ((!at_root || cur != row)
+			    && cur->parent_id != NULL)
+				{
+					parent = (GtkTreeIter *)g_hash_table_lookup (ht_nodes, cur->parent_id);
+					if (parent == NULL)
+						{
+							/* parent not read yet */
+							orphans = (GSList *)g_hash_table_lookup (ht_orphans, cur->parent_id);
+							orphans = g_slist_prepend (orphans, cur);
+							g_hash_table_replace (ht_orphans, g_strdup (cur->parent_id), orphans);
+							continue;
+						}
+				}
+
+			gdaex_fill_treestore_hierarchical_add_row (tstore, info, cur, parent, ht_nodes,
+			                                           missing_func, user_data);
+
+			/* the rows that were waiting for this one */
+			orphans = (cur->id != NULL ? (GSList *)g_hash_table_lookup (ht_orphans, cur->id) : NULL);
+			if (orphans != NULL)
+				{
+					g_hash_table_remove (ht_orphans, cur->id);
+					for (orphan = orphans; orphan != NULL; orphan = g_slist_next (orphan))
+						{
+							pending = g_slist_prepend (pending, orphan->data);
+						}
+					g_slist_free (orphans);
+				}
+
+			gdaex_fill_treestore_row_free (cur);
+		}
+}
+
+/**
+ * gdaex_fill_treestore_hierarchical:
+ * @gdaex: a #GdaEx object.
+ * @tstore: a #GtkTreeStore.
+ * @dm: a #GdaDataModel.
+ * @id_col: the column of @dm with the row's key.
+ * @parent_id_col: the column of @dm with the parent row's key (NULL or
+ * empty for root rows).
+ * @cols_formatted:
+ * @cols_format_func:
+ * @missing_func:
+ * @user_data:
+ *
+ * Fills @tstore as gdaex_fill_treemodel_from_datamodel_with_missing_func() does,
+ * but appends every row under the row whose @id_col is equal to its
+ * @parent_id_col, in a single forward pass over @dm, so @dm can be a cursor
+ * model. Rows arriving before their parent are kept, already converted, and
+ * attached as soon as the parent is read; rows whose parent is never found
+ * are appended at the root, with their own children under them.
+ */
+void
+gdaex_fill_treestore_hierarchical (GdaEx *gdaex,
+                                   GtkTreeStore *tstore,
+                                   GdaDataModel *dm,
+                                   guint id_col,
+                                   guint parent_id_col,
+                                   guint *cols_formatted,
+                                   gchar *(*cols_format_func) (GdaDataModelIter *, guint),
+                                   GdaExFillTreeModelMissingFunc missing_func, gpointer user_data)
+{
+	GdaDataModelIter *gda_iter;
+
+	GdaExFillInfo *info;
+
+	GHashTable *ht_nodes;
+	GHashTable *ht_orphans;
+	GHashTable *ht_waiting;
+	GHashTableIter ht_iter;
+	gpointer key;
+	gpointer value;
+
+	GSList *orphan;
+	GSList *roots;
+
+	GdaExFillTreeStoreRow *row;
+	guint not_found;
+
+	g_return_if_fail (IS_GDAEX (gdaex));
+	g_return_if_fail (GTK_IS_TREE_STORE (tstore));
+	g_return_if_fail (GDA_IS_DATA_MODEL (dm));
+	g_return_if_fail (id_col < (guint)gda_data_model_get_n_columns (dm));
+	g_return_if_fail (parent_id_col < (guint)gda_data_model_get_n_columns (dm));
+
+	gtk_tree_store_clear (tstore);
+
+	if (gtk_tree_model_get_n_columns (GTK_TREE_MODEL (tstore)) == 0)
+		{
+			return;
+		}
+
+	gda_iter = gda_data_model_create_iter (dm);
+	if (gda_iter == NULL)
+		{
+			return;
+		}
+
+	info = gdaex_fill_info_new (GTK_TREE_MODEL (tstore), dm, cols_format_func);
+
+	/* id => GtkTreeIter of the row already in the store */
+	ht_nodes = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, (GDestroyNotify)gtk_tree_iter_free);
+	/* parent id => GSList of GdaExFillTreeStoreRow waiting for it */
+	ht_orphans = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+
+	while (gda_data_model_iter_move_next (gda_iter))
+		{
+			row = gdaex_fill_treestore_row_new (info, gda_iter, id_col, parent_id_col);
+			gdaex_fill_treestore_hierarchical_add_pending (tstore, info, row, FALSE,
+			                                               ht_nodes, ht_orphans,
+			                                               missing_func, user_data);
+		}
+
+	/* the rows still waiting: only those whose parent isn't in @dm at all
+	 * go to the root, the others wait for one of them */
+	ht_waiting = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+	g_hash_table_iter_init (&ht_iter, ht_orphans);
+	while (g_hash_table_iter_next (&ht_iter, &key, &value))
+		{
+			for (orphan = (GSList *)value; orphan != NULL; orphan = g_slist_next (orphan))
+				{
+					row = (GdaExFillTreeStoreRow *)orphan->data;
+					if (row->id != NULL)
+						{
+							g_hash_table_add (ht_waiting, g_strdup (row->id));
+						}
+				}
+		}
+
+	roots = NULL;
+	g_hash_table_iter_init (&ht_iter, ht_orphans);
+	while (g_hash_table_iter_next (&ht_iter, &key, &value))
+		{
+			if (!g_hash_table_contains (ht_waiting, key))
+				{
+					roots = g_slist_concat (roots, (GSList *)value);
+					g_hash_table_iter_remove (&ht_iter);
+				}
+		}
+	g_hash_table_destroy (ht_waiting);
+
+	not_found = 0;
+	for (;;)
+		{
+			if (roots == NULL)
+				{
+					/* what's left waits in a cycle: one of them is taken as
+					 * the topmost */
+					g_hash_table_iter_init (&ht_iter, ht_orphans);
+					if (!g_hash_table_iter_next (&ht_iter, &key, &value))
+						{
+							break;
+						}
+					roots = g_slist_prepend (NULL, ((GSList *)value)->data);
+					if (((GSList *)value)->next != NULL)
+						{
+							g_hash_table_iter_replace (&ht_iter, g_slist_delete_link ((GSList *)value, (GSList *)value));
+						}
+					else
+						{
+							g_slist_free ((GSList *)value);
+							g_hash_table_iter_remove (&ht_iter);
+						}
+				}
+
+			row = (GdaExFillTreeStoreRow *)roots->data;
+			roots = g_slist_delete_link (roots, roots);
+
+			gdaex_fill_treestore_hierarchical_add_pending (tstore, info, row, TRUE,
+			                                               ht_nodes, ht_orphans,
+			                                               missing_func, user_data);
+			not_found++;
+		}
+
+	if (not_found > 0)
+		{
+			g_warning (_("%u rows have been added to the root because their parent was not found."), not_found);
+		}
+
+	g_hash_table_destroy (ht_orphans);
+	g_hash_table_destroy (ht_nodes);
+
+	gdaex_fill_info_free (info);
+	g_object_unref (gda_iter);
+}
+
+void
+gdaex_fill_treemodel_from_sql (GdaEx *gdaex,
+                               GtkTreeModel *store,
+                               const gchar *sql,
+                               guint *cols_formatted,
+                               gchar *(*cols_format_func) (GdaDataModelIter *, guint))
+{
+	gdaex_fill_treemodel_from_sql_with_missing_func (gdaex, store, sql, cols_formatted, cols_format_func, NULL, NULL);
+}
+
+void
+gdaex_fill_treemodel_from_datamodel (GdaEx *gdaex,
+                                     GtkTreeModel *store,
+                                     GdaDataModel *dm,
+                                     guint *cols_formatted,
+                                     gchar *(*cols_format_func) (GdaDataModelIter *, guint))
+{
+	gdaex_fill_treemodel_from_datamodel_with_missing_func (gdaex, store, dm, cols_formatted, cols_format_func, NULL, NULL);
+}
+
+typedef struct
+	{
+		GtkTreeModel *store;
+		gchar *sql;
+
+		GdaExFillInfo *info;
+
+		GdaExFillTreeModelMissingFunc missing_func;
+		gpointer missing_func_user_data;
+
+		/* the serial of the latest request on the store */
+		gint *latest;
+		gint serial;
+
+		/* info->cols GValue's for each row */
+		GArray *rows;
+		guint n_rows;
+
+		/* the fetched rows, for info->cols_format_func */
+		GdaDataModel *dm;
+	} GdaExFillAsyncData;
+
+static void
+gdaex_fill_async_data_free (GdaExFillAsyncData *data)
+{
+	guint i;
+
+	if (data->rows != NULL)
+		{
+			for (i = 0; i < data->rows->len; i++)
+				{
+					if (G_IS_VALUE (&g_array_index (data->rows, GValue, i)))
+						{
+							g_value_unset (&g_array_index (data->rows, GValue, i));
+						}
+				}
+			g_array_free (data->rows, TRUE);
+		}
+	if (data->dm != NULL)
+		{
+			g_object_unref (data->dm);
+		}
+	gdaex_fill_info_free (data->info);
+	g_free (data->sql);
+	g_object_unref (data->store);
+	g_free (data);
+}
+
+static gboolean
+gdaex_fill_async_is_stale (GTask *task, GdaExFillAsyncData *data)
+{
+	if (g_task_return_error_if_cancelled (task))
+		{
+			return TRUE;
+		}
+
+	/* a newer request has been started on the same store */
+	if (g_atomic_int_get (data->latest) != data->serial)
+		{
+			g_task_return_new_error (task, G_IO_ERROR, G_IO_ERROR_CANCELLED,
+			                         _("Superseded by a newer request."));
+			return TRUE;
+		}
+
+	return FALSE;
+}
+
+/* main thread: bulk insert of the rows converted by the worker */
+static gboolean
+gdaex_fill_async_apply (gpointer user_data)
+{
+	GTask *task;
+	GdaExFillAsyncData *data;
+
+	GtkTreeIter iter;
+	gint sort_col;
+	GtkSortType sort_type;
+	gboolean sorted;
+	guint row;
+	guint col;
+	GValue *values;
+
+	GdaDataModelIter *gda_iter;
+	gboolean *formats;
+
+	task = G_TASK (user_data);
+	data = (GdaExFillAsyncData *)g_task_get_task_data (task);
+
+	if (gdaex_fill_async_is_stale (task, data))
+		{
+			g_object_unref (task);
+			return G_SOURCE_REMOVE;
+		}
+
+	/* sort once at the end instead of at every insert */
+	sorted = gtk_tree_sortable_get_sort_column_id (GTK_TREE_SORTABLE (data->store), &sort_col, &sort_type);
+	if (sorted)
+		{
+			gtk_tree_sortable_set_sort_column_id (GTK_TREE_SORTABLE (data->store),
+			                                      GTK_TREE_SORTABLE_UNSORTED_SORT_COLUMN_ID,
+			                                      sort_type);
+		}
+
+	if (GTK_IS_LIST_STORE (data->store))
+		{
+			gtk_list_store_clear (GTK_LIST_STORE (data->store));
+		}
+	else /* GTK_IS_TREE_STORE */
+		{
+			gtk_tree_store_clear (GTK_TREE_STORE (data->store));
+		}
+
+	/* cols_format_func isn't required to be thread-safe: it is called
+	 * here, on the rows already fetched by the worker (the data model is
+	 * random access in thread-safe mode, so no query runs) */
+	gda_iter = NULL;
+	formats = NULL;
+	if (data->dm != NULL)
+		{
+			gda_iter = gda_data_model_create_iter (data->dm);
+			formats = g_new0 (gboolean, data->info->cols);
+			for (col = 0; col < data->info->cols; col++)
+				{
+					formats[col] = gdaex_fill_info_uses_format_func (data->info, col);
+				}
+		}
+
+	for (row = 0; row < data->n_rows; row++)
+		{
+			values = &g_array_index (data->rows, GValue, row * data->info->cols);
+			if (gda_iter != NULL
+			    && gda_data_model_iter_move_to_row (gda_iter, row))
+				{
+					for (col = 0; col < data->info->cols; col++)
+						{
+							if (formats[col])
+								{
+									g_value_take_string (&values[col],
+									                     (*data->info->cols_format_func) (gda_iter, data->info->col_sources[col]));
+								}
+						}
+				}
+
+			if (GTK_IS_LIST_STORE (data->store))
+				{
+					gtk_list_store_insert_with_valuesv (GTK_LIST_STORE (data->store), &iter, -1,
+					                                    data->info->columns, values, data->info->cols);
+				}
+			else /* GTK_IS_TREE_STORE */
+				{
+					gtk_tree_store_insert_with_valuesv (GTK_TREE_STORE (data->store), &iter, NULL, -1,
+					                                    data->info->columns, values, data->info->cols);
+				}
+
+			if (data->info->call_missing_func
+			    && data->missing_func != NULL)
+				{
+					data->missing_func (data->store, &iter, data->missing_func_user_data);
+				}
+		}
+
+	if (gda_iter != NULL)
+		{
+			g_object_unref (gda_iter);
+		}
+	g_free (formats);
+
+	if (sorted)
+		{
+			gtk_tree_sortable_set_sort_column_id (GTK_TREE_SORTABLE (data->store), sort_col, sort_type);
+		}
+
+	g_task_return_boolean (task, TRUE);
+	g_object_unref (task);
+
+	return G_SOURCE_REMOVE;
+}
+
+/* worker thread: query and conversion */
+static void
+gdaex_fill_async_thread (GTask *task,
+                         gpointer source_object,
+                         gpointer task_data,
+                         GCancellable *cancellable)
+{
+	GdaExFillAsyncData *data;
+	GdaEx *gdaex;
+
+	GdaDataModel *dm;
+	GdaDataModelIter *gda_iter;
+	guint col;
+
+	data = (GdaExFillAsyncData *)task_data;
+	gdaex = GDAEX (source_object);
+
+	if (gdaex_fill_async_is_stale (task, data))
+		{
+			return;
+		}
+
+	/* the rows can be fetched from the connection while iterating: it is
+	 * kept until the last one; the wait for it can be long, so the request
+	 * is checked again before executing */
+	gdaex_lock (gdaex);
+	if (gdaex_fill_async_is_stale (task, data))
+		{
+			gdaex_unlock (gdaex);
+			return;
+		}
+
+	dm = gdaex_query (gdaex, data->sql);
+	if (dm == NULL)
+		{
+			gdaex_unlock (gdaex);
+			g_task_return_new_error (task, G_IO_ERROR, G_IO_ERROR_FAILED,
+			                         _("Error executing selection query: %s"), data->sql);
+			return;
+		}
+
+	gda_iter = gda_data_model_create_iter (dm);
+	if (gda_iter == NULL)
+		{
+			g_object_unref (dm);
+			gdaex_unlock (gdaex);
+			g_task_return_new_error (task, G_IO_ERROR, G_IO_ERROR_FAILED,
+			                         _("Unable to create an iterator over the data model."));
+			return;
+		}
+
+	gdaex_fill_info_describe (data->info, dm);
+
+	data->rows = g_array_sized_new (FALSE, TRUE, sizeof (GValue),
+	                                MAX (gda_data_model_get_n_rows (dm), 0) * data->info->cols);
+	data->n_rows = 0;
+
+	while (gda_data_model_iter_move_next (gda_iter))
+		{
+			if (gdaex_fill_async_is_stale (task, data))
+				{
+					g_object_unref (gda_iter);
+					g_object_unref (dm);
+					gdaex_unlock (gdaex);
+					return;
+				}
+
+			gdaex_fill_info_convert_row (data->info, gda_iter);
+
+			/* the buffer takes ownership of the converted values */
+			g_array_append_vals (data->rows, data->info->values, data->info->cols);
+			for (col = 0; col < data->info->cols; col++)
+				{
+					memset (&data->info->values[col], 0, sizeof (GValue));
+				}
+			data->n_rows++;
+		}
+
+	g_object_unref (gda_iter);
+	gdaex_unlock (gdaex);
+
+	if (data->info->cols_format_func != NULL)
+		{
+			data->dm = dm;
+		}
+	else
+		{
+			g_object_unref (dm);
+		}
+
+	g_main_context_invoke (g_task_get_context (task), gdaex_fill_async_apply, g_object_ref (task));
+}
+
+/**
+ * gdaex_fill_treemodel_from_sql_async:
+ * @gdaex: a #GdaEx object.
+ * @store: a #GtkListStore or #GtkTreeStore.
+ * @sql: the sql text.
+ * @cols_formatted:
+ * @cols_format_func: if not NULL, it is called from the main loop, while the
+ * rows are inserted; it needn't be thread-safe.
+ * @missing_func:
+ * @missing_func_user_data:
+ * @cancellable: (allow-none): a #GCancellable.
+ * @callback: called when @store has been filled.
+ * @user_data: data for @callback.
+ *
+ * As gdaex_fill_treemodel_from_sql_with_missing_func(), but the query and the
+ * conversion of the rows run in a worker thread; the main loop only inserts
+ * the converted rows into @store, calling @cols_format_func on them.
+ * @gdaex must be in thread-safe mode (see gdaex_set_thread_safe()), otherwise
+ * @callback gets a G_IO_ERROR_NOT_SUPPORTED error.
+ * A new request on the same @store supersedes the previous one, whose result
+ * is discarded and whose @callback gets a G_IO_ERROR_CANCELLED error.
+ */
+void
+gdaex_fill_treemodel_from_sql_async (GdaEx *gdaex,
+                                     GtkTreeModel *store,
+                                     const gchar *sql,
+                                     guint *cols_formatted,
+                                     gchar *(*cols_format_func) (GdaDataModelIter *, guint),
+                                     GdaExFillTreeModelMissingFunc missing_func, gpointer missing_func_user_data,
+                                     GCancellable *cancellable,
+                                     GAsyncReadyCallback callback,
+                                     gpointer user_data)
+{
+	GTask *task;
+	GdaExFillAsyncData *data;
+	gint *latest;
+
+	g_return_if_fail (IS_GDAEX (gdaex));
+	g_return_if_fail (GTK_IS_LIST_STORE (store) || GTK_IS_TREE_STORE (store));
+	g_return_if_fail (sql != NULL);
+
+	latest = (gint *)g_object_get_data (G_OBJECT (store), "gdaex_fill_async_serial");
+	if (latest == NULL)
+		{
+			latest = g_new0 (gint, 1);
+			g_object_set_data_full (G_OBJECT (store), "gdaex_fill_async_serial", latest, g_free);
+		}
+
+	data = g_new0 (GdaExFillAsyncData, 1);
+	data->store = g_object_ref (store);
+	data->sql = g_strstrip (g_strdup (sql));
+	data->info = gdaex_fill_info_new_for_store (store, cols_format_func);
+	data->info->format_in_main = TRUE;
+	data->missing_func = missing_func;
+	data->missing_func_user_data = missing_func_user_data;
+	data->latest = latest;
+	data->serial = g_atomic_int_add (latest, 1) + 1;
+
+	task = g_task_new (gdaex, cancellable, callback, user_data);
+	g_task_set_source_tag (task, gdaex_fill_treemodel_from_sql_async);
+	g_task_set_task_data (task, data, (GDestroyNotify)gdaex_fill_async_data_free);
+
+	if (g_strcmp0 (data->sql, "") == 0)
+		{
+			g_task_return_new_error (task, G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT,
+			                         _("The sql text cannot be empty."));
+		}
+	else if (!gdaex_get_thread_safe (gdaex))
+		{
+			g_task_return_new_error (task, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED,
+			                         _("The GdaEx object isn't in thread-safe mode."));
+		}
+	else
+		{
+			g_task_run_in_thread (task, gdaex_fill_async_thread);
+		}
+
+	g_object_unref (task);
 }
 
-void
-gdaex_fill_treemodel_from_datamodel (GdaEx *gdaex,
-                                     GtkTreeModel *store,
-                                     GdaDataModel *dm,
-                                     guint *cols_formatted,
-                                     gchar *(*cols_format_func) (GdaDataModelIter *, guint))
+/**
+ * gdaex_fill_treemodel_from_sql_finish:
+ * @gdaex: a #GdaEx object.
+ * @result: the #GAsyncResult passed to the callback.
+ * @error: (allow-none): return location for a #GError.
+ *
+ * Returns: #TRUE if the store has been filled.
+ */
+gboolean
+gdaex_fill_treemodel_from_sql_finish (GdaEx *gdaex,
+                                      GAsyncResult *result,
+                                      GError **error)
 {
-	gdaex_fill_treemodel_from_datamodel_with_missing_func (gdaex, store, dm, cols_formatted, cols_format_func, NULL, NULL);
+	g_return_val_if_fail (g_task_is_valid (result, gdaex), FALSE);
+
+	return g_task_propagate_boolean (G_TASK (result), error);
 }
 
 G_DEPRECATED_FOR (gdaex_fill_treemodel_from_sql_with_missing_func)
@@ -3530,6 +5169,526 @@ gchar
 	return ret;
 }
 
+typedef enum
+	{
+		GDAEX_DATE_FORMATTER_TOKEN_LITERAL,
+		GDAEX_DATE_FORMATTER_TOKEN_DAY,
+		GDAEX_DATE_FORMATTER_TOKEN_DAY_SPACE,
+		GDAEX_DATE_FORMATTER_TOKEN_MONTH,
+		GDAEX_DATE_FORMATTER_TOKEN_YEAR,
+		GDAEX_DATE_FORMATTER_TOKEN_YEAR_SHORT,
+		GDAEX_DATE_FORMATTER_TOKEN_HOUR,
+		GDAEX_DATE_FORMATTER_TOKEN_HOUR12,
+		GDAEX_DATE_FORMATTER_TOKEN_MINUTE,
+		GDAEX_DATE_FORMATTER_TOKEN_SECOND
+	} GdaExDateFormatterTokenType;
+
+typedef struct
+	{
+		GdaExDateFormatterTokenType type;
+		gchar *literal;
+	} GdaExDateFormatterToken;
+
+/* maximum number of rendered strings kept by a formatter */
+#define GDAEX_DATE_FORMATTER_CACHE_SIZE 4096
+
+struct _GdaExDateFormatter
+	{
+		gchar *pattern;
+
+		GArray *tokens;
+		gboolean use_gdatetime;
+
+		GHashTable *cache;
+		gboolean has_last;
+		gint64 last_key;
+		const gchar *last_str;
+
+		GString *str;
+	};
+
+static void
+gdaex_date_formatter_add_token (GdaExDateFormatter *formatter,
+                                GdaExDateFormatterTokenType type,
+                                GString *literal)
+{
+	GdaExDateFormatterToken token;
+
+	if (literal != NULL && literal->len > 0)
+		{
+			token.type = GDAEX_DATE_FORMATTER_TOKEN_LITERAL;
+			token.literal = g_strdup (literal->str);
+			g_array_append_val (formatter->tokens, token);
+			g_string_truncate (literal, 0);
+		}
+
+	if (type != GDAEX_DATE_FORMATTER_TOKEN_LITERAL)
+		{
+			token.type = type;
+			token.literal = NULL;
+			g_array_append_val (formatter->tokens, token);
+		}
+}
+
+static void
+gdaex_date_formatter_compile (GdaExDateFormatter *formatter, const gchar *pattern, GString *literal)
+{
+	const gchar *p;
+
+	for (p = pattern; *p != '\0'; p++)
+		{
+			if (*p != '%')
+				{
+					g_string_append_c (literal, *p);
+					continue;
+				}
+
+			p++;
+
+			/* alternative representations (glibc %E and %O) */
+			if (*p == 'E' || *p == 'O')
+				{
+					p++;
+				}
+
+			switch (*p)
+				{
+					case 'd':
+						gdaex_date_formatter_add_token (formatter, GDAEX_DATE_FORMATTER_TOKEN_DAY, literal);
+						break;
+
+					case 'e':
+						gdaex_date_formatter_add_token (formatter, GDAEX_DATE_FORMATTER_TOKEN_DAY_SPACE, literal);
+						break;
+
+					case 'm':
+						gdaex_date_formatter_add_token (formatter, GDAEX_DATE_FORMATTER_TOKEN_MONTH, literal);
+						break;
+
+					case 'Y':
+						gdaex_date_formatter_add_token (formatter, GDAEX_DATE_FORMATTER_TOKEN_YEAR, literal);
+						break;
+
+					case 'y':
+						gdaex_date_formatter_add_token (formatter, GDAEX_DATE_FORMATTER_TOKEN_YEAR_SHORT, literal);
+						break;
+
+					case 'H':
+						gdaex_date_formatter_add_token (formatter, GDAEX_DATE_FORMATTER_TOKEN_HOUR, literal);
+						break;
+
+					case 'I':
+						gdaex_date_formatter_add_token (formatter, GDAEX_DATE_FORMATTER_TOKEN_HOUR12, literal);
+						break;
+
+					case 'M':
+						gdaex_date_formatter_add_token (formatter, GDAEX_DATE_FORMATTER_TOKEN_MINUTE, literal);
+						break;
+
+					case 'S':
+						gdaex_date_formatter_add_token (formatter, GDAEX_DATE_FORMATTER_TOKEN_SECOND, literal);
+						break;
+
+					case 'D':
+						gdaex_date_formatter_compile (formatter, "%m/%d/%y", literal);
+						break;
+
+					case 'F':
+						gdaex_date_formatter_compile (formatter, "%Y-%m-%d", literal);
+						break;
+
+					case 'T':
+						gdaex_date_formatter_compile (formatter, "%H:%M:%S", literal);
+						break;
+
+					case 'R':
+						gdaex_date_formatter_compile (formatter, "%H:%M", literal);
+						break;
+
+					case '%':
+						g_string_append_c (literal, '%');
+						break;
+
+					case '\0':
+						p--;
+						break;
+
+					default:
+						/* names, week numbers, am/pm, etc.: let GDateTime render it */
+						formatter->use_gdatetime = TRUE;
+						break;
+				}
+		}
+}
+
+static gchar
+*gdaex_date_formatter_get_locale_pattern (GType gtype)
+{
+	const gchar *date_fmt;
+	const gchar *time_fmt;
+#ifdef HAVE_LANGINFO_H
+	const gchar *locale;
+#endif
+
+	date_fmt = NULL;
+	time_fmt = NULL;
+
+#ifdef HAVE_LANGINFO_H
+	/* the C/POSIX locale has the US %m/%d/%y: the historical formats
+	 * are kept for it */
+	locale = setlocale (LC_TIME, NULL);
+	if (locale != NULL
+	    && g_strcmp0 (locale, "C") != 0
+	    && g_strcmp0 (locale, "POSIX") != 0
+	    && !g_str_has_prefix (locale, "C."))
+		{
+			date_fmt = nl_langinfo (D_FMT);
+			time_fmt = nl_langinfo (T_FMT);
+		}
+#endif
+
+	if (date_fmt == NULL || g_strcmp0 (date_fmt, "") == 0)
+		{
+			date_fmt = "%d/%m/%Y";
+		}
+	if (time_fmt == NULL || g_strcmp0 (time_fmt, "") == 0)
+		{
+			time_fmt = "%H.%M.%S";
+		}
+
+	if (gtype == G_TYPE_DATE)
+		{
+			return g_strdup (date_fmt);
+		}
+	else if (gtype == GDA_TYPE_TIME)
+		{
+			return g_strdup (time_fmt);
+		}
+	else
+		{
+			return g_strdup_printf ("%s %s", date_fmt, time_fmt);
+		}
+}
+
+/**
+ * gdaex_date_formatter_new_with_pattern:
+ * @pattern: a strftime-like pattern.
+ *
+ * Creates a formatter that renders date, time and timestamp #GValue's
+ * with @pattern; the pattern is compiled once and rendered strings are cached.
+ *
+ * Returns: a new #GdaExDateFormatter; free it with gdaex_date_formatter_free().
+ */
+GdaExDateFormatter
+*gdaex_date_formatter_new_with_pattern (const gchar *pattern)
+{
+	GdaExDateFormatter *formatter;
+	GString *literal;
+
+	g_return_val_if_fail (pattern != NULL, NULL);
+
+	formatter = g_new0 (GdaExDateFormatter, 1);
+	formatter->pattern = g_strdup (pattern);
+	formatter->tokens = g_array_new (FALSE, FALSE, sizeof (GdaExDateFormatterToken));
+	formatter->use_gdatetime = FALSE;
+	formatter->cache = g_hash_table_new_full (g_int64_hash, g_int64_equal, g_free, g_free);
+	formatter->has_last = FALSE;
+	formatter->str = g_string_sized_new (32);
+
+	literal = g_string_new ("");
+	gdaex_date_formatter_compile (formatter, formatter->pattern, literal);
+	gdaex_date_formatter_add_token (formatter, GDAEX_DATE_FORMATTER_TOKEN_LITERAL, literal);
+	g_string_free (literal, TRUE);
+
+	return formatter;
+}
+
+/**
+ * gdaex_date_formatter_new:
+ * @gtype: G_TYPE_DATE, GDA_TYPE_TIME or a timestamp type.
+ *
+ * Creates a formatter with the current locale's pattern for @gtype.
+ *
+ * Returns: a new #GdaExDateFormatter; free it with gdaex_date_formatter_free().
+ */
+GdaExDateFormatter
+*gdaex_date_formatter_new (GType gtype)
+{
+	GdaExDateFormatter *formatter;
+	gchar *pattern;
+
+	pattern = gdaex_date_formatter_get_locale_pattern (gtype);
+	formatter = gdaex_date_formatter_new_with_pattern (pattern);
+	g_free (pattern);
+
+	return formatter;
+}
+
+static void
+gdaex_date_formatter_append_number (GString *str, guint number, guint digits, gchar pad)
+{
+	gchar buf[12];
+	guint i;
+
+	i = sizeof (buf);
+	do
+		{
+			buf[--i] = '0' + (number % 10);
+			number /= 10;
+		} while (number > 0 && i > 0);
+
+	while (sizeof (buf) - i < digits && i > 0)
+		{
+			buf[--i] = pad;
+		}
+
+	g_string_append_len (str, buf + i, sizeof (buf) - i);
+}
+
+static void
+gdaex_date_formatter_render (GdaExDateFormatter *formatter,
+                             gint year, guint month, guint day,
+                             guint hour, guint minute, guint second)
+{
+	guint i;
+	GdaExDateFormatterToken *token;
+
+	g_string_truncate (formatter->str, 0);
+
+	if (formatter->use_gdatetime)
+		{
+			GDateTime *gdatetime;
+			gchar *str;
+
+			gdatetime = g_date_time_new_local (year > 0 ? year : 1,
+			                                   month > 0 ? month : 1,
+			                                   day > 0 ? day : 1,
+			                                   hour, minute, (gdouble)second);
+			if (gdatetime != NULL)
+				{
+					str = g_date_time_format (gdatetime, formatter->pattern);
+					g_string_append (formatter->str, str != NULL ? str : "");
+					g_free (str);
+					g_date_time_unref (gdatetime);
+				}
+			return;
+		}
+
+	for (i = 0; i < formatter->tokens->len; i++)
+		{
+			token = &g_array_index (formatter->tokens, GdaExDateFormatterToken, i);
+			switch (token->type)
+				{
+					case GDAEX_DATE_FORMATTER_TOKEN_LITERAL:
+						g_string_append (formatter->str, token->literal);
+						break;
+
+					case GDAEX_DATE_FORMATTER_TOKEN_DAY:
+						gdaex_date_formatter_append_number (formatter->str, day, 2, '0');
+						break;
+
+					case GDAEX_DATE_FORMATTER_TOKEN_DAY_SPACE:
+						gdaex_date_formatter_append_number (formatter->str, day, 2, ' ');
+						break;
+
+					case GDAEX_DATE_FORMATTER_TOKEN_MONTH:
+						gdaex_date_formatter_append_number (formatter->str, month, 2, '0');
+						break;
+
+					case GDAEX_DATE_FORMATTER_TOKEN_YEAR:
+						if (year < 0)
+							{
+								g_string_append_c (formatter->str, '-');
+							}
+						gdaex_date_formatter_append_number (formatter->str, ABS (year), 4, '0');
+						break;
+
+					case GDAEX_DATE_FORMATTER_TOKEN_YEAR_SHORT:
+						gdaex_date_formatter_append_number (formatter->str, ABS (year) % 100, 2, '0');
+						break;
+
+					case GDAEX_DATE_FORMATTER_TOKEN_HOUR:
+						gdaex_date_formatter_append_number (formatter->str, hour, 2, '0');
+						break;
+
+					case GDAEX_DATE_FORMATTER_TOKEN_HOUR12:
+						gdaex_date_formatter_append_number (formatter->str, hour % 12 == 0 ? 12 : hour % 12, 2, '0');
+						break;
+
+					case GDAEX_DATE_FORMATTER_TOKEN_MINUTE:
+						gdaex_date_formatter_append_number (formatter->str, minute, 2, '0');
+						break;
+
+					case GDAEX_DATE_FORMATTER_TOKEN_SECOND:
+						gdaex_date_formatter_append_number (formatter->str, second, 2, '0');
+						break;
+				}
+		}
+}
+
+/**
+ * gdaex_date_formatter_format_value:
+ * @formatter: a #GdaExDateFormatter.
+ * @value: a #GValue of type G_TYPE_DATE, G_TYPE_DATE_TIME, GDA_TYPE_TIMESTAMP or GDA_TYPE_TIME.
+ *
+ * The value is read directly from the provider's struct, without building
+ * an intermediate #GDateTime; repeated values are rendered only once.
+ * The fraction of second and the timezone of timestamps and times aren't
+ * rendered: the date and time are shown as stored.
+ *
+ * Returns: the formatted string, owned by @formatter and valid until the
+ * next call or until @formatter is freed; "" for NULL values.
+ */
+const gchar
+*gdaex_date_formatter_format_value (GdaExDateFormatter *formatter, const GValue *value)
+{
+	gint year;
+	guint month;
+	guint day;
+	guint hour;
+	guint minute;
+	guint second;
+
+	gint64 key;
+	gint64 *new_key;
+	gchar *str;
+
+	g_return_val_if_fail (formatter != NULL, NULL);
+
+	if (value == NULL || gda_value_is_null (value))
+		{
+			return "";
+		}
+
+	year = 0;
+	month = 0;
+	day = 0;
+	hour = 0;
+	minute = 0;
+	second = 0;
+
+	if (gda_value_isa (value, GDA_TYPE_TIMESTAMP))
+		{
+			const GdaTimestamp *gdatimestamp;
+
+			gdatimestamp = gda_value_get_timestamp (value);
+			if (gdatimestamp == NULL)
+				{
+					return "";
+				}
+			year = gdatimestamp->year;
+			month = gdatimestamp->month;
+			day = gdatimestamp->day;
+			hour = gdatimestamp->hour;
+			minute = gdatimestamp->minute;
+			second = gdatimestamp->second;
+		}
+	else if (gda_value_isa (value, G_TYPE_DATE))
+		{
+			const GDate *gdate;
+
+			gdate = (const GDate *)g_value_get_boxed (value);
+			if (gdate == NULL || !g_date_valid (gdate))
+				{
+					return "";
+				}
+			year = g_date_get_year (gdate);
+			month = g_date_get_month (gdate);
+			day = g_date_get_day (gdate);
+		}
+	else if (gda_value_isa (value, G_TYPE_DATE_TIME))
+		{
+			GDateTime *gdatetime;
+
+			gdatetime = (GDateTime *)g_value_get_boxed (value);
+			if (gdatetime == NULL)
+				{
+					return "";
+				}
+			year = g_date_time_get_year (gdatetime);
+			month = g_date_time_get_month (gdatetime);
+			day = g_date_time_get_day_of_month (gdatetime);
+			hour = g_date_time_get_hour (gdatetime);
+			minute = g_date_time_get_minute (gdatetime);
+			second = g_date_time_get_second (gdatetime);
+		}
+	else if (gda_value_isa (value, GDA_TYPE_TIME))
+		{
+			const GdaTime *gdatime;
+
+			gdatime = gda_value_get_time (value);
+			if (gdatime == NULL)
+				{
+					return "";
+				}
+			hour = gdatime->hour;
+			minute = gdatime->minute;
+			second = gdatime->second;
+		}
+	else
+		{
+			str = gda_value_stringify (value);
+			g_string_assign (formatter->str, str != NULL ? str : "");
+			g_free (str);
+			return formatter->str->str;
+		}
+
+	key = (((((gint64)(year & 0xffff) * 13 + month) * 32 + day) * 24 + hour) * 60 + minute) * 61 + second;
+
+	if (formatter->has_last && formatter->last_key == key)
+		{
+			return formatter->last_str;
+		}
+
+	str = (gchar *)g_hash_table_lookup (formatter->cache, &key);
+	if (str == NULL)
+		{
+			if (g_hash_table_size (formatter->cache) >= GDAEX_DATE_FORMATTER_CACHE_SIZE)
+				{
+					g_hash_table_remove_all (formatter->cache);
+				}
+
+			gdaex_date_formatter_render (formatter, year, month, day, hour, minute, second);
+
+			new_key = g_new (gint64, 1);
+			*new_key = key;
+			str = g_strdup (formatter->str->str);
+			g_hash_table_insert (formatter->cache, new_key, str);
+		}
+
+	formatter->has_last = TRUE;
+	formatter->last_key = key;
+	formatter->last_str = str;
+
+	return str;
+}
+
+/**
+ * gdaex_date_formatter_free:
+ * @formatter: a #GdaExDateFormatter.
+ *
+ */
+void
+gdaex_date_formatter_free (GdaExDateFormatter *formatter)
+{
+	guint i;
+
+	if (formatter == NULL)
+		{
+			return;
+		}
+
+	for (i = 0; i < formatter->tokens->len; i++)
+		{
+			g_free (g_array_index (formatter->tokens, GdaExDateFormatterToken, i).literal);
+		}
+	g_array_free (formatter->tokens, TRUE);
+	g_hash_table_destroy (formatter->cache);
+	g_string_free (formatter->str, TRUE);
+	g_free (formatter->pattern);
+	g_free (formatter);
+}
+
 gboolean
 _gdaex_save_data_file_in_blob (GdaEx *gdaex,
                                const gchar *sql,
@@ -3568,6 +5727,8 @@ _gdaex_save_data_file_in_blob (GdaEx *gdaex,
 		}
 	gda_statement_get_parameters (stmt, &plist, NULL);
 
+	/* the transaction is of the connection: no other thread can use it until its end */
+	gdaex_lock (gdaex);
 	gda_connection_begin_transaction (gda_con, NULL, 0, NULL);
 
 	param = gda_set_get_holder (plist, blob_field_name);
@@ -3587,6 +5748,7 @@ _gdaex_save_data_file_in_blob (GdaEx *gdaex,
 			g_object_unref (plist);
 
 			gda_connection_rollback_transaction (gda_con, NULL, NULL);
+			gdaex_unlock (gdaex);
 
 			/* TODO error */
 			g_warning ("Error on setting blob: %s.",
@@ -3604,6 +5766,7 @@ _gdaex_save_data_file_in_blob (GdaEx *gdaex,
 			if (error != NULL)
 				{
 					gda_connection_rollback_transaction (gda_con, NULL, NULL);
+					gdaex_unlock (gdaex);
 
 					/* TODO error */
 					g_warning ("Error on statement execution for blob updating: %s.",
@@ -3611,6 +5774,7 @@ _gdaex_save_data_file_in_blob (GdaEx *gdaex,
 					return FALSE;
 				}
 			gda_connection_commit_transaction (gda_con, NULL, NULL);
+			gdaex_unlock (gdaex);
 		}
 
 	if (value != NULL)
@@ -3785,6 +5949,85 @@ gdaex_create_connection_parser (GdaEx *gdaex)
 		}
 }
 
+static void
+gdaex_thread_parser_free (GdaExThreadParser *tp)
+{
+	g_weak_ref_clear (&tp->gdaex);
+	g_object_unref (tp->parser);
+	g_free (tp);
+}
+
+static gboolean
+gdaex_thread_parser_is_orphan (gpointer key, gpointer value, gpointer user_data)
+{
+	GObject *gdaex;
+
+	gdaex = g_weak_ref_get (&((GdaExThreadParser *)value)->gdaex);
+	if (gdaex == NULL)
+		{
+			return TRUE;
+		}
+	g_object_unref (gdaex);
+
+	return FALSE;
+}
+
+/* in thread-safe mode every thread has its own parser, freed when the
+ * thread exits or, after the GdaEx is gone, at the next new parser */
+static GdaSqlParser
+*gdaex_get_parser (GdaEx *gdaex)
+{
+	GHashTable *ht;
+	GdaExThreadParser *tp;
+
+	GdaExPrivate *priv = GDAEX_GET_PRIVATE (gdaex);
+
+	if (!priv->thread_safe)
+		{
+			return priv->gda_parser;
+		}
+
+	ht = (GHashTable *)g_private_get (&thread_parsers);
+	if (ht == NULL)
+		{
+			ht = g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL, (GDestroyNotify)gdaex_thread_parser_free);
+			g_private_set (&thread_parsers, ht);
+		}
+
+	tp = (GdaExThreadParser *)g_hash_table_lookup (ht, GUINT_TO_POINTER (priv->serial));
+	if (tp == NULL)
+		{
+			g_hash_table_foreach_remove (ht, gdaex_thread_parser_is_orphan, NULL);
+
+			tp = g_new0 (GdaExThreadParser, 1);
+			g_weak_ref_init (&tp->gdaex, gdaex);
+			tp->parser = gda_connection_create_parser (priv->gda_conn);
+			if (tp->parser == NULL)
+				{
+					tp->parser = gda_sql_parser_new ();
+				}
+			g_hash_table_insert (ht, GUINT_TO_POINTER (priv->serial), tp);
+		}
+
+	return tp->parser;
+}
+
+static void
+gdaex_finalize (GObject *object)
+{
+	GdaEx *gdaex = GDAEX (object);
+	GdaExPrivate *priv = GDAEX_GET_PRIVATE (gdaex);
+
+	g_free (priv->opt_log_file);
+
+	g_async_queue_unref (priv->pool);
+	g_mutex_clear (&priv->pool_mutex);
+	g_cond_clear (&priv->lock_cond);
+	g_mutex_clear (&priv->lock_mutex);
+
+	G_OBJECT_CLASS (gdaex_parent_class)->finalize (object);
+}
+
 static void
 gdaex_set_property (GObject *object, guint property_id, const GValue *value, GParamSpec *pspec)
 {
@@ -62,6 +62,14 @@ struct _GdaExClass
 
 GType gdaex_get_type (void) G_GNUC_CONST;
 
+#define GDAEX_ERROR gdaex_error_quark ()
+GQuark gdaex_error_quark (void);
+
+typedef enum
+	{
+		GDAEX_ERROR_NOT_A_SELECT
+	} GdaExError;
+
 
 GdaEx *gdaex_new_from_dsn (const gchar *dsn,
                            const gchar *username,
@@ -75,6 +83,12 @@ const GdaConnection *gdaex_get_gdaconnection (GdaEx *gdaex);
 const gchar *gdaex_get_provider (GdaEx *gdaex);
 const GdaSqlParser *gdaex_get_sql_parser (GdaEx *gdaex);
 
+void gdaex_set_thread_safe (GdaEx *gdaex, gboolean thread_safe);
+gboolean gdaex_get_thread_safe (GdaEx *gdaex);
+void gdaex_lock (GdaEx *gdaex);
+void gdaex_unlock (GdaEx *gdaex);
+void gdaex_get_lock_stats (GdaEx *gdaex, guint64 *acquisitions, guint64 *contentions, gint64 *wait_usec);
+
 const gchar *gdaex_get_tables_name_prefix (GdaEx *gdaex);
 void gdaex_set_tables_name_prefix (GdaEx *gdaex, const gchar *tables_name_prefix);
 
@@ -199,8 +213,21 @@ gboolean gdaex_begin (GdaEx *gdaex);
 
 gint gdaex_execute (GdaEx *gdaex, const gchar *sql);
 
+GdaStatement *gdaex_prepare_statement (GdaEx *gdaex, GdaStatement *stmt);
+GdaDataModel *gdaex_query_statement (GdaEx *gdaex, GdaStatement *stmt, GdaSet *params);
+gint gdaex_execute_statement (GdaEx *gdaex, GdaStatement *stmt, GdaSet *params);
+
 GSList *gdaex_batch_execute (GdaEx *gdaex, ...);
 
+typedef struct
+	{
+		GdaDataModel *dm;
+		GError *error;
+	} GdaExBatchResult;
+
+void gdaex_batch_result_free (GdaExBatchResult *result);
+GPtrArray *gdaex_batch_query_parallel (GdaEx *gdaex, guint n_connections, ...);
+
 gboolean gdaex_commit (GdaEx *gdaex);
 gboolean gdaex_rollback (GdaEx *gdaex);
 
@@ -216,6 +243,10 @@ GtkBuilder *gdaex_get_gtkbuilder (GdaEx *gdaex);
 
 typedef void (*GdaExFillTreeModelMissingFunc) (GtkTreeModel *store, GtkTreeIter *iter, gpointer user_data);
 
+void gdaex_treemodel_set_sort_shadow_column (GtkTreeModel *store,
+                                             guint col,
+                                             guint shadow_col);
+
 void gdaex_fill_treemodel_from_sql_with_missing_func (GdaEx *gdaex,
                                                       GtkTreeModel *store,
                                                       const gchar *sql,
@@ -228,6 +259,26 @@ void gdaex_fill_treemodel_from_datamodel_with_missing_func (GdaEx *gdaex,
                                                             guint *cols_formatted,
                                                             gchar *(*cols_format_func) (GdaDataModelIter *, guint),
                                                             GdaExFillTreeModelMissingFunc missing_func, gpointer user_data);
+void gdaex_fill_treemodel_from_sql_async (GdaEx *gdaex,
+                                          GtkTreeModel *store,
+                                          const gchar *sql,
+                                          guint *cols_formatted,
+                                          gchar *(*cols_format_func) (GdaDataModelIter *, guint),
+                                          GdaExFillTreeModelMissingFunc missing_func, gpointer missing_func_user_data,
+                                          GCancellable *cancellable,
+                                          GAsyncReadyCallback callback,
+                                          gpointer user_data);
+gboolean gdaex_fill_treemodel_from_sql_finish (GdaEx *gdaex,
+                                               GAsyncResult *result,
+                                               GError **error);
+void gdaex_fill_treestore_hierarchical (GdaEx *gdaex,
+                                        GtkTreeStore *tstore,
+                                        GdaDataModel *dm,
+                                        guint id_col,
+                                        guint parent_id_col,
+                                        guint *cols_formatted,
+                                        gchar *(*cols_format_func) (GdaDataModelIter *, guint),
+                                        GdaExFillTreeModelMissingFunc missing_func, gpointer user_data);
 void gdaex_fill_treemodel_from_sql (GdaEx *gdaex,
                                     GtkTreeModel *store,
                                     const gchar *sql,
@@ -295,6 +346,14 @@ gchar *gdaex_format_money (gdouble number,
                      gint decimals,
                      gboolean with_currency_symbol);
 
+typedef struct _GdaExDateFormatter GdaExDateFormatter;
+
+GdaExDateFormatter *gdaex_date_formatter_new (GType gtype);
+GdaExDateFormatter *gdaex_date_formatter_new_with_pattern (const gchar *pattern);
+const gchar *gdaex_date_formatter_format_value (GdaExDateFormatter *formatter,
+                                                const GValue *value);
+void gdaex_date_formatter_free (GdaExDateFormatter *formatter);
+
 gboolean gdaex_save_data_in_blob (GdaEx *gdaex,
                                   const gchar *sql,
                                   const gchar *blob_field_name,
@@ -27,7 +27,13 @@
 #include "gdaex.h"
 #include "queryeditor.h"
 #include "queryeditor_widget_interface.h"
+#include "queryeditormodel.h"
+#include "queryeditorschema.h"
 #include "sqlbuilder.h"
+#include "pager.h"
+#include "compactmodel.h"
+#include "modelindex.h"
+#include "modelview.h"
 
 
 #endif /* __LIBGDAEX_H__ */
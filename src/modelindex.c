@@ -0,0 +1,695 @@
+/*
+ *  modelindex.c
+ *
+ *  Copyright (C) 2016 Andrea Zagli <azagli@libero.it>
+ *
+ *  This file is part of libgdaex.
+ *
+ *  libgdaex is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  libgdaex is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with libgdaex; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+	#include <config.h>
+#endif
+
+#include <glib/gi18n-lib.h>
+
+#include "modelindex.h"
+#include "modelview.h"
+
+static void gdaex_data_model_index_class_init (GdaExDataModelIndexClass *klass);
+static void gdaex_data_model_index_init (GdaExDataModelIndex *gdaex_data_model_index);
+
+static void gdaex_data_model_index_finalize (GObject *object);
+
+static void gdaex_data_model_index_set_property (GObject *object,
+                               guint property_id,
+                               const GValue *value,
+                               GParamSpec *pspec);
+static void gdaex_data_model_index_get_property (GObject *object,
+                               guint property_id,
+                               GValue *value,
+                               GParamSpec *pspec);
+
+
+#define GDAEX_DATA_MODEL_INDEX_GET_PRIVATE(obj) (G_TYPE_INSTANCE_GET_PRIVATE ((obj), GDAEX_TYPE_DATA_MODEL_INDEX, GdaExDataModelIndexPrivate))
+
+typedef struct _GdaExDataModelIndexPrivate GdaExDataModelIndexPrivate;
+struct _GdaExDataModelIndexPrivate
+{
+	GdaDataModel *model;
+	GdaExDataModelIndexType type;
+
+	guint n_columns;
+	gint *columns;
+	guint n_rows;
+
+	/* GDAEX_DATA_MODEL_INDEX_HASH: key string => GArray of rows */
+	GHashTable *hash;
+
+	/* GDAEX_DATA_MODEL_INDEX_SORTED: copies of the key values (n_rows * n_columns,
+	 * NULL for NULL) and the rows in key order */
+	GValue **keys;
+	GArray *sorted;
+};
+
+G_DEFINE_TYPE (GdaExDataModelIndex, gdaex_data_model_index, G_TYPE_OBJECT)
+
+static void
+gdaex_data_model_index_class_init (GdaExDataModelIndexClass *klass)
+{
+	GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+	g_type_class_add_private (object_class, sizeof (GdaExDataModelIndexPrivate));
+
+	object_class->set_property = gdaex_data_model_index_set_property;
+	object_class->get_property = gdaex_data_model_index_get_property;
+	object_class->finalize = gdaex_data_model_index_finalize;
+}
+
+static void
+gdaex_data_model_index_init (GdaExDataModelIndex *gdaex_data_model_index)
+{
+	GdaExDataModelIndexPrivate *priv = GDAEX_DATA_MODEL_INDEX_GET_PRIVATE (gdaex_data_model_index);
+
+	priv->model = NULL;
+	priv->n_columns = 0;
+	priv->columns = NULL;
+	priv->n_rows = 0;
+	priv->hash = NULL;
+	priv->keys = NULL;
+	priv->sorted = NULL;
+}
+
+static void
+gdaex_data_model_index_rows_free (gpointer data)
+{
+	g_array_unref ((GArray *)data);
+}
+
+/* NULLs first; values of different types are compared in the type of a */
+static gint
+gdaex_data_model_index_value_compare (const GValue *a, const GValue *b)
+{
+	GValue tmp = G_VALUE_INIT;
+	gchar *str_a;
+	gchar *str_b;
+	gint ret;
+
+	if (a == NULL || gda_value_is_null (a))
+		{
+			return (b == NULL || gda_value_is_null (b)) ? 0 : -1;
+		}
+	if (b == NULL || gda_value_is_null (b))
+		{
+			return 1;
+		}
+
+	if (G_VALUE_TYPE (a) == G_VALUE_TYPE (b))
+		{
+			return gda_value_compare (a, b);
+		}
+
+	g_value_init (&tmp, G_VALUE_TYPE (a));
+	if (g_value_transform (b, &tmp))
+		{
+			ret = gda_value_compare (a, &tmp);
+		}
+	else
+		{
+			str_a = gda_value_stringify (a);
+			str_b = gda_value_stringify (b);
+			ret = g_strcmp0 (str_a, str_b);
+			g_free (str_a);
+			g_free (str_b);
+		}
+	g_value_unset (&tmp);
+
+	return ret;
+}
+
+static gchar
+*gdaex_data_model_index_hash_key (const GValue **values, guint n_values)
+{
+	GString *key;
+	gchar *str;
+	guint i;
+
+	key = g_string_new ("");
+	for (i = 0; i < n_values; i++)
+		{
+			if (values[i] == NULL || gda_value_is_null (values[i]))
+				{
+					g_string_append_c (key, 'N');
+				}
+			else
+				{
+					str = gda_value_stringify (values[i]);
+					g_string_append_printf (key, "V%s", str);
+					g_free (str);
+				}
+			g_string_append_c (key, '\x1f');
+		}
+
+	return g_string_free (key, FALSE);
+}
+
+static gint
+gdaex_data_model_index_compare_rows (gconstpointer a, gconstpointer b, gpointer user_data)
+{
+	GdaExDataModelIndexPrivate *priv = (GdaExDataModelIndexPrivate *)user_data;
+
+	gint row_a;
+	gint row_b;
+	guint i;
+	gint ret;
+
+	row_a = *(const gint *)a;
+	row_b = *(const gint *)b;
+
+	for (i = 0; i < priv->n_columns; i++)
+		{
+			ret = gdaex_data_model_index_value_compare (priv->keys[row_a * priv->n_columns + i],
+			                                            priv->keys[row_b * priv->n_columns + i]);
+			if (ret != 0)
+				{
+					return ret;
+				}
+		}
+
+	/* equal keys keep the order of the model */
+	return row_a - row_b;
+}
+
+/* compares the first n_values columns of the key of row with values */
+static gint
+gdaex_data_model_index_compare_key (GdaExDataModelIndexPrivate *priv, gint row, const GValue **values, guint n_values)
+{
+	guint i;
+	gint ret;
+
+	for (i = 0; i < n_values; i++)
+		{
+			ret = gdaex_data_model_index_value_compare (priv->keys[row * priv->n_columns + i], values[i]);
+			if (ret != 0)
+				{
+					return ret;
+				}
+		}
+
+	return 0;
+}
+
+/* the first position of sorted whose key is >= (or > if upper) values */
+static guint
+gdaex_data_model_index_bound (GdaExDataModelIndexPrivate *priv, const GValue **values, guint n_values, gboolean upper)
+{
+	guint low;
+	guint high;
+	guint mid;
+	gint cmp;
+
+	low = 0;
+	high = priv->sorted->len;
+	while (low < high)
+		{
+			mid = low + (high - low) / 2;
+			cmp = gdaex_data_model_index_compare_key (priv, g_array_index (priv->sorted, gint, mid), values, n_values);
+			if (cmp < 0 || (upper && cmp == 0))
+				{
+					low = mid + 1;
+				}
+			else
+				{
+					high = mid;
+				}
+		}
+
+	return low;
+}
+
+static GArray
+*gdaex_data_model_index_sorted_slice (GdaExDataModelIndexPrivate *priv, guint start, guint end)
+{
+	GArray *ret;
+
+	ret = g_array_sized_new (FALSE, FALSE, sizeof (gint), end > start ? end - start : 0);
+	if (end > start)
+		{
+			g_array_append_vals (ret, &g_array_index (priv->sorted, gint, start), end - start);
+		}
+
+	return ret;
+}
+
+/**
+ * gdaex_data_model_index_new:
+ * @model: a #GdaDataModel with random access.
+ * @type: the kind of index.
+ * @...: the names of the columns of the key, terminated with #NULL.
+ *
+ * Indexes @model on the key columns: an hash index finds the rows with a
+ * key in constant time, a sorted index also finds ranges and string
+ * prefixes with a binary search and gives the rows in key order.
+ * @model must not be changed while the index is in use.
+ *
+ * Returns: a new #GdaExDataModelIndex object, or #NULL on error.
+ */
+GdaExDataModelIndex
+*gdaex_data_model_index_new (GdaDataModel *model, GdaExDataModelIndexType type, ...)
+{
+	GdaExDataModelIndex *gdaex_data_model_index;
+	GArray *columns;
+	GArray *rows;
+	va_list ap;
+	const gchar *column_name;
+	gint col;
+	guint row;
+	guint i;
+	const GValue **values;
+	const GValue *gval;
+	gchar *key;
+
+	g_return_val_if_fail (GDA_IS_DATA_MODEL (model), NULL);
+
+	if (!(gda_data_model_get_access_flags (model) & GDA_DATA_MODEL_ACCESS_RANDOM))
+		{
+			g_warning (_("The data model doesn't support random access: unable to index it."));
+			return NULL;
+		}
+
+	columns = g_array_new (FALSE, FALSE, sizeof (gint));
+	va_start (ap, type);
+	while ((column_name = va_arg (ap, const gchar *)) != NULL)
+		{
+			col = gda_data_model_get_column_index (model, column_name);
+			if (col < 0)
+				{
+					g_warning (_("No column with name «%s»."), column_name);
+					g_array_unref (columns);
+					va_end (ap);
+					return NULL;
+				}
+			g_array_append_val (columns, col);
+		}
+	va_end (ap);
+
+	if (columns->len == 0)
+		{
+			g_warning (_("An index needs at least one column."));
+			g_array_unref (columns);
+			return NULL;
+		}
+
+	gdaex_data_model_index = GDAEX_DATA_MODEL_INDEX (g_object_new (gdaex_data_model_index_get_type (), NULL));
+
+	GdaExDataModelIndexPrivate *priv = GDAEX_DATA_MODEL_INDEX_GET_PRIVATE (gdaex_data_model_index);
+
+	priv->model = g_object_ref (model);
+	priv->type = type;
+	priv->n_columns = columns->len;
+	priv->columns = (gint *)g_array_free (columns, FALSE);
+	priv->n_rows = gda_data_model_get_n_rows (model);
+
+	values = g_new0 (const GValue *, priv->n_columns);
+
+	if (priv->type == GDAEX_DATA_MODEL_INDEX_HASH)
+		{
+			priv->hash = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, gdaex_data_model_index_rows_free);
+			for (row = 0; row < priv->n_rows; row++)
+				{
+					for (i = 0; i < priv->n_columns; i++)
+						{
+							values[i] = gda_data_model_get_value_at (model, priv->columns[i], row, NULL);
+						}
+
+					key = gdaex_data_model_index_hash_key (values, priv->n_columns);
+					rows = g_hash_table_lookup (priv->hash, key);
+					if (rows == NULL)
+						{
+							rows = g_array_sized_new (FALSE, FALSE, sizeof (gint), 1);
+							g_hash_table_insert (priv->hash, key, rows);
+						}
+					else
+						{
+							g_free (key);
+						}
+					g_array_append_val (rows, row);
+				}
+		}
+	else
+		{
+			/* the values are copied: some models reuse the returned GValue */
+			priv->keys = g_new0 (GValue *, priv->n_rows * priv->n_columns);
+			priv->sorted = g_array_sized_new (FALSE, FALSE, sizeof (gint), priv->n_rows);
+			for (row = 0; row < priv->n_rows; row++)
+				{
+					for (i = 0; i < priv->n_columns; i++)
+						{
+							gval = gda_data_model_get_value_at (model, priv->columns[i], row, NULL);
+							if (gval != NULL && !gda_value_is_null (gval))
+								{
+									priv->keys[row * priv->n_columns + i] = gda_value_copy (gval);
+								}
+						}
+					g_array_append_val (priv->sorted, row);
+				}
+			g_array_sort_with_data (priv->sorted, gdaex_data_model_index_compare_rows, priv);
+		}
+
+	g_free (values);
+
+	return gdaex_data_model_index;
+}
+
+/**
+ * gdaex_data_model_index_get_model:
+ * @index: a #GdaExDataModelIndex object.
+ *
+ * Returns: (transfer none): the indexed model.
+ */
+GdaDataModel
+*gdaex_data_model_index_get_model (GdaExDataModelIndex *index)
+{
+	g_return_val_if_fail (GDAEX_IS_DATA_MODEL_INDEX (index), NULL);
+
+	GdaExDataModelIndexPrivate *priv = GDAEX_DATA_MODEL_INDEX_GET_PRIVATE (index);
+
+	return priv->model;
+}
+
+static GArray
+*gdaex_data_model_index_lookup_valist (GdaExDataModelIndex *index, va_list ap, gboolean first_only)
+{
+	GArray *ret;
+	GArray *rows;
+	const GValue **values;
+	gchar *key;
+	guint start;
+	guint end;
+	guint i;
+
+	GdaExDataModelIndexPrivate *priv = GDAEX_DATA_MODEL_INDEX_GET_PRIVATE (index);
+
+	values = g_new0 (const GValue *, priv->n_columns);
+	for (i = 0; i < priv->n_columns; i++)
+		{
+			values[i] = va_arg (ap, const GValue *);
+		}
+
+	if (priv->type == GDAEX_DATA_MODEL_INDEX_HASH)
+		{
+			key = gdaex_data_model_index_hash_key (values, priv->n_columns);
+			rows = g_hash_table_lookup (priv->hash, key);
+			g_free (key);
+
+			ret = g_array_new (FALSE, FALSE, sizeof (gint));
+			if (rows != NULL)
+				{
+					g_array_append_vals (ret, rows->data, first_only ? 1 : rows->len);
+				}
+		}
+	else
+		{
+			start = gdaex_data_model_index_bound (priv, values, priv->n_columns, FALSE);
+			end = gdaex_data_model_index_bound (priv, values, priv->n_columns, TRUE);
+			if (first_only && end > start)
+				{
+					end = start + 1;
+				}
+			ret = gdaex_data_model_index_sorted_slice (priv, start, end);
+		}
+
+	g_free (values);
+
+	return ret;
+}
+
+/**
+ * gdaex_data_model_index_get_row:
+ * @index: a #GdaExDataModelIndex object.
+ * @...: a #GValue for every column of the key.
+ *
+ * Returns: the first row of the model with the key, or -1.
+ */
+gint
+gdaex_data_model_index_get_row (GdaExDataModelIndex *index, ...)
+{
+	GArray *rows;
+	va_list ap;
+	gint ret;
+
+	g_return_val_if_fail (GDAEX_IS_DATA_MODEL_INDEX (index), -1);
+
+	va_start (ap, index);
+	rows = gdaex_data_model_index_lookup_valist (index, ap, TRUE);
+	va_end (ap);
+
+	ret = rows->len > 0 ? g_array_index (rows, gint, 0) : -1;
+	g_array_unref (rows);
+
+	return ret;
+}
+
+/**
+ * gdaex_data_model_index_lookup:
+ * @index: a #GdaExDataModelIndex object.
+ * @...: a #GValue for every column of the key.
+ *
+ * Returns: (transfer full) (element-type gint): the rows of the model with
+ * the key, in the order of the model.
+ */
+GArray
+*gdaex_data_model_index_lookup (GdaExDataModelIndex *index, ...)
+{
+	GArray *ret;
+	va_list ap;
+
+	g_return_val_if_fail (GDAEX_IS_DATA_MODEL_INDEX (index), NULL);
+
+	va_start (ap, index);
+	ret = gdaex_data_model_index_lookup_valist (index, ap, FALSE);
+	va_end (ap);
+
+	return ret;
+}
+
+/**
+ * gdaex_data_model_index_range:
+ * @index: a sorted #GdaExDataModelIndex object.
+ * @from: (nullable): the lowest value of the first column of the key.
+ * @to: (nullable): the highest value of the first column of the key.
+ *
+ * Both bounds are included; a #NULL bound is open, but NULL values are
+ * never in a range.
+ *
+ * Returns: (transfer full) (element-type gint): the rows of the model in
+ * key order, or #NULL if @index isn't sorted.
+ */
+GArray
+*gdaex_data_model_index_range (GdaExDataModelIndex *index, const GValue *from, const GValue *to)
+{
+	guint start;
+	guint end;
+
+	g_return_val_if_fail (GDAEX_IS_DATA_MODEL_INDEX (index), NULL);
+
+	GdaExDataModelIndexPrivate *priv = GDAEX_DATA_MODEL_INDEX_GET_PRIVATE (index);
+
+	if (priv->type != GDAEX_DATA_MODEL_INDEX_SORTED)
+		{
+			g_warning (_("Range lookups need a sorted index."));
+			return NULL;
+		}
+
+	if (from != NULL && !gda_value_is_null (from))
+		{
+			start = gdaex_data_model_index_bound (priv, &from, 1, FALSE);
+		}
+	else
+		{
+			/* after the NULLs */
+			from = NULL;
+			start = gdaex_data_model_index_bound (priv, &from, 1, TRUE);
+		}
+
+	if (to != NULL && !gda_value_is_null (to))
+		{
+			end = gdaex_data_model_index_bound (priv, &to, 1, TRUE);
+		}
+	else
+		{
+			end = priv->sorted->len;
+		}
+
+	return gdaex_data_model_index_sorted_slice (priv, start, end);
+}
+
+/**
+ * gdaex_data_model_index_prefix:
+ * @index: a sorted #GdaExDataModelIndex object on a string column.
+ * @prefix: the beginning of the strings to find.
+ *
+ * Returns: (transfer full) (element-type gint): the rows of the model whose
+ * first column of the key starts with @prefix, in key order, or #NULL if
+ * @index isn't sorted.
+ */
+GArray
+*gdaex_data_model_index_prefix (GdaExDataModelIndex *index, const gchar *prefix)
+{
+	GValue gval = G_VALUE_INIT;
+	const GValue *pval;
+	const GValue *key;
+	guint start;
+	guint end;
+
+	g_return_val_if_fail (GDAEX_IS_DATA_MODEL_INDEX (index), NULL);
+	g_return_val_if_fail (prefix != NULL, NULL);
+
+	GdaExDataModelIndexPrivate *priv = GDAEX_DATA_MODEL_INDEX_GET_PRIVATE (index);
+
+	if (priv->type != GDAEX_DATA_MODEL_INDEX_SORTED)
+		{
+			g_warning (_("Prefix lookups need a sorted index."));
+			return NULL;
+		}
+
+	/* the strings with the prefix follow the prefix itself */
+	g_value_init (&gval, G_TYPE_STRING);
+	g_value_set_string (&gval, prefix);
+	pval = &gval;
+	start = gdaex_data_model_index_bound (priv, &pval, 1, FALSE);
+	g_value_unset (&gval);
+
+	for (end = start; end < priv->sorted->len; end++)
+		{
+			key = priv->keys[g_array_index (priv->sorted, gint, end) * priv->n_columns];
+			if (key == NULL
+			    || !G_VALUE_HOLDS_STRING (key)
+			    || !g_str_has_prefix (g_value_get_string (key), prefix))
+				{
+					break;
+				}
+		}
+
+	return gdaex_data_model_index_sorted_slice (priv, start, end);
+}
+
+/**
+ * gdaex_data_model_index_get_view:
+ * @index: a #GdaExDataModelIndex object.
+ * @rows: (nullable) (element-type gint): the rows returned by a lookup,
+ * or #NULL for every row.
+ *
+ * Returns: (transfer full): a read-only model over the indexed model with
+ * only @rows, sharing its values (see gdaex_data_model_view_new()). With
+ * @rows #NULL the rows are in key order for a sorted index.
+ */
+GdaDataModel
+*gdaex_data_model_index_get_view (GdaExDataModelIndex *index, GArray *rows)
+{
+	GdaDataModel *ret;
+	guint row;
+
+	g_return_val_if_fail (GDAEX_IS_DATA_MODEL_INDEX (index), NULL);
+
+	GdaExDataModelIndexPrivate *priv = GDAEX_DATA_MODEL_INDEX_GET_PRIVATE (index);
+
+	if (rows != NULL)
+		{
+			return gdaex_data_model_view_new (priv->model, rows);
+		}
+
+	if (priv->type == GDAEX_DATA_MODEL_INDEX_SORTED)
+		{
+			return gdaex_data_model_view_new (priv->model, priv->sorted);
+		}
+
+	rows = g_array_sized_new (FALSE, FALSE, sizeof (gint), priv->n_rows);
+	for (row = 0; row < priv->n_rows; row++)
+		{
+			g_array_append_val (rows, row);
+		}
+	ret = gdaex_data_model_view_new (priv->model, rows);
+	g_array_unref (rows);
+
+	return ret;
+}
+
+/* PRIVATE */
+static void
+gdaex_data_model_index_finalize (GObject *object)
+{
+	GdaExDataModelIndex *gdaex_data_model_index = GDAEX_DATA_MODEL_INDEX (object);
+	GdaExDataModelIndexPrivate *priv = GDAEX_DATA_MODEL_INDEX_GET_PRIVATE (gdaex_data_model_index);
+
+	guint i;
+
+	if (priv->hash != NULL)
+		{
+			g_hash_table_destroy (priv->hash);
+		}
+	if (priv->keys != NULL)
+		{
+			for (i = 0; i < priv->n_rows * priv->n_columns; i++)
+				{
+					if (priv->keys[i] != NULL)
+						{
+							gda_value_free (priv->keys[i]);
+						}
+				}
+			g_free (priv->keys);
+		}
+	if (priv->sorted != NULL)
+		{
+			g_array_unref (priv->sorted);
+		}
+	g_free (priv->columns);
+	if (priv->model != NULL)
+		{
+			g_object_unref (priv->model);
+		}
+
+	G_OBJECT_CLASS (gdaex_data_model_index_parent_class)->finalize (object);
+}
+
+static void
+gdaex_data_model_index_set_property (GObject *object, guint property_id, const GValue *value, GParamSpec *pspec)
+{
+	GdaExDataModelIndex *gdaex_data_model_index = GDAEX_DATA_MODEL_INDEX (object);
+	GdaExDataModelIndexPrivate *priv = GDAEX_DATA_MODEL_INDEX_GET_PRIVATE (gdaex_data_model_index);
+
+	switch (property_id)
+		{
+			default:
+				G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+				break;
+		}
+}
+
+static void
+gdaex_data_model_index_get_property (GObject *object, guint property_id, GValue *value, GParamSpec *pspec)
+{
+	GdaExDataModelIndex *gdaex_data_model_index = GDAEX_DATA_MODEL_INDEX (object);
+	GdaExDataModelIndexPrivate *priv = GDAEX_DATA_MODEL_INDEX_GET_PRIVATE (gdaex_data_model_index);
+
+	switch (property_id)
+		{
+			default:
+				G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+				break;
+		}
+}
@@ -0,0 +1,79 @@
+/*
+ *  modelindex.h
+ *
+ *  Copyright (C) 2016 Andrea Zagli <azagli@libero.it>
+ *
+ *  This file is part of libgdaex.
+ *
+ *  libgdaex is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  libgdaex is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with libgdaex; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#ifndef __GDAEX_DATA_MODEL_INDEX_H__
+#define __GDAEX_DATA_MODEL_INDEX_H__
+
+#include <glib.h>
+#include <glib-object.h>
+
+#include "gdaex.h"
+
+G_BEGIN_DECLS
+
+
+typedef enum
+	{
+		GDAEX_DATA_MODEL_INDEX_HASH,
+		GDAEX_DATA_MODEL_INDEX_SORTED
+	} GdaExDataModelIndexType;
+
+#define GDAEX_TYPE_DATA_MODEL_INDEX                 (gdaex_data_model_index_get_type ())
+#define GDAEX_DATA_MODEL_INDEX(obj)                 (G_TYPE_CHECK_INSTANCE_CAST ((obj), GDAEX_TYPE_DATA_MODEL_INDEX, GdaExDataModelIndex))
+#define GDAEX_DATA_MODEL_INDEX_CLASS(klass)         (G_TYPE_CHECK_CLASS_CAST ((klass), GDAEX_TYPE_DATA_MODEL_INDEX, GdaExDataModelIndexClass))
+#define GDAEX_IS_DATA_MODEL_INDEX(obj)              (G_TYPE_CHECK_INSTANCE_TYPE ((obj), GDAEX_TYPE_DATA_MODEL_INDEX))
+#define GDAEX_IS_DATA_MODEL_INDEX_CLASS(klass)      (G_TYPE_CHECK_CLASS_TYPE ((klass), GDAEX_TYPE_DATA_MODEL_INDEX))
+#define GDAEX_DATA_MODEL_INDEX_GET_CLASS(obj)       (G_TYPE_INSTANCE_GET_CLASS ((obj), GDAEX_TYPE_DATA_MODEL_INDEX, GdaExDataModelIndexClass))
+
+
+typedef struct _GdaExDataModelIndex GdaExDataModelIndex;
+typedef struct _GdaExDataModelIndexClass GdaExDataModelIndexClass;
+
+struct _GdaExDataModelIndex
+	{
+		GObject parent;
+	};
+
+struct _GdaExDataModelIndexClass
+	{
+		GObjectClass parent_class;
+	};
+
+GType gdaex_data_model_index_get_type (void) G_GNUC_CONST;
+
+
+GdaExDataModelIndex *gdaex_data_model_index_new (GdaDataModel *model, GdaExDataModelIndexType type, ...) G_GNUC_NULL_TERMINATED;
+
+GdaDataModel *gdaex_data_model_index_get_model (GdaExDataModelIndex *index);
+
+gint gdaex_data_model_index_get_row (GdaExDataModelIndex *index, ...);
+GArray *gdaex_data_model_index_lookup (GdaExDataModelIndex *index, ...);
+GArray *gdaex_data_model_index_range (GdaExDataModelIndex *index, const GValue *from, const GValue *to);
+GArray *gdaex_data_model_index_prefix (GdaExDataModelIndex *index, const gchar *prefix);
+
+GdaDataModel *gdaex_data_model_index_get_view (GdaExDataModelIndex *index, GArray *rows);
+
+
+G_END_DECLS
+
+#endif /* __GDAEX_DATA_MODEL_INDEX_H__ */
@@ -0,0 +1,273 @@
+/*
+ *  modelview.c
+ *
+ *  Copyright (C) 2016 Andrea Zagli <azagli@libero.it>
+ *
+ *  This file is part of libgdaex.
+ *
+ *  libgdaex is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  libgdaex is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with libgdaex; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+	#include <config.h>
+#endif
+
+#include <glib/gi18n-lib.h>
+
+#include "modelview.h"
+
+static void gdaex_data_model_view_class_init (GdaExDataModelViewClass *klass);
+static void gdaex_data_model_view_data_model_init (GdaDataModelIface *iface);
+static void gdaex_data_model_view_init (GdaExDataModelView *gdaex_data_model_view);
+
+static void gdaex_data_model_view_finalize (GObject *object);
+
+static void gdaex_data_model_view_set_property (GObject *object,
+                               guint property_id,
+                               const GValue *value,
+                               GParamSpec *pspec);
+static void gdaex_data_model_view_get_property (GObject *object,
+                               guint property_id,
+                               GValue *value,
+                               GParamSpec *pspec);
+
+static gint gdaex_data_model_view_get_n_rows (GdaDataModel *model);
+static gint gdaex_data_model_view_get_n_columns (GdaDataModel *model);
+static GdaColumn *gdaex_data_model_view_describe_column (GdaDataModel *model, gint col);
+static GdaDataModelAccessFlags gdaex_data_model_view_get_access_flags (GdaDataModel *model);
+static const GValue *gdaex_data_model_view_get_value_at (GdaDataModel *model, gint col, gint row, GError **error);
+static GdaValueAttribute gdaex_data_model_view_get_attributes_at (GdaDataModel *model, gint col, gint row);
+
+
+#define GDAEX_DATA_MODEL_VIEW_GET_PRIVATE(obj) (G_TYPE_INSTANCE_GET_PRIVATE ((obj), GDAEX_TYPE_DATA_MODEL_VIEW, GdaExDataModelViewPrivate))
+
+typedef struct _GdaExDataModelViewPrivate GdaExDataModelViewPrivate;
+struct _GdaExDataModelViewPrivate
+{
+	GdaDataModel *model;
+	GArray *rows;   /* gint, the rows of model in the order of the view */
+};
+
+G_DEFINE_TYPE_WITH_CODE (GdaExDataModelView, gdaex_data_model_view, G_TYPE_OBJECT,
+                         G_IMPLEMENT_INTERFACE (GDA_TYPE_DATA_MODEL, gdaex_data_model_view_data_model_init))
+
+static void
+gdaex_data_model_view_class_init (GdaExDataModelViewClass *klass)
+{
+	GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+	g_type_class_add_private (object_class, sizeof (GdaExDataModelViewPrivate));
+
+	object_class->set_property = gdaex_data_model_view_set_property;
+	object_class->get_property = gdaex_data_model_view_get_property;
+	object_class->finalize = gdaex_data_model_view_finalize;
+}
+
+static void
+gdaex_data_model_view_data_model_init (GdaDataModelIface *iface)
+{
+	iface->i_get_n_rows = gdaex_data_model_view_get_n_rows;
+	iface->i_get_n_columns = gdaex_data_model_view_get_n_columns;
+	iface->i_describe_column = gdaex_data_model_view_describe_column;
+	iface->i_get_access_flags = gdaex_data_model_view_get_access_flags;
+	iface->i_get_value_at = gdaex_data_model_view_get_value_at;
+	iface->i_get_attributes_at = gdaex_data_model_view_get_attributes_at;
+}
+
+static void
+gdaex_data_model_view_init (GdaExDataModelView *gdaex_data_model_view)
+{
+	GdaExDataModelViewPrivate *priv = GDAEX_DATA_MODEL_VIEW_GET_PRIVATE (gdaex_data_model_view);
+
+	priv->model = NULL;
+	priv->rows = NULL;
+}
+
+/**
+ * gdaex_data_model_view_new:
+ * @model: a #GdaDataModel with random access.
+ * @rows: (element-type gint): the rows of @model to show, in order.
+ *
+ * Creates a read-only model showing only @rows of @model, without copying
+ * any value. @rows is referenced, not copied: it must not be changed
+ * afterwards.
+ *
+ * Returns: (transfer full): a new #GdaDataModel.
+ */
+GdaDataModel
+*gdaex_data_model_view_new (GdaDataModel *model, GArray *rows)
+{
+	GdaExDataModelView *gdaex_data_model_view;
+
+	g_return_val_if_fail (GDA_IS_DATA_MODEL (model), NULL);
+	g_return_val_if_fail (rows != NULL, NULL);
+	g_return_val_if_fail (g_array_get_element_size (rows) == sizeof (gint), NULL);
+
+	gdaex_data_model_view = GDAEX_DATA_MODEL_VIEW (g_object_new (gdaex_data_model_view_get_type (), NULL));
+
+	GdaExDataModelViewPrivate *priv = GDAEX_DATA_MODEL_VIEW_GET_PRIVATE (gdaex_data_model_view);
+
+	priv->model = g_object_ref (model);
+	priv->rows = g_array_ref (rows);
+
+	return GDA_DATA_MODEL (gdaex_data_model_view);
+}
+
+/**
+ * gdaex_data_model_view_get_model:
+ * @view: a #GdaExDataModelView object.
+ *
+ * Returns: (transfer none): the model under @view.
+ */
+GdaDataModel
+*gdaex_data_model_view_get_model (GdaExDataModelView *view)
+{
+	g_return_val_if_fail (GDAEX_IS_DATA_MODEL_VIEW (view), NULL);
+
+	GdaExDataModelViewPrivate *priv = GDAEX_DATA_MODEL_VIEW_GET_PRIVATE (view);
+
+	return priv->model;
+}
+
+/**
+ * gdaex_data_model_view_get_model_row:
+ * @view: a #GdaExDataModelView object.
+ * @row: a row of @view.
+ *
+ * Returns: the row of the model under @view, or -1 if @row is out of range.
+ */
+gint
+gdaex_data_model_view_get_model_row (GdaExDataModelView *view, gint row)
+{
+	g_return_val_if_fail (GDAEX_IS_DATA_MODEL_VIEW (view), -1);
+
+	GdaExDataModelViewPrivate *priv = GDAEX_DATA_MODEL_VIEW_GET_PRIVATE (view);
+
+	if (row < 0 || row >= (gint)priv->rows->len)
+		{
+			return -1;
+		}
+
+	return g_array_index (priv->rows, gint, row);
+}
+
+static gint
+gdaex_data_model_view_get_n_rows (GdaDataModel *model)
+{
+	GdaExDataModelViewPrivate *priv = GDAEX_DATA_MODEL_VIEW_GET_PRIVATE (model);
+
+	return priv->rows->len;
+}
+
+static gint
+gdaex_data_model_view_get_n_columns (GdaDataModel *model)
+{
+	GdaExDataModelViewPrivate *priv = GDAEX_DATA_MODEL_VIEW_GET_PRIVATE (model);
+
+	return gda_data_model_get_n_columns (priv->model);
+}
+
+static GdaColumn
+*gdaex_data_model_view_describe_column (GdaDataModel *model, gint col)
+{
+	GdaExDataModelViewPrivate *priv = GDAEX_DATA_MODEL_VIEW_GET_PRIVATE (model);
+
+	return gda_data_model_describe_column (priv->model, col);
+}
+
+static GdaDataModelAccessFlags
+gdaex_data_model_view_get_access_flags (GdaDataModel *model)
+{
+	return GDA_DATA_MODEL_ACCESS_RANDOM
+	       | GDA_DATA_MODEL_ACCESS_CURSOR_FORWARD
+	       | GDA_DATA_MODEL_ACCESS_CURSOR_BACKWARD;
+}
+
+static const GValue
+*gdaex_data_model_view_get_value_at (GdaDataModel *model, gint col, gint row, GError **error)
+{
+	GdaExDataModelViewPrivate *priv = GDAEX_DATA_MODEL_VIEW_GET_PRIVATE (model);
+
+	if (row < 0 || row >= (gint)priv->rows->len)
+		{
+			g_set_error (error, GDA_DATA_MODEL_ERROR, GDA_DATA_MODEL_ROW_OUT_OF_RANGE_ERROR,
+			             _("Row %d out of range (0-%d)"), row, priv->rows->len - 1);
+			return NULL;
+		}
+
+	return gda_data_model_get_value_at (priv->model, col, g_array_index (priv->rows, gint, row), error);
+}
+
+static GdaValueAttribute
+gdaex_data_model_view_get_attributes_at (GdaDataModel *model, gint col, gint row)
+{
+	GdaExDataModelViewPrivate *priv = GDAEX_DATA_MODEL_VIEW_GET_PRIVATE (model);
+
+	if (row < 0 || row >= (gint)priv->rows->len)
+		{
+			return GDA_VALUE_ATTR_NO_MODIF;
+		}
+
+	return gda_data_model_get_attributes_at (priv->model, col, g_array_index (priv->rows, gint, row))
+	       | GDA_VALUE_ATTR_NO_MODIF;
+}
+
+/* PRIVATE */
+static void
+gdaex_data_model_view_finalize (GObject *object)
+{
+	GdaExDataModelView *gdaex_data_model_view = GDAEX_DATA_MODEL_VIEW (object);
+	GdaExDataModelViewPrivate *priv = GDAEX_DATA_MODEL_VIEW_GET_PRIVATE (gdaex_data_model_view);
+
+	if (priv->model != NULL)
+		{
+			g_object_unref (priv->model);
+		}
+	if (priv->rows != NULL)
+		{
+			g_array_unref (priv->rows);
+		}
+
+	G_OBJECT_CLASS (gdaex_data_model_view_parent_class)->finalize (object);
+}
+
+static void
+gdaex_data_model_view_set_property (GObject *object, guint property_id, const GValue *value, GParamSpec *pspec)
+{
+	GdaExDataModelView *gdaex_data_model_view = GDAEX_DATA_MODEL_VIEW (object);
+	GdaExDataModelViewPrivate *priv = GDAEX_DATA_MODEL_VIEW_GET_PRIVATE (gdaex_data_model_view);
+
+	switch (property_id)
+		{
+			default:
+				G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+				break;
+		}
+}
+
+static void
+gdaex_data_model_view_get_property (GObject *object, guint property_id, GValue *value, GParamSpec *pspec)
+{
+	GdaExDataModelView *gdaex_data_model_view = GDAEX_DATA_MODEL_VIEW (object);
+	GdaExDataModelViewPrivate *priv = GDAEX_DATA_MODEL_VIEW_GET_PRIVATE (gdaex_data_model_view);
+
+	switch (property_id)
+		{
+			default:
+				G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+				break;
+		}
+}
@@ -0,0 +1,67 @@
+/*
+ *  modelview.h
+ *
+ *  Copyright (C) 2016 Andrea Zagli <azagli@libero.it>
+ *
+ *  This file is part of libgdaex.
+ *
+ *  libgdaex is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  libgdaex is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with libgdaex; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#ifndef __GDAEX_DATA_MODEL_VIEW_H__
+#define __GDAEX_DATA_MODEL_VIEW_H__
+
+#include <glib.h>
+#include <glib-object.h>
+
+#include "gdaex.h"
+
+G_BEGIN_DECLS
+
+
+#define GDAEX_TYPE_DATA_MODEL_VIEW                 (gdaex_data_model_view_get_type ())
+#define GDAEX_DATA_MODEL_VIEW(obj)                 (G_TYPE_CHECK_INSTANCE_CAST ((obj), GDAEX_TYPE_DATA_MODEL_VIEW, GdaExDataModelView))
+#define GDAEX_DATA_MODEL_VIEW_CLASS(klass)         (G_TYPE_CHECK_CLASS_CAST ((klass), GDAEX_TYPE_DATA_MODEL_VIEW, GdaExDataModelViewClass))
+#define GDAEX_IS_DATA_MODEL_VIEW(obj)              (G_TYPE_CHECK_INSTANCE_TYPE ((obj), GDAEX_TYPE_DATA_MODEL_VIEW))
+#define GDAEX_IS_DATA_MODEL_VIEW_CLASS(klass)      (G_TYPE_CHECK_CLASS_TYPE ((klass), GDAEX_TYPE_DATA_MODEL_VIEW))
+#define GDAEX_DATA_MODEL_VIEW_GET_CLASS(obj)       (G_TYPE_INSTANCE_GET_CLASS ((obj), GDAEX_TYPE_DATA_MODEL_VIEW, GdaExDataModelViewClass))
+
+
+typedef struct _GdaExDataModelView GdaExDataModelView;
+typedef struct _GdaExDataModelViewClass GdaExDataModelViewClass;
+
+struct _GdaExDataModelView
+	{
+		GObject parent;
+	};
+
+struct _GdaExDataModelViewClass
+	{
+		GObjectClass parent_class;
+	};
+
+GType gdaex_data_model_view_get_type (void) G_GNUC_CONST;
+
+
+GdaDataModel *gdaex_data_model_view_new (GdaDataModel *model, GArray *rows);
+
+GdaDataModel *gdaex_data_model_view_get_model (GdaExDataModelView *view);
+gint gdaex_data_model_view_get_model_row (GdaExDataModelView *view, gint row);
+
+
+G_END_DECLS
+
+#endif /* __GDAEX_DATA_MODEL_VIEW_H__ */
@@ -0,0 +1,369 @@
+/*
+ *  pager.c
+ *
+ *  Copyright (C) 2016 Andrea Zagli <azagli@libero.it>
+ *
+ *  This file is part of libgdaex.
+ *
+ *  libgdaex is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  libgdaex is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with libgdaex; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+	#include <config.h>
+#endif
+
+#include <glib/gi18n-lib.h>
+
+#include "pager.h"
+
+static void gdaex_pager_class_init (GdaExPagerClass *klass);
+static void gdaex_pager_init (GdaExPager *gdaex_pager);
+
+static void gdaex_pager_finalize (GObject *object);
+
+static void gdaex_pager_set_property (GObject *object,
+                               guint property_id,
+                               const GValue *value,
+                               GParamSpec *pspec);
+static void gdaex_pager_get_property (GObject *object,
+                               guint property_id,
+                               GValue *value,
+                               GParamSpec *pspec);
+
+
+#define GDAEX_PAGER_GET_PRIVATE(obj) (G_TYPE_INSTANCE_GET_PRIVATE ((obj), GDAEX_TYPE_PAGER, GdaExPagerPrivate))
+
+typedef struct _GdaExPagerPrivate GdaExPagerPrivate;
+struct _GdaExPagerPrivate
+{
+	GdaEx *gdaex;
+	GdaExSqlBuilder *sqlb;
+	GdaSet *params;
+	guint page_size;
+	gboolean keyset;
+
+	/* OFFSET: the caller's parameters with LIMIT and OFFSET */
+	GdaSet *page_params;
+
+	guint page;
+	gboolean finished;
+
+	/* the last page, where the keyset continues from */
+	GdaDataModel *last;
+};
+
+G_DEFINE_TYPE (GdaExPager, gdaex_pager, G_TYPE_OBJECT)
+
+static void
+gdaex_pager_class_init (GdaExPagerClass *klass)
+{
+	GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+	g_type_class_add_private (object_class, sizeof (GdaExPagerPrivate));
+
+	object_class->set_property = gdaex_pager_set_property;
+	object_class->get_property = gdaex_pager_get_property;
+	object_class->finalize = gdaex_pager_finalize;
+}
+
+static void
+gdaex_pager_init (GdaExPager *gdaex_pager)
+{
+	GdaExPagerPrivate *priv = GDAEX_PAGER_GET_PRIVATE (gdaex_pager);
+
+	priv->gdaex = NULL;
+	priv->sqlb = NULL;
+	priv->params = NULL;
+	priv->page_size = 0;
+	priv->keyset = FALSE;
+	priv->page_params = NULL;
+	priv->page = 0;
+	priv->finished = FALSE;
+	priv->last = NULL;
+}
+
+/**
+ * gdaex_pager_new:
+ * @gdaex: a #GdaEx object.
+ * @sqlb: a SELECT #GdaExSqlBuilder with an ORDER BY.
+ * @params: (nullable): the values of the parameters of @sqlb.
+ * @page_size: the number of rows of every page.
+ * @keyset: TRUE to continue from the last row of the previous page
+ * (see gdaex_sql_builder_keyset()), FALSE to use OFFSET.
+ *
+ * @sqlb is owned by the pager, that sets its LIMIT (and OFFSET or keyset
+ * predicate): it must not be changed while paging. Both LIMIT and OFFSET
+ * are parameters, so every page reuses the same prepared statement.
+ *
+ * Returns: a new #GdaExPager object.
+ */
+GdaExPager
+*gdaex_pager_new (GdaEx *gdaex, GdaExSqlBuilder *sqlb, GdaSet *params, guint page_size, gboolean keyset)
+{
+	GdaExPager *gdaex_pager;
+
+	g_return_val_if_fail (IS_GDAEX (gdaex), NULL);
+	g_return_val_if_fail (GDAEX_IS_SQLBUILDER (sqlb), NULL);
+	g_return_val_if_fail (params == NULL || GDA_IS_SET (params), NULL);
+	g_return_val_if_fail (page_size > 0, NULL);
+
+	gdaex_pager = GDAEX_PAGER (g_object_new (gdaex_pager_get_type (), NULL));
+
+	GdaExPagerPrivate *priv = GDAEX_PAGER_GET_PRIVATE (gdaex_pager);
+
+	priv->gdaex = g_object_ref (gdaex);
+	priv->sqlb = g_object_ref (sqlb);
+	priv->params = params != NULL ? g_object_ref (params) : NULL;
+	priv->page_size = page_size;
+	priv->keyset = keyset;
+
+	if (priv->keyset)
+		{
+			/* the limit doesn't change anymore */
+			gdaex_sql_builder_limit (priv->sqlb, priv->page_size, 0);
+		}
+	else
+		{
+			gdaex_sql_builder_limit_params (priv->sqlb, "gdaex_pager_limit", "gdaex_pager_offset");
+			priv->page_params = gda_set_new_inline (2,
+			                                        "gdaex_pager_limit", G_TYPE_INT, (gint)priv->page_size,
+			                                        "gdaex_pager_offset", G_TYPE_INT, 0);
+			if (priv->params != NULL)
+				{
+					/* the caller's holders are shared: their values stay current */
+					gda_set_merge_with_set (priv->page_params, priv->params);
+				}
+		}
+
+	return gdaex_pager;
+}
+
+/* sets into @set the values of the caller's parameters */
+static void
+gdaex_pager_bind_params (GdaExPager *pager, GdaSet *set)
+{
+	GSList *holders;
+	GdaHolder *holder;
+
+	GdaExPagerPrivate *priv = GDAEX_PAGER_GET_PRIVATE (pager);
+
+	if (priv->params == NULL)
+		{
+			return;
+		}
+
+	for (holders = priv->params->holders; holders != NULL; holders = g_slist_next (holders))
+		{
+			if (!gda_holder_is_valid ((GdaHolder *)holders->data))
+				{
+					continue;
+				}
+			holder = gda_set_get_holder (set, gda_holder_get_id ((GdaHolder *)holders->data));
+			if (holder != NULL)
+				{
+					gda_holder_set_value (holder, gda_holder_get_value ((GdaHolder *)holders->data), NULL);
+				}
+		}
+}
+
+/**
+ * gdaex_pager_next:
+ * @pager: a #GdaExPager object.
+ *
+ * Returns: (transfer full): the next page, or #NULL when there are no
+ * more rows or on error.
+ */
+GdaDataModel
+*gdaex_pager_next (GdaExPager *pager)
+{
+	GdaDataModel *dm;
+	GdaSet *params;
+	gint nrows;
+
+	g_return_val_if_fail (GDAEX_IS_PAGER (pager), NULL);
+
+	GdaExPagerPrivate *priv = GDAEX_PAGER_GET_PRIVATE (pager);
+
+	if (priv->finished)
+		{
+			return NULL;
+		}
+
+	if (!priv->keyset)
+		{
+			if (!gda_set_set_holder_value (priv->page_params, NULL, "gdaex_pager_offset", (gint)(priv->page * priv->page_size)))
+				{
+					priv->finished = TRUE;
+					return NULL;
+				}
+			params = priv->page_params;
+		}
+	else if (priv->last != NULL)
+		{
+			params = gdaex_sql_builder_keyset (priv->sqlb, priv->last, gda_data_model_get_n_rows (priv->last) - 1);
+			if (params == NULL)
+				{
+					priv->finished = TRUE;
+					return NULL;
+				}
+			gdaex_pager_bind_params (pager, params);
+		}
+	else
+		{
+			params = priv->params;
+		}
+
+	dm = gdaex_sql_builder_query (priv->sqlb, priv->gdaex, params);
+	if (dm == NULL)
+		{
+			priv->finished = TRUE;
+			return NULL;
+		}
+
+	nrows = gda_data_model_get_n_rows (dm);
+	if (nrows < (gint)priv->page_size)
+		{
+			priv->finished = TRUE;
+		}
+	if (nrows <= 0)
+		{
+			g_object_unref (dm);
+			return NULL;
+		}
+
+	if (priv->last != NULL)
+		{
+			g_object_unref (priv->last);
+		}
+	priv->last = g_object_ref (dm);
+	priv->page++;
+
+	return dm;
+}
+
+/**
+ * gdaex_pager_rewind:
+ * @pager: a #GdaExPager object.
+ *
+ * Starts again from the first page: the next call to gdaex_pager_next()
+ * returns it.
+ */
+void
+gdaex_pager_rewind (GdaExPager *pager)
+{
+	g_return_if_fail (GDAEX_IS_PAGER (pager));
+
+	GdaExPagerPrivate *priv = GDAEX_PAGER_GET_PRIVATE (pager);
+
+	if (priv->keyset)
+		{
+			/* the first page has no continuation predicate */
+			gdaex_sql_builder_keyset_reset (priv->sqlb);
+		}
+
+	if (priv->last != NULL)
+		{
+			g_object_unref (priv->last);
+			priv->last = NULL;
+		}
+	priv->page = 0;
+	priv->finished = FALSE;
+}
+
+/**
+ * gdaex_pager_get_page:
+ * @pager: a #GdaExPager object.
+ *
+ * Returns: the number of pages returned so far.
+ */
+guint
+gdaex_pager_get_page (GdaExPager *pager)
+{
+	g_return_val_if_fail (GDAEX_IS_PAGER (pager), 0);
+
+	GdaExPagerPrivate *priv = GDAEX_PAGER_GET_PRIVATE (pager);
+
+	return priv->page;
+}
+
+/**
+ * gdaex_pager_is_finished:
+ * @pager: a #GdaExPager object.
+ *
+ * Returns: TRUE if there are no more pages.
+ */
+gboolean
+gdaex_pager_is_finished (GdaExPager *pager)
+{
+	g_return_val_if_fail (GDAEX_IS_PAGER (pager), TRUE);
+
+	GdaExPagerPrivate *priv = GDAEX_PAGER_GET_PRIVATE (pager);
+
+	return priv->finished;
+}
+
+/* PRIVATE */
+static void
+gdaex_pager_finalize (GObject *object)
+{
+	GdaExPager *gdaex_pager = GDAEX_PAGER (object);
+	GdaExPagerPrivate *priv = GDAEX_PAGER_GET_PRIVATE (gdaex_pager);
+
+	if (priv->last != NULL)
+		{
+			g_object_unref (priv->last);
+		}
+	if (priv->page_params != NULL)
+		{
+			g_object_unref (priv->page_params);
+		}
+	if (priv->params != NULL)
+		{
+			g_object_unref (priv->params);
+		}
+	g_object_unref (priv->sqlb);
+	g_object_unref (priv->gdaex);
+
+	G_OBJECT_CLASS (gdaex_pager_parent_class)->finalize (object);
+}
+
+static void
+gdaex_pager_set_property (GObject *object, guint property_id, const GValue *value, GParamSpec *pspec)
+{
+	GdaExPager *gdaex_pager = GDAEX_PAGER (object);
+	GdaExPagerPrivate *priv = GDAEX_PAGER_GET_PRIVATE (gdaex_pager);
+
+	switch (property_id)
+		{
+			default:
+				G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+				break;
+		}
+}
+
+static void
+gdaex_pager_get_property (GObject *object, guint property_id, GValue *value, GParamSpec *pspec)
+{
+	GdaExPager *gdaex_pager = GDAEX_PAGER (object);
+	GdaExPagerPrivate *priv = GDAEX_PAGER_GET_PRIVATE (gdaex_pager);
+
+	switch (property_id)
+		{
+			default:
+				G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+				break;
+		}
+}
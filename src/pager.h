@@ -0,0 +1,71 @@
+/*
+ *  pager.h
+ *
+ *  Copyright (C) 2016 Andrea Zagli <azagli@libero.it>
+ *
+ *  This file is part of libgdaex.
+ *
+ *  libgdaex is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  libgdaex is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with libgdaex; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#ifndef __GDAEX_PAGER_H__
+#define __GDAEX_PAGER_H__
+
+#include <glib.h>
+#include <glib-object.h>
+
+#include "gdaex.h"
+#include "sqlbuilder.h"
+
+G_BEGIN_DECLS
+
+
+#define GDAEX_TYPE_PAGER                 (gdaex_pager_get_type ())
+#define GDAEX_PAGER(obj)                 (G_TYPE_CHECK_INSTANCE_CAST ((obj), GDAEX_TYPE_PAGER, GdaExPager))
+#define GDAEX_PAGER_CLASS(klass)         (G_TYPE_CHECK_CLASS_CAST ((klass), GDAEX_TYPE_PAGER, GdaExPagerClass))
+#define GDAEX_IS_PAGER(obj)              (G_TYPE_CHECK_INSTANCE_TYPE ((obj), GDAEX_TYPE_PAGER))
+#define GDAEX_IS_PAGER_CLASS(klass)      (G_TYPE_CHECK_CLASS_TYPE ((klass), GDAEX_TYPE_PAGER))
+#define GDAEX_PAGER_GET_CLASS(obj)       (G_TYPE_INSTANCE_GET_CLASS ((obj), GDAEX_TYPE_PAGER, GdaExPagerClass))
+
+
+typedef struct _GdaExPager GdaExPager;
+typedef struct _GdaExPagerClass GdaExPagerClass;
+
+struct _GdaExPager
+	{
+		GObject parent;
+	};
+
+struct _GdaExPagerClass
+	{
+		GObjectClass parent_class;
+	};
+
+GType gdaex_pager_get_type (void) G_GNUC_CONST;
+
+
+GdaExPager *gdaex_pager_new (GdaEx *gdaex, GdaExSqlBuilder *sqlb, GdaSet *params, guint page_size, gboolean keyset);
+
+GdaDataModel *gdaex_pager_next (GdaExPager *pager);
+void gdaex_pager_rewind (GdaExPager *pager);
+
+guint gdaex_pager_get_page (GdaExPager *pager);
+gboolean gdaex_pager_is_finished (GdaExPager *pager);
+
+
+G_END_DECLS
+
+#endif /* __GDAEX_PAGER_H__ */
@@ -38,32 +38,6 @@
 
 #define GROUP "{--group--}"
 
-typedef struct
-	{
-		gchar *name;
-		gchar *name_visible;
-		gboolean visible;
-
-		GHashTable *fields;	/* GdaExQueryEditorField */
-	} GdaExQueryEditorTable;
-
-typedef struct
-	{
-		GdaExQueryEditorTable *table1;
-		GdaExQueryEditorTable *table2;
-
-		GdaExQueryEditorJoinType join_type;
-
-		GSList *fields1;
-		GSList *fields2;
-	} GdaExQueryEditorRelation;
-
-typedef enum
-	{
-		GDAEX_QE_LINK_TYPE_AND = 1,
-		GDAEX_QE_LINK_TYPE_OR
-	} GdaExQueryEditorLinkType;
-
 enum
 	{
 		GDAEX_QE_PAGE_SHOW,
@@ -92,15 +66,30 @@ static GdaExQueryEditorIWidget *gdaex_query_editor_iwidget_construct (GdaExQuery
 
 static void gdaex_query_editor_clean (GdaExQueryEditor *gdaex_query_editor);
 
+static void gdaex_query_editor_count_schedule (GdaExQueryEditor *qe);
+
 static gboolean _gdaex_query_editor_add_table (GdaExQueryEditor *qe,
                               const gchar *table_name,
                               const gchar *table_name_visibile,
                               gboolean is_visible);
 
+static GdaExQueryEditorFieldIWidgets *gdaex_query_editor_get_field_iwidgets (GdaExQueryEditor *qe,
+                                                                             const GdaExQueryEditorField *field);
+
+static void gdaex_query_editor_sync_model (GdaExQueryEditor *qe);
+static void gdaex_query_editor_sync_model_where (GdaExQueryEditor *qe,
+                                                 GtkTreeIter *iter_parent,
+                                                 GNode *parent);
+static void gdaex_query_editor_fill_stores (GdaExQueryEditor *qe);
+static void gdaex_query_editor_fill_stores_where (GdaExQueryEditor *qe,
+                                                  GNode *node,
+                                                  GtkTreeIter *iter_parent);
+
 static void gdaex_query_editor_refresh_gui (GdaExQueryEditor *qe);
-static void gdaex_query_editor_refresh_gui_add_fields (GdaExQueryEditor *qe,
-                                                       GdaExQueryEditorTable *table,
-                                                       GtkTreeIter *iter_parent);
+static void gdaex_query_editor_fields_clean (GdaExQueryEditor *qe);
+static void gdaex_query_editor_fields_changed (GdaExQueryEditor *qe,
+                                               const GdaExQueryEditorTable *table,
+                                               const GdaExQueryEditorField *field);
 
 static void gdaex_query_editor_refill_always_show (GdaExQueryEditor *qe);
 static void gdaex_query_editor_refill_always_order (GdaExQueryEditor *qe);
@@ -113,10 +102,6 @@ static void gdaex_query_editor_store_move_iter_up_down (GdaExQueryEditor *qe,
                                       GObject *store,
                                       gboolean up);
 
-static gboolean gdaex_query_editor_model_has_value (GtkTreeModel *model,
-                                                    guint column,
-                                                    GValue *value);
-
 static void gdaex_query_editor_remove_child_from_vbx_values (GdaExQueryEditor *qe);
 
 static gchar *gdaex_query_editor_get_where_type_str_from_type (guint where_type);
@@ -131,6 +116,8 @@ static void gdaex_query_editor_on_btn_save_clicked (GtkButton *button,
 
 static void gdaex_query_editor_on_sel_fields_changed (GtkTreeSelection *treeselection,
                                                     gpointer user_data);
+static void gdaex_query_editor_on_txt_fields_filter_search_changed (GtkSearchEntry *entry,
+                                                                   gpointer user_data);
 static void gdaex_query_editor_on_trv_fields_row_activated (GtkTreeView *tree_view,
                                                             GtkTreePath *path,
                                                             GtkTreeViewColumn *column,
@@ -141,7 +128,9 @@ static void gdaex_query_editor_on_notebook_switch_page (GtkNotebook *notebook,
 														guint page_num,
 														gpointer user_data);
 
+static void gdaex_query_editor_show_add (GdaExQueryEditor *qe, const gchar *table_name, const gchar *field_name);
 static void gdaex_query_editor_show_add_iter (GdaExQueryEditor *qe, GtkTreeIter *iter);
+static void gdaex_query_editor_order_add (GdaExQueryEditor *qe, const gchar *table_name, const gchar *field_name);
 static void gdaex_query_editor_order_add_iter (GdaExQueryEditor *qe, GtkTreeIter *iter);
 
 static void gdaex_query_editor_on_btn_show_add_clicked (GtkButton *button,
@@ -154,6 +143,12 @@ static void gdaex_query_editor_on_btn_show_down_clicked (GtkButton *button,
                                     gpointer user_data);
 static void gdaex_query_editor_on_btn_show_clean_clicked (GtkButton *button,
                                     gpointer user_data);
+static void gdaex_query_editor_show_on_row_deleted (GtkTreeModel *tree_model,
+                                                    GtkTreePath *path,
+                                                    gpointer user_data);
+static void gdaex_query_editor_order_on_row_deleted (GtkTreeModel *tree_model,
+                                                     GtkTreePath *path,
+                                                     gpointer user_data);
 static void gdaex_query_editor_on_sel_show_changed (GtkTreeSelection *treeselection,
                                                     gpointer user_data);
 
@@ -185,19 +180,67 @@ static void gdaex_query_editor_on_btn_order_clean_clicked (GtkButton *button,
 static void gdaex_query_editor_on_sel_order_changed (GtkTreeSelection *treeselection,
                                                     gpointer user_data);
 
-static void gdaex_query_editor_on_txt1_btn_browse_clicked (gpointer instance, gpointer user_data);
-static void gdaex_query_editor_on_txt2_btn_browse_clicked (gpointer instance, gpointer user_data);
+static void gdaex_query_editor_on_txt1_btn_browse_clicked (GtkEntry *entry,
+                                                           GtkEntryIconPosition icon_pos,
+                                                           GdkEvent *event,
+                                                           gpointer user_data);
+static void gdaex_query_editor_on_txt2_btn_browse_clicked (GtkEntry *entry,
+                                                           GtkEntryIconPosition icon_pos,
+                                                           GdkEvent *event,
+                                                           gpointer user_data);
+static void gdaex_query_editor_on_tstore_where_row_changed (GtkTreeModel *tree_model,
+                                                            GtkTreePath *path,
+                                                            GtkTreeIter *iter,
+                                                            gpointer user_data);
+static void gdaex_query_editor_on_tstore_where_row_deleted (GtkTreeModel *tree_model,
+                                                            GtkTreePath *path,
+                                                            gpointer user_data);
+static void gdaex_query_editor_on_tstore_where_rows_reordered (GtkTreeModel *tree_model,
+                                                               GtkTreePath *path,
+                                                               GtkTreeIter *iter,
+                                                               gpointer new_order,
+                                                               gpointer user_data);
+static void gdaex_query_editor_values_set_browse (GdaExQueryEditor *qe,
+                                                  GtkWidget *iwidget,
+                                                  GCallback callback);
 
 
+#define GDAEX_QE_VALUES_PAGE 100
+
+#define GDAEX_QE_COUNT_DELAY 600
+#define GDAEX_QE_COUNT_BUDGET 2000
+
 #define GDAEX_QUERY_EDITOR_GET_PRIVATE(obj) (G_TYPE_INSTANCE_GET_PRIVATE ((obj), TYPE_GDAEX_QUERY_EDITOR, GdaExQueryEditorPrivate))
 
+/* the widgets of a field belong to the editor, not to the shared schema */
+typedef struct
+	{
+		GdaExQueryEditorIWidget *iwidget_from;
+		GdaExQueryEditorIWidget *iwidget_to;
+	} GdaExQueryEditorFieldIWidgets;
+
+/* an entry of the prefix index of the fields tree */
+typedef struct
+	{
+		gchar *word;	/* case and accents folded */
+		gchar *key;	/* "table.field" */
+	} GdaExQueryEditorIndexWord;
+
+/* the fields chosen in the show or order list; the iters of the store
+ * persist, but any row can be deleted by the view (e.g. dragging it), so
+ * after a deletion the table is rebuilt at the next lookup */
+typedef struct
+	{
+		GtkTreeModel *store;
+		GHashTable *ht;	/* "table.field" => GtkTreeIter of store */
+		gboolean stale;
+	} GdaExQueryEditorChoices;
+
 typedef struct _GdaExQueryEditorPrivate GdaExQueryEditorPrivate;
 struct _GdaExQueryEditorPrivate
 	{
 		GdaEx *gdaex;
 
-		GPtrArray *ar_modules;
-
 		GtkBuilder *gtkbuilder;
 
 		GtkWidget *notebook;
@@ -215,14 +258,21 @@ struct _GdaExQueryEditorPrivate
 		GtkTreeStore *tstore_where;
 		GtkListStore *lstore_order;
 
+		GHashTable *ht_fields_rows;	/* "table" and "table.field" => GtkTreeIter of tstore_fields */
+		GdaExQueryEditorChoices choices_show;
+		GdaExQueryEditorChoices choices_order;
+
+		GPtrArray *fields_index;	/* GdaExQueryEditorIndexWord sorted by word; NULL until needed */
+		gchar *fields_filter_text;
+		GHashTable *fields_filter;	/* "table.field" matching the filter; NULL shows all */
+
 		GtkTreeSelection *sel_fields;
 		GtkTreeSelection *sel_show;
 		GtkTreeSelection *sel_where;
 		GtkTreeSelection *sel_order;
 
-		GHashTable *tables;	/* GdaExQueryEditorTable */
-
-		GSList *relations;	/* GdaExQueryEditorRelation */
+		GdaExQueryEditorModel *model;
+		GHashTable *iwidgets;	/* "table.field" => GdaExQueryEditorFieldIWidgets */
 
 		/* for value choosing */
 		guint editor_type;
@@ -253,6 +303,23 @@ struct _GdaExQueryEditorPrivate
 
 		GtkListStore *lstore_link_type;
 		GtkListStore *lstore_where_type;
+
+		/* values already in the database for the field of the condition */
+		gchar *values_table_name;
+		gchar *values_field_name;
+		GtkWidget *popover_values;
+		GtkWidget *txt_values_filter;
+		GtkWidget *btn_values_more;
+		GtkListStore *lstore_values;
+		GtkWidget *values_iwidget;
+		guint values_offset;
+		GCancellable *values_cancellable;
+
+		/* rows of the query, counted in background */
+		GtkWidget *lbl_rows_count;
+		guint count_budget;
+		guint count_source_id;
+		GCancellable *count_cancellable;
 	};
 
 G_DEFINE_TYPE (GdaExQueryEditor, gdaex_query_editor, G_TYPE_OBJECT)
@@ -300,6 +367,12 @@ enum
 		COL_ORDER_ORDER_VISIBLE
 	};
 
+enum
+	{
+		COL_VALUES_VALUE,
+		COL_VALUES_COUNT
+	};
+
 static void
 gdaex_query_editor_class_init (GdaExQueryEditorClass *klass)
 {
@@ -339,101 +412,358 @@ gdaex_query_editor_init (GdaExQueryEditor *gdaex_query_editor)
 
 }
 
+typedef GdaExQueryEditorIWidget *(* IWidgetConstructorFunc) (void);
+typedef gboolean (* IWidgetXmlParsingFunc) (GdaExQueryEditorIWidget *, xmlNodePtr);
+
+#define GDAEX_QE_MODULES_MANIFEST_SUFFIX ".iwidgets"
+#define GDAEX_QE_MODULES_MANIFEST_GROUP "IWidgets"
+
+typedef struct
+	{
+		gchar *module;	/* module file from a manifest; NULL if not listed */
+		gboolean resolved;
+		IWidgetConstructorFunc constructor;
+		IWidgetXmlParsingFunc xml_parsing;
+	} GdaExQueryEditorIWidgetType;
+
+/* iwidget modules registry, built once and shared by every editor */
+typedef struct
+	{
+		gchar *modulesdir;
+		GHashTable *types;	/* type name -> GdaExQueryEditorIWidgetType */
+		GHashTable *modules;	/* module file -> GModule, NULL if not loadable */
+		GModule *self;
+		gboolean self_opened;
+		gboolean scanned;
+	} GdaExQueryEditorModules;
+
+G_LOCK_DEFINE_STATIC (iwidget_modules);
+static GdaExQueryEditorModules *iwidget_modules = NULL;
+
 static void
-gdaex_query_editor_load_modules (GdaExQueryEditor *gdaex_query_editor)
+gdaex_query_editor_iwidget_type_free (GdaExQueryEditorIWidgetType *iwtype)
 {
-	GdaExQueryEditorPrivate *priv;
+	g_free (iwtype->module);
+	g_free (iwtype);
+}
 
+static gchar
+*gdaex_query_editor_modules_get_dir (void)
+{
 	gchar *modulesdir;
-	GDir *dir;
-	GError *error;
 
-	GModule *module;
-	const gchar *filename;
-
-	if (g_module_supported ())
+	modulesdir = g_strdup (g_getenv ("LIBGDAEX_MODULESDIR"));
+	if (modulesdir == NULL)
 		{
-			priv = GDAEX_QUERY_EDITOR_GET_PRIVATE (gdaex_query_editor);
-
-			modulesdir = (gchar *)g_getenv ("LIBGDAEX_MODULESDIR");
-			if (modulesdir == NULL)
-				{
 #ifdef G_OS_WIN32
 
-					gchar *moddir;
-					gchar *p;
+			gchar *moddir;
+			gchar *p;
 
-					moddir = g_win32_get_package_installation_directory_of_module (NULL);
+			moddir = g_win32_get_package_installation_directory_of_module (NULL);
 
-					p = g_strrstr (moddir, g_strdup_printf ("%c", G_DIR_SEPARATOR));
-					if (p != NULL
-						&& (g_ascii_strcasecmp (p + 1, "src") == 0
-							|| g_ascii_strcasecmp (p + 1, ".libs") == 0))
-						{
-							modulesdir = g_strdup (MODULESDIR);
-						}
-					else
-						{
-							modulesdir = g_build_filename (moddir, "lib", PACKAGE, "modules", NULL);
-						}
+			p = g_strrstr (moddir, G_DIR_SEPARATOR_S);
+			if (p != NULL
+				&& (g_ascii_strcasecmp (p + 1, "src") == 0
+					|| g_ascii_strcasecmp (p + 1, ".libs") == 0))
+				{
+					modulesdir = g_strdup (MODULESDIR);
+				}
+			else
+				{
+					modulesdir = g_build_filename (moddir, "lib", PACKAGE, "modules", NULL);
+				}
+			g_free (moddir);
 
 #else
 
-					modulesdir = g_strdup (MODULESDIR);
+			modulesdir = g_strdup (MODULESDIR);
 
 #endif
+		}
+
+	return modulesdir;
+}
+
+static void
+gdaex_query_editor_modules_read_manifest (GdaExQueryEditorModules *registry,
+                                          const gchar *filename)
+{
+	GKeyFile *kf;
+	GError *error;
+
+	gchar *module;
+	gchar **types;
+	gsize n_types;
+	gsize i;
+
+	GdaExQueryEditorIWidgetType *iwtype;
+
+	kf = g_key_file_new ();
+
+	error = NULL;
+	if (!g_key_file_load_from_file (kf, filename, G_KEY_FILE_NONE, &error))
+		{
+			g_warning (_("Unable to read modules manifest %s: %s."), filename,
+			           error != NULL && error->message != NULL ? error->message : _("no details"));
+			if (error != NULL)
+				{
+					g_error_free (error);
 				}
+			g_key_file_free (kf);
+			return;
+		}
 
-			/* load myself as module (for filters and validators) */
-			module = g_module_open (NULL, G_MODULE_BIND_LAZY);
-			if (module == NULL)
+	module = g_key_file_get_string (kf, GDAEX_QE_MODULES_MANIFEST_GROUP, "Module", NULL);
+	types = g_key_file_get_string_list (kf, GDAEX_QE_MODULES_MANIFEST_GROUP, "Types", &n_types, NULL);
+	if (module == NULL || types == NULL)
+		{
+			g_warning (_("Modules manifest %s must list a Module and its Types."), filename);
+		}
+	else
+		{
+			for (i = 0; i < n_types; i++)
 				{
-					g_warning (_("Unable to load module of myself"));
+					g_strstrip (types[i]);
+					if (types[i][0] == '\0'
+						|| g_hash_table_contains (registry->types, types[i]))
+						{
+							continue;
+						}
+
+					iwtype = g_new0 (GdaExQueryEditorIWidgetType, 1);
+					iwtype->module = g_strdup (module);
+					g_hash_table_insert (registry->types, g_strdup (types[i]), iwtype);
 				}
-			else
+		}
+
+	g_free (module);
+	g_strfreev (types);
+	g_key_file_free (kf);
+}
+
+/* must be called with the iwidget_modules lock held */
+static GdaExQueryEditorModules
+*gdaex_query_editor_modules_get (void)
+{
+	GDir *dir;
+	const gchar *filename;
+	gchar *path;
+
+	if (iwidget_modules != NULL)
+		{
+			return iwidget_modules;
+		}
+
+	iwidget_modules = g_new0 (GdaExQueryEditorModules, 1);
+	iwidget_modules->types = g_hash_table_new_full (g_str_hash, g_str_equal,
+	                                                g_free,
+	                                                (GDestroyNotify)gdaex_query_editor_iwidget_type_free);
+	iwidget_modules->modules = g_hash_table_new_full (g_str_hash, g_str_equal,
+	                                                  g_free, NULL);
+
+	if (!g_module_supported ())
+		{
+			g_warning (_("Modules not supported by this operating system."));
+			return iwidget_modules;
+		}
+
+	iwidget_modules->modulesdir = gdaex_query_editor_modules_get_dir ();
+
+	/* only the manifests are read here: no module is opened */
+	dir = g_dir_open (iwidget_modules->modulesdir, 0, NULL);
+	if (dir != NULL)
+		{
+			while ((filename = g_dir_read_name (dir)) != NULL)
 				{
-					if (priv->ar_modules == NULL)
+					if (g_str_has_suffix (filename, GDAEX_QE_MODULES_MANIFEST_SUFFIX))
 						{
-							priv->ar_modules = g_ptr_array_new ();
+							path = g_build_filename (iwidget_modules->modulesdir, filename, NULL);
+							gdaex_query_editor_modules_read_manifest (iwidget_modules, path);
+							g_free (path);
 						}
-					g_ptr_array_add (priv->ar_modules, (gpointer)module);
 				}
+			g_dir_close (dir);
+		}
+
+	return iwidget_modules;
+}
+
+/* must be called with the iwidget_modules lock held */
+static GModule
+*gdaex_query_editor_modules_open (GdaExQueryEditorModules *registry,
+                                  const gchar *module)
+{
+	GModule *gmodule;
+	gchar *path;
+
+	if (g_hash_table_lookup_extended (registry->modules, module, NULL, (gpointer *)&gmodule))
+		{
+			return gmodule;
+		}
+
+	if (g_path_is_absolute (module))
+		{
+			path = g_strdup (module);
+		}
+	else
+		{
+			path = g_build_filename (registry->modulesdir, module, NULL);
+		}
+
+	gmodule = g_module_open (path, G_MODULE_BIND_LAZY);
+	if (gmodule == NULL)
+		{
+			g_warning (_("Unable to load %s: %s."), path, g_module_error ());
+		}
+	else
+		{
+			/* symbols are cached: the module must never be unloaded */
+			g_module_make_resident (gmodule);
+		}
+	g_free (path);
+
+	g_hash_table_insert (registry->modules, g_strdup (module), gmodule);
+
+	return gmodule;
+}
+
+static gboolean
+gdaex_query_editor_modules_resolve (GdaExQueryEditorIWidgetType *iwtype,
+                                    GModule *gmodule,
+                                    const gchar *type)
+{
+	gchar *symbol;
+
+	if (gmodule == NULL)
+		{
+			return FALSE;
+		}
+
+	symbol = g_strconcat (type, "_new", NULL);
+	if (!g_module_symbol (gmodule, symbol, (gpointer *)&iwtype->constructor))
+		{
+			iwtype->constructor = NULL;
+		}
+	g_free (symbol);
+
+	if (iwtype->constructor == NULL)
+		{
+			return FALSE;
+		}
+
+	symbol = g_strconcat (type, "_xml_parsing", NULL);
+	if (!g_module_symbol (gmodule, symbol, (gpointer *)&iwtype->xml_parsing))
+		{
+			iwtype->xml_parsing = NULL;
+		}
+	g_free (symbol);
+
+	return TRUE;
+}
+
+/* types not listed in any manifest: look in the program itself,
+ * then in every module of the dir (opened once) */
+static void
+gdaex_query_editor_modules_resolve_unlisted (GdaExQueryEditorModules *registry,
+                                             GdaExQueryEditorIWidgetType *iwtype,
+                                             const gchar *type)
+{
+	GDir *dir;
+	const gchar *filename;
+
+	GHashTableIter iter;
+	GModule *gmodule;
+
+	if (!registry->self_opened)
+		{
+			registry->self_opened = TRUE;
+			registry->self = g_module_open (NULL, G_MODULE_BIND_LAZY);
+			if (registry->self == NULL)
+				{
+					g_warning (_("Unable to load module of myself"));
+				}
+		}
+	if (gdaex_query_editor_modules_resolve (iwtype, registry->self, type))
+		{
+			return;
+		}
+
+	if (!registry->scanned)
+		{
+			registry->scanned = TRUE;
 
-			/* for each file in MODULESDIR */
-			error = NULL;
-			dir = g_dir_open (modulesdir, 0, &error);
-			if (dir != NULL && error == NULL)
+			dir = g_dir_open (registry->modulesdir, 0, NULL);
+			if (dir != NULL)
 				{
 					while ((filename = g_dir_read_name (dir)) != NULL)
 						{
-							/* trying to open the module */
-							module = g_module_open (filename, G_MODULE_BIND_LAZY);
-							if (module != NULL)
-								{
-									if (priv->ar_modules == NULL)
-										{
-											priv->ar_modules = g_ptr_array_new ();
-										}
-								    g_ptr_array_add (priv->ar_modules, (gpointer)module);
-								}
-							else
+							if (!g_str_has_suffix (filename, GDAEX_QE_MODULES_MANIFEST_SUFFIX))
 								{
-									g_warning (_("Unable to load %s: %s."), filename, g_module_error ());
+									gdaex_query_editor_modules_open (registry, filename);
 								}
 						}
-
 					g_dir_close (dir);
 				}
-			else
+		}
+
+	g_hash_table_iter_init (&iter, registry->modules);
+	while (g_hash_table_iter_next (&iter, NULL, (gpointer *)&gmodule))
+		{
+			if (gdaex_query_editor_modules_resolve (iwtype, gmodule, type))
 				{
-					g_warning (_("Unable to open modules dir: %s."),
-							   error != NULL && error->message != NULL ? error->message : _("no details"));
+					return;
 				}
 		}
-	else
+}
+
+/* returns the cached symbols of @type, loading its module on first use */
+static gboolean
+gdaex_query_editor_modules_lookup (const gchar *type,
+                                   IWidgetConstructorFunc *constructor,
+                                   IWidgetXmlParsingFunc *xml_parsing)
+{
+	GdaExQueryEditorModules *registry;
+	GdaExQueryEditorIWidgetType *iwtype;
+
+	G_LOCK (iwidget_modules);
+
+	registry = gdaex_query_editor_modules_get ();
+
+	iwtype = (GdaExQueryEditorIWidgetType *)g_hash_table_lookup (registry->types, type);
+	if (iwtype == NULL)
 		{
-			g_warning (_("Modules not supported by this operating system."));
+			iwtype = g_new0 (GdaExQueryEditorIWidgetType, 1);
+			g_hash_table_insert (registry->types, g_strdup (type), iwtype);
+		}
+
+	if (!iwtype->resolved
+		&& g_module_supported ())
+		{
+			if (iwtype->module != NULL)
+				{
+					if (!gdaex_query_editor_modules_resolve (iwtype,
+					                                         gdaex_query_editor_modules_open (registry, iwtype->module),
+					                                         type))
+						{
+							g_warning (_("Module %s doesn't provide iwidget type %s."), iwtype->module, type);
+						}
+				}
+			else
+				{
+					gdaex_query_editor_modules_resolve_unlisted (registry, iwtype, type);
+				}
+
+			/* also unresolved types are cached, to not search them again */
+			iwtype->resolved = TRUE;
 		}
+
+	*constructor = iwtype->constructor;
+	*xml_parsing = iwtype->xml_parsing;
+
+	G_UNLOCK (iwidget_modules);
+
+	return *constructor != NULL;
 }
 
 /**
@@ -456,7 +786,17 @@ GdaExQueryEditor
 
 	priv = GDAEX_QUERY_EDITOR_GET_PRIVATE (gdaex_query_editor);
 
-	gdaex_query_editor_clean (gdaex_query_editor);
+	priv->model = gdaex_query_editor_model_new (gdaex);
+	priv->iwidgets = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
+
+	priv->ht_fields_rows = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, (GDestroyNotify)gtk_tree_iter_free);
+	priv->choices_show.ht = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, (GDestroyNotify)gtk_tree_iter_free);
+	priv->choices_show.stale = FALSE;
+	priv->choices_order.ht = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, (GDestroyNotify)gtk_tree_iter_free);
+	priv->choices_order.stale = FALSE;
+	priv->fields_index = NULL;
+	priv->fields_filter_text = NULL;
+	priv->fields_filter = NULL;
 
 	priv->lstore_link_type = gtk_list_store_new (2,
 	                                             G_TYPE_UINT,
@@ -467,8 +807,6 @@ GdaExQueryEditor
 
 	priv->gdaex = gdaex;
 
-	gdaex_query_editor_load_modules (gdaex_query_editor);
-
 	priv->gtkbuilder = gdaex_get_gtkbuilder (priv->gdaex);
 
 	error = NULL;
@@ -500,6 +838,13 @@ GdaExQueryEditor
 	priv->tstore_where = GTK_TREE_STORE (gtk_builder_get_object (priv->gtkbuilder, "tstore_where"));
 	priv->lstore_order = GTK_LIST_STORE (gtk_builder_get_object (priv->gtkbuilder, "lstore_order"));
 
+	priv->choices_show.store = GTK_TREE_MODEL (priv->lstore_show);
+	g_signal_connect (G_OBJECT (priv->lstore_show), "row-deleted",
+	                  G_CALLBACK (gdaex_query_editor_show_on_row_deleted), (gpointer)gdaex_query_editor);
+	priv->choices_order.store = GTK_TREE_MODEL (priv->lstore_order);
+	g_signal_connect (G_OBJECT (priv->lstore_order), "row-deleted",
+	                  G_CALLBACK (gdaex_query_editor_order_on_row_deleted), (gpointer)gdaex_query_editor);
+
 	priv->sel_fields = gtk_tree_view_get_selection (GTK_TREE_VIEW (priv->trv_fields));
 	priv->sel_show = gtk_tree_view_get_selection (GTK_TREE_VIEW (gtk_builder_get_object (priv->gtkbuilder, "treeview2")));
 	priv->sel_where = gtk_tree_view_get_selection (GTK_TREE_VIEW (priv->trv_where));
@@ -508,6 +853,17 @@ GdaExQueryEditor
 	priv->vbx_values_container = GTK_WIDGET (gtk_builder_get_object (priv->gtkbuilder, "vbox3"));
 	priv->vbx_values = GTK_WIDGET (gtk_builder_get_object (priv->gtkbuilder, "vbox4"));
 
+	priv->lbl_rows_count = GTK_WIDGET (gtk_builder_get_object (priv->gtkbuilder, "lbl_rows_count"));
+	priv->count_budget = GDAEX_QE_COUNT_BUDGET;
+	g_signal_connect (G_OBJECT (priv->tstore_where), "row-changed",
+	                  G_CALLBACK (gdaex_query_editor_on_tstore_where_row_changed), (gpointer)gdaex_query_editor);
+	g_signal_connect (G_OBJECT (priv->tstore_where), "row-inserted",
+	                  G_CALLBACK (gdaex_query_editor_on_tstore_where_row_changed), (gpointer)gdaex_query_editor);
+	g_signal_connect (G_OBJECT (priv->tstore_where), "row-deleted",
+	                  G_CALLBACK (gdaex_query_editor_on_tstore_where_row_deleted), (gpointer)gdaex_query_editor);
+	g_signal_connect (G_OBJECT (priv->tstore_where), "rows-reordered",
+	                  G_CALLBACK (gdaex_query_editor_on_tstore_where_rows_reordered), (gpointer)gdaex_query_editor);
+
 	g_signal_connect (gtk_builder_get_object (priv->gtkbuilder, "button16"), "clicked",
 	                  G_CALLBACK (gdaex_query_editor_on_btn_cancel_clicked), (gpointer)gdaex_query_editor);
 	g_signal_connect (gtk_builder_get_object (priv->gtkbuilder, "button15"), "clicked",
@@ -517,6 +873,8 @@ GdaExQueryEditor
 	                  G_CALLBACK (gdaex_query_editor_on_sel_fields_changed), (gpointer)gdaex_query_editor);
 	g_signal_connect (G_OBJECT (priv->trv_fields), "row-activated",
 	                  G_CALLBACK (gdaex_query_editor_on_trv_fields_row_activated), (gpointer)gdaex_query_editor);
+	g_signal_connect (gtk_builder_get_object (priv->gtkbuilder, "entry_fields_filter"), "search-changed",
+	                  G_CALLBACK (gdaex_query_editor_on_txt_fields_filter_search_changed), (gpointer)gdaex_query_editor);
 
 	g_signal_connect (gtk_builder_get_object (priv->gtkbuilder, "button3"), "clicked",
 	                  G_CALLBACK (gdaex_query_editor_on_btn_show_add_clicked), (gpointer)gdaex_query_editor);
@@ -707,134 +1065,116 @@ gdaex_query_editor_add_table (GdaExQueryEditor *qe,
 	return _gdaex_query_editor_add_table (qe, table_name, table_name_visibile, TRUE);
 }
 
-gboolean
-gdaex_query_editor_table_add_field (GdaExQueryEditor *qe,
-                                    const gchar *table_name,
-                                    GdaExQueryEditorField field)
+static GdaExQueryEditorIWidget
+*gdaex_query_editor_iwidget_new_default (GdaExQueryEditorFieldType type)
 {
-	gboolean ret;
+	GdaExQueryEditorIWidget *iwidget;
 
-	GdaExQueryEditorPrivate *priv;
-	GdaExQueryEditorTable *table;
-	GdaExQueryEditorField *_field;
+	if (type == GDAEX_QE_FIELD_TYPE_DATE
+		|| type == GDAEX_QE_FIELD_TYPE_DATETIME
+		|| type == GDAEX_QE_FIELD_TYPE_TIME)
+		{
+			iwidget = GDAEX_QUERY_EDITOR_IWIDGET (gdaex_query_editor_entry_date_new ());
+			/* TODO
+			 * read format from locale */
+			if (type == GDAEX_QE_FIELD_TYPE_DATE)
+				{
+					gdaex_query_editor_entry_date_set_format (GDAEX_QUERY_EDITOR_ENTRY_DATE (iwidget), "%d/%m/%Y");
+					gtk_entry_set_max_length (GTK_ENTRY (iwidget), 10);
+				}
+			else if (type == GDAEX_QE_FIELD_TYPE_DATETIME)
+				{
+					gdaex_query_editor_entry_date_set_format (GDAEX_QUERY_EDITOR_ENTRY_DATE (iwidget), "%d/%m/%Y %H:%M:%S");
+					gtk_entry_set_max_length (GTK_ENTRY (iwidget), 19);
+				}
+			else if (type == GDAEX_QE_FIELD_TYPE_TIME)
+				{
+					gdaex_query_editor_entry_date_set_format (GDAEX_QUERY_EDITOR_ENTRY_DATE (iwidget), "%H:%M:%S");
+					gtk_entry_set_max_length (GTK_ENTRY (iwidget), 8);
+				}
+		}
+	else if (type == GDAEX_QE_FIELD_TYPE_BOOLEAN)
+		{
+			iwidget = GDAEX_QUERY_EDITOR_IWIDGET (gdaex_query_editor_check_new ());
+		}
+	else
+		{
+			iwidget = GDAEX_QUERY_EDITOR_IWIDGET (gdaex_query_editor_entry_new ());
+		}
 
-	g_return_val_if_fail (GDAEX_IS_QUERY_EDITOR (qe), FALSE);
-	g_return_val_if_fail (table_name != NULL, FALSE);
+	return iwidget;
+}
 
-	priv = GDAEX_QUERY_EDITOR_GET_PRIVATE (qe);
+/* the widgets of field, the default ones created at the first request */
+static GdaExQueryEditorFieldIWidgets
+*gdaex_query_editor_get_field_iwidgets (GdaExQueryEditor *qe,
+                                        const GdaExQueryEditorField *field)
+{
+	GdaExQueryEditorPrivate *priv;
+	GdaExQueryEditorFieldIWidgets *iwidgets;
 
-	table = g_hash_table_lookup (priv->tables, table_name);
-	if (table == NULL)
-		{
-			g_warning (_("Table «%s» doesn't exists."), table_name);
-			return FALSE;
-		}
+	gchar *key;
 
-	_field = g_memdup (&field, sizeof (GdaExQueryEditorField));
-	_field->table_name = g_strdup (table_name);
+	priv = GDAEX_QUERY_EDITOR_GET_PRIVATE (qe);
 
-	if (_field->name == NULL)
+	key = g_strdup_printf ("%s.%s", field->table_name, field->name);
+	iwidgets = g_hash_table_lookup (priv->iwidgets, key);
+	if (iwidgets == NULL)
 		{
-			g_warning (_("No field added: the field must have a name."));
-			g_free (_field);
-			return FALSE;
+			iwidgets = g_new0 (GdaExQueryEditorFieldIWidgets, 1);
+			g_hash_table_insert (priv->iwidgets, key, iwidgets);
 		}
 	else
 		{
-			if (g_strcmp0 (g_strstrip (_field->name), "") == 0)
-				{
-					g_warning (_("No field added: the field must have a name."));
-					g_free (_field);
-					return FALSE;
-				}
+			g_free (key);
 		}
 
-	if (_field->name_visible == NULL)
+	if (!GDAEX_QUERY_EDITOR_IS_IWIDGET (iwidgets->iwidget_from))
 		{
-			_field->name_visible = g_strdup (_field->name);
+			iwidgets->iwidget_from = gdaex_query_editor_iwidget_new_default (field->type);
 		}
-	else
+	if (!GDAEX_QUERY_EDITOR_IS_IWIDGET (iwidgets->iwidget_to))
 		{
-			if (g_strcmp0 (g_strstrip (_field->name_visible), "") == 0)
-				{
-					_field->name_visible = g_strdup (_field->name);
-				}
+			iwidgets->iwidget_to = gdaex_query_editor_iwidget_new_default (field->type);
 		}
 
-	if (!GDAEX_QUERY_EDITOR_IS_IWIDGET (_field->iwidget_from))
-		{
-			if (_field->type == GDAEX_QE_FIELD_TYPE_DATE
-				|| _field->type == GDAEX_QE_FIELD_TYPE_DATETIME
-				|| _field->type == GDAEX_QE_FIELD_TYPE_TIME)
-				{
-					_field->iwidget_from = GDAEX_QUERY_EDITOR_IWIDGET (gdaex_query_editor_entry_date_new ());
-					/* TODO
-					 * read format from locale */
-					if (_field->type == GDAEX_QE_FIELD_TYPE_DATE)
-						{
-							gdaex_query_editor_entry_date_set_format (GDAEX_QUERY_EDITOR_ENTRY_DATE (_field->iwidget_from), "%d/%m/%Y");
-							gtk_entry_set_max_length (GTK_ENTRY (_field->iwidget_from), 10);
-						}
-					else if (_field->type == GDAEX_QE_FIELD_TYPE_DATETIME)
-						{
-							gdaex_query_editor_entry_date_set_format (GDAEX_QUERY_EDITOR_ENTRY_DATE (_field->iwidget_from), "%d/%m/%Y %H:%M:%S");
-							gtk_entry_set_max_length (GTK_ENTRY (_field->iwidget_from), 19);
-						}
-					else if (_field->type == GDAEX_QE_FIELD_TYPE_TIME)
-						{
-							gdaex_query_editor_entry_date_set_format (GDAEX_QUERY_EDITOR_ENTRY_DATE (_field->iwidget_from), "%H:%M:%S");
-							gtk_entry_set_max_length (GTK_ENTRY (_field->iwidget_from), 8);
-						}
-				}
-			else if (_field->type == GDAEX_QE_FIELD_TYPE_BOOLEAN)
-				{
-					_field->iwidget_from = GDAEX_QUERY_EDITOR_IWIDGET (gdaex_query_editor_check_new ());
-				}
-			else
-				{
-					_field->iwidget_from = GDAEX_QUERY_EDITOR_IWIDGET (gdaex_query_editor_entry_new ());
-				}
-		}
-	if (!GDAEX_QUERY_EDITOR_IS_IWIDGET (_field->iwidget_to))
+	return iwidgets;
+}
+
+gboolean
+gdaex_query_editor_table_add_field (GdaExQueryEditor *qe,
+                                    const gchar *table_name,
+                                    GdaExQueryEditorField field)
+{
+	GdaExQueryEditorPrivate *priv;
+	GdaExQueryEditorFieldIWidgets *iwidgets;
+
+	gchar *key;
+
+	g_return_val_if_fail (GDAEX_IS_QUERY_EDITOR (qe), FALSE);
+	g_return_val_if_fail (table_name != NULL, FALSE);
+
+	priv = GDAEX_QUERY_EDITOR_GET_PRIVATE (qe);
+
+	if (!gdaex_query_editor_model_table_add_field (priv->model, table_name, field))
 		{
-			if (_field->type == GDAEX_QE_FIELD_TYPE_DATE
-				|| _field->type == GDAEX_QE_FIELD_TYPE_DATETIME
-				|| _field->type == GDAEX_QE_FIELD_TYPE_TIME)
-				{
-					_field->iwidget_to = GDAEX_QUERY_EDITOR_IWIDGET (gdaex_query_editor_entry_date_new ());
-					/* TODO
-					 * read format from locale */
-					if (_field->type == GDAEX_QE_FIELD_TYPE_DATE)
-						{
-							gdaex_query_editor_entry_date_set_format (GDAEX_QUERY_EDITOR_ENTRY_DATE (_field->iwidget_to), "%d/%m/%Y");
-							gtk_entry_set_max_length (GTK_ENTRY (_field->iwidget_to), 10);
-						}
-					else if (_field->type == GDAEX_QE_FIELD_TYPE_DATETIME)
-						{
-							gdaex_query_editor_entry_date_set_format (GDAEX_QUERY_EDITOR_ENTRY_DATE (_field->iwidget_to), "%d/%m/%Y %H:%M:%S");
-							gtk_entry_set_max_length (GTK_ENTRY (_field->iwidget_to), 19);
-						}
-					else if (_field->type == GDAEX_QE_FIELD_TYPE_TIME)
-						{
-							gdaex_query_editor_entry_date_set_format (GDAEX_QUERY_EDITOR_ENTRY_DATE (_field->iwidget_to), "%H:%M:%S");
-							gtk_entry_set_max_length (GTK_ENTRY (_field->iwidget_to), 8);
-						}
-				}
-			else if (_field->type == GDAEX_QE_FIELD_TYPE_BOOLEAN)
-				{
-					_field->iwidget_to = GDAEX_QUERY_EDITOR_IWIDGET (gdaex_query_editor_check_new ());
-				}
-			else
-				{
-					_field->iwidget_to = GDAEX_QUERY_EDITOR_IWIDGET (gdaex_query_editor_entry_new ());
-				}
+			return FALSE;
 		}
 
-	g_hash_table_insert (table->fields, _field->name, _field);
+	/* the missing ones are created when needed */
+	iwidgets = g_new0 (GdaExQueryEditorFieldIWidgets, 1);
+	iwidgets->iwidget_from = field.iwidget_from;
+	iwidgets->iwidget_to = field.iwidget_to;
 
-	ret = TRUE;
+	key = g_strstrip (g_strdup (field.name));
+	g_hash_table_replace (priv->iwidgets, g_strdup_printf ("%s.%s", table_name, key), iwidgets);
 
-	return ret;
+	gdaex_query_editor_fields_changed (qe,
+	                                   gdaex_query_editor_model_get_table (priv->model, table_name),
+	                                   gdaex_query_editor_model_get_field (priv->model, table_name, key));
+	g_free (key);
+
+	return TRUE;
 }
 
 /**
@@ -853,82 +1193,11 @@ gdaex_query_editor_add_relation_slist (GdaExQueryEditor *qe,
 {
 	GdaExQueryEditorPrivate *priv;
 
-	GdaExQueryEditorTable *table;
-	GdaExQueryEditorField *field1;
-	GdaExQueryEditorField *field2;
-
-	GdaExQueryEditorRelation *relation;
-
-	gboolean create_relation;
-
 	g_return_val_if_fail (GDAEX_IS_QUERY_EDITOR (qe), FALSE);
-	g_return_val_if_fail (fields_joined != NULL, FALSE);
 
 	priv = GDAEX_QUERY_EDITOR_GET_PRIVATE (qe);
 
-	create_relation = FALSE;
-
-	relation = g_new0 (GdaExQueryEditorRelation, 1);
-
-	/* check if table exists */
-	table = g_hash_table_lookup (priv->tables, table1);
-	if (table == NULL)
-		{
-			g_warning (_("Table «%s» doesn't exists."), table1);
-			return FALSE;
-		}
-	relation->table1 = table;
-
-	table = g_hash_table_lookup (priv->tables, table2);
-	if (table == NULL)
-		{
-			g_warning (_("Table «%s» doesn't exists."), table2);
-			return FALSE;
-		}
-	relation->table2 = table;
-
-	while (fields_joined != NULL)
-		{
-			field1 = g_hash_table_lookup (relation->table1->fields, (gchar *)fields_joined->data);
-			if (field1 == NULL)
-				{
-					continue;
-				}
-
-			fields_joined = g_slist_next (fields_joined);
-			if (fields_joined != NULL)
-				{
-					field2 = g_hash_table_lookup (relation->table2->fields, (gchar *)fields_joined->data);
-					if (field2 == NULL)
-						{
-							continue;
-						}
-				}
-			else
-				{
-					continue;
-				}
-
-			relation->fields1 = g_slist_append (relation->fields1, field1);
-			relation->fields2 = g_slist_append (relation->fields2, field2);
-			create_relation = TRUE;
-
-			fields_joined = g_slist_next (fields_joined);
-		}
-
-	if (create_relation)
-		{
-			relation->join_type = join_type;
-			priv->relations = g_slist_append (priv->relations, relation);
-		}
-	else
-		{
-			g_warning (_("Relation not created: no field added to the relation."));
-			g_free (relation);
-			return FALSE;
-		}
-
-	return TRUE;
+	return gdaex_query_editor_model_add_relation_slist (priv->model, table1, table2, join_type, fields_joined);
 }
 
 /**
@@ -983,250 +1252,215 @@ gdaex_query_editor_add_relation (GdaExQueryEditor *qe,
 	return gdaex_query_editor_add_relation_slist (qe, table1, table2, join_type, fields_joined);
 }
 
-static GdaExQueryEditorFieldType
-gdaex_query_editor_str_to_field_type (gchar *str)
+static GdaExQueryEditorIWidget
+*gdaex_query_editor_iwidget_construct (GdaExQueryEditor *qe,
+									   const gchar *type,
+									   xmlNode *xnode)
 {
-	GdaExQueryEditorFieldType ret;
-
-	g_return_val_if_fail (str != NULL, 0);
+	IWidgetConstructorFunc iwidget_constructor;
+	IWidgetXmlParsingFunc iwidget_xml_parsing;
 
-	ret = 0;
+	GdaExQueryEditorIWidget *iwidget;
 
-	if (g_strcmp0 (str, "text") == 0
-		|| g_strcmp0 (str, "string") == 0)
-		{
-			ret = GDAEX_QE_FIELD_TYPE_TEXT;
-		}
-	else if (g_strcmp0 (str, "integer") == 0
-			 || g_strcmp0 (str, "int") == 0)
-		{
-			ret = GDAEX_QE_FIELD_TYPE_INTEGER;
-		}
-	else if (g_strcmp0 (str, "boolean") == 0
-			 || g_strcmp0 (str, "bool") == 0)
-		{
-			ret = GDAEX_QE_FIELD_TYPE_BOOLEAN;
-		}
-	else if (g_strcmp0 (str, "double") == 0
-			 || g_strcmp0 (str, "float") == 0)
-		{
-			ret = GDAEX_QE_FIELD_TYPE_DOUBLE;
-		}
-	else if (g_strcmp0 (str, "date") == 0)
-		{
-			ret = GDAEX_QE_FIELD_TYPE_DATE;
-		}
-	else if (g_strcmp0 (str, "datetime") == 0)
-		{
-			ret = GDAEX_QE_FIELD_TYPE_DATETIME;
-		}
-	else if (g_strcmp0 (str, "time") == 0)
+	iwidget = NULL;
+	if (gdaex_query_editor_modules_lookup (type, &iwidget_constructor, &iwidget_xml_parsing))
 		{
-			ret = GDAEX_QE_FIELD_TYPE_TIME;
+			iwidget = iwidget_constructor ();
+			if (iwidget != NULL
+				&& iwidget_xml_parsing != NULL)
+				{
+					iwidget_xml_parsing (iwidget, xnode);
+				}
 		}
 
-	return ret;
+	return iwidget;
 }
 
-static guint
-gdaex_query_editor_str_to_where_type (gchar *str)
+static void
+gdaex_query_editor_load_field_widget (GdaExQueryEditor *qe,
+                                      const gchar *table_name,
+                                      const GdaExQueryEditorField *field,
+                                      xmlNode *xnode)
 {
-	guint ret;
-
-	gchar **types;
+	GdaExQueryEditorClass *klass;
+	GdaExQueryEditorPrivate *priv;
+	GdaExQueryEditorFieldIWidgets *iwidgets;
 
-	guint i;
-	guint l;
+	xmlChar *type;
+	gchar *key;
 
-	g_return_val_if_fail (str != NULL, 0);
+	klass = GDAEX_QUERY_EDITOR_GET_CLASS (qe);
+	priv = GDAEX_QUERY_EDITOR_GET_PRIVATE (qe);
 
-	ret = 0;
+	key = g_strdup_printf ("%s.%s", table_name, field->name);
+	iwidgets = g_hash_table_lookup (priv->iwidgets, key);
+	if (iwidgets == NULL)
+		{
+			iwidgets = g_new0 (GdaExQueryEditorFieldIWidgets, 1);
+			g_hash_table_insert (priv->iwidgets, key, iwidgets);
+		}
+	else
+		{
+			g_free (key);
+		}
 
-	types = g_strsplit (str, "|", 0);
+	type = xmlGetProp (xnode, (const xmlChar *)"type");
 
-	l = g_strv_length (types);
-	for (i = 0; i < l; i++)
+	if (xmlStrcmp (xnode->name, "widget") == 0
+		|| xmlStrcmp (xnode->name, "widget_from") == 0)
 		{
-			if (g_strcmp0 (types[i], "equal") == 0)
-				{
-					ret |= GDAEX_QE_WHERE_TYPE_EQUAL;
-				}
-			else if (g_strcmp0 (types[i], "starts") == 0)
-				{
-					ret |= GDAEX_QE_WHERE_TYPE_STARTS;
-				}
-			else if (g_strcmp0 (types[i], "contains") == 0)
-				{
-					ret |= GDAEX_QE_WHERE_TYPE_CONTAINS;
-				}
-			else if (g_strcmp0 (types[i], "ends") == 0)
-				{
-					ret |= GDAEX_QE_WHERE_TYPE_ENDS;
-				}
-			else if (g_strcmp0 (types[i], "istarts") == 0)
-				{
-					ret |= GDAEX_QE_WHERE_TYPE_ISTARTS;
-				}
-			else if (g_strcmp0 (types[i], "icontains") == 0)
-				{
-					ret |= GDAEX_QE_WHERE_TYPE_ICONTAINS;
-				}
-			else if (g_strcmp0 (types[i], "iends") == 0)
-				{
-					ret |= GDAEX_QE_WHERE_TYPE_IENDS;
-				}
-			else if (g_strcmp0 (types[i], "great") == 0)
-				{
-					ret |= GDAEX_QE_WHERE_TYPE_GREAT;
-				}
-			else if (g_strcmp0 (types[i], "great_equal") == 0)
-				{
-					ret |= GDAEX_QE_WHERE_TYPE_GREAT_EQUAL;
-				}
-			else if (g_strcmp0 (types[i], "less") == 0)
-				{
-					ret |= GDAEX_QE_WHERE_TYPE_LESS;
-				}
-			else if (g_strcmp0 (types[i], "less_equal") == 0)
-				{
-					ret |= GDAEX_QE_WHERE_TYPE_LESS_EQUAL;
-				}
-			else if (g_strcmp0 (types[i], "between") == 0)
-				{
-					ret |= GDAEX_QE_WHERE_TYPE_BETWEEN;
-				}
-			else if (g_strcmp0 (types[i], "is_null") == 0)
+			iwidgets->iwidget_from = gdaex_query_editor_iwidget_construct (qe,
+																		type,
+																		xnode);
+			if (iwidgets->iwidget_from == NULL)
 				{
-					ret |= GDAEX_QE_WHERE_TYPE_IS_NULL;
+					g_warning (_("Unknown iwidget_from type «%s»."), type);
 				}
-			else if (g_strcmp0 (types[i], "string") == 0)
+			else
 				{
-					ret |= GDAEX_QE_WHERE_TYPE_STRING;
+					g_signal_emit (qe, klass->iwidget_init_signal_id,
+								   0,
+								   iwidgets->iwidget_from,
+								   table_name,
+								   field->name,
+								   TRUE);
 				}
-			else if (g_strcmp0 (types[i], "number") == 0)
+		}
+	if (xmlStrcmp (xnode->name, "widget") == 0
+		|| xmlStrcmp (xnode->name, "widget_to") == 0)
+		{
+			iwidgets->iwidget_to = gdaex_query_editor_iwidget_construct (qe,
+																	  type,
+																	  xnode);
+			if (iwidgets->iwidget_to == NULL)
 				{
-					ret |= GDAEX_QE_WHERE_TYPE_NUMBER;
+					g_warning (_("Unknown iwidget_to type «%s»."), type);
 				}
-			else if (g_strcmp0 (types[i], "datetime") == 0)
+			else
 				{
-					ret |= GDAEX_QE_WHERE_TYPE_DATETIME;
+					g_signal_emit (qe, klass->iwidget_init_signal_id,
+								   0,
+								   iwidgets->iwidget_to,
+								   table_name,
+								   field->name,
+								   FALSE);
 				}
 		}
 
-	g_strfreev (types);
-
-	return ret;
+	xmlFree (type);
 }
 
-static GdaExQueryEditorJoinType
-gdaex_query_editor_str_to_join_type (gchar *str)
+void
+gdaex_query_editor_load_tables_from_xml (GdaExQueryEditor *qe,
+                                         xmlNode *root,
+                                         gboolean clean)
 {
-	GdaExQueryEditorJoinType ret;
-
-	g_return_val_if_fail (str != NULL, 0);
+	GdaExQueryEditorPrivate *priv;
 
-	ret = 0;
+	xmlNode *xfields;
+	xmlNode *xfield;
+	xmlNode *cur;
 
-	if (g_strcmp0 (str, "inner") == 0)
-		{
-			ret = GDAEX_QE_JOIN_TYPE_INNER;
-		}
-	else if (g_strcmp0 (str, "left") == 0)
-		{
-			ret = GDAEX_QE_JOIN_TYPE_LEFT;
-		}
+	xmlChar *table_name;
+	xmlChar *field_name;
 
-	return ret;
-}
+	const GdaExQueryEditorField *field;
 
-typedef GdaExQueryEditorIWidget *(* IWidgetConstructorFunc) (void);
-typedef gboolean (* IWidgetXmlParsingFunc) (GdaExQueryEditorIWidget *, xmlNodePtr);
+	g_return_if_fail (GDAEX_IS_QUERY_EDITOR (qe));
+	g_return_if_fail (root != NULL);
+	g_return_if_fail (xmlStrcmp (root->name, "gdaex_query_editor") == 0);
 
-static GdaExQueryEditorIWidget
-*gdaex_query_editor_iwidget_construct (GdaExQueryEditor *qe,
-									   const gchar *type,
-									   xmlNode *xnode)
-{
-	GdaExQueryEditorPrivate *priv;
+	priv = GDAEX_QUERY_EDITOR_GET_PRIVATE (qe);
 
-	guint i;
+	if (clean)
+		{
+			gdaex_query_editor_clean (qe);
+			gdaex_query_editor_clean_choices (qe);
+		}
 
-	IWidgetConstructorFunc iwidget_constructor;
-	IWidgetXmlParsingFunc iwidget_xml_parsing;
+	gdaex_query_editor_model_load_tables_from_xml (priv->model, root, FALSE);
 
-	GdaExQueryEditorIWidget *iwidget;
+	/* the model skips the widget nodes: construct them now that the fields exist */
+	for (xfields = root->children; xfields != NULL; xfields = xfields->next)
+		{
+			if (xmlStrcmp (xfields->name, "fields") != 0)
+				{
+					continue;
+				}
 
-	priv = GDAEX_QUERY_EDITOR_GET_PRIVATE (qe);
+			table_name = xmlGetProp (xfields, "table");
 
-	iwidget = NULL;
-	for (i = 0; i < priv->ar_modules->len; i++)
-		{
-			if (g_module_symbol ((GModule *)g_ptr_array_index (priv->ar_modules, i),
-								 g_strconcat (type, "_new", NULL),
-								 (gpointer *)&iwidget_constructor))
+			for (xfield = xfields->children; xfield != NULL; xfield = xfield->next)
 				{
-					if (iwidget_constructor != NULL)
+					if (xmlStrcmp (xfield->name, "field") != 0)
+						{
+							continue;
+						}
+
+					field = NULL;
+					for (cur = xfield->children; cur != NULL; cur = cur->next)
 						{
-							iwidget = iwidget_constructor ();
-							if (iwidget != NULL)
+							if (xmlStrcmp (cur->name, "name") == 0)
 								{
-									if (g_module_symbol ((GModule *)g_ptr_array_index (priv->ar_modules, i),
-														 g_strconcat (type, "_xml_parsing", NULL),
-														 (gpointer *)&iwidget_xml_parsing))
+									field_name = xmlNodeGetContent (cur);
+									if (field_name != NULL)
 										{
-											if (iwidget_xml_parsing != NULL)
-												{
-													iwidget_xml_parsing (iwidget, xnode);
-												}
+											field = gdaex_query_editor_model_get_field (priv->model, table_name, g_strstrip (field_name));
+											xmlFree (field_name);
 										}
+									break;
+								}
+						}
+					if (field == NULL)
+						{
+							continue;
+						}
+
+					for (cur = xfield->children; cur != NULL; cur = cur->next)
+						{
+							if (xmlStrcmp (cur->name, "widget") == 0
+							    || xmlStrcmp (cur->name, "widget_from") == 0
+							    || xmlStrcmp (cur->name, "widget_to") == 0)
+								{
+									gdaex_query_editor_load_field_widget (qe, table_name, field, cur);
 								}
-							break;
 						}
 				}
+
+			xmlFree (table_name);
 		}
 
-	return iwidget;
+	gdaex_query_editor_fields_changed (qe, NULL, NULL);
 }
 
+/**
+ * gdaex_query_editor_load_tables_from_file:
+ * @qe: a #GdaExQueryEditor object.
+ * @filename: the xml file with the definitions.
+ * @clean: whether to remove the current tables and choices before.
+ *
+ * The definitions are shared with the other editors that load the same
+ * file (see gdaex_query_editor_model_load_tables_from_file()): only the
+ * widget nodes are parsed as xml, the widgets are per editor.
+ */
 void
-gdaex_query_editor_load_tables_from_xml (GdaExQueryEditor *qe,
-                                         xmlNode *root,
-                                         gboolean clean)
+gdaex_query_editor_load_tables_from_file (GdaExQueryEditor *qe,
+                                          const gchar *filename,
+                                          gboolean clean)
 {
 	GdaExQueryEditorPrivate *priv;
-	GdaExQueryEditorClass *klass;
-
-	xmlDoc *xdoc;
-	xmlXPathContextPtr xpcontext;
-	xmlXPathObjectPtr xpresult;
-	xmlNodeSetPtr xnodeset;
-
-	xmlNode *xnode;
-	xmlNode *xtable;
-	xmlNode *xfield;
-	xmlNode *xrelation;
-	xmlNode *xdecode;
-	xmlNode *xfields_joined;
-	xmlNode *cur;
-
-	guint i;
-
-	gchar *table_name;
-	gchar *name;
-	gchar *name_visible;
 
-	GdaExQueryEditorField *field;
+	GVariant *widgets;
+	GVariantIter iter;
+	const gchar *table_name;
+	const gchar *field_name;
+	const gchar *xml;
 
-	gchar *table_left;
-	gchar *table_right;
-	GdaExQueryEditorJoinType join_type;
-	GSList *fields_joined;
+	xmlDoc *xdoc;
+	const GdaExQueryEditorField *field;
 
 	g_return_if_fail (GDAEX_IS_QUERY_EDITOR (qe));
-	g_return_if_fail (root != NULL);
-	g_return_if_fail (xmlStrcmp (root->name, "gdaex_query_editor") == 0);
-
-	klass = GDAEX_QUERY_EDITOR_GET_CLASS (qe);
+	g_return_if_fail (filename != NULL);
 
 	priv = GDAEX_QUERY_EDITOR_GET_PRIVATE (qe);
 
@@ -1236,1012 +1470,475 @@ gdaex_query_editor_load_tables_from_xml (GdaExQueryEditor *qe,
 			gdaex_query_editor_clean_choices (qe);
 		}
 
-	table_name = NULL;
-	name = NULL;
-	name_visible = NULL;
-	join_type = 0;
-	fields_joined = NULL;
-
-	xdoc = xmlNewDoc ("");
-	xmlDocSetRootElement (xdoc, root);
+	gdaex_query_editor_model_load_tables_from_file (priv->model, filename, FALSE);
 
-	/* search tables node */
-	xpcontext = xmlXPathNewContext (xdoc);
-	xpcontext->node = xmlDocGetRootElement (xdoc);
-	xpresult = xmlXPathEvalExpression ((const xmlChar *)"child::tables", xpcontext);
-	if (xpresult != NULL && !xmlXPathNodeSetIsEmpty (xpresult->nodesetval))
+	widgets = gdaex_query_editor_model_get_widgets (priv->model);
+	if (widgets != NULL)
 		{
-			xnodeset = xpresult->nodesetval;
-			for (i = 0; i < xnodeset->nodeNr; i++)
+			g_variant_iter_init (&iter, widgets);
+			while (g_variant_iter_next (&iter, "(&s&s&s)", &table_name, &field_name, &xml))
 				{
-					xtable = xnodeset->nodeTab[i]->children;
-					while (xtable != NULL)
+					field = gdaex_query_editor_model_get_field (priv->model, table_name, field_name);
+					if (field == NULL)
 						{
-							if (xmlStrcmp (xtable->name, "table") == 0)
-								{
-									if (table_name != NULL)
-										{
-											g_free (table_name);
-											table_name = NULL;
-										}
-									if (name_visible != NULL)
-										{
-											g_free (name_visible);
-											name_visible = NULL;
-										}
-
-									cur = xtable->children;
-									while (cur != NULL)
-										{
-											if (xmlStrcmp (cur->name, "name") == 0)
-												{
-													table_name = xmlNodeGetContent (cur);
-													if (table_name != NULL)
-														{
-															table_name = g_strstrip (g_strdup (table_name));
-														}
-												}
-											else if (xmlStrcmp (cur->name, "name_visible") == 0)
-												{
-													name_visible = xmlNodeGetContent (cur);
-													if (name_visible != NULL)
-														{
-															name_visible = g_strstrip (g_strdup (name_visible));
-														}
-												}
+							continue;
+						}
 
-											if (table_name != NULL)
-												{
-													gdaex_query_editor_add_table (qe, table_name, name_visible);
-												}
-
-											cur = cur->next;
-										}
-								}
-
-							xtable = xtable->next;
+					xdoc = xmlParseMemory (xml, strlen (xml));
+					if (xdoc != NULL)
+						{
+							gdaex_query_editor_load_field_widget (qe, table_name, field, xmlDocGetRootElement (xdoc));
+							xmlFreeDoc (xdoc);
 						}
 				}
 		}
-	else
-		{
-			g_warning (_("No table's definitions on xml file."));
-		}
 
-	/* search fields node */
-	if (table_name != NULL)
-		{
-			g_free (table_name);
-			table_name = NULL;
-		}
+	gdaex_query_editor_fields_changed (qe, NULL, NULL);
+}
 
-	xpcontext = xmlXPathNewContext (xdoc);
-	xpcontext->node = xmlDocGetRootElement (xdoc);
-	xpresult = xmlXPathEvalExpression ((const xmlChar *)"child::fields", xpcontext);
-	if (xpresult != NULL && !xmlXPathNodeSetIsEmpty (xpresult->nodesetval))
-		{
-			xnodeset = xpresult->nodesetval;
-			for (i = 0; i < xnodeset->nodeNr; i++)
-				{
-					table_name = xmlGetProp (xnodeset->nodeTab[i], "table");
+void
+gdaex_query_editor_clean_choices (GdaExQueryEditor *qe)
+{
+	GdaExQueryEditorPrivate *priv;
 
-					xfield = xnodeset->nodeTab[i]->children;
-					while (xfield != NULL)
-						{
-							if (xmlStrcmp (xfield->name, "field") == 0)
-								{
-									field = g_new0 (GdaExQueryEditorField, 1);
-									field->for_show = TRUE;
-									field->for_where = TRUE;
-									field->for_order = TRUE;
-
-									field->where_default_from = g_strdup ("");
-									field->where_default_from_visible = g_strdup ("");
-									field->where_default_from_sql = g_strdup ("");
-									field->where_default_to = g_strdup ("");
-									field->where_default_to_visible = g_strdup ("");
-									field->where_default_to_sql = g_strdup ("");
-
-									cur = xfield->children;
-									while (cur != NULL)
-										{
-											if (xmlStrcmp (cur->name, "name") == 0)
-												{
-													field->name = xmlNodeGetContent (cur);
-													if (field->name != NULL)
-														{
-															field->name = g_strstrip (g_strdup (field->name));
-														}
-												}
-											else if (xmlStrcmp (cur->name, "name_visible") == 0)
-												{
-													field->name_visible = xmlNodeGetContent (cur);
-													if (field->name_visible != NULL)
-														{
-															field->name_visible = g_strstrip (g_strdup (field->name_visible));
-														}
-												}
-											else if (xmlStrcmp (cur->name, "description") == 0)
-												{
-													field->description = xmlNodeGetContent (cur);
-												}
-											else if (xmlStrcmp (cur->name, "alias") == 0)
-												{
-													field->alias = xmlNodeGetContent (cur);
-												}
-											else if (xmlStrcmp (cur->name, "type") == 0)
-												{
-													field->type = gdaex_query_editor_str_to_field_type (xmlNodeGetContent (cur));
-												}
-											else if (xmlStrcmp (cur->name, "for_show") == 0)
-												{
-													field->for_show = zak_utils_string_to_boolean (xmlNodeGetContent (cur));
-												}
-											else if (xmlStrcmp (cur->name, "always_showed") == 0)
-												{
-													field->always_showed = zak_utils_string_to_boolean (xmlNodeGetContent (cur));
-												}
-											else if (xmlStrcmp (cur->name, "for_where") == 0)
-												{
-													field->for_where = zak_utils_string_to_boolean (xmlNodeGetContent (cur));
-												}
-											else if (xmlStrcmp (cur->name, "available_where_type") == 0)
-												{
-													field->available_where_type = gdaex_query_editor_str_to_where_type (xmlNodeGetContent (cur));
-												}
-											else if (xmlStrcmp (cur->name, "where_default_not") == 0)
-												{
-													field->where_default_not = zak_utils_string_to_boolean (xmlNodeGetContent (cur));
-												}
-											else if (xmlStrcmp (cur->name, "where_default_type") == 0)
-												{
-													field->where_default_type = gdaex_query_editor_str_to_where_type (xmlNodeGetContent (cur));
-												}
-											else if (xmlStrcmp (cur->name, "where_default_from") == 0)
-												{
-													xmlNode *wfrom;
-
-													wfrom = cur->children;
-													while (wfrom != NULL)
-														{
-															if (xmlStrcmp (wfrom->name, "w_value") == 0)
-																{
-																	field->where_default_from  = xmlNodeGetContent (wfrom);
-																}
-															else if (xmlStrcmp (wfrom->name, "w_visible") == 0)
-																{
-																	field->where_default_from_visible  = xmlNodeGetContent (wfrom);
-																}
-															else if (xmlStrcmp (wfrom->name, "w_sql") == 0)
-																{
-																	field->where_default_from_sql  = xmlNodeGetContent (wfrom);
-																}
-
-															wfrom = wfrom->next;
-														}
-												}
-											else if (xmlStrcmp (cur->name, "where_default_to") == 0)
-												{
-													xmlNode *wto;
-
-													wto = cur->children;
-													while (wto != NULL)
-														{
-															if (xmlStrcmp (wto->name, "w_value") == 0)
-																{
-																	field->where_default_to  = xmlNodeGetContent (wto);
-																}
-															else if (xmlStrcmp (wto->name, "w_visible") == 0)
-																{
-																	field->where_default_to_visible  = xmlNodeGetContent (wto);
-																}
-															else if (xmlStrcmp (wto->name, "w_sql") == 0)
-																{
-																	field->where_default_to_sql  = xmlNodeGetContent (wto);
-																}
-
-															wto = wto->next;
-														}
-												}
-											else if (xmlStrcmp (cur->name, "for_order") == 0)
-												{
-													field->for_order = zak_utils_string_to_boolean (xmlNodeGetContent (cur));
-												}
-											else if (xmlStrcmp (cur->name, "always_ordered") == 0)
-												{
-													field->always_ordered = zak_utils_string_to_boolean (xmlNodeGetContent (cur));
-												}
-											else if (xmlStrcmp (cur->name, "order_default") == 0)
-												{
-													if (g_strcmp0 (xmlNodeGetContent (cur), "ASC") == 0)
-														{
-															field->order_default = GDAEX_QE_ORDER_ASC;
-														}
-													else
-														{
-															field->order_default = GDAEX_QE_ORDER_DESC;
-														}
-												}
-											else if (xmlStrcmp (cur->name, "decode") == 0)
-												{
-													xdecode = cur->children;
-													while (xdecode != NULL)
-														{
-															if (xmlStrcmp (xdecode->name, "table_name") == 0)
-																{
-																	field->decode_table2 = xmlNodeGetContent (xdecode);
-																}
-															else if (xmlStrcmp (xdecode->name, "join_type") == 0)
-																{
-																	field->decode_join_type = gdaex_query_editor_str_to_join_type (xmlNodeGetContent (xdecode));
-																}
-															else if (xmlStrcmp (xdecode->name, "field_name_to_join") == 0)
-																{
-																	field->decode_field2 = xmlNodeGetContent (xdecode);
-																}
-															else if (xmlStrcmp (xdecode->name, "field_name_to_show") == 0)
-																{
-																	field->decode_field_to_show = xmlNodeGetContent (xdecode);
-																}
-															else if (xmlStrcmp (xdecode->name, "alias") == 0)
-																{
-																	field->decode_field_alias = xmlNodeGetContent (xdecode);
-																}
-
-															xdecode = xdecode->next;
-														}
-												}
-											else if (xmlStrcmp (cur->name, "widget") == 0
-													 || xmlStrcmp (cur->name, "widget_from") == 0
-													 || xmlStrcmp (cur->name, "widget_to") == 0)
-												{
-													gchar *type;
-
-													type = xmlGetProp (cur, (const xmlChar *)"type");
-
-													if (xmlStrcmp (cur->name, "widget") == 0
-														|| xmlStrcmp (cur->name, "widget_from") == 0)
-														{
-															field->iwidget_from = gdaex_query_editor_iwidget_construct (qe,
-																														type,
-																														cur);
-															if (field->iwidget_from == NULL)
-																{
-																	g_warning (_("Unknown iwidget_from type «%s»."), type);
-																}
-															else
-																{
-																	g_signal_emit (qe, klass->iwidget_init_signal_id,
-																				   0,
-																				   field->iwidget_from,
-																				   table_name,
-																				   field->name,
-																				   TRUE);
-																}
-														}
-													if (xmlStrcmp (cur->name, "widget") == 0
-														|| xmlStrcmp (cur->name, "widget_to") == 0)
-														{
-															field->iwidget_to = gdaex_query_editor_iwidget_construct (qe,
-																													  type,
-																													  cur);
-															if (field->iwidget_to == NULL)
-																{
-																	g_warning (_("Unknown iwidget_to type «%s»."), type);
-																}
-															else
-																{
-																	g_signal_emit (qe, klass->iwidget_init_signal_id,
-																				   0,
-																				   field->iwidget_from,
-																				   table_name,
-																				   field->name,
-																				   FALSE);
-																}
-														}
-												}
+	g_return_if_fail (GDAEX_IS_QUERY_EDITOR (qe));
 
-											cur = cur->next;
-										}
+	priv = GDAEX_QUERY_EDITOR_GET_PRIVATE (qe);
 
-									gdaex_query_editor_table_add_field (qe, table_name, *field);
-									g_free (field);
-								}
+	gtk_list_store_clear (priv->lstore_show);
+	gtk_tree_store_clear (priv->tstore_where);
+	gtk_list_store_clear (priv->lstore_order);
 
-							xfield = xfield->next;
-						}
+	gdaex_query_editor_refill_always_show (qe);
+	gdaex_query_editor_refill_always_order (qe);
 
-					if (table_name != NULL)
-						{
-							g_free (table_name);
-							table_name = NULL;
-						}
-				}
-		}
-	else
-		{
-			g_warning (_("No field's definitions on xml file."));
-		}
+	gtk_button_clicked (GTK_BUTTON (gtk_builder_get_object (priv->gtkbuilder, "button16")));
+}
 
-	/* search relations node */
-	xpcontext = xmlXPathNewContext (xdoc);
-	xpcontext->node = xmlDocGetRootElement (xdoc);
-	xpresult = xmlXPathEvalExpression ((const xmlChar *)"child::relations", xpcontext);
-	if (xpresult != NULL && !xmlXPathNodeSetIsEmpty (xpresult->nodesetval))
-		{
-			xnodeset = xpresult->nodesetval;
-			for (i = 0; i < xnodeset->nodeNr; i++)
-				{
-					xrelation = xnodeset->nodeTab[i]->children;
-					while (xrelation != NULL)
-						{
-							if (xmlStrcmp (xrelation->name, "relation") == 0)
-								{
-									cur = xrelation->children;
-									while (cur != NULL)
-										{
-											if (xmlStrcmp (cur->name, "table_left") == 0)
-												{
-													table_left = xmlNodeGetContent (cur);
-													if (table_left != NULL)
-														{
-															table_left = g_strstrip (g_strdup (table_left));
-														}
-												}
-											else if (xmlStrcmp (cur->name, "table_right") == 0)
-												{
-													table_right = xmlNodeGetContent (cur);
-													if (table_right != NULL)
-														{
-															table_right = g_strstrip (g_strdup (table_right));
-														}
-												}
-											else if (xmlStrcmp (cur->name, "join_type") == 0)
-												{
-													join_type = gdaex_query_editor_str_to_join_type (xmlNodeGetContent (cur));
-												}
-											else if (xmlStrcmp (cur->name, "fields_joined") == 0)
-												{
-													xfields_joined = cur->children;
-													while (xfields_joined != NULL)
-														{
-															if (xmlStrcmp (xfields_joined->name, "field_left") == 0)
-																{
-																	name = xmlNodeGetContent (xfields_joined);
-																	if (name != NULL)
-																		{
-																			name = g_strstrip (g_strdup (name));
-																			fields_joined = g_slist_append (fields_joined, name);
-																		}
-																}
-															else if (xmlStrcmp (xfields_joined->name, "field_right") == 0)
-																{
-																	name = xmlNodeGetContent (xfields_joined);
-																	if (name != NULL)
-																		{
-																			name = g_strstrip (g_strdup (name));
-																			fields_joined = g_slist_append (fields_joined, name);
-																		}
-																}
-
-															xfields_joined = xfields_joined->next;
-														}
-												}
+/**
+ * gdaex_query_editor_get_model:
+ * @qe: a #GdaExQueryEditor object.
+ *
+ * The model is updated with the choices of the gui on every call of
+ * gdaex_query_editor_get_sql() and friends.
+ *
+ * Returns: (transfer none): the #GdaExQueryEditorModel that holds tables,
+ * relations and choices of @qe.
+ */
+GdaExQueryEditorModel
+*gdaex_query_editor_get_model (GdaExQueryEditor *qe)
+{
+	GdaExQueryEditorPrivate *priv;
 
-											cur = cur->next;
-										}
+	g_return_val_if_fail (GDAEX_IS_QUERY_EDITOR (qe), NULL);
 
-									if (table_left != NULL
-									    && table_right != NULL
-									    && join_type > 0
-									    && fields_joined != NULL)
-										{
-											gdaex_query_editor_add_relation_slist (qe, table_left, table_right, join_type, fields_joined);
-										}
-									if (table_left != NULL)
-										{
-											g_free (table_left);
-											table_left = NULL;
-										}
-									if (table_right != NULL)
-										{
-											g_free (table_right);
-											table_right = NULL;
-										}
-									if (fields_joined != NULL)
-										{
-											g_slist_free (fields_joined);
-											fields_joined = NULL;
-										}
-									join_type = 0;
-								}
+	priv = GDAEX_QUERY_EDITOR_GET_PRIVATE (qe);
 
-							xrelation = xrelation->next;
-						}
-				}
-		}
+	return priv->model;
 }
 
-void
-gdaex_query_editor_load_tables_from_file (GdaExQueryEditor *qe,
-                                          const gchar *filename,
-                                          gboolean clean)
+GdaSqlBuilder
+*gdaex_query_editor_get_sql_as_gdasqlbuilder (GdaExQueryEditor *qe)
 {
-	xmlDoc *xdoc;
-	xmlNode *xroot;
+	GdaExQueryEditorPrivate *priv;
 
-	g_return_if_fail (filename != NULL);
+	g_return_val_if_fail (GDAEX_IS_QUERY_EDITOR (qe), NULL);
 
-	xdoc = xmlParseFile (filename);
-	if (xdoc != NULL)
-		{
-			xroot = xmlDocGetRootElement (xdoc);
-			if (xroot != NULL)
-				{
-					gdaex_query_editor_load_tables_from_xml (qe, xroot, clean);
-				}
-		}
+	priv = GDAEX_QUERY_EDITOR_GET_PRIVATE (qe);
+
+	gdaex_query_editor_sync_model (qe);
+
+	return gdaex_query_editor_model_get_sql_as_gdasqlbuilder (priv->model);
 }
 
-void
-gdaex_query_editor_clean_choices (GdaExQueryEditor *qe)
+const gchar
+*gdaex_query_editor_get_sql (GdaExQueryEditor *qe)
 {
 	GdaExQueryEditorPrivate *priv;
 
-	g_return_if_fail (GDAEX_IS_QUERY_EDITOR (qe));
+	g_return_val_if_fail (GDAEX_IS_QUERY_EDITOR (qe), NULL);
 
 	priv = GDAEX_QUERY_EDITOR_GET_PRIVATE (qe);
 
-	gtk_list_store_clear (priv->lstore_show);
-	gtk_tree_store_clear (priv->tstore_where);
-	gtk_list_store_clear (priv->lstore_order);
+	gdaex_query_editor_sync_model (qe);
 
-	gdaex_query_editor_refill_always_show (qe);
-	gdaex_query_editor_refill_always_order (qe);
+	return gdaex_query_editor_model_get_sql (priv->model);
+}
 
-	gtk_button_clicked (GTK_BUTTON (gtk_builder_get_object (priv->gtkbuilder, "button16")));
+/**
+ * gdaex_query_editor_get_statement:
+ * @qe: a #GdaExQueryEditor object.
+ * @params: (out) (transfer full): the parameters of the statement, set with
+ * the values of the conditions; #NULL if there are no conditions.
+ *
+ * Like gdaex_query_editor_get_sql(), but with a parameter for each value
+ * of the conditions: the same search with other values gives the same
+ * statement (see gdaex_query_editor_model_get_statement()), to execute
+ * with gdaex_query_statement().
+ *
+ * Returns: (transfer full): a #GdaStatement; #NULL on error.
+ */
+GdaStatement
+*gdaex_query_editor_get_statement (GdaExQueryEditor *qe, GdaSet **params)
+{
+	GdaExQueryEditorPrivate *priv;
+
+	g_return_val_if_fail (GDAEX_IS_QUERY_EDITOR (qe), NULL);
+	g_return_val_if_fail (params != NULL, NULL);
+
+	priv = GDAEX_QUERY_EDITOR_GET_PRIVATE (qe);
+
+	gdaex_query_editor_sync_model (qe);
+
+	return gdaex_query_editor_model_get_statement (priv->model, params);
 }
 
-static GDate
-*gdaex_query_editor_get_gdate_from_sql (const gchar *sql)
+const gchar
+*gdaex_query_editor_get_sql_select (GdaExQueryEditor *qe)
 {
-	GDate *ret;
+	gchar *ret;
+	const gchar *sql;
 
-	gint year;
-	gint month;
-	gint day;
+	gchar *start;
+	gchar *end;
 
 	ret = NULL;
 
-	year = 0;
-	month = 0;
-	day = 0;
+	sql = gdaex_query_editor_get_sql (qe);
+	if (sql == NULL)
+		{
+			return ret;
+		}
 
-	if (strlen (sql + 1) >= 10)
+	start = g_strstr_len (sql, -1, "SELECT");
+	if (start == NULL)
 		{
-			year = strtol (g_strndup (sql + 1, 4), NULL, 10);
-			month = strtol (g_strndup (sql + 6, 2), NULL, 10);
-			day = strtol (g_strndup (sql + 9, 2), NULL, 10);
+			return ret;
+		}
 
-			ret = g_date_new_dmy (day,
-			                      month,
-			                      year);
+	end = g_strstr_len (sql, -1, "FROM");
+	if (end == NULL)
+		{
+			return ret;
 		}
 
+	ret = g_strndup (start + 7, strlen (sql) - 8 - strlen (end));
+
 	return ret;
 }
 
-static GdaTimestamp
-*gdaex_query_editor_get_gdatimestamp_from_sql (const gchar *sql)
+const gchar
+*gdaex_query_editor_get_sql_from (GdaExQueryEditor *qe)
 {
-	GdaTimestamp *ret;
+	gchar *ret;
+	const gchar *sql;
+
+	gchar *start;
+	gchar *end;
 
 	ret = NULL;
 
-	if (strlen (sql + 1) >= 10)
+	sql = gdaex_query_editor_get_sql (qe);
+	if (sql == NULL)
 		{
-			ret = g_new0 (GdaTimestamp, 1);
+			return ret;
+		}
 
-			ret->year = strtol (g_strndup (sql + 1, 4), NULL, 10);
-			ret->month = strtol (g_strndup (sql + 6, 2), NULL, 10);
-			ret->day = strtol (g_strndup (sql + 9, 2), NULL, 10);
+	start = g_strstr_len (sql, -1, "FROM");
+	if (start == NULL)
+		{
+			return ret;
+		}
 
-			if (strlen (sql + 1) >= 12)
-				{
-					ret->hour = strtol (g_strndup (sql + 12, 2), NULL, 10);
-					ret->minute = strtol (g_strndup (sql + 15, 2), NULL, 10);
-					if (strlen (sql + 1) >= 16)
-						{
-							ret->second = strtol (g_strndup (sql + 18, 2), NULL, 10);
-						}
-				}
+	end = g_strstr_len (sql, -1, "WHERE");
+	if (end == NULL)
+		{
+			end = g_strstr_len (sql, -1, "ORDER BY");
 		}
 
+	ret = g_strndup (start + 5, strlen (start) - (end != NULL ? 6 : 5) - (end != NULL ? strlen (end) : 0));
+
 	return ret;
 }
 
-GdaExQueryEditorRelation
-*gdaex_query_editor_get_table_relation (GdaExQueryEditor *qe,
-                                        const gchar *table_name)
+const gchar
+*gdaex_query_editor_get_sql_where (GdaExQueryEditor *qe)
 {
-	GdaExQueryEditorRelation *ret;
-
-	GdaExQueryEditorPrivate *priv;
+	gchar *ret;
+	const gchar *sql;
 
-	GSList *relations;
+	gchar *start;
+	gchar *end;
 
-	priv = GDAEX_QUERY_EDITOR_GET_PRIVATE (qe);
+	ret = NULL;
 
-	if (priv->relations == NULL)
+	sql = gdaex_query_editor_get_sql (qe);
+	if (sql == NULL)
 		{
-			return NULL;
+			return ret;
 		}
 
-	ret = NULL;
-
-	relations = priv->relations;
-	while (relations != NULL)
+	start = g_strstr_len (sql, -1, "WHERE");
+	if (start == NULL)
 		{
-			if (g_strcmp0 (((GdaExQueryEditorRelation *)relations->data)->table2->name, table_name) == 0)
-				{
-					ret = (GdaExQueryEditorRelation *)relations->data;
-					break;
-				}
-
-			relations = g_slist_next (relations);
+			return ret;
 		}
 
+	end = g_strstr_len (sql, -1, "ORDER BY");
+
+	ret = g_strndup (start + 6, strlen (start) - (end != NULL ? 7 : 6) - (end != NULL ? strlen (end) : 0));
+
 	return ret;
 }
 
-static void
-gdaex_query_editor_add_table_relation_to_gdasqlbuilder (GdaExQueryEditor *qe,
-                                                        GdaSqlBuilder *sqlbuilder,
-                                                        const gchar *table_name)
+const gchar
+*gdaex_query_editor_get_sql_order (GdaExQueryEditor *qe)
 {
-	GdaExQueryEditorRelation *relation;
-
-	GSList *fields1;
-	GSList *fields2;
-
-	guint id_target1;
-	guint id_target2;
-	guint id_join1;
-	guint id_join2;
-	guint join_cond;
+	gchar *ret;
+	const gchar *sql;
 
-	GdaExQueryEditorPrivate *priv;
+	gchar *start;
 
-	priv = GDAEX_QUERY_EDITOR_GET_PRIVATE (qe);
+	ret = NULL;
 
-	/* check if table is part of a relation */
-	relation = gdaex_query_editor_get_table_relation (qe, table_name);
-	if (relation != NULL)
-		{
-			id_target1 = gda_sql_builder_select_add_target_id (sqlbuilder,
-			                                                   gda_sql_builder_add_id (sqlbuilder, relation->table1->name),
-			                                                   NULL);
-			id_target2 = gda_sql_builder_select_add_target_id (sqlbuilder,
-			                                                   gda_sql_builder_add_id (sqlbuilder, relation->table2->name),
-			                                                   NULL);
-
-			/* for each fields couple */
-			fields1 = relation->fields1;
-			fields2 = relation->fields2;
-			while (fields1 != NULL)
-				{
-					id_join1 = gda_sql_builder_add_id (sqlbuilder, g_strconcat (relation->table1->name, ".", ((GdaExQueryEditorField *)fields1->data)->name, NULL));
-					id_join2 = gda_sql_builder_add_id (sqlbuilder, g_strconcat (relation->table2->name, ".", ((GdaExQueryEditorField *)fields2->data)->name, NULL));
+	sql = gdaex_query_editor_get_sql (qe);
+	if (sql == NULL)
+		{
+			return ret;
+		}
 
-					join_cond = gda_sql_builder_add_cond (sqlbuilder, GDA_SQL_OPERATOR_TYPE_EQ,
-					                                      id_join1, id_join2, 0);
+	start = g_strstr_len (sql, -1, "ORDER BY");
+	if (start == NULL)
+		{
+			return ret;
+		}
 
-					gda_sql_builder_select_join_targets (sqlbuilder, id_target1, id_target2,
-					                                     relation->join_type == GDAEX_QE_JOIN_TYPE_LEFT ? GDA_SQL_SELECT_JOIN_LEFT : GDA_SQL_SELECT_JOIN_INNER,
-					                                     join_cond);
+	ret = g_strndup (start + 9, strlen (start) - 9);
 
-					fields1 = g_slist_next (fields1);
-					fields2 = g_slist_next (fields2);
-				}
-		}
+	return ret;
 }
 
-static guint
-gdaex_query_editor_sql_where (GdaExQueryEditor *qe,
-                              GdaSqlBuilder *sqlbuilder,
-                              GtkTreeIter *iter,
-                              GtkTreeIter *iter_parent,
-                              guint id_cond_parent)
+xmlNode
+*gdaex_query_editor_get_sql_as_xml (GdaExQueryEditor *qe)
 {
 	GdaExQueryEditorPrivate *priv;
 
-	guint id_ret;
+	g_return_val_if_fail (GDAEX_IS_QUERY_EDITOR (qe), NULL);
 
-	gchar *table_name;
-	gchar *field_name;
-	gchar *field_name_with_table;
-
-	GdaExQueryEditorTable *table;
-	GdaExQueryEditorField *field;
+	priv = GDAEX_QUERY_EDITOR_GET_PRIVATE (qe);
 
-	guint link_type;
-	GdaSqlOperatorType link_op;
-	gboolean not;
-	guint where_type;
-	GdaSqlOperatorType where_op;
-	gchar *from_str;
-	gchar *to_str;
-	GDate *from_date;
-	GDateTime *from_datetime;
+	gdaex_query_editor_sync_model (qe);
 
-	guint id_field;
-	guint id_value1;
-	guint id_value2;
-	guint id_cond_iter;
+	return gdaex_query_editor_model_get_sql_as_xml (priv->model);
+}
 
-	gboolean case_insensitive;
+void
+gdaex_query_editor_load_choices_from_xml (GdaExQueryEditor *qe, xmlNode *root,
+                                          gboolean clean)
+{
+	GdaExQueryEditorPrivate *priv;
 
-	gboolean is_group;
+	g_return_if_fail (GDAEX_IS_QUERY_EDITOR (qe));
 
-	GtkTreeIter children;
+	g_return_if_fail (xmlStrEqual (root->name, "gdaex_query_editor_choices"));
 
 	priv = GDAEX_QUERY_EDITOR_GET_PRIVATE (qe);
 
-	id_ret = 0;
-
-	do
+	if (clean)
 		{
-			id_value2 = 0;
-
-			gtk_tree_model_get (GTK_TREE_MODEL (priv->tstore_where), iter,
-			                    COL_WHERE_LINK_TYPE, &link_type,
-			                    COL_WHERE_TABLE_NAME, &table_name,
-			                    COL_WHERE_NAME, &field_name,
-			                    COL_WHERE_CONDITION_NOT, &not,
-			                    COL_WHERE_CONDITION_TYPE, &where_type,
-			                    COL_WHERE_CONDITION_FROM_SQL, &from_str,
-			                    COL_WHERE_CONDITION_TO_SQL, &to_str,
-			                    -1);
-
-			is_group = (g_strcmp0 (table_name, GROUP) == 0);
-
-			switch (link_type)
-				{
-					case GDAEX_QE_LINK_TYPE_AND:
-						link_op = GDA_SQL_OPERATOR_TYPE_AND;
-						break;
-
-					case GDAEX_QE_LINK_TYPE_OR:
-						link_op = GDA_SQL_OPERATOR_TYPE_OR;
-						break;
-				}
+			gdaex_query_editor_clean_choices (qe);
+		}
 
-			if (!is_group)
-				{
-					case_insensitive = (where_type == GDAEX_QE_WHERE_TYPE_ISTARTS
-					                    || where_type == GDAEX_QE_WHERE_TYPE_ICONTAINS
-					                    || where_type == GDAEX_QE_WHERE_TYPE_IENDS);
+	/* the loaded choices are added to the current ones */
+	gdaex_query_editor_sync_model (qe);
+	gdaex_query_editor_model_load_choices_from_xml (priv->model, root, FALSE);
+	gdaex_query_editor_fill_stores (qe);
+}
 
-					if (from_str == NULL)
-						{
-							from_str = g_strdup ("");
-						}
-					else
-						{
-							if (case_insensitive)
-								{
-									from_str = g_utf8_strdown (from_str, -1);
-								}
-						}
-					if (to_str != NULL && g_strcmp0 (g_strstrip (to_str), "") != 0)
-						{
-							if (case_insensitive)
-								{
-									to_str = g_utf8_strdown (to_str, -1);
-								}
-						}
-					else
-						{
-							to_str = NULL;
-						}
+/* PRIVATE */
+static void
+gdaex_query_editor_set_property (GObject *object,
+                   guint property_id,
+                   const GValue *value,
+                   GParamSpec *pspec)
+{
+	GdaExQueryEditor *gdaex_query_editor = (GdaExQueryEditor *)object;
+	GdaExQueryEditorPrivate *priv = GDAEX_QUERY_EDITOR_GET_PRIVATE (gdaex_query_editor);
 
-					switch (where_type)
-						{
-							case GDAEX_QE_WHERE_TYPE_STARTS:
-							case GDAEX_QE_WHERE_TYPE_ISTARTS:
-								from_str = g_strconcat (from_str, "%", NULL);
-								if (to_str != NULL)
-									{
-										to_str = g_strconcat (to_str, "%", NULL);
-									}
-								break;
+	switch (property_id)
+		{
+			default:
+				G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+				break;
+		}
+}
 
-							case GDAEX_QE_WHERE_TYPE_CONTAINS:
-							case GDAEX_QE_WHERE_TYPE_ICONTAINS:
-								from_str = g_strconcat ("%", from_str, "%", NULL);
-								if (to_str != NULL)
-									{
-										to_str = g_strconcat ("%", to_str, "%", NULL);
-									}
-								break;
+static void
+gdaex_query_editor_get_property (GObject *object,
+                   guint property_id,
+                   GValue *value,
+                   GParamSpec *pspec)
+{
+	GdaExQueryEditor *gdaex_query_editor = (GdaExQueryEditor *)object;
+	GdaExQueryEditorPrivate *priv = GDAEX_QUERY_EDITOR_GET_PRIVATE (gdaex_query_editor);
 
-							case GDAEX_QE_WHERE_TYPE_ENDS:
-							case GDAEX_QE_WHERE_TYPE_IENDS:
-								from_str = g_strconcat ("%", from_str, NULL);
-								if (to_str != NULL)
-									{
-										to_str = g_strconcat ("%", to_str, NULL);
-									}
-								break;
-						}
+	switch (property_id)
+		{
+			default:
+				G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+				break;
+		}
+}
 
-					table = g_hash_table_lookup (priv->tables, table_name);
-					field = g_hash_table_lookup (table->fields, field_name);
+static void
+gdaex_query_editor_dispose (GObject *object)
+{
+	GdaExQueryEditor *gdaex_query_editor = (GdaExQueryEditor *)object;
+	GdaExQueryEditorPrivate *priv = GDAEX_QUERY_EDITOR_GET_PRIVATE (gdaex_query_editor);
 
-					gdaex_query_editor_add_table_relation_to_gdasqlbuilder (qe, sqlbuilder, table_name);
+	g_signal_handlers_disconnect_by_data (priv->tstore_where, gdaex_query_editor);
+	g_signal_handlers_disconnect_by_data (priv->lstore_show, gdaex_query_editor);
+	g_signal_handlers_disconnect_by_data (priv->lstore_order, gdaex_query_editor);
+	if (priv->count_source_id != 0)
+		{
+			g_source_remove (priv->count_source_id);
+			priv->count_source_id = 0;
+		}
+	if (priv->count_cancellable != NULL)
+		{
+			g_cancellable_cancel (priv->count_cancellable);
+			g_clear_object (&priv->count_cancellable);
+		}
 
-					field_name_with_table = g_strconcat (case_insensitive ? "LOWER(" : "",
-					                                     table->name, ".", field->name,
-					                                     case_insensitive ? ")" : "",
-					                                     NULL);
-					id_field = gda_sql_builder_add_id (sqlbuilder, field_name_with_table);
-					g_free (field_name_with_table);
+	gtk_tree_store_clear (priv->tstore_fields);
+	gtk_list_store_clear (priv->lstore_show);
+	gtk_tree_store_clear (priv->tstore_where);
+	gtk_list_store_clear (priv->lstore_order);
 
-					if (where_type == GDAEX_QE_WHERE_TYPE_IS_NULL)
-						{
-							id_value1 = 0;
-						}
-					else
-						{
-							switch (field->type)
-								{
-									case GDAEX_QE_FIELD_TYPE_TEXT:
-										id_value1 = gda_sql_builder_add_expr (sqlbuilder, NULL, G_TYPE_STRING, from_str);
-										if (to_str != NULL)
-											{
-												id_value2 = gda_sql_builder_add_expr (sqlbuilder, NULL, G_TYPE_STRING, to_str);
-											}
-										break;
+	if (priv->values_cancellable != NULL)
+		{
+			g_cancellable_cancel (priv->values_cancellable);
+			g_clear_object (&priv->values_cancellable);
+		}
 
-									case GDAEX_QE_FIELD_TYPE_INTEGER:
-										id_value1 = gda_sql_builder_add_expr (sqlbuilder, NULL, G_TYPE_INT, strtol (from_str, NULL, 10));
-										if (to_str != NULL)
-											{
-												id_value2 = gda_sql_builder_add_expr (sqlbuilder, NULL, G_TYPE_INT, strtol (to_str, NULL, 10));
-											}
-										break;
+	if (priv->model != NULL)
+		{
+			g_object_unref (priv->model);
+			priv->model = NULL;
+		}
 
-									case GDAEX_QE_FIELD_TYPE_BOOLEAN:
-										id_value1 = gda_sql_builder_add_expr (sqlbuilder, NULL, G_TYPE_BOOLEAN, zak_utils_string_to_boolean (from_str));
-										if (to_str != NULL)
-											{
-												id_value2 = gda_sql_builder_add_expr (sqlbuilder, NULL, G_TYPE_BOOLEAN, zak_utils_string_to_boolean (to_str));
-											}
-										break;
+	G_OBJECT_CLASS (gdaex_query_editor_parent_class)->dispose (object);
+}
 
-									case GDAEX_QE_FIELD_TYPE_DOUBLE:
-										id_value1 = gda_sql_builder_add_expr (sqlbuilder, NULL, G_TYPE_DOUBLE, g_strtod (from_str, NULL));
-										if (to_str != NULL)
-											{
-												id_value2 = gda_sql_builder_add_expr (sqlbuilder, NULL, G_TYPE_DOUBLE, g_strtod (to_str, NULL));
-											}
-										break;
+static void
+gdaex_query_editor_finalize (GObject *object)
+{
+	GdaExQueryEditor *gdaex_query_editor = (GdaExQueryEditor *)object;
+	GdaExQueryEditorPrivate *priv = GDAEX_QUERY_EDITOR_GET_PRIVATE (gdaex_query_editor);
 
-									case GDAEX_QE_FIELD_TYPE_DATE:
-										id_value1 = gda_sql_builder_add_expr (sqlbuilder, NULL, G_TYPE_DATE, gdaex_query_editor_get_gdate_from_sql (from_str));
-										if (to_str != NULL)
-											{
-												id_value2 = gda_sql_builder_add_expr (sqlbuilder, NULL, G_TYPE_DATE, gdaex_query_editor_get_gdate_from_sql (to_str));
-											}
-										break;
+	gtk_widget_destroy (priv->hpaned_main);
+	g_hash_table_destroy (priv->iwidgets);
 
-									case GDAEX_QE_FIELD_TYPE_DATETIME:
-										id_value1 = gda_sql_builder_add_expr (sqlbuilder, NULL, GDA_TYPE_TIMESTAMP, gdaex_query_editor_get_gdatimestamp_from_sql (from_str));
-										if (to_str != NULL)
-											{
-												id_value2 = gda_sql_builder_add_expr (sqlbuilder, NULL, GDA_TYPE_TIMESTAMP, gdaex_query_editor_get_gdatimestamp_from_sql (to_str));
-											}
-										break;
+	g_hash_table_destroy (priv->ht_fields_rows);
+	g_hash_table_destroy (priv->choices_show.ht);
+	g_hash_table_destroy (priv->choices_order.ht);
+	if (priv->fields_index != NULL)
+		{
+			g_ptr_array_unref (priv->fields_index);
+		}
+	if (priv->fields_filter != NULL)
+		{
+			g_hash_table_destroy (priv->fields_filter);
+		}
+	g_free (priv->fields_filter_text);
 
-									case GDAEX_QE_FIELD_TYPE_TIME:
-										/* TODO
-										type = G_TYPE_DATE_TIME; */
-										break;
-								};
-						}
+	if (priv->popover_values != NULL)
+		{
+			gtk_widget_destroy (priv->popover_values);
+			g_object_unref (priv->popover_values);
+			g_object_unref (priv->lstore_values);
+		}
+	g_free (priv->values_table_name);
+	g_free (priv->values_field_name);
 
-					switch (where_type)
-						{
-							case GDAEX_QE_WHERE_TYPE_EQUAL:
-								where_op = GDA_SQL_OPERATOR_TYPE_EQ;
-								break;
+	G_OBJECT_CLASS (gdaex_query_editor_parent_class)->finalize (object);
+}
 
-							case GDAEX_QE_WHERE_TYPE_STARTS:
-							case GDAEX_QE_WHERE_TYPE_CONTAINS:
-							case GDAEX_QE_WHERE_TYPE_ENDS:
-							case GDAEX_QE_WHERE_TYPE_ISTARTS:
-							case GDAEX_QE_WHERE_TYPE_ICONTAINS:
-							case GDAEX_QE_WHERE_TYPE_IENDS:
-								where_op = GDA_SQL_OPERATOR_TYPE_LIKE;
-								break;
+static void
+gdaex_query_editor_clean (GdaExQueryEditor *gdaex_query_editor)
+{
+	GdaExQueryEditorPrivate *priv = GDAEX_QUERY_EDITOR_GET_PRIVATE (gdaex_query_editor);
 
-							case GDAEX_QE_WHERE_TYPE_GREAT:
-								where_op = GDA_SQL_OPERATOR_TYPE_GT;
-								break;
+	gdaex_query_editor_model_clean (priv->model);
+	g_hash_table_remove_all (priv->iwidgets);
 
-							case GDAEX_QE_WHERE_TYPE_GREAT_EQUAL:
-								where_op = GDA_SQL_OPERATOR_TYPE_GEQ;
-								break;
+	gdaex_query_editor_fields_clean (gdaex_query_editor);
+}
 
-							case GDAEX_QE_WHERE_TYPE_LESS:
-								where_op = GDA_SQL_OPERATOR_TYPE_LT;
-								break;
+static gboolean
+_gdaex_query_editor_add_table (GdaExQueryEditor *qe,
+                              const gchar *table_name,
+                              const gchar *table_name_visible,
+                              gboolean is_visible)
+{
+	GdaExQueryEditorPrivate *priv;
 
-							case GDAEX_QE_WHERE_TYPE_LESS_EQUAL:
-								where_op = GDA_SQL_OPERATOR_TYPE_LEQ;
-								break;
+	gchar *_table_name;
+	gboolean ret;
 
-							case GDAEX_QE_WHERE_TYPE_BETWEEN:
-								where_op = GDA_SQL_OPERATOR_TYPE_BETWEEN;
-								break;
+	g_return_val_if_fail (GDAEX_IS_QUERY_EDITOR (qe), FALSE);
+	g_return_val_if_fail (table_name != NULL, FALSE);
 
-							case GDAEX_QE_WHERE_TYPE_IS_NULL:
-								if (not)
-									{
-										where_op = GDA_SQL_OPERATOR_TYPE_ISNOTNULL;
-									}
-								else
-									{
-										where_op = GDA_SQL_OPERATOR_TYPE_ISNULL;
-									}
-								break;
+	priv = GDAEX_QUERY_EDITOR_GET_PRIVATE (qe);
 
-							default:
-								g_warning (_("Where type «%d» not valid."), where_type);
-								continue;
-						}
+	if (!gdaex_query_editor_model_add_table (priv->model, table_name, table_name_visible))
+		{
+			return FALSE;
+		}
 
-					id_cond_iter = gda_sql_builder_add_cond (sqlbuilder, where_op, id_field, id_value1, id_value2);
-					if (id_cond_iter == 0)
-						{
-							g_warning (_("Unable to create GdaSqlBuilder condition."));
-							continue;
-						}
-					else
-						{
-							if (not && where_type != GDAEX_QE_WHERE_TYPE_IS_NULL)
-								{
-									id_cond_iter = gda_sql_builder_add_cond (sqlbuilder, GDA_SQL_OPERATOR_TYPE_NOT, id_cond_iter, 0, 0);
-								}
-							if (id_ret == 0)
-								{
-									id_ret = id_cond_iter;
-								}
-							else
-								{
-									id_ret = gda_sql_builder_add_cond (sqlbuilder, link_op, id_ret, id_cond_iter, 0);
-								}
-						}
-				}
-			else
-				{
-					if (gtk_tree_model_iter_children (GTK_TREE_MODEL (priv->tstore_where), &children, iter))
-						{
-							id_cond_iter = gdaex_query_editor_sql_where (qe, sqlbuilder, &children, iter, 0);
-							if (id_cond_iter != 0)
-								{
-									if (not)
-										{
-											id_cond_iter = gda_sql_builder_add_cond (sqlbuilder, GDA_SQL_OPERATOR_TYPE_NOT, id_cond_iter, 0, 0);
-										}
-									if (id_ret == 0)
-										{
-											id_ret = id_cond_iter;
-										}
-									else
-										{
-											id_ret = gda_sql_builder_add_cond (sqlbuilder, link_op, id_ret, id_cond_iter, 0);
-										}
-								}
-						}
-				}
-		} while (gtk_tree_model_iter_next (GTK_TREE_MODEL (priv->tstore_where), iter));
+	_table_name = g_strstrip (g_strdup (table_name));
+	ret = gdaex_query_editor_model_table_set_visible (priv->model, _table_name, is_visible);
+	g_free (_table_name);
 
-	return id_ret;
+	return ret;
 }
 
-GdaSqlBuilder
-*gdaex_query_editor_get_sql_as_gdasqlbuilder (GdaExQueryEditor *qe)
+/* copies the choices of the stores into the model */
+static void
+gdaex_query_editor_sync_model (GdaExQueryEditor *qe)
 {
 	GdaExQueryEditorPrivate *priv;
 
-	GdaSqlBuilder *sqlbuilder;
-
 	GtkTreeIter iter;
 
 	gchar *table_name;
 	gchar *field_name;
-	gchar *alias;
-	gchar *asc_desc;
-
-	GdaExQueryEditorTable *table;
-	GdaExQueryEditorField *field;
-
-	g_return_val_if_fail (GDAEX_IS_QUERY_EDITOR (qe), NULL);
+	gchar *str;
 
 	priv = GDAEX_QUERY_EDITOR_GET_PRIVATE (qe);
 
-	sqlbuilder = gda_sql_builder_new (GDA_SQL_STATEMENT_SELECT);
+	gdaex_query_editor_model_clean_choices (priv->model);
 
-	/* SHOW */
 	if (gtk_tree_model_get_iter_first (GTK_TREE_MODEL (priv->lstore_show), &iter))
 		{
-			guint id_target1;
-			guint id_target2;
-			guint id_join1;
-			guint id_join2;
-			guint join_cond;
-
 			do
 				{
 					gtk_tree_model_get (GTK_TREE_MODEL (priv->lstore_show), &iter,
 					                    COL_SHOW_TABLE_NAME, &table_name,
 					                    COL_SHOW_NAME, &field_name,
-					                    COL_SHOW_ALIAS, &alias,
+					                    COL_SHOW_ALIAS, &str,
 					                    -1);
 
-					table = g_hash_table_lookup (priv->tables, table_name);
-					field = g_hash_table_lookup (table->fields, field_name);
-
-					gdaex_query_editor_add_table_relation_to_gdasqlbuilder (qe, sqlbuilder, table_name);
+					gdaex_query_editor_model_add_show (priv->model, table_name, field_name, str);
 
-					if (field->decode_table2 != NULL)
-						{
-							id_target1 = gda_sql_builder_select_add_target_id (sqlbuilder,
-							                                                   gda_sql_builder_add_id (sqlbuilder, table->name),
-							                                                   NULL);
-							id_target2 = gda_sql_builder_select_add_target_id (sqlbuilder,
-							                                                   gda_sql_builder_add_id (sqlbuilder, field->decode_table2),
-							                                                   NULL);
-
-							id_join1 = gda_sql_builder_add_id (sqlbuilder, g_strconcat (field->table_name, ".", field->name, NULL));
-							id_join2 = gda_sql_builder_add_id (sqlbuilder, g_strconcat (field->decode_table2, ".", field->decode_field2, NULL));
-
-							join_cond = gda_sql_builder_add_cond (sqlbuilder, GDA_SQL_OPERATOR_TYPE_EQ,
-							                                      id_join1, id_join2, 0);
-
-							gda_sql_builder_select_join_targets (sqlbuilder, id_target1, id_target2,
-							                                     field->decode_join_type == GDAEX_QE_JOIN_TYPE_LEFT ? GDA_SQL_SELECT_JOIN_LEFT : GDA_SQL_SELECT_JOIN_INNER,
-							                                     join_cond);
-							gda_sql_builder_select_add_field (sqlbuilder, field->decode_field_to_show,
-							                                  field->decode_table2,
-							                                  alias != NULL && g_strcmp0 (alias, "") != 0 ? alias : field->decode_field_alias);
-						}
-					else
-						{
-							gda_sql_builder_select_add_field (sqlbuilder, field->name, table->name,
-							                                  alias != NULL && g_strcmp0 (alias, "") != 0 ? alias : field->alias);
-							gda_sql_builder_select_add_target_id (sqlbuilder,
-							                                      gda_sql_builder_add_id (sqlbuilder, table->name),
-							                                      NULL);
-						}
+					g_free (table_name);
+					g_free (field_name);
+					g_free (str);
 				} while (gtk_tree_model_iter_next (GTK_TREE_MODEL (priv->lstore_show), &iter));
 		}
 
-	/* WHERE */
-	if (gtk_tree_model_get_iter_first (GTK_TREE_MODEL (priv->tstore_where), &iter))
-		{
-			guint id_cond;
-
-			id_cond = gdaex_query_editor_sql_where (qe, sqlbuilder, &iter, NULL, 0);
-
-			if (id_cond != 0)
-				{
-					gda_sql_builder_set_where (sqlbuilder, id_cond);
-				}
-		}
+	gdaex_query_editor_sync_model_where (qe, NULL, NULL);
 
-	/* ORDER */
 	if (gtk_tree_model_get_iter_first (GTK_TREE_MODEL (priv->lstore_order), &iter))
 		{
 			do
@@ -2249,1040 +1946,972 @@ GdaSqlBuilder
 					gtk_tree_model_get (GTK_TREE_MODEL (priv->lstore_order), &iter,
 					                    COL_ORDER_TABLE_NAME, &table_name,
 					                    COL_ORDER_NAME, &field_name,
-					                    COL_ORDER_ORDER, &asc_desc,
+					                    COL_ORDER_ORDER, &str,
 					                    -1);
 
-					table = g_hash_table_lookup (priv->tables, table_name);
-					field = g_hash_table_lookup (table->fields, field_name);
-
-					gdaex_query_editor_add_table_relation_to_gdasqlbuilder (qe, sqlbuilder, table_name);
+					gdaex_query_editor_model_add_order (priv->model, table_name, field_name,
+					                                    g_strcmp0 (str, "ASC") == 0 ? GDAEX_QE_ORDER_ASC : GDAEX_QE_ORDER_DESC);
 
-					gda_sql_builder_select_order_by (sqlbuilder,
-					                                 gda_sql_builder_add_id (sqlbuilder, field->name),
-					                                 (g_strcmp0 (asc_desc, "ASC") == 0),
-					                                 NULL);
+					g_free (table_name);
+					g_free (field_name);
+					g_free (str);
 				} while (gtk_tree_model_iter_next (GTK_TREE_MODEL (priv->lstore_order), &iter));
 		}
-
-	return sqlbuilder;
 }
 
-const gchar
-*gdaex_query_editor_get_sql (GdaExQueryEditor *qe)
+static void
+gdaex_query_editor_sync_model_where (GdaExQueryEditor *qe,
+                                     GtkTreeIter *iter_parent,
+                                     GNode *parent)
 {
-	const gchar *ret;
-
 	GdaExQueryEditorPrivate *priv;
 
-	GdaSqlBuilder *sqlbuilder;
-	GdaStatement *stmt;
-	GError *error;
-
-	ret = NULL;
-
-	sqlbuilder = gdaex_query_editor_get_sql_as_gdasqlbuilder (qe);
-	if (sqlbuilder == NULL)
-		{
-			return ret;
-		}
+	GtkTreeIter iter;
+	GdaExQueryEditorWhereChoice choice;
+	GNode *node;
 
 	priv = GDAEX_QUERY_EDITOR_GET_PRIVATE (qe);
 
-	error = NULL;
-	stmt = gda_sql_builder_get_statement (sqlbuilder, &error);
-	if (stmt == NULL || error != NULL)
+	if (!gtk_tree_model_iter_children (GTK_TREE_MODEL (priv->tstore_where), &iter, iter_parent))
 		{
-			g_object_unref (sqlbuilder);
-			g_warning (_("Unable to create GdaStatement: %s."),
-			           error != NULL && error->message != NULL ? error->message : _("no details"));
-			return NULL;
+			return;
 		}
 
-	error = NULL;
-	ret = gda_statement_to_sql_extended (stmt,
-	                                     (GdaConnection *)gdaex_get_gdaconnection (priv->gdaex),
-	                                     NULL, 0, NULL, &error);
-	if (error != NULL)
+	do
 		{
-			ret = NULL;
-			g_warning (_("Unable to create sql: %s."),
-			           error->message != NULL ? error->message : _("no details"));
-		}
-
-	g_object_unref (sqlbuilder);
-
-	return ret;
-}
-
-const gchar
-*gdaex_query_editor_get_sql_select (GdaExQueryEditor *qe)
-{
-	gchar *ret;
-	const gchar *sql;
-
-	gchar *start;
-	gchar *end;
-
-	ret = NULL;
-
-	sql = gdaex_query_editor_get_sql (qe);
-	if (sql == NULL)
-		{
-			return ret;
-		}
+			memset (&choice, 0, sizeof (GdaExQueryEditorWhereChoice));
 
-	start = g_strstr_len (sql, -1, "SELECT");
-	if (start == NULL)
-		{
-			return ret;
-		}
+			gtk_tree_model_get (GTK_TREE_MODEL (priv->tstore_where), &iter,
+			                    COL_WHERE_LINK_TYPE, &choice.link_type,
+			                    COL_WHERE_TABLE_NAME, &choice.table_name,
+			                    COL_WHERE_NAME, &choice.field_name,
+			                    COL_WHERE_CONDITION_NOT, &choice.not,
+			                    COL_WHERE_CONDITION_TYPE, &choice.where_type,
+			                    COL_WHERE_CONDITION_FROM, &choice.from,
+			                    COL_WHERE_CONDITION_FROM_VISIBLE, &choice.from_visible,
+			                    COL_WHERE_CONDITION_FROM_SQL, &choice.from_sql,
+			                    COL_WHERE_CONDITION_TO, &choice.to,
+			                    COL_WHERE_CONDITION_TO_VISIBLE, &choice.to_visible,
+			                    COL_WHERE_CONDITION_TO_SQL, &choice.to_sql,
+			                    -1);
 
-	end = g_strstr_len (sql, -1, "FROM");
-	if (end == NULL)
-		{
-			return ret;
-		}
+			choice.is_group = (g_strcmp0 (choice.table_name, GROUP) == 0);
 
-	ret = g_strndup (start + 7, strlen (sql) - 8 - strlen (end));
+			node = gdaex_query_editor_model_add_where (priv->model, parent, &choice);
+			if (node != NULL && choice.is_group)
+				{
+					gdaex_query_editor_sync_model_where (qe, &iter, node);
+				}
 
-	return ret;
+			g_free (choice.table_name);
+			g_free (choice.field_name);
+			g_free (choice.from);
+			g_free (choice.from_visible);
+			g_free (choice.from_sql);
+			g_free (choice.to);
+			g_free (choice.to_visible);
+			g_free (choice.to_sql);
+		} while (gtk_tree_model_iter_next (GTK_TREE_MODEL (priv->tstore_where), &iter));
 }
 
-const gchar
-*gdaex_query_editor_get_sql_from (GdaExQueryEditor *qe)
+/* refills the stores with the choices of the model */
+static void
+gdaex_query_editor_fill_stores (GdaExQueryEditor *qe)
 {
-	gchar *ret;
-	const gchar *sql;
-
-	gchar *start;
-	gchar *end;
+	GdaExQueryEditorPrivate *priv;
 
-	ret = NULL;
+	GtkTreeIter iter;
 
-	sql = gdaex_query_editor_get_sql (qe);
-	if (sql == NULL)
-		{
-			return ret;
-		}
+	GPtrArray *choices;
+	GdaExQueryEditorShowChoice *show;
+	GdaExQueryEditorOrderChoice *order;
+	const GdaExQueryEditorTable *table;
+	const GdaExQueryEditorField *field;
 
-	start = g_strstr_len (sql, -1, "FROM");
-	if (start == NULL)
-		{
-			return ret;
-		}
-
-	end = g_strstr_len (sql, -1, "WHERE");
-	if (end == NULL)
-		{
-			end = g_strstr_len (sql, -1, "ORDER BY");
-		}
+	gchar *name_visible;
+	guint i;
 
-	ret = g_strndup (start + 5, strlen (start) - (end != NULL ? 6 : 5) - (end != NULL ? strlen (end) : 0));
+	priv = GDAEX_QUERY_EDITOR_GET_PRIVATE (qe);
 
-	return ret;
-}
+	gtk_list_store_clear (priv->lstore_show);
+	gtk_tree_store_clear (priv->tstore_where);
+	gtk_list_store_clear (priv->lstore_order);
 
-const gchar
-*gdaex_query_editor_get_sql_where (GdaExQueryEditor *qe)
-{
-	gchar *ret;
-	const gchar *sql;
+	choices = gdaex_query_editor_model_get_show (priv->model);
+	for (i = 0; i < choices->len; i++)
+		{
+			show = (GdaExQueryEditorShowChoice *)g_ptr_array_index (choices, i);
 
-	gchar *start;
-	gchar *end;
+			table = gdaex_query_editor_model_get_table (priv->model, show->table_name);
+			field = g_hash_table_lookup (table->fields, show->field_name);
 
-	ret = NULL;
+			name_visible = g_strconcat (table->name_visible, " - ", field->name_visible, NULL);
 
-	sql = gdaex_query_editor_get_sql (qe);
-	if (sql == NULL)
-		{
-			return ret;
-		}
+			gtk_list_store_append (priv->lstore_show, &iter);
+			gtk_list_store_set (priv->lstore_show, &iter,
+			                    COL_SHOW_TABLE_NAME, show->table_name,
+			                    COL_SHOW_NAME, show->field_name,
+			                    COL_SHOW_VISIBLE_NAME, name_visible,
+			                    COL_SHOW_ALIAS, show->alias,
+			                    -1);
+			gdaex_query_editor_choices_add (&priv->choices_show, &iter, show->table_name, show->field_name);
 
-	start = g_strstr_len (sql, -1, "WHERE");
-	if (start == NULL)
-		{
-			return ret;
+			g_free (name_visible);
 		}
 
-	end = g_strstr_len (sql, -1, "ORDER BY");
-
-	ret = g_strndup (start + 6, strlen (start) - (end != NULL ? 7 : 6) - (end != NULL ? strlen (end) : 0));
-
-	return ret;
-}
+	gdaex_query_editor_fill_stores_where (qe, gdaex_query_editor_model_get_where (priv->model), NULL);
+	gtk_tree_view_expand_all (GTK_TREE_VIEW (priv->trv_where));
 
-const gchar
-*gdaex_query_editor_get_sql_order (GdaExQueryEditor *qe)
-{
-	gchar *ret;
-	const gchar *sql;
+	choices = gdaex_query_editor_model_get_order (priv->model);
+	for (i = 0; i < choices->len; i++)
+		{
+			order = (GdaExQueryEditorOrderChoice *)g_ptr_array_index (choices, i);
 
-	gchar *start;
+			table = gdaex_query_editor_model_get_table (priv->model, order->table_name);
+			field = g_hash_table_lookup (table->fields, order->field_name);
 
-	ret = NULL;
+			name_visible = g_strconcat (table->name_visible, " - ", field->name_visible, NULL);
 
-	sql = gdaex_query_editor_get_sql (qe);
-	if (sql == NULL)
-		{
-			return ret;
-		}
+			gtk_list_store_append (priv->lstore_order, &iter);
+			gtk_list_store_set (priv->lstore_order, &iter,
+			                    COL_ORDER_TABLE_NAME, order->table_name,
+			                    COL_ORDER_NAME, order->field_name,
+			                    COL_ORDER_VISIBLE_NAME, name_visible,
+			                    COL_ORDER_ORDER, order->order == GDAEX_QE_ORDER_ASC ? "ASC" : "DESC",
+			                    COL_ORDER_ORDER_VISIBLE, order->order == GDAEX_QE_ORDER_ASC ? _("Ascending") : _("Descending"),
+			                    -1);
+			gdaex_query_editor_choices_add (&priv->choices_order, &iter, order->table_name, order->field_name);
 
-	start = g_strstr_len (sql, -1, "ORDER BY");
-	if (start == NULL)
-		{
-			return ret;
+			g_free (name_visible);
 		}
-
-	ret = g_strndup (start + 9, strlen (start) - 9);
-
-	return ret;
 }
 
 static void
-gdaex_query_editor_xml_where (GdaExQueryEditor *qe,
-                              GtkTreeIter *iter,
-                              GtkTreeIter *iter_parent,
-                              xmlNode *xnode_parent)
+gdaex_query_editor_fill_stores_where (GdaExQueryEditor *qe,
+                                      GNode *node,
+                                      GtkTreeIter *iter_parent)
 {
 	GdaExQueryEditorPrivate *priv;
 
-	gchar *table_name;
-	gchar *field_name;
-
-	GdaExQueryEditorTable *table;
-	GdaExQueryEditorField *field;
-
-	GtkTreePath *path;
-	gint *indices;
-
-	gboolean is_group;
+	GtkTreeIter iter;
 
-	gboolean not;
-	guint link_type;
-	guint where_type;
-	gchar *from_str;
-	gchar *to_str;
-	gchar *str_link;
-	gchar *str_op;
+	GNode *child;
+	GdaExQueryEditorWhereChoice *choice;
+	const GdaExQueryEditorTable *table;
+	const GdaExQueryEditorField *field;
 
-	xmlNode *xnode;
-	GtkTreeIter children;
+	gchar *link_type_visible;
+	gchar *where_type_visible;
+	gchar *name_visible;
 
 	priv = GDAEX_QUERY_EDITOR_GET_PRIVATE (qe);
 
-	do
+	for (child = node->children; child != NULL; child = child->next)
 		{
-			gtk_tree_model_get (GTK_TREE_MODEL (priv->tstore_where), iter,
-			                    COL_WHERE_LINK_TYPE, &link_type,
-			                    COL_WHERE_TABLE_NAME, &table_name,
-			                    COL_WHERE_NAME, &field_name,
-			                    COL_WHERE_CONDITION_NOT, &not,
-			                    COL_WHERE_CONDITION_TYPE, &where_type,
-			                    COL_WHERE_CONDITION_FROM_SQL, &from_str,
-			                    COL_WHERE_CONDITION_TO_SQL, &to_str,
-			                    -1);
+			choice = (GdaExQueryEditorWhereChoice *)child->data;
 
-			is_group = (g_strcmp0 (table_name, GROUP) == 0);
+			link_type_visible = gdaex_query_editor_get_link_type_str_from_type (choice->link_type);
 
-			switch (link_type)
+			gtk_tree_store_append (priv->tstore_where, &iter, iter_parent);
+			if (choice->is_group)
 				{
-					case GDAEX_QE_LINK_TYPE_AND:
-						str_link = g_strdup ("AND");
-						break;
-
-					case GDAEX_QE_LINK_TYPE_OR:
-						str_link = g_strdup ("OR");
-						break;
+					gtk_tree_store_set (priv->tstore_where, &iter,
+					                    COL_WHERE_LINK_TYPE, choice->link_type,
+					                    COL_WHERE_LINK_TYPE_VISIBLE, link_type_visible,
+					                    COL_WHERE_TABLE_NAME, GROUP,
+					                    COL_WHERE_NAME, GROUP,
+					                    COL_WHERE_VISIBLE_NAME, "(...)",
+					                    COL_WHERE_CONDITION_NOT, choice->not,
+					                    -1);
 
-					default:
-						path = gtk_tree_model_get_path (GTK_TREE_MODEL (priv->tstore_where), iter);
-						indices = gtk_tree_path_get_indices (path);
-						if (indices[gtk_tree_path_get_depth (path) - 1] != 0)
-							{
-								g_warning (_("Link type «%d» not valid."), link_type);
-								continue;
-							}
-						else
-							{
-								str_link = g_strdup ("");
-								break;
-							}
+					gdaex_query_editor_fill_stores_where (qe, child, &iter);
 				}
-
-			if (!is_group)
+			else
 				{
-					switch (where_type)
-						{
-							case GDAEX_QE_WHERE_TYPE_EQUAL:
-								str_op = g_strdup ("EQUAL");
-								break;
-
-							case GDAEX_QE_WHERE_TYPE_STARTS:
-								str_op = g_strdup ("STARTS");
-								break;
-
-							case GDAEX_QE_WHERE_TYPE_CONTAINS:
-								str_op = g_strdup ("CONTAINS");
-								break;
-
-							case GDAEX_QE_WHERE_TYPE_ENDS:
-								str_op = g_strdup ("ENDS");
-								break;
+					table = gdaex_query_editor_model_get_table (priv->model, choice->table_name);
+					field = g_hash_table_lookup (table->fields, choice->field_name);
+
+					name_visible = g_strconcat (table->name_visible, " - ", field->name_visible, NULL);
+					where_type_visible = gdaex_query_editor_get_where_type_str_from_type (choice->where_type);
+
+					gtk_tree_store_set (priv->tstore_where, &iter,
+					                    COL_WHERE_LINK_TYPE, choice->link_type,
+					                    COL_WHERE_LINK_TYPE_VISIBLE, link_type_visible,
+					                    COL_WHERE_TABLE_NAME, choice->table_name,
+					                    COL_WHERE_NAME, choice->field_name,
+					                    COL_WHERE_VISIBLE_NAME, name_visible,
+					                    COL_WHERE_CONDITION_NOT, choice->not,
+					                    COL_WHERE_CONDITION_TYPE, choice->where_type,
+					                    COL_WHERE_CONDITION_TYPE_VISIBLE, where_type_visible,
+					                    COL_WHERE_CONDITION_FROM, choice->from,
+					                    COL_WHERE_CONDITION_FROM_VISIBLE, choice->from_visible,
+					                    COL_WHERE_CONDITION_FROM_SQL, choice->from_sql,
+					                    COL_WHERE_CONDITION_TO, choice->to,
+					                    COL_WHERE_CONDITION_TO_VISIBLE, choice->to_visible,
+					                    COL_WHERE_CONDITION_TO_SQL, choice->to_sql,
+					                    -1);
 
-							case GDAEX_QE_WHERE_TYPE_ISTARTS:
-								str_op = g_strdup ("ISTARTS");
-								break;
+					g_free (name_visible);
+					g_free (where_type_visible);
+				}
 
-							case GDAEX_QE_WHERE_TYPE_ICONTAINS:
-								str_op = g_strdup ("ICONTAINS");
-								break;
+			g_free (link_type_visible);
+		}
+}
 
-							case GDAEX_QE_WHERE_TYPE_IENDS:
-								str_op = g_strdup ("IENDS");
-								break;
+static gchar
+*gdaex_query_editor_field_key (const gchar *table_name, const gchar *field_name)
+{
+	return g_strdup_printf ("%s.%s", table_name, field_name);
+}
 
-							case GDAEX_QE_WHERE_TYPE_GREAT:
-								str_op = g_strdup ("GREAT");
-								break;
+static void
+gdaex_query_editor_choices_add (GdaExQueryEditorChoices *choices,
+                                GtkTreeIter *iter,
+                                const gchar *table_name,
+                                const gchar *field_name)
+{
+	g_hash_table_replace (choices->ht,
+	                      gdaex_query_editor_field_key (table_name, field_name),
+	                      gtk_tree_iter_copy (iter));
+}
 
-							case GDAEX_QE_WHERE_TYPE_GREAT_EQUAL:
-								str_op = g_strdup ("GREAT_EQUAL");
-								break;
+/* whether the show or order choices have the field */
+static gboolean
+gdaex_query_editor_choices_has (GdaExQueryEditorChoices *choices,
+                                const gchar *table_name,
+                                const gchar *field_name)
+{
+	gboolean ret;
 
-							case GDAEX_QE_WHERE_TYPE_LESS:
-								str_op = g_strdup ("LESS");
-								break;
+	GtkTreeIter iter;
+	gchar *key;
+	gchar *row_table_name;
+	gchar *row_field_name;
 
-							case GDAEX_QE_WHERE_TYPE_LESS_EQUAL:
-								str_op = g_strdup ("LESS_EQUAL");
-								break;
+	if (choices->stale)
+		{
+			/* the table name and the field name are the first two
+			 * columns of both the stores */
+			g_hash_table_remove_all (choices->ht);
+			if (gtk_tree_model_get_iter_first (choices->store, &iter))
+				{
+					do
+						{
+							gtk_tree_model_get (choices->store, &iter,
+							                    0, &row_table_name,
+							                    1, &row_field_name,
+							                    -1);
+							if (row_table_name != NULL && row_field_name != NULL)
+								{
+									gdaex_query_editor_choices_add (choices, &iter, row_table_name, row_field_name);
+								}
+							g_free (row_table_name);
+							g_free (row_field_name);
+						} while (gtk_tree_model_iter_next (choices->store, &iter));
+				}
+			choices->stale = FALSE;
+		}
 
-							case GDAEX_QE_WHERE_TYPE_BETWEEN:
-								str_op = g_strdup ("BETWEEN");
-								break;
+	key = gdaex_query_editor_field_key (table_name, field_name);
+	ret = g_hash_table_contains (choices->ht, key);
+	g_free (key);
 
-							case GDAEX_QE_WHERE_TYPE_IS_NULL:
-								str_op = g_strdup ("IS_NULL");
-								break;
+	return ret;
+}
 
-							default:
-								g_warning (_("Where type «%d» not valid."), where_type);
-								continue;
-						}
+static gboolean
+gdaex_query_editor_fields_get_row (GdaExQueryEditor *qe,
+                                   const gchar *key,
+                                   GtkTreeIter *iter)
+{
+	GdaExQueryEditorPrivate *priv;
 
-					xnode = xmlNewNode (NULL, "field");
+	GtkTreeIter *row;
 
-					xmlAddChild (xnode_parent, xnode);
+	priv = GDAEX_QUERY_EDITOR_GET_PRIVATE (qe);
 
-					xmlNewProp (xnode, "table", table_name);
-					xmlNewProp (xnode, "field", field_name);
-					xmlNewProp (xnode, "link_type", str_link);
-					xmlNewProp (xnode, "not", (not ? "y" : "n"));
-					xmlNewProp (xnode, "where_type", str_op);
-					xmlNewProp (xnode, "from", from_str);
-					xmlNewProp (xnode, "to", to_str);
+	/* the rows of the fields tree are removed only together with their key */
+	row = g_hash_table_lookup (priv->ht_fields_rows, key);
+	if (row == NULL)
+		{
+			return FALSE;
+		}
 
-					g_free (str_op);
-				}
-			else
-				{
-					if (gtk_tree_model_iter_children (GTK_TREE_MODEL (priv->tstore_where), &children, iter))
-						{
-							xnode = xmlNewNode (NULL, "group");
+	*iter = *row;
 
-							xmlAddChild (xnode_parent, xnode);
+	return TRUE;
+}
 
-							xmlNewProp (xnode, "not", (not ? "y" : "n"));
+static void
+gdaex_query_editor_fields_set_row (GdaExQueryEditor *qe,
+                                   const gchar *key,
+                                   GtkTreeIter *iter)
+{
+	GdaExQueryEditorPrivate *priv;
 
-							gdaex_query_editor_xml_where (qe, &children, iter, xnode);
-						}
-				}
+	priv = GDAEX_QUERY_EDITOR_GET_PRIVATE (qe);
 
-			g_free (str_link);
-		} while (gtk_tree_model_iter_next (GTK_TREE_MODEL (priv->tstore_where), iter));
+	g_hash_table_replace (priv->ht_fields_rows,
+	                      g_strdup (key),
+	                      gtk_tree_iter_copy (iter));
 }
 
-xmlNode
-*gdaex_query_editor_get_sql_as_xml (GdaExQueryEditor *qe)
+/* adds, or removes, the row of field in the fields tree, without touching
+ * the other rows */
+static void
+gdaex_query_editor_fields_sync_field (GdaExQueryEditor *qe,
+                                      const GdaExQueryEditorTable *table,
+                                      const GdaExQueryEditorField *field)
 {
 	GdaExQueryEditorPrivate *priv;
 
-	xmlNode *ret;
-
+	GtkTreeIter iter_table;
 	GtkTreeIter iter;
+	GtkTreePath *path;
 
-	gchar *table_name;
-	gchar *field_name;
-
-	GdaExQueryEditorTable *table;
-	GdaExQueryEditorField *field;
-
-	xmlNode *node;
-
-	ret = NULL;
-
-	g_return_val_if_fail (GDAEX_IS_QUERY_EDITOR (qe), NULL);
+	gchar *key;
+	gboolean wanted;
+	gboolean new_table;
 
 	priv = GDAEX_QUERY_EDITOR_GET_PRIVATE (qe);
 
-	ret = xmlNewNode (NULL, "gdaex_query_editor_choices");
-
-	/* SHOW */
-	if (gtk_tree_model_get_iter_first (GTK_TREE_MODEL (priv->lstore_show), &iter))
-		{
-			gchar *alias;
-			xmlNode *node_show;
+	key = gdaex_query_editor_field_key (table->name, field->name);
 
-			node_show = xmlNewNode (NULL, "show");
-			xmlAddChild (ret, node_show);
+	wanted = (table->visible
+	          && (field->for_show || field->for_where || field->for_order)
+	          && (priv->fields_filter == NULL || g_hash_table_contains (priv->fields_filter, key)));
 
-			do
+	if (gdaex_query_editor_fields_get_row (qe, key, &iter))
+		{
+			if (!wanted)
 				{
-					gtk_tree_model_get (GTK_TREE_MODEL (priv->lstore_show), &iter,
-					                    COL_SHOW_TABLE_NAME, &table_name,
-					                    COL_SHOW_NAME, &field_name,
-					                    COL_SHOW_ALIAS, &alias,
-					                    -1);
-
-					table = g_hash_table_lookup (priv->tables, table_name);
-					field = g_hash_table_lookup (table->fields, field_name);
+					gtk_tree_model_iter_parent (GTK_TREE_MODEL (priv->tstore_fields), &iter_table, &iter);
+					gtk_tree_store_remove (priv->tstore_fields, &iter);
+					g_hash_table_remove (priv->ht_fields_rows, key);
 
-					node = xmlNewNode (NULL, "field");
-					xmlAddChild (node_show, node);
-					xmlNewProp (node, "table", table_name);
-					xmlNewProp (node, "field", field_name);
-					if (alias != NULL && g_strcmp0 (alias, "") != 0)
-						{
-							xmlNewProp (node, "alias", alias);
-						}
-					else
+					/* if no fields, remove table */
+					if (!gtk_tree_model_iter_has_child (GTK_TREE_MODEL (priv->tstore_fields), &iter_table))
 						{
-							xmlNewProp (node, "alias", field->alias);
+							gtk_tree_store_remove (priv->tstore_fields, &iter_table);
+							g_hash_table_remove (priv->ht_fields_rows, table->name);
 						}
-				} while (gtk_tree_model_iter_next (GTK_TREE_MODEL (priv->lstore_show), &iter));
+				}
 		}
-
-	/* WHERE */
-	if (gtk_tree_model_get_iter_first (GTK_TREE_MODEL (priv->tstore_where), &iter))
+	else if (wanted)
 		{
-			xmlNode *node_where;
+			new_table = !gdaex_query_editor_fields_get_row (qe, table->name, &iter_table);
+			if (new_table)
+				{
+					gtk_tree_store_append (priv->tstore_fields, &iter_table, NULL);
+					gtk_tree_store_set (priv->tstore_fields, &iter_table,
+					                    COL_FIELDS_NAME, table->name,
+					                    COL_FIELDS_VISIBLE_NAME, table->name_visible,
+					                    -1);
+					gdaex_query_editor_fields_set_row (qe, table->name, &iter_table);
+				}
 
-			node_where = xmlNewNode (NULL, "where");
-			xmlAddChild (ret, node_where);
+			gtk_tree_store_append (priv->tstore_fields, &iter, &iter_table);
+			gtk_tree_store_set (priv->tstore_fields, &iter,
+			                    COL_FIELDS_TABLE_NAME, table->name,
+			                    COL_FIELDS_NAME, field->name,
+			                    COL_FIELDS_VISIBLE_NAME, field->name_visible,
+			                    COL_FIELDS_DESCRIPTION, field->description,
+			                    -1);
+			gdaex_query_editor_fields_set_row (qe, key, &iter);
 
-			gdaex_query_editor_xml_where (qe, &iter, NULL, node_where);
+			if (new_table)
+				{
+					path = gtk_tree_model_get_path (GTK_TREE_MODEL (priv->tstore_fields), &iter_table);
+					gtk_tree_view_expand_row (GTK_TREE_VIEW (priv->trv_fields), path, FALSE);
+					gtk_tree_path_free (path);
+				}
 		}
 
-	/* ORDER */
-	if (gtk_tree_model_get_iter_first (GTK_TREE_MODEL (priv->lstore_order), &iter))
-		{
-			gchar *asc_desc;
-			xmlNode *node_order;
-
-			node_order = xmlNewNode (NULL, "order");
-			xmlAddChild (ret, node_order);
+	g_free (key);
 
-			do
-				{
-					gtk_tree_model_get (GTK_TREE_MODEL (priv->lstore_order), &iter,
-					                    COL_ORDER_TABLE_NAME, &table_name,
-					                    COL_ORDER_NAME, &field_name,
-					                    COL_ORDER_ORDER, &asc_desc,
-					                    -1);
-
-					node = xmlNewNode (NULL, "field");
-					xmlAddChild (node_order, node);
-					xmlNewProp (node, "table", table_name);
-					xmlNewProp (node, "field", field_name);
-					xmlNewProp (node, "asc_desc", asc_desc);
-				} while (gtk_tree_model_iter_next (GTK_TREE_MODEL (priv->lstore_order), &iter));
+	if (table->visible
+	    && field->for_show && field->always_showed
+	    && !gdaex_query_editor_choices_has (&priv->choices_show, table->name, field->name))
+		{
+			gdaex_query_editor_show_add (qe, table->name, field->name);
+		}
+	if (table->visible
+	    && field->for_order && field->always_ordered
+	    && !gdaex_query_editor_choices_has (&priv->choices_order, table->name, field->name))
+		{
+			gdaex_query_editor_order_add (qe, table->name, field->name);
 		}
-
-	return ret;
 }
 
-void
-gdaex_query_editor_load_choices_from_xml (GdaExQueryEditor *qe, xmlNode *root,
-                                          gboolean clean)
+/* brings the fields tree in line with the tables of the model and the
+ * filter: only the missing rows are added and the unwanted ones removed */
+static void
+gdaex_query_editor_refresh_gui (GdaExQueryEditor *qe)
 {
 	GdaExQueryEditorPrivate *priv;
 
-	GtkTreeIter iter;
-
-	gchar *table_name;
-	gchar *field_name;
-	gchar *name_visible;
-	gchar *alias;
-	GValue *v_table_field;
-
-	GdaExQueryEditorTable *table;
-	GdaExQueryEditorField *field;
-
-	xmlNode *node;
-	xmlNode *node_field;
+	GHashTableIter hiter_table;
+	GHashTableIter hiter_field;
+	gpointer key, value;
+	const GdaExQueryEditorTable *table;
 
 	g_return_if_fail (GDAEX_IS_QUERY_EDITOR (qe));
 
-	g_return_if_fail (xmlStrEqual (root->name, "gdaex_query_editor_choices"));
-
 	priv = GDAEX_QUERY_EDITOR_GET_PRIVATE (qe);
 
-	if (clean)
+	g_hash_table_iter_init (&hiter_table, gdaex_query_editor_model_get_tables (priv->model));
+	while (g_hash_table_iter_next (&hiter_table, &key, &value))
 		{
-			gdaex_query_editor_clean_choices (qe);
-		}
-
-	node = root->children;
-	while (node != NULL)
-	{
-		if (xmlStrEqual (node->name, "show")
-		    || xmlStrEqual (node->name, "where")
-		    || xmlStrEqual (node->name, "order"))
-			{
-				node_field = node->children;
-				while (node_field != NULL)
-					{
-						if (xmlStrEqual (node_field->name, "field"))
-							{
-								table_name = xmlGetProp (node_field, "table");
-								table = g_hash_table_lookup (priv->tables, table_name);
-								if (table == NULL)
-									{
-										g_warning (_("Table «%s» not found."), table_name);
-										continue;
-									}
-
-								field_name = xmlGetProp (node_field, "field");
-								field = g_hash_table_lookup (table->fields, field_name);
-								if (field == NULL)
-									{
-										g_warning (_("Field «%s» not found in table «%s»."), field_name, table_name);
-										continue;
-									}
-
-								name_visible = g_strconcat (table->name_visible, " - ", field->name_visible, NULL);
-								v_table_field = gda_value_new (G_TYPE_STRING);
-								g_value_set_string (v_table_field, name_visible);
-
-								if (xmlStrEqual (node->name, "show"))
-									{
-										if (!gdaex_query_editor_model_has_value (GTK_TREE_MODEL (priv->lstore_show), COL_SHOW_VISIBLE_NAME, v_table_field))
-											{
-												alias = xmlGetProp (node_field, "alias");
-												if (alias == NULL)
-													{
-														alias = g_strdup ("");
-													}
-
-												gtk_list_store_append (priv->lstore_show, &iter);
-												gtk_list_store_set (priv->lstore_show, &iter,
-												                    COL_SHOW_TABLE_NAME, field->table_name,
-												                    COL_SHOW_NAME, field_name,
-												                    COL_SHOW_VISIBLE_NAME, name_visible,
-												                    COL_SHOW_ALIAS, alias,
-												                    -1);
-											}
-									}
-								else if (xmlStrEqual (node->name, "where"))
-									{
-										gchar *link;
-										gchar *not;
-										gchar *condition;
-										gchar *from;
-										gchar *to;
-										gchar *from_sql;
-										gchar *to_sql;
-										gchar *from_visible;
-										gchar *to_visible;
-
-										GdaExQueryEditorLinkType link_type;
-										GdaExQueryEditorWhereType where_type;
-
-										link = xmlGetProp (node_field, "link_type");
-										not = xmlGetProp (node_field, "not");
-										condition = xmlGetProp (node_field, "where_type");
-
-										from_sql = xmlGetProp (node_field, "from");
-										to_sql = xmlGetProp (node_field, "to");
-										from_visible = xmlGetProp (node_field, "from_visible");
-										to_visible = xmlGetProp (node_field, "to_visible");
-
-
-										if (field->type == GDAEX_QE_FIELD_TYPE_DATE)
-											{
-												GDate *gdate = gdaex_query_editor_get_gdate_from_sql (from_sql);
-												from = g_strdup_printf ("%02d/%02d/%04d",
-												                        g_date_get_day (gdate),
-												                        g_date_get_month (gdate),
-												                        g_date_get_year (gdate));
-
-												gdate = gdaex_query_editor_get_gdate_from_sql (to_sql);
-												to = g_strdup_printf ("%02d/%02d/%04d",
-												                      g_date_get_day (gdate),
-												                      g_date_get_month (gdate),
-												                      g_date_get_year (gdate));
-											}
-										else if (field->type = GDAEX_QE_FIELD_TYPE_DATETIME)
-											{
-												GdaTimestamp *gdate = gdaex_query_editor_get_gdatimestamp_from_sql (from_sql);
-												from = g_strdup_printf ("%02d/%02d/%04d %02d.%02d.%02d",
-												                        gdate->day,
-												                        gdate->month,
-												                        gdate->year,
-												                        gdate->hour,
-												                        gdate->minute,
-												                        gdate->second);
-
-												gdate = gdaex_query_editor_get_gdatimestamp_from_sql (to_sql);
-												to = g_strdup_printf ("%02d/%02d/%04d %02d.%02d.%02d",
-												                      gdate->day,
-												                      gdate->month,
-												                      gdate->year,
-												                      gdate->hour,
-												                      gdate->minute,
-												                      gdate->second);
-											}
-										else if (field->type = GDAEX_QE_FIELD_TYPE_TIME)
-											{
-												/* TODO */
-											}
-										else
-											{
-												from = xmlGetProp (node_field, "from");
-												to = xmlGetProp (node_field, "to");
-											}
-
-										link_type = 0;
-										if (g_strcmp0 (link, "AND") == 0)
-											{
-												link_type = GDAEX_QE_LINK_TYPE_AND;
-											}
-										else if (g_strcmp0 (link, "OR") == 0)
-											{
-												link_type = GDAEX_QE_LINK_TYPE_OR;
-											}
-
-										if (g_strcmp0 (condition, "EQUAL") == 0)
-											{
-												where_type = GDAEX_QE_WHERE_TYPE_EQUAL;
-											}
-										else if (g_strcmp0 (condition, "STARTS") == 0)
-											{
-												where_type = GDAEX_QE_WHERE_TYPE_STARTS;
-											}
-										else if (g_strcmp0 (condition, "CONTAINS") == 0)
-											{
-												where_type = GDAEX_QE_WHERE_TYPE_CONTAINS;
-											}
-										else if (g_strcmp0 (condition, "ENDS") == 0)
-											{
-												where_type = GDAEX_QE_WHERE_TYPE_ENDS;
-											}
-										else if (g_strcmp0 (condition, "ISTARTS") == 0)
-											{
-												where_type = GDAEX_QE_WHERE_TYPE_ISTARTS;
-											}
-										else if (g_strcmp0 (condition, "ICONTAINS") == 0)
-											{
-												where_type = GDAEX_QE_WHERE_TYPE_ICONTAINS;
-											}
-										else if (g_strcmp0 (condition, "IENDS") == 0)
-											{
-												where_type = GDAEX_QE_WHERE_TYPE_IENDS;
-											}
-										else if (g_strcmp0 (condition, "GREAT") == 0)
-											{
-												where_type = GDAEX_QE_WHERE_TYPE_GREAT;
-											}
-										else if (g_strcmp0 (condition, "GREAT_EQUAL") == 0)
-											{
-												where_type = GDAEX_QE_WHERE_TYPE_GREAT_EQUAL;
-											}
-										else if (g_strcmp0 (condition, "LESS") == 0)
-											{
-												where_type = GDAEX_QE_WHERE_TYPE_LESS;
-											}
-										else if (g_strcmp0 (condition, "LESS_EQUAL") == 0)
-											{
-												where_type = GDAEX_QE_WHERE_TYPE_LESS_EQUAL;
-											}
-										else if (g_strcmp0 (condition, "BETWEEN") == 0)
-											{
-												where_type = GDAEX_QE_WHERE_TYPE_BETWEEN;
-											}
-										else if (g_strcmp0 (condition, "IS_NULL") == 0)
-											{
-												where_type = GDAEX_QE_WHERE_TYPE_IS_NULL;
-											}
-
-										if (where_type != 0)
-											{
-												gtk_tree_store_append (priv->tstore_where, &iter, NULL);
-												gtk_tree_store_set (priv->tstore_where, &iter,
-												                    COL_WHERE_LINK_TYPE, link_type,
-												                    COL_WHERE_LINK_TYPE_VISIBLE, gdaex_query_editor_get_link_type_str_from_type (link_type),
-												                    COL_WHERE_TABLE_NAME, table_name,
-												                    COL_WHERE_NAME, field_name,
-												                    COL_WHERE_VISIBLE_NAME, name_visible,
-												                    COL_WHERE_CONDITION_NOT, (g_strcmp0 (not, "n") != 0),
-												                    COL_WHERE_CONDITION_TYPE, where_type,
-												                    COL_WHERE_CONDITION_TYPE_VISIBLE, gdaex_query_editor_get_where_type_str_from_type (where_type),
-												                    COL_WHERE_CONDITION_FROM_VISIBLE, from_visible,
-												                    COL_WHERE_CONDITION_FROM, from,
-												                    COL_WHERE_CONDITION_FROM_SQL, from_sql,
-												                    COL_WHERE_CONDITION_TO_VISIBLE, (where_type == GDAEX_QE_WHERE_TYPE_BETWEEN ? to_visible : ""),
-												                    COL_WHERE_CONDITION_TO, (where_type == GDAEX_QE_WHERE_TYPE_BETWEEN ? to : ""),
-												                    COL_WHERE_CONDITION_TO_SQL, (where_type == GDAEX_QE_WHERE_TYPE_BETWEEN ? to_sql : ""),
-												                    -1);
-											}
-
-										g_free (from);
-										g_free (to);
-										g_free (from_sql);
-										g_free (to_sql);
-										g_free (from_visible);
-										g_free (to_visible);
-										g_free (link);
-										g_free (not);
-										g_free (condition);
-									}
-								else if (xmlStrEqual (node->name, "order"))
-									{
-										if (!gdaex_query_editor_model_has_value (GTK_TREE_MODEL (priv->lstore_show), COL_SHOW_VISIBLE_NAME, v_table_field))
-											{
-												gchar *asc_desc;
-												asc_desc = xmlGetProp (node_field, "asc_desc");
-
-												if (g_strcmp0 (asc_desc, "ASC") == 0
-												    || g_strcmp0 (asc_desc, "DESC") == 0)
-													{
-														gtk_list_store_append (priv->lstore_order, &iter);
-														gtk_list_store_set (priv->lstore_order, &iter,
-														                    COL_ORDER_TABLE_NAME, field->table_name,
-														                    COL_ORDER_NAME, field_name,
-														                    COL_ORDER_VISIBLE_NAME, name_visible,
-														                    COL_ORDER_ORDER, asc_desc,
-														                    COL_ORDER_ORDER_VISIBLE, g_strcmp0 (asc_desc, "ASC") == 0 ? _("Ascending") : _("Descending"),
-														                    -1);
-													}
-											}
-									}
-
-								g_free (field_name);
-								g_free (table_name);
-								g_free (name_visible);
-							}
+			table = (GdaExQueryEditorTable *)value;
 
-						node_field = node_field->next;
-					}
-			}
-		node = node->next;
-	}
+			g_hash_table_iter_init (&hiter_field, table->fields);
+			while (g_hash_table_iter_next (&hiter_field, &key, &value))
+				{
+					gdaex_query_editor_fields_sync_field (qe, table, (GdaExQueryEditorField *)value);
+				}
+		}
 }
 
-/* PRIVATE */
 static void
-gdaex_query_editor_set_property (GObject *object,
-                   guint property_id,
-                   const GValue *value,
-                   GParamSpec *pspec)
+gdaex_query_editor_fields_clean (GdaExQueryEditor *qe)
 {
-	GdaExQueryEditor *gdaex_query_editor = (GdaExQueryEditor *)object;
-	GdaExQueryEditorPrivate *priv = GDAEX_QUERY_EDITOR_GET_PRIVATE (gdaex_query_editor);
+	GdaExQueryEditorPrivate *priv;
 
-	switch (property_id)
+	priv = GDAEX_QUERY_EDITOR_GET_PRIVATE (qe);
+
+	gtk_tree_store_clear (priv->tstore_fields);
+	g_hash_table_remove_all (priv->ht_fields_rows);
+
+	if (priv->fields_index != NULL)
 		{
-			default:
-				G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
-				break;
+			g_ptr_array_unref (priv->fields_index);
+			priv->fields_index = NULL;
 		}
 }
 
 static void
-gdaex_query_editor_get_property (GObject *object,
-                   guint property_id,
-                   GValue *value,
-                   GParamSpec *pspec)
+gdaex_query_editor_index_word_free (GdaExQueryEditorIndexWord *word)
 {
-	GdaExQueryEditor *gdaex_query_editor = (GdaExQueryEditor *)object;
-	GdaExQueryEditorPrivate *priv = GDAEX_QUERY_EDITOR_GET_PRIVATE (gdaex_query_editor);
+	g_free (word->word);
+	g_free (word->key);
+	g_free (word);
+}
 
-	switch (property_id)
+static gint
+gdaex_query_editor_index_word_compare (gconstpointer a, gconstpointer b)
+{
+	return g_strcmp0 ((*(GdaExQueryEditorIndexWord **)a)->word,
+	                  (*(GdaExQueryEditorIndexWord **)b)->word);
+}
+
+/* the words of str, case and accents folded */
+static gchar
+**gdaex_query_editor_index_split (const gchar *str)
+{
+	GPtrArray *words;
+	gchar *normalized;
+	gchar *folded;
+	gchar *p;
+	gchar *start;
+
+	words = g_ptr_array_new ();
+
+	normalized = g_utf8_normalize (str != NULL ? str : "", -1, G_NORMALIZE_ALL);
+	folded = g_utf8_casefold (normalized != NULL ? normalized : "", -1);
+	g_free (normalized);
+
+	start = NULL;
+	for (p = folded; ; p = g_utf8_next_char (p))
 		{
-			default:
-				G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
-				break;
+			if (*p != '\0' && g_unichar_isalnum (g_utf8_get_char (p)))
+				{
+					if (start == NULL)
+						{
+							start = p;
+						}
+				}
+			else
+				{
+					if (start != NULL)
+						{
+							g_ptr_array_add (words, g_strndup (start, p - start));
+							start = NULL;
+						}
+					if (*p == '\0')
+						{
+							break;
+						}
+				}
 		}
+	g_free (folded);
+
+	g_ptr_array_add (words, NULL);
+
+	return (gchar **)g_ptr_array_free (words, FALSE);
 }
 
 static void
-gdaex_query_editor_dispose (GObject *object)
+gdaex_query_editor_index_add (GPtrArray *index,
+                              const gchar *str,
+                              const gchar *key)
 {
-	GdaExQueryEditor *gdaex_query_editor = (GdaExQueryEditor *)object;
-	GdaExQueryEditorPrivate *priv = GDAEX_QUERY_EDITOR_GET_PRIVATE (gdaex_query_editor);
-
-	gtk_tree_store_clear (priv->tstore_fields);
-	gtk_list_store_clear (priv->lstore_show);
-	gtk_tree_store_clear (priv->tstore_where);
-	gtk_list_store_clear (priv->lstore_order);
+	gchar **words;
+	guint i;
+	GdaExQueryEditorIndexWord *word;
 
-	if (priv->tables != NULL)
+	words = gdaex_query_editor_index_split (str);
+	for (i = 0; words[i] != NULL; i++)
 		{
-			g_hash_table_destroy (priv->tables);
-			priv->tables = NULL;
+			word = g_new0 (GdaExQueryEditorIndexWord, 1);
+			word->word = words[i];
+			word->key = g_strdup (key);
+			g_ptr_array_add (index, word);
 		}
+	g_free (words);
+}
+
+/* sorted words of the visible names and descriptions of the fields */
+static GPtrArray
+*gdaex_query_editor_index_build (GdaExQueryEditor *qe)
+{
+	GdaExQueryEditorPrivate *priv;
+
+	GPtrArray *index;
+	GHashTableIter hiter_table;
+	GHashTableIter hiter_field;
+	gpointer key, value;
+	const GdaExQueryEditorTable *table;
+	const GdaExQueryEditorField *field;
+	gchar *field_key;
 
-	if (priv->relations != NULL)
+	priv = GDAEX_QUERY_EDITOR_GET_PRIVATE (qe);
+
+	index = g_ptr_array_new_with_free_func ((GDestroyNotify)gdaex_query_editor_index_word_free);
+
+	g_hash_table_iter_init (&hiter_table, gdaex_query_editor_model_get_tables (priv->model));
+	while (g_hash_table_iter_next (&hiter_table, &key, &value))
 		{
-			g_slist_free (priv->relations);
-			priv->relations = NULL;
+			table = (GdaExQueryEditorTable *)value;
+
+			g_hash_table_iter_init (&hiter_field, table->fields);
+			while (g_hash_table_iter_next (&hiter_field, &key, &value))
+				{
+					field = (GdaExQueryEditorField *)value;
+
+					field_key = gdaex_query_editor_field_key (table->name, field->name);
+					gdaex_query_editor_index_add (index, table->name_visible, field_key);
+					gdaex_query_editor_index_add (index, field->name_visible, field_key);
+					gdaex_query_editor_index_add (index, field->description, field_key);
+					g_free (field_key);
+				}
 		}
 
-	G_OBJECT_CLASS (gdaex_query_editor_parent_class)->dispose (object);
+	g_ptr_array_sort (index, gdaex_query_editor_index_word_compare);
+
+	return index;
 }
 
-static void
-gdaex_query_editor_finalize (GObject *object)
+/* the keys of the fields with a word starting with prefix */
+static GHashTable
+*gdaex_query_editor_index_lookup (GPtrArray *index,
+                                  const gchar *prefix)
 {
-	GdaExQueryEditor *gdaex_query_editor = (GdaExQueryEditor *)object;
-	GdaExQueryEditorPrivate *priv = GDAEX_QUERY_EDITOR_GET_PRIVATE (gdaex_query_editor);
+	GHashTable *ret;
+	guint low;
+	guint high;
+	guint mid;
+	GdaExQueryEditorIndexWord *word;
+
+	ret = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+
+	/* first word not lesser than prefix */
+	low = 0;
+	high = index->len;
+	while (low < high)
+		{
+			mid = low + (high - low) / 2;
+			word = (GdaExQueryEditorIndexWord *)g_ptr_array_index (index, mid);
+			if (g_strcmp0 (word->word, prefix) < 0)
+				{
+					low = mid + 1;
+				}
+			else
+				{
+					high = mid;
+				}
+		}
 
-	gtk_widget_destroy (priv->hpaned_main);
+	for (; low < index->len; low++)
+		{
+			word = (GdaExQueryEditorIndexWord *)g_ptr_array_index (index, low);
+			if (!g_str_has_prefix (word->word, prefix))
+				{
+					break;
+				}
+			g_hash_table_add (ret, g_strdup (word->key));
+		}
 
-	G_OBJECT_CLASS (gdaex_query_editor_parent_class)->finalize (object);
+	return ret;
 }
 
 static void
-gdaex_query_editor_clean (GdaExQueryEditor *gdaex_query_editor)
+gdaex_query_editor_count_on_ready (GObject *source_object,
+                                   GAsyncResult *res,
+                                   gpointer user_data)
 {
-	GdaExQueryEditorPrivate *priv = GDAEX_QUERY_EDITOR_GET_PRIVATE (gdaex_query_editor);
+	GdaExQueryEditor *qe;
+	GdaExQueryEditorPrivate *priv;
+
+	GError *error;
+	gint64 rows;
+	gboolean estimated;
+	gchar *str_rows;
+	gchar *str;
+
+	qe = GDAEX_QUERY_EDITOR (user_data);
+	priv = GDAEX_QUERY_EDITOR_GET_PRIVATE (qe);
 
-	if (priv->tables != NULL)
+	error = NULL;
+	rows = gdaex_query_editor_model_count_finish (GDAEX_QUERY_EDITOR_MODEL (source_object), res, &estimated, &error);
+	if (rows < 0)
 		{
-			g_hash_table_destroy (priv->tables);
+			if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_TIMED_OUT))
+				{
+					gtk_label_set_text (GTK_LABEL (priv->lbl_rows_count), _("Too many rows to count them in time"));
+				}
+			else if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_BUSY))
+				{
+					/* the previous count is still on the database: retry later */
+					if (priv->count_cancellable != NULL
+					    && !g_cancellable_is_cancelled (priv->count_cancellable))
+						{
+							gdaex_query_editor_count_schedule (qe);
+						}
+				}
+			else if (!g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+				{
+					/* a cancelled count has been superseded by a newer one */
+					gtk_label_set_text (GTK_LABEL (priv->lbl_rows_count), "");
+				}
+			g_clear_error (&error);
+			g_object_unref (qe);
+			return;
 		}
-	priv->tables = g_hash_table_new (g_str_hash, g_str_equal);
 
-	if (priv->relations != NULL)
+	str_rows = g_strdup_printf ("%" G_GINT64_FORMAT, rows);
+	if (estimated)
+		{
+			str = g_strdup_printf (_("About %s rows"), str_rows);
+		}
+	else
 		{
-			g_slist_free (priv->relations);
+			str = g_strdup_printf (g_dngettext (GETTEXT_PACKAGE, "%s row", "%s rows", rows), str_rows);
 		}
-	priv->relations = NULL;
+	gtk_label_set_text (GTK_LABEL (priv->lbl_rows_count), str);
+	g_free (str);
+	g_free (str_rows);
+
+	g_object_unref (qe);
 }
 
 static gboolean
-_gdaex_query_editor_add_table (GdaExQueryEditor *qe,
-                              const gchar *table_name,
-                              const gchar *table_name_visible,
-                              gboolean is_visible)
+gdaex_query_editor_count_on_timeout (gpointer user_data)
 {
+	GdaExQueryEditor *qe;
 	GdaExQueryEditorPrivate *priv;
-	GdaExQueryEditorTable *table;
 
-	gchar *_table_name;
+	qe = GDAEX_QUERY_EDITOR (user_data);
+	priv = GDAEX_QUERY_EDITOR_GET_PRIVATE (qe);
 
-	g_return_val_if_fail (GDAEX_IS_QUERY_EDITOR (qe), FALSE);
-	g_return_val_if_fail (table_name != NULL, FALSE);
+	priv->count_source_id = 0;
 
-	priv = GDAEX_QUERY_EDITOR_GET_PRIVATE (qe);
+	gdaex_query_editor_sync_model (qe);
 
-	table = g_new0 (GdaExQueryEditorTable, 1);
+	gtk_label_set_text (GTK_LABEL (priv->lbl_rows_count), _("Counting rows..."));
+	gdaex_query_editor_model_count_async (priv->model,
+	                                      priv->count_budget,
+	                                      priv->count_cancellable,
+	                                      gdaex_query_editor_count_on_ready,
+	                                      g_object_ref (qe));
 
-	_table_name = g_strdup (table_name);
+	return G_SOURCE_REMOVE;
+}
 
-	g_return_val_if_fail (g_strcmp0 (g_strstrip (_table_name), "") != 0, FALSE);
+/* the rows are counted again when the conditions stay the same for a while */
+static void
+gdaex_query_editor_count_schedule (GdaExQueryEditor *qe)
+{
+	GdaExQueryEditorPrivate *priv;
 
-	table->name = g_strdup (_table_name);
-	g_free (_table_name);
+	priv = GDAEX_QUERY_EDITOR_GET_PRIVATE (qe);
 
-	if (table_name_visible == NULL)
+	if (priv->count_cancellable != NULL)
 		{
-			table->name_visible = g_strdup (table->name);
+			g_cancellable_cancel (priv->count_cancellable);
+			g_clear_object (&priv->count_cancellable);
 		}
-	else
+	if (priv->count_source_id != 0)
 		{
-			_table_name = g_strdup (table_name_visible);
-			if (g_strcmp0 (g_strstrip (_table_name), "") == 0)
-				{
-					table->name_visible = g_strdup (table->name);
-					g_free (_table_name);
-				}
-			else
-				{
-					table->name_visible = g_strdup (_table_name);
-					g_free (_table_name);
-				}
+			g_source_remove (priv->count_source_id);
+			priv->count_source_id = 0;
 		}
 
-	table->fields = g_hash_table_new (g_str_hash, g_str_equal);
-	table->visible = is_visible;
+	if (priv->count_budget == 0)
+		{
+			return;
+		}
 
-	g_hash_table_insert (priv->tables, table->name, table);
+	priv->count_cancellable = g_cancellable_new ();
+	priv->count_source_id = g_timeout_add (GDAEX_QE_COUNT_DELAY, gdaex_query_editor_count_on_timeout, qe);
+}
 
-	return TRUE;
+static void
+gdaex_query_editor_on_tstore_where_row_changed (GtkTreeModel *tree_model,
+                                                GtkTreePath *path,
+                                                GtkTreeIter *iter,
+                                                gpointer user_data)
+{
+	gdaex_query_editor_count_schedule (GDAEX_QUERY_EDITOR (user_data));
 }
 
 static void
-gdaex_query_editor_refresh_gui (GdaExQueryEditor *qe)
+gdaex_query_editor_on_tstore_where_row_deleted (GtkTreeModel *tree_model,
+                                                GtkTreePath *path,
+                                                gpointer user_data)
 {
-	GdaExQueryEditorPrivate *priv;
+	gdaex_query_editor_count_schedule (GDAEX_QUERY_EDITOR (user_data));
+}
 
-	GtkTreeIter iter;
-	GHashTableIter hiter;
-	gpointer key, value;
-	GdaExQueryEditorTable *table;
+static void
+gdaex_query_editor_on_tstore_where_rows_reordered (GtkTreeModel *tree_model,
+                                                   GtkTreePath *path,
+                                                   GtkTreeIter *iter,
+                                                   gpointer new_order,
+                                                   gpointer user_data)
+{
+	gdaex_query_editor_count_schedule (GDAEX_QUERY_EDITOR (user_data));
+}
+
+/**
+ * gdaex_query_editor_set_count_budget:
+ * @qe: a #GdaExQueryEditor object.
+ * @budget: the maximum time in milliseconds; 0 disables the count.
+ *
+ * Every time the conditions change, the rows returned by the query are
+ * counted in background and shown under the editor; the count is given up
+ * after @budget (see gdaex_query_editor_model_count_async()).
+ */
+void
+gdaex_query_editor_set_count_budget (GdaExQueryEditor *qe,
+                                     guint budget)
+{
+	GdaExQueryEditorPrivate *priv;
 
 	g_return_if_fail (GDAEX_IS_QUERY_EDITOR (qe));
 
 	priv = GDAEX_QUERY_EDITOR_GET_PRIVATE (qe);
 
-	gtk_tree_store_clear (priv->tstore_fields);
+	priv->count_budget = budget;
+	gtk_label_set_text (GTK_LABEL (priv->lbl_rows_count), "");
+	gtk_widget_set_visible (priv->lbl_rows_count, budget > 0);
 
-	g_hash_table_iter_init (&hiter, priv->tables);
-	while (g_hash_table_iter_next (&hiter, &key, &value))
-		{
-			table = (GdaExQueryEditorTable *)value;
+	gdaex_query_editor_count_schedule (qe);
+}
 
-			if (table->visible)
-				{
-					gtk_tree_store_append (priv->tstore_fields, &iter, NULL);
-					gtk_tree_store_set (priv->tstore_fields, &iter,
-					                    COL_FIELDS_NAME, table->name,
-					                    COL_FIELDS_VISIBLE_NAME, table->name_visible,
-					                    -1);
+/**
+ * gdaex_query_editor_get_count_budget:
+ * @qe: a #GdaExQueryEditor object.
+ *
+ * Returns: the maximum time in milliseconds of the count of the rows; 0 if
+ * the rows are not counted.
+ */
+guint
+gdaex_query_editor_get_count_budget (GdaExQueryEditor *qe)
+{
+	GdaExQueryEditorPrivate *priv;
 
-					gdaex_query_editor_refresh_gui_add_fields (qe, table, &iter);
+	g_return_val_if_fail (GDAEX_IS_QUERY_EDITOR (qe), 0);
 
-					/* if no fields, remove table */
-					if (!gtk_tree_model_iter_has_child (GTK_TREE_MODEL (priv->tstore_fields), &iter))
-						{
-							gtk_tree_store_remove (priv->tstore_fields, &iter);
-						}
-				}
-		}
+	priv = GDAEX_QUERY_EDITOR_GET_PRIVATE (qe);
 
-	gtk_tree_view_expand_all (GTK_TREE_VIEW (priv->trv_fields));
+	return priv->count_budget;
 }
 
-static void
-gdaex_query_editor_refresh_gui_add_fields (GdaExQueryEditor *qe,
-                                           GdaExQueryEditorTable *table,
-                                           GtkTreeIter *iter_parent)
+/**
+ * gdaex_query_editor_set_fields_filter:
+ * @qe: a #GdaExQueryEditor object.
+ * @filter: (nullable): the words to search.
+ *
+ * Shows in the fields tree only the fields with, for every word of @filter,
+ * a word of the table name, the field name or the description starting
+ * with it; case and accents are ignored. #NULL or an empty @filter shows
+ * all the fields.
+ */
+void
+gdaex_query_editor_set_fields_filter (GdaExQueryEditor *qe,
+                                      const gchar *filter)
 {
 	GdaExQueryEditorPrivate *priv;
 
-	GtkTreeIter iter;
+	gchar **words;
+	gchar *text;
+	guint i;
+	GHashTable *matches;
 	GHashTableIter hiter;
-	gpointer key, value;
-	GdaExQueryEditorField *field;
+	gpointer key;
+
+	g_return_if_fail (GDAEX_IS_QUERY_EDITOR (qe));
 
 	priv = GDAEX_QUERY_EDITOR_GET_PRIVATE (qe);
 
-	g_hash_table_iter_init (&hiter, table->fields);
-	while (g_hash_table_iter_next (&hiter, &key, &value))
+	if (priv->fields_filter != NULL)
 		{
-			field = (GdaExQueryEditorField *)value;
+			g_hash_table_destroy (priv->fields_filter);
+			priv->fields_filter = NULL;
+		}
 
-			if (field->for_show || field->for_where || field->for_order)
-				{
-					gtk_tree_store_append (priv->tstore_fields, &iter, iter_parent);
-					gtk_tree_store_set (priv->tstore_fields, &iter,
-					                    COL_FIELDS_TABLE_NAME, table->name,
-					                    COL_FIELDS_NAME, field->name,
-					                    COL_FIELDS_VISIBLE_NAME, field->name_visible,
-					                    COL_FIELDS_DESCRIPTION, field->description,
-					                    -1);
-				}
+	words = gdaex_query_editor_index_split (filter);
+
+	text = (words[0] != NULL ? g_strdup (filter) : NULL);
+	g_free (priv->fields_filter_text);
+	priv->fields_filter_text = text;
 
-			if (field->for_show && field->always_showed)
+	if (words[0] != NULL)
+		{
+			if (priv->fields_index == NULL)
 				{
-					gdaex_query_editor_show_add_iter (qe, &iter);
+					priv->fields_index = gdaex_query_editor_index_build (qe);
 				}
-			if (field->for_order && field->always_ordered)
+
+			for (i = 0; words[i] != NULL; i++)
 				{
-					gdaex_query_editor_order_add_iter (qe, &iter);
+					matches = gdaex_query_editor_index_lookup (priv->fields_index, words[i]);
+					if (priv->fields_filter == NULL)
+						{
+							priv->fields_filter = matches;
+						}
+					else
+						{
+							g_hash_table_iter_init (&hiter, priv->fields_filter);
+							while (g_hash_table_iter_next (&hiter, &key, NULL))
+								{
+									if (!g_hash_table_contains (matches, key))
+										{
+											g_hash_table_iter_remove (&hiter);
+										}
+								}
+							g_hash_table_destroy (matches);
+						}
 				}
 		}
+	g_strfreev (words);
+
+	gdaex_query_editor_refresh_gui (qe);
 }
 
+/* to call when tables or fields are added; field NULL if more than one */
 static void
-gdaex_query_editor_refill_always_show (GdaExQueryEditor *qe)
+gdaex_query_editor_fields_changed (GdaExQueryEditor *qe,
+                                   const GdaExQueryEditorTable *table,
+                                   const GdaExQueryEditorField *field)
 {
 	GdaExQueryEditorPrivate *priv;
 
-	GtkTreeIter iter_table;
-	GtkTreeIter iter;
+	gchar *filter;
 
-	gchar *table_name;
-	gchar *field_name;
+	priv = GDAEX_QUERY_EDITOR_GET_PRIVATE (qe);
+
+	if (priv->fields_index != NULL)
+		{
+			g_ptr_array_unref (priv->fields_index);
+			priv->fields_index = NULL;
+		}
+
+	if (priv->fields_filter_text != NULL)
+		{
+			/* the new fields could match */
+			filter = g_strdup (priv->fields_filter_text);
+			gdaex_query_editor_set_fields_filter (qe, filter);
+			g_free (filter);
+		}
+	else if (field != NULL)
+		{
+			gdaex_query_editor_fields_sync_field (qe, table, field);
+		}
+	else
+		{
+			gdaex_query_editor_refresh_gui (qe);
+		}
+}
 
-	GdaExQueryEditorTable *table;
-	GdaExQueryEditorField *field;
+static void
+gdaex_query_editor_refill_always_show (GdaExQueryEditor *qe)
+{
+	GdaExQueryEditorPrivate *priv;
+
+	GHashTableIter hiter_table;
+	GHashTableIter hiter_field;
+	gpointer key, value;
+	const GdaExQueryEditorTable *table;
+	const GdaExQueryEditorField *field;
 
 	priv = GDAEX_QUERY_EDITOR_GET_PRIVATE (qe);
 
-	if (gtk_tree_model_get_iter_first (GTK_TREE_MODEL (priv->tstore_fields), &iter_table))
+	g_hash_table_iter_init (&hiter_table, gdaex_query_editor_model_get_tables (priv->model));
+	while (g_hash_table_iter_next (&hiter_table, &key, &value))
 		{
-			do
+			table = (GdaExQueryEditorTable *)value;
+			if (!table->visible)
 				{
-					if (gtk_tree_model_iter_children (GTK_TREE_MODEL (priv->tstore_fields), &iter, &iter_table))
+					continue;
+				}
+
+			g_hash_table_iter_init (&hiter_field, table->fields);
+			while (g_hash_table_iter_next (&hiter_field, &key, &value))
+				{
+					field = (GdaExQueryEditorField *)value;
+					if (field->for_show && field->always_showed
+					    && !gdaex_query_editor_choices_has (&priv->choices_show, table->name, field->name))
 						{
-							do
-								{
-									gtk_tree_model_get (GTK_TREE_MODEL (priv->tstore_fields), &iter,
-									                    COL_FIELDS_TABLE_NAME, &table_name,
-									                    COL_FIELDS_NAME, &field_name,
-									                    -1);
-									table = g_hash_table_lookup (priv->tables, table_name);
-									field = g_hash_table_lookup (table->fields, field_name);
-									if (field->always_showed)
-										{
-											gdaex_query_editor_show_add_iter (qe, &iter);
-										}
-								} while (gtk_tree_model_iter_next (GTK_TREE_MODEL (priv->tstore_fields), &iter));
+							gdaex_query_editor_show_add (qe, table->name, field->name);
 						}
-				} while (gtk_tree_model_iter_next (GTK_TREE_MODEL (priv->tstore_fields), &iter_table));
+				}
 		}
 }
 
 static void
 gdaex_query_editor_refill_always_order (GdaExQueryEditor *qe)
 {
-	GdaExQueryEditorPrivate *priv;
-
-	GtkTreeIter iter_table;
-	GtkTreeIter iter;
-
-	gchar *table_name;
-	gchar *field_name;
+	GdaExQueryEditorPrivate *priv;
 
-	GdaExQueryEditorTable *table;
-	GdaExQueryEditorField *field;
+	GHashTableIter hiter_table;
+	GHashTableIter hiter_field;
+	gpointer key, value;
+	const GdaExQueryEditorTable *table;
+	const GdaExQueryEditorField *field;
 
 	priv = GDAEX_QUERY_EDITOR_GET_PRIVATE (qe);
 
-	if (gtk_tree_model_get_iter_first (GTK_TREE_MODEL (priv->tstore_fields), &iter_table))
+	g_hash_table_iter_init (&hiter_table, gdaex_query_editor_model_get_tables (priv->model));
+	while (g_hash_table_iter_next (&hiter_table, &key, &value))
 		{
-			do
+			table = (GdaExQueryEditorTable *)value;
+			if (!table->visible)
+				{
+					continue;
+				}
+
+			g_hash_table_iter_init (&hiter_field, table->fields);
+			while (g_hash_table_iter_next (&hiter_field, &key, &value))
 				{
-					if (gtk_tree_model_iter_children (GTK_TREE_MODEL (priv->tstore_fields), &iter, &iter_table))
+					field = (GdaExQueryEditorField *)value;
+					if (field->for_order && field->always_ordered
+					    && !gdaex_query_editor_choices_has (&priv->choices_order, table->name, field->name))
 						{
-							do
-								{
-									gtk_tree_model_get (GTK_TREE_MODEL (priv->tstore_fields), &iter,
-									                    COL_FIELDS_TABLE_NAME, &table_name,
-									                    COL_FIELDS_NAME, &field_name,
-									                    -1);
-									table = g_hash_table_lookup (priv->tables, table_name);
-									field = g_hash_table_lookup (table->fields, field_name);
-									if (field->always_ordered)
-										{
-											gdaex_query_editor_order_add_iter (qe, &iter);
-										}
-								} while (gtk_tree_model_iter_next (GTK_TREE_MODEL (priv->tstore_fields), &iter));
+							gdaex_query_editor_order_add (qe, table->name, field->name);
 						}
-				} while (gtk_tree_model_iter_next (GTK_TREE_MODEL (priv->tstore_fields), &iter_table));
+				}
 		}
 }
 
@@ -3431,37 +3060,6 @@ gdaex_query_editor_store_move_iter_up_down (GdaExQueryEditor *qe,
 		}
 }
 
-static gboolean
-gdaex_query_editor_model_has_value (GtkTreeModel *model,
-                                    guint column,
-                                    GValue *value)
-{
-	gboolean ret;
-
-	GtkTreeIter iter;
-	GValue iter_value = { 0 };
-
-	g_return_val_if_fail (gtk_tree_model_get_column_type (model, column) == G_VALUE_TYPE (value), FALSE);
-
-	ret = FALSE;
-
-	if (gtk_tree_model_get_iter_first (model, &iter))
-		{
-			do
-				{
-					gtk_tree_model_get_value (model, &iter, column, &iter_value);
-					if (!gda_value_differ (value, &iter_value))
-						{
-							g_value_unset (&iter_value);
-							return TRUE;
-						}
-					g_value_unset (&iter_value);
-				} while (gtk_tree_model_iter_next (model, &iter));
-		}
-
-	return ret;
-}
-
 static void
 gdaex_query_editor_remove_child_from_vbx_values (GdaExQueryEditor *qe)
 {
@@ -3573,11 +3171,8 @@ gdaex_query_editor_on_sel_fields_changed (GtkTreeSelection *treeselection,
 
 	gchar *table_name;
 	gchar *field_name;
-	GdaExQueryEditorTable *table;
-	GdaExQueryEditorField *field;
-
-	gchar *table_field;
-	GValue *v_table_field;
+	const GdaExQueryEditorTable *table;
+	const GdaExQueryEditorField *field;
 
 	GdaExQueryEditor *qe = (GdaExQueryEditor *)user_data;
 	GdaExQueryEditorPrivate *priv = GDAEX_QUERY_EDITOR_GET_PRIVATE (qe);
@@ -3599,7 +3194,7 @@ gdaex_query_editor_on_sel_fields_changed (GtkTreeSelection *treeselection,
 					return;
 				}
 
-			table = g_hash_table_lookup (priv->tables, table_name);
+			table = gdaex_query_editor_model_get_table (priv->model, table_name);
 			field = g_hash_table_lookup (table->fields, field_name);
 
 			if (field->for_where)
@@ -3607,21 +3202,14 @@ gdaex_query_editor_on_sel_fields_changed (GtkTreeSelection *treeselection,
 					gtk_widget_set_sensitive (GTK_WIDGET (gtk_builder_get_object (priv->gtkbuilder, "button7")), TRUE);
 				}
 
-			table_field = g_strconcat (table->name_visible, " - ", field->name_visible, NULL);
-			v_table_field = gda_value_new (G_TYPE_STRING);
-			g_value_set_string (v_table_field, table_field);
-			if (!gdaex_query_editor_model_has_value (GTK_TREE_MODEL (priv->lstore_show),
-			                                         COL_ORDER_VISIBLE_NAME,
-			                                         v_table_field))
+			if (!gdaex_query_editor_choices_has (&priv->choices_show, table->name, field->name))
 				{
 					if (!field->always_showed && field->for_show)
 						{
 							gtk_widget_set_sensitive (GTK_WIDGET (gtk_builder_get_object (priv->gtkbuilder, "button3")), TRUE);
 						}
 				}
-			if (!gdaex_query_editor_model_has_value (GTK_TREE_MODEL (priv->lstore_order),
-			                                         COL_ORDER_VISIBLE_NAME,
-			                                         v_table_field))
+			if (!gdaex_query_editor_choices_has (&priv->choices_order, table->name, field->name))
 				{
 				if (field->for_order)
 					{
@@ -3629,11 +3217,20 @@ gdaex_query_editor_on_sel_fields_changed (GtkTreeSelection *treeselection,
 					}
 				}
 
-			g_free (table_field);
-			g_value_unset (v_table_field);
+			g_free (table_name);
+			g_free (field_name);
 		}
 }
 
+static void
+gdaex_query_editor_on_txt_fields_filter_search_changed (GtkSearchEntry *entry,
+                                                        gpointer user_data)
+{
+	GdaExQueryEditor *qe = (GdaExQueryEditor *)user_data;
+
+	gdaex_query_editor_set_fields_filter (qe, gtk_entry_get_text (GTK_ENTRY (entry)));
+}
+
 static void
 gdaex_query_editor_on_trv_fields_row_activated (GtkTreeView *tree_view,
                                                 GtkTreePath *path,
@@ -4022,80 +3619,116 @@ gdaex_query_editor_on_notebook_switch_page (GtkNotebook *notebook,
 }
 
 static void
-gdaex_query_editor_show_add_iter (GdaExQueryEditor *qe, GtkTreeIter *iter)
+gdaex_query_editor_show_add (GdaExQueryEditor *qe, const gchar *table_name, const gchar *field_name)
 {
 	GdaExQueryEditorPrivate *priv;
 
-	gchar *table_name;
-	gchar *field_name;
-	GdaExQueryEditorTable *table;
-	GdaExQueryEditorField *field;
+	GtkTreeIter iter;
+	const GdaExQueryEditorTable *table;
+	const GdaExQueryEditorField *field;
+	gchar *name_visible;
 
 	GtkWidget *wpage;
 
 	priv = GDAEX_QUERY_EDITOR_GET_PRIVATE (qe);
 
-	gtk_tree_model_get (GTK_TREE_MODEL (priv->tstore_fields), iter,
-	                    COL_FIELDS_TABLE_NAME, &table_name,
-	                    COL_FIELDS_NAME, &field_name,
-	                    -1);
-
-	table = g_hash_table_lookup (priv->tables, table_name);
+	table = gdaex_query_editor_model_get_table (priv->model, table_name);
 	field = g_hash_table_lookup (table->fields, field_name);
 
-	gtk_list_store_append (priv->lstore_show, iter);
-	gtk_list_store_set (priv->lstore_show, iter,
+	name_visible = g_strconcat (table->name_visible, " - ", field->name_visible, NULL);
+
+	gtk_list_store_append (priv->lstore_show, &iter);
+	gtk_list_store_set (priv->lstore_show, &iter,
 	                    COL_SHOW_TABLE_NAME, field->table_name,
-	                    COL_SHOW_NAME, field_name,
-	                    COL_SHOW_VISIBLE_NAME, g_strconcat (table->name_visible, " - ", field->name_visible, NULL),
+	                    COL_SHOW_NAME, field->name,
+	                    COL_SHOW_VISIBLE_NAME, name_visible,
 	                    -1);
+	gdaex_query_editor_choices_add (&priv->choices_show, &iter, table->name, field->name);
+
+	g_free (name_visible);
 
 	wpage = gtk_notebook_get_nth_page (GTK_NOTEBOOK (priv->notebook), GDAEX_QE_PAGE_SHOW);
 	if (gtk_widget_get_visible (wpage))
 		{
-			gtk_tree_selection_select_iter (priv->sel_show, iter);
+			gtk_tree_selection_select_iter (priv->sel_show, &iter);
 		}
+}
+
+static void
+gdaex_query_editor_show_add_iter (GdaExQueryEditor *qe, GtkTreeIter *iter)
+{
+	GdaExQueryEditorPrivate *priv;
+
+	gchar *table_name;
+	gchar *field_name;
+
+	priv = GDAEX_QUERY_EDITOR_GET_PRIVATE (qe);
+
+	gtk_tree_model_get (GTK_TREE_MODEL (priv->tstore_fields), iter,
+	                    COL_FIELDS_TABLE_NAME, &table_name,
+	                    COL_FIELDS_NAME, &field_name,
+	                    -1);
+
+	gdaex_query_editor_show_add (qe, table_name, field_name);
 
 	g_free (table_name);
 	g_free (field_name);
 }
 
 static void
-gdaex_query_editor_order_add_iter (GdaExQueryEditor *qe, GtkTreeIter *iter)
+gdaex_query_editor_order_add (GdaExQueryEditor *qe, const gchar *table_name, const gchar *field_name)
 {
 	GdaExQueryEditorPrivate *priv;
 
-	gchar *table_name;
-	gchar *field_name;
-	GdaExQueryEditorTable *table;
-	GdaExQueryEditorField *field;
+	GtkTreeIter iter;
+	const GdaExQueryEditorTable *table;
+	const GdaExQueryEditorField *field;
+	gchar *name_visible;
 
 	GtkWidget *wpage;
 
 	priv = GDAEX_QUERY_EDITOR_GET_PRIVATE (qe);
 
-	gtk_tree_model_get (GTK_TREE_MODEL (priv->tstore_fields), iter,
-						COL_FIELDS_TABLE_NAME, &table_name,
-						COL_FIELDS_NAME, &field_name,
-						-1);
-
-	table = g_hash_table_lookup (priv->tables, table_name);
+	table = gdaex_query_editor_model_get_table (priv->model, table_name);
 	field = g_hash_table_lookup (table->fields, field_name);
 
-	gtk_list_store_append (priv->lstore_order, iter);
-	gtk_list_store_set (priv->lstore_order, iter,
+	name_visible = g_strconcat (table->name_visible, " - ", field->name_visible, NULL);
+
+	gtk_list_store_append (priv->lstore_order, &iter);
+	gtk_list_store_set (priv->lstore_order, &iter,
 						COL_ORDER_TABLE_NAME, field->table_name,
-						COL_ORDER_NAME, field_name,
-						COL_ORDER_VISIBLE_NAME, g_strconcat (table->name_visible, " - ", field->name_visible, NULL),
+						COL_ORDER_NAME, field->name,
+						COL_ORDER_VISIBLE_NAME, name_visible,
 						COL_ORDER_ORDER, field->order_default == GDAEX_QE_ORDER_ASC ? "ASC" : "DESC",
 						COL_ORDER_ORDER_VISIBLE, field->order_default == GDAEX_QE_ORDER_ASC ? _("Ascending") : _("Descending"),
 						-1);
+	gdaex_query_editor_choices_add (&priv->choices_order, &iter, table->name, field->name);
+
+	g_free (name_visible);
 
 	wpage = gtk_notebook_get_nth_page (GTK_NOTEBOOK (priv->notebook), GDAEX_QE_PAGE_ORDER);
 	if (gtk_widget_get_visible (wpage))
 		{
-			gtk_tree_selection_select_iter (priv->sel_order, iter);
+			gtk_tree_selection_select_iter (priv->sel_order, &iter);
 		}
+}
+
+static void
+gdaex_query_editor_order_add_iter (GdaExQueryEditor *qe, GtkTreeIter *iter)
+{
+	GdaExQueryEditorPrivate *priv;
+
+	gchar *table_name;
+	gchar *field_name;
+
+	priv = GDAEX_QUERY_EDITOR_GET_PRIVATE (qe);
+
+	gtk_tree_model_get (GTK_TREE_MODEL (priv->tstore_fields), iter,
+						COL_FIELDS_TABLE_NAME, &table_name,
+						COL_FIELDS_NAME, &field_name,
+						-1);
+
+	gdaex_query_editor_order_add (qe, table_name, field_name);
 
 	g_free (table_name);
 	g_free (field_name);
@@ -4169,6 +3802,28 @@ gdaex_query_editor_on_btn_show_down_clicked (GtkButton *button,
 	                                      FALSE);
 }
 
+static void
+gdaex_query_editor_show_on_row_deleted (GtkTreeModel *tree_model,
+                                        GtkTreePath *path,
+                                        gpointer user_data)
+{
+	GdaExQueryEditor *qe = (GdaExQueryEditor *)user_data;
+	GdaExQueryEditorPrivate *priv = GDAEX_QUERY_EDITOR_GET_PRIVATE (qe);
+
+	priv->choices_show.stale = TRUE;
+}
+
+static void
+gdaex_query_editor_order_on_row_deleted (GtkTreeModel *tree_model,
+                                         GtkTreePath *path,
+                                         gpointer user_data)
+{
+	GdaExQueryEditor *qe = (GdaExQueryEditor *)user_data;
+	GdaExQueryEditorPrivate *priv = GDAEX_QUERY_EDITOR_GET_PRIVATE (qe);
+
+	priv->choices_order.stale = TRUE;
+}
+
 static void
 gdaex_query_editor_on_btn_show_clean_clicked (GtkButton *button,
                                     gpointer user_data)
@@ -4190,8 +3845,8 @@ gdaex_query_editor_on_sel_show_changed (GtkTreeSelection *treeselection,
 	gchar *field_name;
 	gchar *alias;
 
-	GdaExQueryEditorTable *table;
-	GdaExQueryEditorField *field;
+	const GdaExQueryEditorTable *table;
+	const GdaExQueryEditorField *field;
 
 	GtkWidget *lbl;
 
@@ -4214,7 +3869,7 @@ gdaex_query_editor_on_sel_show_changed (GtkTreeSelection *treeselection,
 			                    COL_SHOW_ALIAS, &alias,
 			                    -1);
 
-			table = g_hash_table_lookup (priv->tables, table_name);
+			table = gdaex_query_editor_model_get_table (priv->model, table_name);
 			field = g_hash_table_lookup (table->fields, field_name);
 
 			gtk_widget_set_sensitive (GTK_WIDGET (gtk_builder_get_object (priv->gtkbuilder, "button4")), !field->always_showed);
@@ -4280,8 +3935,8 @@ gdaex_query_editor_on_btn_where_add_clicked (GtkButton *button,
 
 	gchar *table_name;
 	gchar *field_name;
-	GdaExQueryEditorTable *table;
-	GdaExQueryEditorField *field;
+	const GdaExQueryEditorTable *table;
+	const GdaExQueryEditorField *field;
 
 	GtkWidget *wpage;
 
@@ -4297,7 +3952,7 @@ gdaex_query_editor_on_btn_where_add_clicked (GtkButton *button,
 			                    COL_FIELDS_NAME, &field_name,
 			                    -1);
 
-			table = g_hash_table_lookup (priv->tables, table_name);
+			table = gdaex_query_editor_model_get_table (priv->model, table_name);
 			field = g_hash_table_lookup (table->fields, field_name);
 
 			if (gtk_tree_selection_get_selected (priv->sel_where, NULL, &iter_parent))
@@ -4488,8 +4143,9 @@ gdaex_query_editor_on_sel_where_changed (GtkTreeSelection *treeselection,
 	gchar *from;
 	gchar *to;
 
-	GdaExQueryEditorTable *table;
-	GdaExQueryEditorField *field;
+	const GdaExQueryEditorTable *table;
+	const GdaExQueryEditorField *field;
+	GdaExQueryEditorFieldIWidgets *iwidgets;
 
 	GtkWidget *lbl;
 
@@ -4525,8 +4181,9 @@ gdaex_query_editor_on_sel_where_changed (GtkTreeSelection *treeselection,
 			is_group = (g_strcmp0 (table_name, GROUP) == 0);
 			if (!is_group)
 				{
-					table = g_hash_table_lookup (priv->tables, table_name);
+					table = gdaex_query_editor_model_get_table (priv->model, table_name);
 					field = g_hash_table_lookup (table->fields, field_name);
+					iwidgets = gdaex_query_editor_get_field_iwidgets (qe, field);
 				}
 
 			path = gtk_tree_model_get_path (GTK_TREE_MODEL (priv->tstore_where), &iter);
@@ -4781,10 +4438,10 @@ gdaex_query_editor_on_sel_where_changed (GtkTreeSelection *treeselection,
 							case GDAEX_QE_FIELD_TYPE_DATE:
 							case GDAEX_QE_FIELD_TYPE_DATETIME:
 							case GDAEX_QE_FIELD_TYPE_TIME:
-								priv->txt_from = GTK_WIDGET (field->iwidget_from);
-								g_object_ref (G_OBJECT (field->iwidget_from));
-								priv->txt_to = GTK_WIDGET (field->iwidget_to);
-								g_object_ref (G_OBJECT (field->iwidget_to));
+								priv->txt_from = GTK_WIDGET (iwidgets->iwidget_from);
+								g_object_ref (G_OBJECT (iwidgets->iwidget_from));
+								priv->txt_to = GTK_WIDGET (iwidgets->iwidget_to);
+								g_object_ref (G_OBJECT (iwidgets->iwidget_to));
 								break;
 
 							default:
@@ -4797,6 +4454,15 @@ gdaex_query_editor_on_sel_where_changed (GtkTreeSelection *treeselection,
 					gtk_grid_attach (GTK_GRID (priv->tbl), priv->txt_from, 4, 1, 1, 1);
 					gtk_grid_attach (GTK_GRID (priv->tbl), priv->txt_to, 6, 1, 1, 1);
 
+					g_free (priv->values_table_name);
+					g_free (priv->values_field_name);
+					priv->values_table_name = g_strdup (table_name);
+					priv->values_field_name = g_strdup (field_name);
+					gdaex_query_editor_values_set_browse (qe, priv->txt_from,
+					                                      G_CALLBACK (gdaex_query_editor_on_txt1_btn_browse_clicked));
+					gdaex_query_editor_values_set_browse (qe, priv->txt_to,
+					                                      G_CALLBACK (gdaex_query_editor_on_txt2_btn_browse_clicked));
+
 					if (gtk_tree_model_get_iter_first (GTK_TREE_MODEL (priv->lstore_where_type), &iter_cb))
 						{
 							if (where_type == 0)
@@ -4830,8 +4496,8 @@ gdaex_query_editor_on_sel_where_changed (GtkTreeSelection *treeselection,
 							case GDAEX_QE_FIELD_TYPE_DATE:
 							case GDAEX_QE_FIELD_TYPE_DATETIME:
 							case GDAEX_QE_FIELD_TYPE_TIME:
-								gdaex_query_editor_iwidget_set_value (field->iwidget_from, from == NULL ? "" : from);
-								gdaex_query_editor_iwidget_set_value (field->iwidget_to, to == NULL ? "" : to);
+								gdaex_query_editor_iwidget_set_value (iwidgets->iwidget_from, from == NULL ? "" : from);
+								gdaex_query_editor_iwidget_set_value (iwidgets->iwidget_to, to == NULL ? "" : to);
 								break;
 
 							default:
@@ -4978,8 +4644,8 @@ gdaex_query_editor_on_sel_order_changed (GtkTreeSelection *treeselection,
 	GtkWidget *tbl;
 	GtkWidget *lbl;
 
-	GdaExQueryEditorTable *table;
-	GdaExQueryEditorField *field;
+	const GdaExQueryEditorTable *table;
+	const GdaExQueryEditorField *field;
 
 	GdaExQueryEditor *qe = (GdaExQueryEditor *)user_data;
 	GdaExQueryEditorPrivate *priv = GDAEX_QUERY_EDITOR_GET_PRIVATE (qe);
@@ -5000,7 +4666,7 @@ gdaex_query_editor_on_sel_order_changed (GtkTreeSelection *treeselection,
 			                    COL_ORDER_ORDER, &order,
 			                    -1);
 
-			table = g_hash_table_lookup (priv->tables, table_name);
+			table = gdaex_query_editor_model_get_table (priv->model, table_name);
 			field = g_hash_table_lookup (table->fields, field_name);
 
 			gtk_widget_set_sensitive (GTK_WIDGET (gtk_builder_get_object (priv->gtkbuilder, "button12")), !field->always_ordered);
@@ -5053,14 +4719,366 @@ gdaex_query_editor_on_sel_order_changed (GtkTreeSelection *treeselection,
 		}
 }
 
+/* the value as iwidget wants it: the date entries have their own format,
+ * the other iwidgets take the sql text */
+static gchar
+*gdaex_query_editor_values_format (GtkWidget *iwidget,
+                                   GdaExQueryEditorValue *value)
+{
+	gchar *ret;
+
+	GDateTime *gdt;
+	const GDate *gdate;
+	const GdaTimestamp *gdatimestamp;
+	const GdaTime *gdatime;
+	gchar *format;
+
+	if (!GDAEX_QUERY_EDITOR_IS_ENTRY_DATE (iwidget)
+	    || value->gval == NULL)
+		{
+			return g_strdup (value->value);
+		}
+
+	gdt = NULL;
+	if (G_VALUE_HOLDS (value->gval, G_TYPE_DATE))
+		{
+			gdate = (const GDate *)g_value_get_boxed (value->gval);
+			if (gdate != NULL && g_date_valid (gdate))
+				{
+					gdt = g_date_time_new_local (g_date_get_year (gdate),
+					                             g_date_get_month (gdate),
+					                             g_date_get_day (gdate),
+					                             0, 0, 0.0);
+				}
+		}
+	else if (G_VALUE_HOLDS (value->gval, GDA_TYPE_TIMESTAMP))
+		{
+			gdatimestamp = gda_value_get_timestamp (value->gval);
+			if (gdatimestamp != NULL)
+				{
+					gdt = g_date_time_new_local (gdatimestamp->year,
+					                             gdatimestamp->month,
+					                             gdatimestamp->day,
+					                             gdatimestamp->hour,
+					                             gdatimestamp->minute,
+					                             gdatimestamp->second);
+				}
+		}
+	else if (G_VALUE_HOLDS (value->gval, GDA_TYPE_TIME))
+		{
+			gdatime = gda_value_get_time (value->gval);
+			if (gdatime != NULL)
+				{
+					/* only the time is formatted */
+					gdt = g_date_time_new_local (2000, 1, 1,
+					                             gdatime->hour,
+					                             gdatime->minute,
+					                             gdatime->second);
+				}
+		}
+
+	ret = NULL;
+	if (gdt != NULL)
+		{
+			format = gdaex_query_editor_entry_date_get_format (GDAEX_QUERY_EDITOR_ENTRY_DATE (iwidget));
+			if (format != NULL)
+				{
+					ret = g_date_time_format (gdt, format);
+					g_free (format);
+				}
+			g_date_time_unref (gdt);
+		}
+
+	return ret != NULL ? ret : g_strdup (value->value);
+}
+
+static void
+gdaex_query_editor_values_on_ready (GObject *source_object,
+                                    GAsyncResult *res,
+                                    gpointer user_data)
+{
+	GdaExQueryEditor *qe;
+	GdaExQueryEditorPrivate *priv;
+
+	GPtrArray *ar_values;
+	GdaExQueryEditorValue *value;
+	GError *error;
+	GtkTreeIter iter;
+	gchar *str;
+	guint i;
+
+	qe = GDAEX_QUERY_EDITOR (user_data);
+	priv = GDAEX_QUERY_EDITOR_GET_PRIVATE (qe);
+
+	error = NULL;
+	ar_values = gdaex_query_editor_model_get_values_finish (GDAEX_QUERY_EDITOR_MODEL (source_object), res, &error);
+	if (ar_values == NULL)
+		{
+			/* a cancelled request has been superseded by a newer one */
+			if (!g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+				{
+					g_warning (_("Unable to read the values of the field: %s"),
+					           error != NULL && error->message != NULL ? error->message : _("no details"));
+				}
+			g_clear_error (&error);
+			g_object_unref (qe);
+			return;
+		}
+
+	for (i = 0; i < ar_values->len; i++)
+		{
+			value = (GdaExQueryEditorValue *)g_ptr_array_index (ar_values, i);
+
+			str = gdaex_query_editor_values_format (priv->values_iwidget, value);
+			gtk_list_store_append (priv->lstore_values, &iter);
+			gtk_list_store_set (priv->lstore_values, &iter,
+			                    COL_VALUES_VALUE, str,
+			                    COL_VALUES_COUNT, value->count,
+			                    -1);
+			g_free (str);
+		}
+
+	priv->values_offset += ar_values->len;
+	gtk_widget_set_sensitive (priv->btn_values_more, ar_values->len == GDAEX_QE_VALUES_PAGE);
+
+	g_ptr_array_unref (ar_values);
+	g_object_unref (qe);
+}
+
+/* reads the first page of values, or the next one with append */
+static void
+gdaex_query_editor_values_refresh (GdaExQueryEditor *qe,
+                                   gboolean append)
+{
+	GdaExQueryEditorPrivate *priv;
+
+	priv = GDAEX_QUERY_EDITOR_GET_PRIVATE (qe);
+
+	if (priv->values_cancellable != NULL)
+		{
+			g_cancellable_cancel (priv->values_cancellable);
+			g_object_unref (priv->values_cancellable);
+		}
+	priv->values_cancellable = g_cancellable_new ();
+
+	if (!append)
+		{
+			gtk_list_store_clear (priv->lstore_values);
+			priv->values_offset = 0;
+		}
+	gtk_widget_set_sensitive (priv->btn_values_more, FALSE);
+
+	gdaex_query_editor_model_get_values_async (priv->model,
+	                                           priv->values_table_name,
+	                                           priv->values_field_name,
+	                                           gtk_entry_get_text (GTK_ENTRY (priv->txt_values_filter)),
+	                                           priv->values_offset,
+	                                           GDAEX_QE_VALUES_PAGE,
+	                                           priv->values_cancellable,
+	                                           gdaex_query_editor_values_on_ready,
+	                                           g_object_ref (qe));
+}
+
+static void
+gdaex_query_editor_values_on_filter_changed (GtkSearchEntry *entry,
+                                             gpointer user_data)
+{
+	gdaex_query_editor_values_refresh (GDAEX_QUERY_EDITOR (user_data), FALSE);
+}
+
+static void
+gdaex_query_editor_values_on_more_clicked (GtkButton *button,
+                                           gpointer user_data)
+{
+	gdaex_query_editor_values_refresh (GDAEX_QUERY_EDITOR (user_data), TRUE);
+}
+
+static void
+gdaex_query_editor_values_on_row_activated (GtkTreeView *tree_view,
+                                            GtkTreePath *path,
+                                            GtkTreeViewColumn *column,
+                                            gpointer user_data)
+{
+	GdaExQueryEditorPrivate *priv;
+
+	GtkTreeIter iter;
+	gchar *value;
+
+	priv = GDAEX_QUERY_EDITOR_GET_PRIVATE (GDAEX_QUERY_EDITOR (user_data));
+
+	if (gtk_tree_model_get_iter (GTK_TREE_MODEL (priv->lstore_values), &iter, path))
+		{
+			gtk_tree_model_get (GTK_TREE_MODEL (priv->lstore_values), &iter,
+			                    COL_VALUES_VALUE, &value,
+			                    -1);
+
+			if (GDAEX_QUERY_EDITOR_IS_IWIDGET (priv->values_iwidget))
+				{
+					gdaex_query_editor_iwidget_set_value (GDAEX_QUERY_EDITOR_IWIDGET (priv->values_iwidget), value);
+				}
+
+			g_free (value);
+		}
+
+	gtk_widget_hide (priv->popover_values);
+}
+
+static void
+gdaex_query_editor_values_on_popover_closed (GtkPopover *popover,
+                                             gpointer user_data)
+{
+	GdaExQueryEditorPrivate *priv;
+
+	priv = GDAEX_QUERY_EDITOR_GET_PRIVATE (GDAEX_QUERY_EDITOR (user_data));
+
+	if (priv->values_cancellable != NULL)
+		{
+			g_cancellable_cancel (priv->values_cancellable);
+			g_clear_object (&priv->values_cancellable);
+		}
+}
+
+/* the popover with the values already in the database for the field of
+ * the current condition */
+static void
+gdaex_query_editor_values_popup (GdaExQueryEditor *qe,
+                                 GtkWidget *iwidget)
+{
+	GdaExQueryEditorPrivate *priv;
+
+	const GdaExQueryEditorField *field;
+
+	GtkWidget *vbox;
+	GtkWidget *scrolledw;
+	GtkWidget *trv;
+	GtkCellRenderer *renderer;
+	GdkRectangle rect;
+
+	priv = GDAEX_QUERY_EDITOR_GET_PRIVATE (qe);
+
+	field = gdaex_query_editor_model_get_field (priv->model, priv->values_table_name, priv->values_field_name);
+	if (field == NULL)
+		{
+			return;
+		}
+
+	if (priv->popover_values == NULL)
+		{
+			priv->popover_values = gtk_popover_new (iwidget);
+			g_object_ref_sink (priv->popover_values);
+			g_signal_connect (G_OBJECT (priv->popover_values), "closed",
+			                  G_CALLBACK (gdaex_query_editor_values_on_popover_closed), qe);
+
+			vbox = gtk_box_new (GTK_ORIENTATION_VERTICAL, 5);
+			g_object_set (G_OBJECT (vbox),
+			              "margin", 5,
+			              NULL);
+			gtk_container_add (GTK_CONTAINER (priv->popover_values), vbox);
+
+			priv->txt_values_filter = gtk_search_entry_new ();
+			gtk_box_pack_start (GTK_BOX (vbox), priv->txt_values_filter, FALSE, FALSE, 0);
+			g_signal_connect (G_OBJECT (priv->txt_values_filter), "search-changed",
+			                  G_CALLBACK (gdaex_query_editor_values_on_filter_changed), qe);
+
+			scrolledw = gtk_scrolled_window_new (NULL, NULL);
+			gtk_scrolled_window_set_policy (GTK_SCROLLED_WINDOW (scrolledw), GTK_POLICY_NEVER, GTK_POLICY_AUTOMATIC);
+			gtk_widget_set_size_request (scrolledw, 300, 250);
+			gtk_box_pack_start (GTK_BOX (vbox), scrolledw, TRUE, TRUE, 0);
+
+			priv->lstore_values = gtk_list_store_new (2,
+			                                          G_TYPE_STRING,
+			                                          G_TYPE_INT);
+
+			trv = gtk_tree_view_new_with_model (GTK_TREE_MODEL (priv->lstore_values));
+			gtk_container_add (GTK_CONTAINER (scrolledw), trv);
+			g_signal_connect (G_OBJECT (trv), "row-activated",
+			                  G_CALLBACK (gdaex_query_editor_values_on_row_activated), qe);
+
+			renderer = gtk_cell_renderer_text_new ();
+			g_object_set (G_OBJECT (renderer),
+			              "ellipsize", PANGO_ELLIPSIZE_END,
+			              NULL);
+			gtk_tree_view_insert_column_with_attributes (GTK_TREE_VIEW (trv), -1, _("Value"), renderer,
+			                                             "text", COL_VALUES_VALUE,
+			                                             NULL);
+			gtk_tree_view_column_set_expand (gtk_tree_view_get_column (GTK_TREE_VIEW (trv), 0), TRUE);
+
+			renderer = gtk_cell_renderer_text_new ();
+			gtk_cell_renderer_set_alignment (renderer, 1.0, 0.5);
+			gtk_tree_view_insert_column_with_attributes (GTK_TREE_VIEW (trv), -1, _("Rows"), renderer,
+			                                             "text", COL_VALUES_COUNT,
+			                                             NULL);
+
+			priv->btn_values_more = gtk_button_new_with_label (_("More values"));
+			gtk_box_pack_start (GTK_BOX (vbox), priv->btn_values_more, FALSE, FALSE, 0);
+			g_signal_connect (G_OBJECT (priv->btn_values_more), "clicked",
+			                  G_CALLBACK (gdaex_query_editor_values_on_more_clicked), qe);
+
+			gtk_widget_show_all (vbox);
+		}
+
+	gtk_popover_set_relative_to (GTK_POPOVER (priv->popover_values), iwidget);
+	if (GTK_IS_ENTRY (iwidget))
+		{
+			gtk_entry_get_icon_area (GTK_ENTRY (iwidget), GTK_ENTRY_ICON_SECONDARY, &rect);
+			gtk_popover_set_pointing_to (GTK_POPOVER (priv->popover_values), &rect);
+		}
+	priv->values_iwidget = iwidget;
+
+	/* the filter is done by the database only on text */
+	g_signal_handlers_block_by_func (priv->txt_values_filter, gdaex_query_editor_values_on_filter_changed, qe);
+	gtk_entry_set_text (GTK_ENTRY (priv->txt_values_filter), "");
+	g_signal_handlers_unblock_by_func (priv->txt_values_filter, gdaex_query_editor_values_on_filter_changed, qe);
+	gtk_widget_set_visible (priv->txt_values_filter, field->type == GDAEX_QE_FIELD_TYPE_TEXT);
+
+	gdaex_query_editor_values_refresh (qe, FALSE);
+
+	gtk_widget_show (priv->popover_values);
+	if (field->type == GDAEX_QE_FIELD_TYPE_TEXT)
+		{
+			gtk_widget_grab_focus (priv->txt_values_filter);
+		}
+}
+
+/* the browse icon on the entry iwidgets opens the values popover */
+static void
+gdaex_query_editor_values_set_browse (GdaExQueryEditor *qe,
+                                      GtkWidget *iwidget,
+                                      GCallback callback)
+{
+	if (!GTK_IS_ENTRY (iwidget))
+		{
+			return;
+		}
+
+	gtk_entry_set_icon_from_icon_name (GTK_ENTRY (iwidget), GTK_ENTRY_ICON_SECONDARY, "edit-find-symbolic");
+	gtk_entry_set_icon_tooltip_text (GTK_ENTRY (iwidget), GTK_ENTRY_ICON_SECONDARY, _("Choose from the values in the database"));
+
+	/* the iwidgets are reused every time the field is shown */
+	g_signal_handlers_disconnect_by_func (iwidget, callback, qe);
+	g_signal_connect (G_OBJECT (iwidget), "icon-press", callback, qe);
+}
+
 static void
-gdaex_query_editor_on_txt1_btn_browse_clicked (gpointer instance, gpointer user_data)
+gdaex_query_editor_on_txt1_btn_browse_clicked (GtkEntry *entry,
+                                               GtkEntryIconPosition icon_pos,
+                                               GdkEvent *event,
+                                               gpointer user_data)
 {
-	g_debug ("Txt1 Open clicked.");
+	if (icon_pos == GTK_ENTRY_ICON_SECONDARY)
+		{
+			gdaex_query_editor_values_popup (GDAEX_QUERY_EDITOR (user_data), GTK_WIDGET (entry));
+		}
 }
 
 static void
-gdaex_query_editor_on_txt2_btn_browse_clicked (gpointer instance, gpointer user_data)
+gdaex_query_editor_on_txt2_btn_browse_clicked (GtkEntry *entry,
+                                               GtkEntryIconPosition icon_pos,
+                                               GdkEvent *event,
+                                               gpointer user_data)
 {
-	g_debug ("Txt2 Open clicked.");
+	if (icon_pos == GTK_ENTRY_ICON_SECONDARY)
+		{
+			gdaex_query_editor_values_popup (GDAEX_QUERY_EDITOR (user_data), GTK_WIDGET (entry));
+		}
 }
@@ -26,6 +26,7 @@
 
 #include "libgdaex.h"
 #include "queryeditor_widget_interface.h"
+#include "queryeditormodel.h"
 
 
 G_BEGIN_DECLS
@@ -68,94 +69,6 @@ gboolean gdaex_query_editor_get_show_visible (GdaExQueryEditor *qe);
 gboolean gdaex_query_editor_get_where_visible (GdaExQueryEditor *qe);
 gboolean gdaex_query_editor_get_order_visible (GdaExQueryEditor *qe);
 
-typedef enum
-	{
-		GDAEX_QE_FIELD_TYPE_TEXT = 1,
-		GDAEX_QE_FIELD_TYPE_INTEGER,
-		GDAEX_QE_FIELD_TYPE_BOOLEAN,
-		GDAEX_QE_FIELD_TYPE_DOUBLE,
-		GDAEX_QE_FIELD_TYPE_DATE,
-		GDAEX_QE_FIELD_TYPE_DATETIME,
-		GDAEX_QE_FIELD_TYPE_TIME
-	} GdaExQueryEditorFieldType;
-
-typedef enum
-	{
-		GDAEX_QE_WHERE_TYPE_EQUAL = 1,
-		GDAEX_QE_WHERE_TYPE_STARTS = 2,
-		GDAEX_QE_WHERE_TYPE_CONTAINS = 4,
-		GDAEX_QE_WHERE_TYPE_ENDS = 8,
-		GDAEX_QE_WHERE_TYPE_ISTARTS = 16,
-		GDAEX_QE_WHERE_TYPE_ICONTAINS = 32,
-		GDAEX_QE_WHERE_TYPE_IENDS = 64,
-		GDAEX_QE_WHERE_TYPE_GREAT = 128,
-		GDAEX_QE_WHERE_TYPE_GREAT_EQUAL = 256,
-		GDAEX_QE_WHERE_TYPE_LESS = 512,
-		GDAEX_QE_WHERE_TYPE_LESS_EQUAL = 1024,
-		GDAEX_QE_WHERE_TYPE_BETWEEN = 2048,
-		GDAEX_QE_WHERE_TYPE_IS_NULL = 4096
-	} GdaExQueryEditorWhereType;
-
-typedef enum
-	{
-		GDAEX_QE_JOIN_TYPE_INNER,
-		GDAEX_QE_JOIN_TYPE_LEFT
-	} GdaExQueryEditorJoinType;
-
-typedef enum
-	{
-		GDAEX_QE_ORDER_ASC,
-		GDAEX_QE_ORDER_DESC
-	} GdaExQueryEditorOrderType;
-
-#define GDAEX_QE_WHERE_TYPE_STRING GDAEX_QE_WHERE_TYPE_STARTS | GDAEX_QE_WHERE_TYPE_CONTAINS | GDAEX_QE_WHERE_TYPE_ENDS | GDAEX_QE_WHERE_TYPE_ISTARTS | GDAEX_QE_WHERE_TYPE_ICONTAINS | GDAEX_QE_WHERE_TYPE_IENDS
-
-#define GDAEX_QE_WHERE_TYPE_NUMBER GDAEX_QE_WHERE_TYPE_EQUAL | GDAEX_QE_WHERE_TYPE_GREAT | GDAEX_QE_WHERE_TYPE_GREAT_EQUAL | GDAEX_QE_WHERE_TYPE_LESS | GDAEX_QE_WHERE_TYPE_LESS_EQUAL | GDAEX_QE_WHERE_TYPE_BETWEEN
-
-#define GDAEX_QE_WHERE_TYPE_DATETIME GDAEX_QE_WHERE_TYPE_NUMBER
-
-typedef struct
-	{
-		gchar *table_name;
-
-		gchar *name;
-		gchar *name_visible;
-		gchar *description;
-		gchar *alias;
-		GdaExQueryEditorFieldType type;
-		gboolean for_show;
-		gboolean always_showed;
-		gboolean for_where;
-		guint available_where_type;
-		gboolean where_default_not;
-		GdaExQueryEditorWhereType where_default_type;
-		gchar *where_default_from;
-		gchar *where_default_from_visible;
-		gchar *where_default_from_sql;
-		gchar *where_default_to;
-		gchar *where_default_to_visible;
-		gchar *where_default_to_sql;
-		gboolean for_order;
-		gboolean always_ordered;
-		GdaExQueryEditorOrderType order_default;
-
-		GdaExQueryEditorIWidget *iwidget_from;
-		GdaExQueryEditorIWidget *iwidget_to;
-
-		/* TODO
-		 * to refactor
-		 */
-		gchar *decode_table2;
-		GdaExQueryEditorJoinType decode_join_type;
-		/* TODO
-		GSList *decode_fields1;
-		GSList *decode_fields2;
-		*/
-		gchar *decode_field2;
-		gchar *decode_field_to_show;
-		gchar *decode_field_alias;
-	} GdaExQueryEditorField;
-
 gboolean gdaex_query_editor_add_table (GdaExQueryEditor *qe,
                                        const gchar *table_name,
                                        const gchar *table_name_visible);
@@ -180,11 +93,21 @@ void gdaex_query_editor_load_tables_from_file (GdaExQueryEditor *qe,
                                                const gchar *filename,
                                                gboolean clean);
 
+void gdaex_query_editor_set_fields_filter (GdaExQueryEditor *qe,
+                                           const gchar *filter);
+
+void gdaex_query_editor_set_count_budget (GdaExQueryEditor *qe,
+                                          guint budget);
+guint gdaex_query_editor_get_count_budget (GdaExQueryEditor *qe);
+
 void gdaex_query_editor_clean_choices (GdaExQueryEditor *qe);
 
+GdaExQueryEditorModel *gdaex_query_editor_get_model (GdaExQueryEditor *qe);
+
 GdaSqlBuilder *gdaex_query_editor_get_sql_as_gdasqlbuilder (GdaExQueryEditor *qe);
 
 const gchar *gdaex_query_editor_get_sql (GdaExQueryEditor *qe);
+GdaStatement *gdaex_query_editor_get_statement (GdaExQueryEditor *qe, GdaSet **params);
 const gchar *gdaex_query_editor_get_sql_select (GdaExQueryEditor *qe);
 const gchar *gdaex_query_editor_get_sql_from (GdaExQueryEditor *qe);
 const gchar *gdaex_query_editor_get_sql_where (GdaExQueryEditor *qe);
@@ -0,0 +1,3527 @@
+/*
+ * Copyright (C) 2011-2016 Andrea Zagli <azagli@libero.it>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifdef HAVE_CONFIG_H
+	#include <config.h>
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <glib/gi18n-lib.h>
+
+#include <libxml/parser.h>
+
+#include <libzakutils/libzakutils.h>
+
+#include "queryeditormodel.h"
+
+static void gdaex_query_editor_model_class_init (GdaExQueryEditorModelClass *klass);
+static void gdaex_query_editor_model_init (GdaExQueryEditorModel *gdaex_query_editor_model);
+
+static void gdaex_query_editor_model_finalize (GObject *object);
+
+static void gdaex_query_editor_model_set_property (GObject *object,
+                               guint property_id,
+                               const GValue *value,
+                               GParamSpec *pspec);
+static void gdaex_query_editor_model_get_property (GObject *object,
+                               guint property_id,
+                               GValue *value,
+                               GParamSpec *pspec);
+
+static void gdaex_query_editor_model_show_choice_free (GdaExQueryEditorShowChoice *choice);
+static void gdaex_query_editor_model_order_choice_free (GdaExQueryEditorOrderChoice *choice);
+static gboolean gdaex_query_editor_model_where_choice_free (GNode *node, gpointer user_data);
+
+#define GDAEX_QE_VALUES_CACHE_TTL 300
+#define GDAEX_QE_VALUES_CACHE_SIZE 64
+
+#define GDAEX_QE_STATEMENTS_CACHE_SIZE 32
+
+/* above this plan estimate the rows are not counted; without a time
+ * limit of the database the count stops here */
+#define GDAEX_QE_COUNT_EXACT_MAX 1000000
+
+typedef struct _GdaExQueryEditorValuesCacheEntry GdaExQueryEditorValuesCacheEntry;
+static void gdaex_query_editor_model_values_cache_entry_free (GdaExQueryEditorValuesCacheEntry *entry);
+
+#define GDAEX_QUERY_EDITOR_MODEL_GET_PRIVATE(obj) (G_TYPE_INSTANCE_GET_PRIVATE ((obj), GDAEX_TYPE_QUERY_EDITOR_MODEL, GdaExQueryEditorModelPrivate))
+
+typedef struct _GdaExQueryEditorModelPrivate GdaExQueryEditorModelPrivate;
+struct _GdaExQueryEditorModelPrivate
+	{
+		GdaEx *gdaex;
+
+		GdaExQueryEditorSchema *schema;
+
+		GPtrArray *show;	/* GdaExQueryEditorShowChoice */
+		GHashTable *ht_show;	/* "table.field" of show */
+		GNode *where;	/* GdaExQueryEditorWhereChoice; the root has no data */
+		GPtrArray *order;	/* GdaExQueryEditorOrderChoice */
+		GHashTable *ht_order;	/* "table.field" of order */
+
+		GVariant *widgets;	/* a(sss) of the last file loaded */
+
+		GMutex values_lock;
+		GHashTable *values_cache;	/* GdaExQueryEditorValuesCacheEntry */
+		guint values_ttl;
+		GdaEx *values_gdaex;	/* opened at the first read of values */
+
+		GMutex count_lock;
+		GdaEx *count_gdaex;	/* opened at the first count */
+
+		GHashTable *statements;	/* serialized GdaStatement => GdaStatement */
+	};
+
+G_DEFINE_TYPE (GdaExQueryEditorModel, gdaex_query_editor_model, G_TYPE_OBJECT)
+
+static void
+gdaex_query_editor_model_class_init (GdaExQueryEditorModelClass *klass)
+{
+	GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+	g_type_class_add_private (object_class, sizeof (GdaExQueryEditorModelPrivate));
+
+	object_class->set_property = gdaex_query_editor_model_set_property;
+	object_class->get_property = gdaex_query_editor_model_get_property;
+	object_class->finalize = gdaex_query_editor_model_finalize;
+}
+
+static void
+gdaex_query_editor_model_init (GdaExQueryEditorModel *gdaex_query_editor_model)
+{
+	GdaExQueryEditorModelPrivate *priv = GDAEX_QUERY_EDITOR_MODEL_GET_PRIVATE (gdaex_query_editor_model);
+
+	priv->gdaex = NULL;
+
+	priv->schema = gdaex_query_editor_schema_new ();
+	priv->widgets = NULL;
+
+	priv->show = g_ptr_array_new_with_free_func ((GDestroyNotify)gdaex_query_editor_model_show_choice_free);
+	priv->ht_show = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+	priv->where = g_node_new (NULL);
+	priv->order = g_ptr_array_new_with_free_func ((GDestroyNotify)gdaex_query_editor_model_order_choice_free);
+	priv->ht_order = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+
+	g_mutex_init (&priv->values_lock);
+	priv->values_cache = g_hash_table_new_full (g_str_hash, g_str_equal,
+	                                            g_free,
+	                                            (GDestroyNotify)gdaex_query_editor_model_values_cache_entry_free);
+	priv->values_ttl = GDAEX_QE_VALUES_CACHE_TTL;
+	priv->values_gdaex = NULL;
+
+	g_mutex_init (&priv->count_lock);
+	priv->count_gdaex = NULL;
+
+	priv->statements = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_object_unref);
+}
+
+/**
+ * gdaex_query_editor_model_new:
+ * @gdaex: a #GdaEx object.
+ *
+ * Creates the headless part of a query editor: tables, fields, relations
+ * and the user's choices, compiled to sql without any widget.
+ *
+ * Returns: the newly created #GdaExQueryEditorModel object.
+ */
+GdaExQueryEditorModel
+*gdaex_query_editor_model_new (GdaEx *gdaex)
+{
+	GdaExQueryEditorModel *gdaex_query_editor_model;
+	GdaExQueryEditorModelPrivate *priv;
+
+	g_return_val_if_fail (IS_GDAEX (gdaex), NULL);
+
+	gdaex_query_editor_model = GDAEX_QUERY_EDITOR_MODEL (g_object_new (gdaex_query_editor_model_get_type (), NULL));
+
+	priv = GDAEX_QUERY_EDITOR_MODEL_GET_PRIVATE (gdaex_query_editor_model);
+
+	priv->gdaex = g_object_ref (gdaex);
+
+	return gdaex_query_editor_model;
+}
+
+/**
+ * gdaex_query_editor_model_get_gdaex:
+ * @model: a #GdaExQueryEditorModel object.
+ *
+ * Returns: (transfer none): the #GdaEx of @model.
+ */
+GdaEx
+*gdaex_query_editor_model_get_gdaex (GdaExQueryEditorModel *model)
+{
+	g_return_val_if_fail (GDAEX_IS_QUERY_EDITOR_MODEL (model), NULL);
+
+	GdaExQueryEditorModelPrivate *priv = GDAEX_QUERY_EDITOR_MODEL_GET_PRIVATE (model);
+
+	return priv->gdaex;
+}
+
+/**
+ * gdaex_query_editor_model_get_schema:
+ * @model: a #GdaExQueryEditorModel object.
+ *
+ * Returns: (transfer none): the tables, fields and relations of @model; it
+ * may be sealed and shared with other models.
+ */
+GdaExQueryEditorSchema
+*gdaex_query_editor_model_get_schema (GdaExQueryEditorModel *model)
+{
+	g_return_val_if_fail (GDAEX_IS_QUERY_EDITOR_MODEL (model), NULL);
+
+	GdaExQueryEditorModelPrivate *priv = GDAEX_QUERY_EDITOR_MODEL_GET_PRIVATE (model);
+
+	return priv->schema;
+}
+
+/**
+ * gdaex_query_editor_model_set_schema:
+ * @model: a #GdaExQueryEditorModel object.
+ * @schema: a #GdaExQueryEditorSchema object.
+ *
+ * Replaces the tables, fields and relations of @model with @schema,
+ * removing all the choices; @schema is referenced, not copied.
+ */
+void
+gdaex_query_editor_model_set_schema (GdaExQueryEditorModel *model,
+                                     GdaExQueryEditorSchema *schema)
+{
+	g_return_if_fail (GDAEX_IS_QUERY_EDITOR_MODEL (model));
+	g_return_if_fail (GDAEX_IS_QUERY_EDITOR_SCHEMA (schema));
+
+	GdaExQueryEditorModelPrivate *priv = GDAEX_QUERY_EDITOR_MODEL_GET_PRIVATE (model);
+
+	/* the choices point to the fields of the old schema */
+	gdaex_query_editor_model_clean_choices (model);
+
+	g_object_ref (schema);
+	g_object_unref (priv->schema);
+	priv->schema = schema;
+
+	g_mutex_lock (&priv->values_lock);
+	g_hash_table_remove_all (priv->values_cache);
+	g_mutex_unlock (&priv->values_lock);
+
+	g_hash_table_remove_all (priv->statements);
+}
+
+/* the schema of model, copied before the first change if it is shared */
+static GdaExQueryEditorSchema
+*gdaex_query_editor_model_get_writable_schema (GdaExQueryEditorModel *model)
+{
+	GdaExQueryEditorSchema *schema;
+
+	GdaExQueryEditorModelPrivate *priv = GDAEX_QUERY_EDITOR_MODEL_GET_PRIVATE (model);
+
+	/* the copy has the same tables and fields: the choices, that refer to
+	 * them by name, stay valid; the caches, built from the old schema and
+	 * about to be outdated by the change, don't */
+	if (gdaex_query_editor_schema_is_sealed (priv->schema))
+		{
+			schema = gdaex_query_editor_schema_copy (priv->schema);
+			g_object_unref (priv->schema);
+			priv->schema = schema;
+
+			g_mutex_lock (&priv->values_lock);
+			g_hash_table_remove_all (priv->values_cache);
+			g_mutex_unlock (&priv->values_lock);
+
+			g_hash_table_remove_all (priv->statements);
+		}
+
+	return priv->schema;
+}
+
+gboolean
+gdaex_query_editor_model_add_table (GdaExQueryEditorModel *model,
+                                    const gchar *table_name,
+                                    const gchar *table_name_visible)
+{
+	g_return_val_if_fail (GDAEX_IS_QUERY_EDITOR_MODEL (model), FALSE);
+
+	return gdaex_query_editor_schema_add_table (gdaex_query_editor_model_get_writable_schema (model),
+	                                            table_name, table_name_visible);
+}
+
+/**
+ * gdaex_query_editor_model_table_add_field:
+ * @model: a #GdaExQueryEditorModel object.
+ * @table_name:
+ * @field:
+ *
+ * Adds a copy of @field to @table_name; see
+ * gdaex_query_editor_schema_table_add_field().
+ *
+ * Returns: #TRUE on success.
+ */
+gboolean
+gdaex_query_editor_model_table_add_field (GdaExQueryEditorModel *model,
+                                          const gchar *table_name,
+                                          GdaExQueryEditorField field)
+{
+	g_return_val_if_fail (GDAEX_IS_QUERY_EDITOR_MODEL (model), FALSE);
+
+	return gdaex_query_editor_schema_table_add_field (gdaex_query_editor_model_get_writable_schema (model),
+	                                                  table_name, field);
+}
+
+/**
+ * gdaex_query_editor_model_table_set_visible:
+ * @model: a #GdaExQueryEditorModel object.
+ * @table_name:
+ * @visible:
+ *
+ * Returns: #TRUE on success.
+ */
+gboolean
+gdaex_query_editor_model_table_set_visible (GdaExQueryEditorModel *model,
+                                            const gchar *table_name,
+                                            gboolean visible)
+{
+	g_return_val_if_fail (GDAEX_IS_QUERY_EDITOR_MODEL (model), FALSE);
+
+	return gdaex_query_editor_schema_table_set_visible (gdaex_query_editor_model_get_writable_schema (model),
+	                                                    table_name, visible);
+}
+
+/**
+ * gdaex_query_editor_model_add_relation_slist:
+ * @model: a #GdaExQueryEditorModel object.
+ * @table1: relation's left part.
+ * @table2: relation's right part.
+ * @join_type:
+ * @fields_joined: couples of fields name, one from @table1 and one from @table2.
+ *
+ */
+gboolean
+gdaex_query_editor_model_add_relation_slist (GdaExQueryEditorModel *model,
+                                             const gchar *table1,
+                                             const gchar *table2,
+                                             GdaExQueryEditorJoinType join_type,
+                                             GSList *fields_joined)
+{
+	g_return_val_if_fail (GDAEX_IS_QUERY_EDITOR_MODEL (model), FALSE);
+
+	return gdaex_query_editor_schema_add_relation_slist (gdaex_query_editor_model_get_writable_schema (model),
+	                                                     table1, table2, join_type, fields_joined);
+}
+
+/**
+ * gdaex_query_editor_model_get_tables:
+ * @model: a #GdaExQueryEditorModel object.
+ *
+ * Returns: (transfer none): the tables of @model, keyed by name.
+ */
+GHashTable
+*gdaex_query_editor_model_get_tables (GdaExQueryEditorModel *model)
+{
+	g_return_val_if_fail (GDAEX_IS_QUERY_EDITOR_MODEL (model), NULL);
+
+	GdaExQueryEditorModelPrivate *priv = GDAEX_QUERY_EDITOR_MODEL_GET_PRIVATE (model);
+
+	return gdaex_query_editor_schema_get_tables (priv->schema);
+}
+
+/**
+ * gdaex_query_editor_model_get_table:
+ * @model: a #GdaExQueryEditorModel object.
+ * @table_name:
+ *
+ * Returns: (transfer none): the table named @table_name, or #NULL.
+ */
+const GdaExQueryEditorTable
+*gdaex_query_editor_model_get_table (GdaExQueryEditorModel *model,
+                                     const gchar *table_name)
+{
+	g_return_val_if_fail (GDAEX_IS_QUERY_EDITOR_MODEL (model), NULL);
+
+	GdaExQueryEditorModelPrivate *priv = GDAEX_QUERY_EDITOR_MODEL_GET_PRIVATE (model);
+
+	return gdaex_query_editor_schema_get_table (priv->schema, table_name);
+}
+
+/**
+ * gdaex_query_editor_model_get_field:
+ * @model: a #GdaExQueryEditorModel object.
+ * @table_name:
+ * @field_name:
+ *
+ * Returns: (transfer none): the field, or #NULL.
+ */
+const GdaExQueryEditorField
+*gdaex_query_editor_model_get_field (GdaExQueryEditorModel *model,
+                                     const gchar *table_name,
+                                     const gchar *field_name)
+{
+	g_return_val_if_fail (GDAEX_IS_QUERY_EDITOR_MODEL (model), NULL);
+
+	GdaExQueryEditorModelPrivate *priv = GDAEX_QUERY_EDITOR_MODEL_GET_PRIVATE (model);
+
+	return gdaex_query_editor_schema_get_field (priv->schema, table_name, field_name);
+}
+
+/**
+ * gdaex_query_editor_model_clean:
+ * @model: a #GdaExQueryEditorModel object.
+ *
+ * Removes all the choices, the relations and the tables.
+ */
+void
+gdaex_query_editor_model_clean (GdaExQueryEditorModel *model)
+{
+	GdaExQueryEditorSchema *schema;
+
+	g_return_if_fail (GDAEX_IS_QUERY_EDITOR_MODEL (model));
+
+	GdaExQueryEditorModelPrivate *priv = GDAEX_QUERY_EDITOR_MODEL_GET_PRIVATE (model);
+
+	schema = gdaex_query_editor_schema_new ();
+	gdaex_query_editor_model_set_schema (model, schema);
+	g_object_unref (schema);
+
+	if (priv->widgets != NULL)
+		{
+			g_variant_unref (priv->widgets);
+			priv->widgets = NULL;
+		}
+}
+
+/**
+ * gdaex_query_editor_model_load_tables_from_xml:
+ * @model: a #GdaExQueryEditorModel object.
+ * @root: a gdaex_query_editor #xmlNode.
+ * @clean: whether to remove the current tables and choices before.
+ *
+ * Loads tables, fields and relations; widget nodes are ignored.
+ */
+void
+gdaex_query_editor_model_load_tables_from_xml (GdaExQueryEditorModel *model,
+                                               xmlNode *root,
+                                               gboolean clean)
+{
+	g_return_if_fail (GDAEX_IS_QUERY_EDITOR_MODEL (model));
+	g_return_if_fail (root != NULL);
+
+	if (clean)
+		{
+			gdaex_query_editor_model_clean (model);
+		}
+
+	gdaex_query_editor_schema_load_tables_from_xml (gdaex_query_editor_model_get_writable_schema (model), root);
+}
+
+/**
+ * gdaex_query_editor_model_load_tables_from_file:
+ * @model: a #GdaExQueryEditorModel object.
+ * @filename: the xml file with the definitions.
+ * @clean: whether to remove the current tables and relations before.
+ *
+ * The definitions are loaded with gdaex_query_editor_schema_new_from_file():
+ * models that load the same file share one sealed schema, copied only if a
+ * model changes it.
+ */
+void
+gdaex_query_editor_model_load_tables_from_file (GdaExQueryEditorModel *model,
+                                                const gchar *filename,
+                                                gboolean clean)
+{
+	GdaExQueryEditorSchema *schema;
+	GVariant *widgets;
+
+	g_return_if_fail (GDAEX_IS_QUERY_EDITOR_MODEL (model));
+	g_return_if_fail (filename != NULL);
+
+	GdaExQueryEditorModelPrivate *priv = GDAEX_QUERY_EDITOR_MODEL_GET_PRIVATE (model);
+
+	schema = gdaex_query_editor_schema_new_from_file (filename);
+	if (schema == NULL)
+		{
+			return;
+		}
+
+	if (clean
+	    || g_hash_table_size (gdaex_query_editor_schema_get_tables (priv->schema)) == 0)
+		{
+			gdaex_query_editor_model_set_schema (model, schema);
+		}
+	else
+		{
+			gdaex_query_editor_schema_merge (gdaex_query_editor_model_get_writable_schema (model), schema);
+		}
+
+	widgets = gdaex_query_editor_schema_get_widgets (schema);
+	if (widgets != NULL)
+		{
+			g_variant_ref (widgets);
+		}
+	if (priv->widgets != NULL)
+		{
+			g_variant_unref (priv->widgets);
+		}
+	priv->widgets = widgets;
+
+	g_object_unref (schema);
+}
+
+/**
+ * gdaex_query_editor_model_get_widgets:
+ * @model: a #GdaExQueryEditorModel object.
+ *
+ * Returns: (transfer none): a #GVariant of type a(sss) with table name,
+ * field name and xml of every widget node of the last file loaded with
+ * gdaex_query_editor_model_load_tables_from_file(); #NULL if none.
+ */
+GVariant
+*gdaex_query_editor_model_get_widgets (GdaExQueryEditorModel *model)
+{
+	g_return_val_if_fail (GDAEX_IS_QUERY_EDITOR_MODEL (model), NULL);
+
+	GdaExQueryEditorModelPrivate *priv = GDAEX_QUERY_EDITOR_MODEL_GET_PRIVATE (model);
+
+	return priv->widgets;
+}
+
+/**
+ * gdaex_query_editor_model_clean_choices:
+ * @model: a #GdaExQueryEditorModel object.
+ *
+ * Removes all the show, where and order choices.
+ */
+void
+gdaex_query_editor_model_clean_choices (GdaExQueryEditorModel *model)
+{
+	g_return_if_fail (GDAEX_IS_QUERY_EDITOR_MODEL (model));
+
+	GdaExQueryEditorModelPrivate *priv = GDAEX_QUERY_EDITOR_MODEL_GET_PRIVATE (model);
+
+	g_ptr_array_set_size (priv->show, 0);
+	g_hash_table_remove_all (priv->ht_show);
+
+	g_node_traverse (priv->where, G_PRE_ORDER, G_TRAVERSE_ALL, -1,
+	                 gdaex_query_editor_model_where_choice_free, NULL);
+	g_node_destroy (priv->where);
+	priv->where = g_node_new (NULL);
+
+	g_ptr_array_set_size (priv->order, 0);
+	g_hash_table_remove_all (priv->ht_order);
+}
+
+/**
+ * gdaex_query_editor_model_add_always_choices:
+ * @model: a #GdaExQueryEditorModel object.
+ *
+ * Adds the fields always showed and always ordered, if not yet present.
+ */
+void
+gdaex_query_editor_model_add_always_choices (GdaExQueryEditorModel *model)
+{
+	GHashTableIter hiter_table;
+	GHashTableIter hiter_field;
+	gpointer key;
+	gpointer value;
+
+	const GdaExQueryEditorTable *table;
+	const GdaExQueryEditorField *field;
+
+	g_return_if_fail (GDAEX_IS_QUERY_EDITOR_MODEL (model));
+
+	GdaExQueryEditorModelPrivate *priv = GDAEX_QUERY_EDITOR_MODEL_GET_PRIVATE (model);
+
+	g_hash_table_iter_init (&hiter_table, gdaex_query_editor_schema_get_tables (priv->schema));
+	while (g_hash_table_iter_next (&hiter_table, &key, &value))
+		{
+			table = (GdaExQueryEditorTable *)value;
+
+			g_hash_table_iter_init (&hiter_field, table->fields);
+			while (g_hash_table_iter_next (&hiter_field, &key, &value))
+				{
+					field = (GdaExQueryEditorField *)value;
+
+					if (field->for_show && field->always_showed)
+						{
+							gdaex_query_editor_model_add_show (model, table->name, field->name, NULL);
+						}
+					if (field->for_order && field->always_ordered)
+						{
+							gdaex_query_editor_model_add_order (model, table->name, field->name, field->order_default);
+						}
+				}
+		}
+}
+
+/**
+ * gdaex_query_editor_model_add_show:
+ * @model: a #GdaExQueryEditorModel object.
+ * @table_name:
+ * @field_name:
+ * @alias: (nullable): the alias to use instead of the field's one.
+ *
+ * Returns: #TRUE if the field is added, #FALSE if it doesn't exist or it is
+ * already showed.
+ */
+gboolean
+gdaex_query_editor_model_add_show (GdaExQueryEditorModel *model,
+                                   const gchar *table_name,
+                                   const gchar *field_name,
+                                   const gchar *alias)
+{
+	const GdaExQueryEditorField *field;
+	GdaExQueryEditorShowChoice *choice;
+	gchar *key;
+
+	g_return_val_if_fail (GDAEX_IS_QUERY_EDITOR_MODEL (model), FALSE);
+
+	GdaExQueryEditorModelPrivate *priv = GDAEX_QUERY_EDITOR_MODEL_GET_PRIVATE (model);
+
+	field = gdaex_query_editor_model_get_field (model, table_name, field_name);
+	if (field == NULL)
+		{
+			g_warning (_("Field «%s» not found in table «%s»."), field_name, table_name);
+			return FALSE;
+		}
+
+	key = g_strconcat (field->table_name, ".", field->name, NULL);
+	if (g_hash_table_contains (priv->ht_show, key))
+		{
+			g_free (key);
+			return FALSE;
+		}
+	g_hash_table_add (priv->ht_show, key);
+
+	choice = g_new0 (GdaExQueryEditorShowChoice, 1);
+	choice->table_name = g_strdup (field->table_name);
+	choice->field_name = g_strdup (field->name);
+	choice->alias = g_strdup (alias != NULL ? alias : "");
+	g_ptr_array_add (priv->show, choice);
+
+	return TRUE;
+}
+
+/**
+ * gdaex_query_editor_model_add_where:
+ * @model: a #GdaExQueryEditorModel object.
+ * @parent: (nullable): a group returned by a previous call, or #NULL for the
+ * first level.
+ * @choice: the condition, or the group if @choice->is_group is #TRUE; it is
+ * copied.
+ *
+ * Returns: (transfer none): the node of the condition, or #NULL on error.
+ */
+GNode
+*gdaex_query_editor_model_add_where (GdaExQueryEditorModel *model,
+                                     GNode *parent,
+                                     const GdaExQueryEditorWhereChoice *choice)
+{
+	GdaExQueryEditorWhereChoice *_choice;
+
+	g_return_val_if_fail (GDAEX_IS_QUERY_EDITOR_MODEL (model), NULL);
+	g_return_val_if_fail (choice != NULL, NULL);
+
+	GdaExQueryEditorModelPrivate *priv = GDAEX_QUERY_EDITOR_MODEL_GET_PRIVATE (model);
+
+	if (parent == NULL)
+		{
+			parent = priv->where;
+		}
+	else if (parent->data == NULL
+	         || !((GdaExQueryEditorWhereChoice *)parent->data)->is_group)
+		{
+			g_warning (_("Conditions can be added only to a group."));
+			return NULL;
+		}
+
+	if (!choice->is_group
+	    && gdaex_query_editor_model_get_field (model, choice->table_name, choice->field_name) == NULL)
+		{
+			g_warning (_("Field «%s» not found in table «%s»."), choice->field_name, choice->table_name);
+			return NULL;
+		}
+
+	_choice = g_new0 (GdaExQueryEditorWhereChoice, 1);
+	_choice->link_type = choice->link_type;
+	_choice->is_group = choice->is_group;
+	_choice->not = choice->not;
+	if (!choice->is_group)
+		{
+			_choice->table_name = g_strdup (choice->table_name);
+			_choice->field_name = g_strdup (choice->field_name);
+			_choice->where_type = choice->where_type;
+			_choice->from = g_strdup (choice->from);
+			_choice->from_visible = g_strdup (choice->from_visible);
+			_choice->from_sql = g_strdup (choice->from_sql);
+			_choice->to = g_strdup (choice->to);
+			_choice->to_visible = g_strdup (choice->to_visible);
+			_choice->to_sql = g_strdup (choice->to_sql);
+		}
+
+	return g_node_append_data (parent, _choice);
+}
+
+/**
+ * gdaex_query_editor_model_add_order:
+ * @model: a #GdaExQueryEditorModel object.
+ * @table_name:
+ * @field_name:
+ * @order:
+ *
+ * Returns: #TRUE if the field is added, #FALSE if it doesn't exist or it is
+ * already ordered.
+ */
+gboolean
+gdaex_query_editor_model_add_order (GdaExQueryEditorModel *model,
+                                    const gchar *table_name,
+                                    const gchar *field_name,
+                                    GdaExQueryEditorOrderType order)
+{
+	const GdaExQueryEditorField *field;
+	GdaExQueryEditorOrderChoice *choice;
+	gchar *key;
+
+	g_return_val_if_fail (GDAEX_IS_QUERY_EDITOR_MODEL (model), FALSE);
+
+	GdaExQueryEditorModelPrivate *priv = GDAEX_QUERY_EDITOR_MODEL_GET_PRIVATE (model);
+
+	field = gdaex_query_editor_model_get_field (model, table_name, field_name);
+	if (field == NULL)
+		{
+			g_warning (_("Field «%s» not found in table «%s»."), field_name, table_name);
+			return FALSE;
+		}
+
+	key = g_strconcat (field->table_name, ".", field->name, NULL);
+	if (g_hash_table_contains (priv->ht_order, key))
+		{
+			g_free (key);
+			return FALSE;
+		}
+	g_hash_table_add (priv->ht_order, key);
+
+	choice = g_new0 (GdaExQueryEditorOrderChoice, 1);
+	choice->table_name = g_strdup (field->table_name);
+	choice->field_name = g_strdup (field->name);
+	choice->order = order;
+	g_ptr_array_add (priv->order, choice);
+
+	return TRUE;
+}
+
+/**
+ * gdaex_query_editor_model_get_show:
+ * @model: a #GdaExQueryEditorModel object.
+ *
+ * Returns: (transfer none) (element-type GdaExQueryEditorShowChoice): the
+ * fields to show, in order.
+ */
+GPtrArray
+*gdaex_query_editor_model_get_show (GdaExQueryEditorModel *model)
+{
+	g_return_val_if_fail (GDAEX_IS_QUERY_EDITOR_MODEL (model), NULL);
+
+	GdaExQueryEditorModelPrivate *priv = GDAEX_QUERY_EDITOR_MODEL_GET_PRIVATE (model);
+
+	return priv->show;
+}
+
+/**
+ * gdaex_query_editor_model_get_where:
+ * @model: a #GdaExQueryEditorModel object.
+ *
+ * Returns: (transfer none): the root of the conditions' tree; the root has
+ * no data, its children have #GdaExQueryEditorWhereChoice data.
+ */
+GNode
+*gdaex_query_editor_model_get_where (GdaExQueryEditorModel *model)
+{
+	g_return_val_if_fail (GDAEX_IS_QUERY_EDITOR_MODEL (model), NULL);
+
+	GdaExQueryEditorModelPrivate *priv = GDAEX_QUERY_EDITOR_MODEL_GET_PRIVATE (model);
+
+	return priv->where;
+}
+
+/**
+ * gdaex_query_editor_model_get_order:
+ * @model: a #GdaExQueryEditorModel object.
+ *
+ * Returns: (transfer none) (element-type GdaExQueryEditorOrderChoice): the
+ * fields to order by, in order.
+ */
+GPtrArray
+*gdaex_query_editor_model_get_order (GdaExQueryEditorModel *model)
+{
+	g_return_val_if_fail (GDAEX_IS_QUERY_EDITOR_MODEL (model), NULL);
+
+	GdaExQueryEditorModelPrivate *priv = GDAEX_QUERY_EDITOR_MODEL_GET_PRIVATE (model);
+
+	return priv->order;
+}
+
+static GDate
+*gdaex_query_editor_model_get_gdate_from_sql (const gchar *sql)
+{
+	GDate *ret;
+
+	gint year;
+	gint month;
+	gint day;
+
+	ret = NULL;
+
+	if (sql != NULL && strlen (sql) >= 11)
+		{
+			year = strtol (sql + 1, NULL, 10);
+			month = strtol (sql + 6, NULL, 10);
+			day = strtol (sql + 9, NULL, 10);
+
+			if (g_date_valid_dmy (day, month, year))
+				{
+					ret = g_date_new_dmy (day, month, year);
+				}
+		}
+
+	return ret;
+}
+
+static GdaTimestamp
+*gdaex_query_editor_model_get_gdatimestamp_from_sql (const gchar *sql)
+{
+	GdaTimestamp *ret;
+
+	ret = NULL;
+
+	if (sql != NULL && strlen (sql) >= 11)
+		{
+			ret = g_new0 (GdaTimestamp, 1);
+
+			ret->year = strtol (sql + 1, NULL, 10);
+			ret->month = strtol (sql + 6, NULL, 10);
+			ret->day = strtol (sql + 9, NULL, 10);
+
+			if (strlen (sql) >= 17)
+				{
+					ret->hour = strtol (sql + 12, NULL, 10);
+					ret->minute = strtol (sql + 15, NULL, 10);
+					if (strlen (sql) >= 20)
+						{
+							ret->second = strtol (sql + 18, NULL, 10);
+						}
+				}
+		}
+
+	return ret;
+}
+
+/* the time part of a quoted datetime, as it comes from the iwidgets */
+static GdaTime
+*gdaex_query_editor_model_get_gdatime_from_sql (const gchar *sql)
+{
+	GdaTime *ret;
+
+	gchar *str;
+	gchar *p;
+	gint hour;
+	gint minute;
+	gint second;
+
+	ret = NULL;
+
+	if (sql == NULL)
+		{
+			return NULL;
+		}
+
+	str = g_strstrip (g_strdup (sql));
+	g_strdelimit (str, "'", ' ');
+	g_strstrip (str);
+
+	p = strrchr (str, ' ');
+	p = (p != NULL ? p + 1 : str);
+	if (strlen (p) >= 5)
+		{
+			hour = strtol (p, NULL, 10);
+			minute = strtol (p + 3, NULL, 10);
+			second = (strlen (p) >= 8 ? strtol (p + 6, NULL, 10) : 0);
+
+			if (p[2] == ':'
+			    && hour >= 0 && hour < 24
+			    && minute >= 0 && minute < 60
+			    && second >= 0 && second < 60)
+				{
+					ret = g_new0 (GdaTime, 1);
+					ret->hour = hour;
+					ret->minute = minute;
+					ret->second = second;
+					ret->timezone = GDA_TIMEZONE_INVALID;
+				}
+		}
+
+	g_free (str);
+
+	return ret;
+}
+
+typedef struct
+	{
+		const GdaExQueryEditorTable *table;
+		GdaExQueryEditorRelation *relation;	/* the edge from the parent; NULL for a root */
+		gboolean reversed;	/* the parent is relation->table2 */
+		gboolean used;
+	} GdaExQueryEditorModelJoinStep;
+
+static void
+gdaex_query_editor_model_plan_add_table (GdaExQueryEditorModel *model,
+                                         GPtrArray *needed,
+                                         const gchar *table_name)
+{
+	const GdaExQueryEditorTable *table;
+	guint i;
+
+	table = gdaex_query_editor_model_get_table (model, table_name);
+	if (table == NULL)
+		{
+			return;
+		}
+
+	for (i = 0; i < needed->len; i++)
+		{
+			if (g_ptr_array_index (needed, i) == table)
+				{
+					return;
+				}
+		}
+	g_ptr_array_add (needed, (gpointer)table);
+}
+
+static void
+gdaex_query_editor_model_plan_add_where_tables (GdaExQueryEditorModel *model,
+                                                GPtrArray *needed,
+                                                GNode *node)
+{
+	GNode *child;
+	GdaExQueryEditorWhereChoice *choice;
+
+	for (child = node->children; child != NULL; child = child->next)
+		{
+			choice = (GdaExQueryEditorWhereChoice *)child->data;
+			if (choice->is_group)
+				{
+					gdaex_query_editor_model_plan_add_where_tables (model, needed, child);
+				}
+			else
+				{
+					gdaex_query_editor_model_plan_add_table (model, needed, choice->table_name);
+				}
+		}
+}
+
+/* breadth first visit of the relations from root: steps are returned in
+ * visit order, so every table comes after its parent. A LEFT relation
+ * walked from its optional side is taken only when no other path reaches
+ * its table: every table is at the minimum number of such walks from root,
+ * and then at the minimum number of joins */
+static GPtrArray
+*gdaex_query_editor_model_plan_visit (GdaExQueryEditorModel *model,
+                                      const GdaExQueryEditorTable *root,
+                                      GHashTable *ht_steps)
+{
+	GPtrArray *steps;
+	GdaExQueryEditorModelJoinStep *step;
+	GdaExQueryEditorModelJoinStep *next;
+	GdaExQueryEditorRelation *relation;
+	const GdaExQueryEditorTable *other;
+	GSList *relations;
+	GSList *deferred;
+	GSList *cur;
+	gboolean reversed;
+	gboolean added;
+	guint start;
+	guint i;
+
+	GdaExQueryEditorModelPrivate *priv = GDAEX_QUERY_EDITOR_MODEL_GET_PRIVATE (model);
+
+	steps = g_ptr_array_new_with_free_func (g_free);
+
+	step = g_new0 (GdaExQueryEditorModelJoinStep, 1);
+	step->table = root;
+	g_ptr_array_add (steps, step);
+	g_hash_table_insert (ht_steps, (gpointer)root, step);
+
+	start = 0;
+	do
+		{
+			deferred = NULL;
+			for (i = start; i < steps->len; i++)
+				{
+					step = (GdaExQueryEditorModelJoinStep *)g_ptr_array_index (steps, i);
+
+					for (relations = gdaex_query_editor_schema_get_relations (priv->schema); relations != NULL; relations = g_slist_next (relations))
+						{
+							relation = (GdaExQueryEditorRelation *)relations->data;
+
+							if (relation->table1 == step->table)
+								{
+									other = relation->table2;
+									reversed = FALSE;
+								}
+							else if (relation->table2 == step->table)
+								{
+									other = relation->table1;
+									reversed = TRUE;
+								}
+							else
+								{
+									continue;
+								}
+
+							if (g_hash_table_lookup (ht_steps, other) != NULL)
+								{
+									continue;
+								}
+
+							next = g_new0 (GdaExQueryEditorModelJoinStep, 1);
+							next->table = other;
+							next->relation = relation;
+							next->reversed = reversed;
+
+							/* tried after every path that doesn't need it */
+							if (reversed && relation->join_type == GDAEX_QE_JOIN_TYPE_LEFT)
+								{
+									deferred = g_slist_append (deferred, next);
+									continue;
+								}
+
+							g_ptr_array_add (steps, next);
+							g_hash_table_insert (ht_steps, (gpointer)other, next);
+						}
+				}
+
+			/* the tables reachable only through a reversed LEFT relation
+			 * start the next round */
+			start = steps->len;
+			added = FALSE;
+			for (cur = deferred; cur != NULL; cur = g_slist_next (cur))
+				{
+					next = (GdaExQueryEditorModelJoinStep *)cur->data;
+					if (g_hash_table_lookup (ht_steps, next->table) != NULL)
+						{
+							g_free (next);
+							continue;
+						}
+
+					g_ptr_array_add (steps, next);
+					g_hash_table_insert (ht_steps, (gpointer)next->table, next);
+					added = TRUE;
+				}
+			g_slist_free (deferred);
+		} while (added);
+
+	return steps;
+}
+
+/* marks the steps on the paths from root to the needed tables;
+ * returns the number of needed tables not reachable from root */
+static guint
+gdaex_query_editor_model_plan_mark (GPtrArray *needed,
+                                    GHashTable *ht_steps,
+                                    guint *joins,
+                                    guint *reversed)
+{
+	GdaExQueryEditorModelJoinStep *step;
+	const GdaExQueryEditorTable *parent;
+	guint unreachable;
+	guint i;
+
+	unreachable = 0;
+	*joins = 0;
+	*reversed = 0;
+
+	for (i = 0; i < needed->len; i++)
+		{
+			step = (GdaExQueryEditorModelJoinStep *)g_hash_table_lookup (ht_steps, g_ptr_array_index (needed, i));
+			if (step == NULL)
+				{
+					unreachable++;
+					continue;
+				}
+
+			while (step != NULL && !step->used)
+				{
+					step->used = TRUE;
+					if (step->relation == NULL)
+						{
+							break;
+						}
+
+					(*joins)++;
+					if (step->reversed && step->relation->join_type == GDAEX_QE_JOIN_TYPE_LEFT)
+						{
+							(*reversed)++;
+						}
+
+					parent = step->reversed ? step->relation->table2 : step->relation->table1;
+					step = (GdaExQueryEditorModelJoinStep *)g_hash_table_lookup (ht_steps, parent);
+				}
+		}
+
+	return unreachable;
+}
+
+/* chooses, between the needed tables, the root that reaches all the others
+ * without walking a LEFT relation from its optional side, and with less joins:
+ * the preserved table of a LEFT JOIN has to come before the other one */
+static GPtrArray
+*gdaex_query_editor_model_plan_joins (GdaExQueryEditorModel *model,
+                                      GPtrArray *needed)
+{
+	GPtrArray *best;
+	GPtrArray *steps;
+	GHashTable *ht_steps;
+
+	guint best_unreachable;
+	guint best_joins;
+	guint best_reversed;
+	guint unreachable;
+	guint joins;
+	guint reversed;
+	guint i;
+
+	best = NULL;
+	best_unreachable = G_MAXUINT;
+	best_joins = G_MAXUINT;
+	best_reversed = G_MAXUINT;
+
+	for (i = 0; i < needed->len; i++)
+		{
+			ht_steps = g_hash_table_new (g_direct_hash, g_direct_equal);
+			steps = gdaex_query_editor_model_plan_visit (model, g_ptr_array_index (needed, i), ht_steps);
+			unreachable = gdaex_query_editor_model_plan_mark (needed, ht_steps, &joins, &reversed);
+			g_hash_table_destroy (ht_steps);
+
+			if (unreachable < best_unreachable
+			    || (unreachable == best_unreachable && reversed < best_reversed)
+			    || (unreachable == best_unreachable && reversed == best_reversed && joins < best_joins))
+				{
+					if (best != NULL)
+						{
+							g_ptr_array_unref (best);
+						}
+					best = steps;
+					best_unreachable = unreachable;
+					best_joins = joins;
+					best_reversed = reversed;
+				}
+			else
+				{
+					g_ptr_array_unref (steps);
+				}
+		}
+
+	return best;
+}
+
+static guint
+gdaex_query_editor_model_plan_join_cond (GdaSqlBuilder *sqlbuilder,
+                                         const gchar *table1,
+                                         GSList *fields1,
+                                         const gchar *table2,
+                                         GSList *fields2)
+{
+	guint id_cond;
+	guint id_eq;
+
+	gchar *str;
+
+	id_cond = 0;
+	while (fields1 != NULL && fields2 != NULL)
+		{
+			str = g_strconcat (table1, ".", ((GdaExQueryEditorField *)fields1->data)->name, NULL);
+			id_eq = gda_sql_builder_add_id (sqlbuilder, str);
+			g_free (str);
+			str = g_strconcat (table2, ".", ((GdaExQueryEditorField *)fields2->data)->name, NULL);
+			id_eq = gda_sql_builder_add_cond (sqlbuilder, GDA_SQL_OPERATOR_TYPE_EQ,
+			                                  id_eq, gda_sql_builder_add_id (sqlbuilder, str), 0);
+			g_free (str);
+
+			id_cond = (id_cond == 0 ? id_eq : gda_sql_builder_add_cond (sqlbuilder, GDA_SQL_OPERATOR_TYPE_AND, id_cond, id_eq, 0));
+
+			fields1 = g_slist_next (fields1);
+			fields2 = g_slist_next (fields2);
+		}
+
+	return id_cond;
+}
+
+/* adds every table in needed once, joined through the shortest relation
+ * paths; relations towards tables without shown, filtered or ordered
+ * fields are skipped.
+ * returns a table name => target id hash table; NULL if a LEFT relation
+ * can only be reached from its optional side (it would need a RIGHT JOIN,
+ * that not every provider has) */
+static GHashTable
+*gdaex_query_editor_model_add_targets_to_gdasqlbuilder (GdaExQueryEditorModel *model,
+                                                        GdaSqlBuilder *sqlbuilder,
+                                                        GPtrArray *needed)
+{
+	GHashTable *ht_targets;
+	GPtrArray *steps;
+	GdaExQueryEditorModelJoinStep *step;
+	const GdaExQueryEditorTable *table;
+	const GdaExQueryEditorTable *parent;
+
+	guint id_target;
+	guint id_parent;
+	GdaSqlSelectJoinType join_type;
+	guint i;
+
+	ht_targets = g_hash_table_new (g_str_hash, g_str_equal);
+
+	while (needed->len > 0)
+		{
+			steps = gdaex_query_editor_model_plan_joins (model, needed);
+
+			for (i = 0; i < steps->len; i++)
+				{
+					step = (GdaExQueryEditorModelJoinStep *)g_ptr_array_index (steps, i);
+					if (!step->used)
+						{
+							continue;
+						}
+
+					id_target = gda_sql_builder_select_add_target_id (sqlbuilder,
+					                                                  gda_sql_builder_add_id (sqlbuilder, step->table->name),
+					                                                  NULL);
+					g_hash_table_insert (ht_targets, step->table->name, GUINT_TO_POINTER (id_target));
+					g_ptr_array_remove (needed, (gpointer)step->table);
+
+					if (step->relation == NULL)
+						{
+							continue;
+						}
+
+					parent = step->reversed ? step->relation->table2 : step->relation->table1;
+					id_parent = GPOINTER_TO_UINT (g_hash_table_lookup (ht_targets, parent->name));
+
+					if (step->relation->join_type == GDAEX_QE_JOIN_TYPE_LEFT)
+						{
+							if (step->reversed)
+								{
+									g_warning (_("The tables «%s» and «%s» can't be joined: no choice of the first table keeps «%s» before «%s» in their LEFT JOIN."),
+									           step->relation->table1->name, step->relation->table2->name,
+									           step->relation->table1->name, step->relation->table2->name);
+									g_ptr_array_unref (steps);
+									g_hash_table_destroy (ht_targets);
+									return NULL;
+								}
+							join_type = GDA_SQL_SELECT_JOIN_LEFT;
+						}
+					else
+						{
+							join_type = GDA_SQL_SELECT_JOIN_INNER;
+						}
+
+					gda_sql_builder_select_join_targets (sqlbuilder, id_parent, id_target, join_type,
+					                                     gdaex_query_editor_model_plan_join_cond (sqlbuilder,
+					                                                                              step->relation->table1->name,
+					                                                                              step->relation->fields1,
+					                                                                              step->relation->table2->name,
+					                                                                              step->relation->fields2));
+				}
+
+			/* the tables not reachable from the chosen root start a new tree */
+			g_ptr_array_unref (steps);
+		}
+
+	return ht_targets;
+}
+
+/* the GValue of str for field; NULL if str isn't valid */
+static GValue
+*gdaex_query_editor_model_sql_gvalue (const GdaExQueryEditorField *field,
+                                      const gchar *str)
+{
+	GValue *gval;
+	GDate *gdate;
+	GdaTimestamp *gdatimestamp;
+	GdaTime *gdatime;
+
+	gval = NULL;
+
+	switch (field->type)
+		{
+			case GDAEX_QE_FIELD_TYPE_TEXT:
+				gval = gda_value_new (G_TYPE_STRING);
+				g_value_set_string (gval, str);
+				break;
+
+			case GDAEX_QE_FIELD_TYPE_INTEGER:
+				gval = gda_value_new (G_TYPE_INT);
+				g_value_set_int (gval, strtol (str, NULL, 10));
+				break;
+
+			case GDAEX_QE_FIELD_TYPE_BOOLEAN:
+				gval = gda_value_new (G_TYPE_BOOLEAN);
+				g_value_set_boolean (gval, zak_utils_string_to_boolean (str));
+				break;
+
+			case GDAEX_QE_FIELD_TYPE_DOUBLE:
+				gval = gda_value_new (G_TYPE_DOUBLE);
+				g_value_set_double (gval, g_strtod (str, NULL));
+				break;
+
+			case GDAEX_QE_FIELD_TYPE_DATE:
+				gdate = gdaex_query_editor_model_get_gdate_from_sql (str);
+				if (gdate != NULL)
+					{
+						gval = gda_value_new (G_TYPE_DATE);
+						g_value_take_boxed (gval, gdate);
+					}
+				break;
+
+			case GDAEX_QE_FIELD_TYPE_DATETIME:
+				gdatimestamp = gdaex_query_editor_model_get_gdatimestamp_from_sql (str);
+				if (gdatimestamp != NULL)
+					{
+						gval = gda_value_new (GDA_TYPE_TIMESTAMP);
+						gda_value_set_timestamp (gval, gdatimestamp);
+						g_free (gdatimestamp);
+					}
+				break;
+
+			case GDAEX_QE_FIELD_TYPE_TIME:
+				gdatime = gdaex_query_editor_model_get_gdatime_from_sql (str);
+				if (gdatime != NULL)
+					{
+						gval = gda_value_new (GDA_TYPE_TIME);
+						gda_value_set_time (gval, gdatime);
+						g_free (gdatime);
+					}
+				break;
+		}
+
+	return gval;
+}
+
+/* with values != NULL the value is added as a parameter and gval is
+ * appended to values, otherwise it is added as a literal and freed */
+static guint
+gdaex_query_editor_model_sql_value (GdaSqlBuilder *sqlbuilder,
+                                    GValue *gval,
+                                    GPtrArray *values)
+{
+	guint id_value;
+
+	gchar *param_name;
+
+	if (values != NULL)
+		{
+			param_name = g_strdup_printf ("gdaex_qe_%u", values->len);
+			id_value = gda_sql_builder_add_param (sqlbuilder, param_name, G_VALUE_TYPE (gval), FALSE);
+			g_free (param_name);
+
+			g_ptr_array_add (values, gval);
+		}
+	else
+		{
+			id_value = gda_sql_builder_add_expr_value (sqlbuilder, NULL, gval);
+			gda_value_free (gval);
+		}
+
+	return id_value;
+}
+
+static guint
+gdaex_query_editor_model_sql_where_cond (GdaExQueryEditorModel *model,
+                                         GdaSqlBuilder *sqlbuilder,
+                                         GdaExQueryEditorWhereChoice *choice,
+                                         GPtrArray *values)
+{
+	const GdaExQueryEditorField *field;
+
+	GdaSqlOperatorType where_op;
+	gboolean case_insensitive;
+	gboolean lower;
+	const gchar *provider;
+	const gchar *column;
+
+	gchar *from_str;
+	gchar *to_str;
+	gchar *str;
+
+	GValue *gval1;
+	GValue *gval2;
+
+	guint id_field;
+	guint id_value1;
+	guint id_value2;
+	guint id_cond;
+
+	GdaExQueryEditorModelPrivate *priv = GDAEX_QUERY_EDITOR_MODEL_GET_PRIVATE (model);
+
+	field = gdaex_query_editor_model_get_field (model, choice->table_name, choice->field_name);
+	if (field == NULL)
+		{
+			g_warning (_("Field «%s» not found in table «%s»."), choice->field_name, choice->table_name);
+			return 0;
+		}
+
+	switch (choice->where_type)
+		{
+			case GDAEX_QE_WHERE_TYPE_EQUAL:
+				where_op = GDA_SQL_OPERATOR_TYPE_EQ;
+				break;
+
+			case GDAEX_QE_WHERE_TYPE_STARTS:
+			case GDAEX_QE_WHERE_TYPE_CONTAINS:
+			case GDAEX_QE_WHERE_TYPE_ENDS:
+			case GDAEX_QE_WHERE_TYPE_ISTARTS:
+			case GDAEX_QE_WHERE_TYPE_ICONTAINS:
+			case GDAEX_QE_WHERE_TYPE_IENDS:
+				where_op = GDA_SQL_OPERATOR_TYPE_LIKE;
+				break;
+
+			case GDAEX_QE_WHERE_TYPE_GREAT:
+				where_op = GDA_SQL_OPERATOR_TYPE_GT;
+				break;
+
+			case GDAEX_QE_WHERE_TYPE_GREAT_EQUAL:
+				where_op = GDA_SQL_OPERATOR_TYPE_GEQ;
+				break;
+
+			case GDAEX_QE_WHERE_TYPE_LESS:
+				where_op = GDA_SQL_OPERATOR_TYPE_LT;
+				break;
+
+			case GDAEX_QE_WHERE_TYPE_LESS_EQUAL:
+				where_op = GDA_SQL_OPERATOR_TYPE_LEQ;
+				break;
+
+			case GDAEX_QE_WHERE_TYPE_BETWEEN:
+				where_op = GDA_SQL_OPERATOR_TYPE_BETWEEN;
+				break;
+
+			case GDAEX_QE_WHERE_TYPE_IS_NULL:
+				where_op = (choice->not ? GDA_SQL_OPERATOR_TYPE_ISNOTNULL : GDA_SQL_OPERATOR_TYPE_ISNULL);
+				break;
+
+			default:
+				g_warning (_("Where type «%d» not valid."), choice->where_type);
+				return 0;
+		}
+
+	case_insensitive = (choice->where_type == GDAEX_QE_WHERE_TYPE_ISTARTS
+	                    || choice->where_type == GDAEX_QE_WHERE_TYPE_ICONTAINS
+	                    || choice->where_type == GDAEX_QE_WHERE_TYPE_IENDS);
+
+	/* case insensitive conditions must not wrap the column in a function,
+	 * or no index can be used:
+	 * - a normalized column holds the field already lower-cased;
+	 * - PostgreSQL has ILIKE;
+	 * - LIKE is already case insensitive on SQLite (and it uses the index
+	 *   when the column is declared COLLATE NOCASE).
+	 * Elsewhere LOWER() on both sides is the fallback. */
+	column = field->name;
+	lower = FALSE;
+	if (case_insensitive)
+		{
+			provider = gdaex_get_provider (priv->gdaex);
+			if (field->normalized != NULL)
+				{
+					column = field->normalized;
+					lower = TRUE;
+				}
+			else if (g_ascii_strcasecmp (provider, "PostgreSQL") == 0)
+				{
+					where_op = GDA_SQL_OPERATOR_TYPE_ILIKE;
+				}
+			else if (g_ascii_strcasecmp (provider, "SQLite") != 0
+			         && g_ascii_strcasecmp (provider, "SQLCipher") != 0)
+				{
+					lower = TRUE;
+				}
+		}
+
+	if (choice->from_sql == NULL)
+		{
+			from_str = g_strdup ("");
+		}
+	else if (lower)
+		{
+			from_str = g_utf8_strdown (choice->from_sql, -1);
+		}
+	else
+		{
+			from_str = g_strdup (choice->from_sql);
+		}
+
+	to_str = NULL;
+	if (choice->to_sql != NULL)
+		{
+			to_str = g_strstrip (lower ? g_utf8_strdown (choice->to_sql, -1) : g_strdup (choice->to_sql));
+			if (g_strcmp0 (to_str, "") == 0)
+				{
+					g_free (to_str);
+					to_str = NULL;
+				}
+		}
+
+	if (case_insensitive || where_op == GDA_SQL_OPERATOR_TYPE_LIKE)
+		{
+			str = g_strconcat (choice->where_type & (GDAEX_QE_WHERE_TYPE_STARTS | GDAEX_QE_WHERE_TYPE_ISTARTS) ? "" : "%",
+			                   from_str,
+			                   choice->where_type & (GDAEX_QE_WHERE_TYPE_ENDS | GDAEX_QE_WHERE_TYPE_IENDS) ? "" : "%",
+			                   NULL);
+			g_free (from_str);
+			from_str = str;
+			if (to_str != NULL)
+				{
+					str = g_strconcat (choice->where_type & (GDAEX_QE_WHERE_TYPE_STARTS | GDAEX_QE_WHERE_TYPE_ISTARTS) ? "" : "%",
+					                   to_str,
+					                   choice->where_type & (GDAEX_QE_WHERE_TYPE_ENDS | GDAEX_QE_WHERE_TYPE_IENDS) ? "" : "%",
+					                   NULL);
+					g_free (to_str);
+					to_str = str;
+				}
+		}
+
+	/* both values are checked before adding any of them: a condition
+	 * without a valid value is skipped */
+	gval1 = NULL;
+	gval2 = NULL;
+	if (choice->where_type != GDAEX_QE_WHERE_TYPE_IS_NULL)
+		{
+			gval1 = gdaex_query_editor_model_sql_gvalue (field, from_str);
+			if (to_str != NULL)
+				{
+					gval2 = gdaex_query_editor_model_sql_gvalue (field, to_str);
+				}
+
+			if (gval1 == NULL
+			    || (to_str != NULL && gval2 == NULL)
+			    || (where_op == GDA_SQL_OPERATOR_TYPE_BETWEEN && gval2 == NULL))
+				{
+					g_warning (_("Value not valid for field «%s» of table «%s»: the condition is skipped."),
+					           choice->field_name, choice->table_name);
+					if (gval1 != NULL)
+						{
+							gda_value_free (gval1);
+						}
+					if (gval2 != NULL)
+						{
+							gda_value_free (gval2);
+						}
+					g_free (from_str);
+					g_free (to_str);
+					return 0;
+				}
+		}
+
+	g_free (from_str);
+	g_free (to_str);
+
+	str = g_strconcat (lower && column == field->name ? "LOWER(" : "",
+	                   field->table_name, ".", column,
+	                   lower && column == field->name ? ")" : "",
+	                   NULL);
+	id_field = gda_sql_builder_add_id (sqlbuilder, str);
+	g_free (str);
+
+	id_value1 = 0;
+	id_value2 = 0;
+	if (gval1 != NULL)
+		{
+			id_value1 = gdaex_query_editor_model_sql_value (sqlbuilder, gval1, values);
+		}
+	if (gval2 != NULL)
+		{
+			id_value2 = gdaex_query_editor_model_sql_value (sqlbuilder, gval2, values);
+		}
+
+	id_cond = gda_sql_builder_add_cond (sqlbuilder, where_op, id_field, id_value1, id_value2);
+	if (id_cond == 0)
+		{
+			g_warning (_("Unable to create GdaSqlBuilder condition."));
+			return 0;
+		}
+
+	if (choice->not && choice->where_type != GDAEX_QE_WHERE_TYPE_IS_NULL)
+		{
+			id_cond = gda_sql_builder_add_cond (sqlbuilder, GDA_SQL_OPERATOR_TYPE_NOT, id_cond, 0, 0);
+		}
+
+	return id_cond;
+}
+
+static guint
+gdaex_query_editor_model_sql_where (GdaExQueryEditorModel *model,
+                                    GdaSqlBuilder *sqlbuilder,
+                                    GNode *node,
+                                    GPtrArray *values)
+{
+	guint id_ret;
+	guint id_cond;
+
+	GNode *child;
+	GdaExQueryEditorWhereChoice *choice;
+
+	id_ret = 0;
+
+	for (child = node->children; child != NULL; child = child->next)
+		{
+			choice = (GdaExQueryEditorWhereChoice *)child->data;
+
+			if (choice->is_group)
+				{
+					id_cond = gdaex_query_editor_model_sql_where (model, sqlbuilder, child, values);
+					if (id_cond != 0 && choice->not)
+						{
+							id_cond = gda_sql_builder_add_cond (sqlbuilder, GDA_SQL_OPERATOR_TYPE_NOT, id_cond, 0, 0);
+						}
+				}
+			else
+				{
+					id_cond = gdaex_query_editor_model_sql_where_cond (model, sqlbuilder, choice, values);
+				}
+
+			if (id_cond == 0)
+				{
+					continue;
+				}
+
+			if (id_ret == 0)
+				{
+					id_ret = id_cond;
+				}
+			else
+				{
+					id_ret = gda_sql_builder_add_cond (sqlbuilder,
+					                                   choice->link_type == GDAEX_QE_LINK_TYPE_OR ? GDA_SQL_OPERATOR_TYPE_OR : GDA_SQL_OPERATOR_TYPE_AND,
+					                                   id_ret, id_cond, 0);
+				}
+		}
+
+	return id_ret;
+}
+
+/* with for_count the select list is only a constant and there is no
+ * ORDER BY: it is the subquery of gdaex_query_editor_model_count_async() */
+static GdaSqlBuilder
+*gdaex_query_editor_model_build_sql (GdaExQueryEditorModel *model,
+                                     GPtrArray *values,
+                                     gboolean for_count)
+{
+	GdaSqlBuilder *sqlbuilder;
+
+	GdaExQueryEditorShowChoice *show;
+	GdaExQueryEditorOrderChoice *order;
+	const GdaExQueryEditorField *field;
+
+	GPtrArray *needed;
+	GHashTable *ht_targets;
+	GHashTable *ht_decodes;
+
+	guint i;
+	guint id_cond;
+
+	guint id_target1;
+	guint id_target2;
+	guint id_join1;
+	guint id_join2;
+	guint join_cond;
+
+	gchar *str;
+
+	GdaExQueryEditorModelPrivate *priv = GDAEX_QUERY_EDITOR_MODEL_GET_PRIVATE (model);
+
+	sqlbuilder = gda_sql_builder_new (GDA_SQL_STATEMENT_SELECT);
+
+	/* FROM: only the tables of shown, filtered and ordered fields */
+	needed = g_ptr_array_new ();
+	for (i = 0; i < priv->show->len; i++)
+		{
+			show = (GdaExQueryEditorShowChoice *)g_ptr_array_index (priv->show, i);
+			gdaex_query_editor_model_plan_add_table (model, needed, show->table_name);
+		}
+	gdaex_query_editor_model_plan_add_where_tables (model, needed, priv->where);
+	for (i = 0; i < priv->order->len; i++)
+		{
+			order = (GdaExQueryEditorOrderChoice *)g_ptr_array_index (priv->order, i);
+			gdaex_query_editor_model_plan_add_table (model, needed, order->table_name);
+		}
+
+	ht_targets = gdaex_query_editor_model_add_targets_to_gdasqlbuilder (model, sqlbuilder, needed);
+	g_ptr_array_unref (needed);
+	if (ht_targets == NULL)
+		{
+			g_object_unref (sqlbuilder);
+			return NULL;
+		}
+
+	/* SHOW */
+	ht_decodes = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+	for (i = 0; i < priv->show->len; i++)
+		{
+			show = (GdaExQueryEditorShowChoice *)g_ptr_array_index (priv->show, i);
+
+			field = gdaex_query_editor_model_get_field (model, show->table_name, show->field_name);
+			if (field == NULL)
+				{
+					continue;
+				}
+
+			if (field->decode_table2 != NULL)
+				{
+					/* more fields decoded through the same table share one join */
+					if (g_hash_table_lookup (ht_targets, field->decode_table2) == NULL)
+						{
+							id_target1 = GPOINTER_TO_UINT (g_hash_table_lookup (ht_targets, field->table_name));
+							id_target2 = gda_sql_builder_select_add_target_id (sqlbuilder,
+							                                                   gda_sql_builder_add_id (sqlbuilder, field->decode_table2),
+							                                                   NULL);
+							g_hash_table_insert (ht_targets, field->decode_table2, GUINT_TO_POINTER (id_target2));
+							g_hash_table_add (ht_decodes, g_strdup (field->decode_table2));
+
+							str = g_strconcat (field->table_name, ".", field->name, NULL);
+							id_join1 = gda_sql_builder_add_id (sqlbuilder, str);
+							g_free (str);
+							str = g_strconcat (field->decode_table2, ".", field->decode_field2, NULL);
+							id_join2 = gda_sql_builder_add_id (sqlbuilder, str);
+							g_free (str);
+
+							join_cond = gda_sql_builder_add_cond (sqlbuilder, GDA_SQL_OPERATOR_TYPE_EQ,
+							                                      id_join1, id_join2, 0);
+
+							gda_sql_builder_select_join_targets (sqlbuilder, id_target1, id_target2,
+							                                     field->decode_join_type == GDAEX_QE_JOIN_TYPE_LEFT ? GDA_SQL_SELECT_JOIN_LEFT : GDA_SQL_SELECT_JOIN_INNER,
+							                                     join_cond);
+						}
+					else if (!g_hash_table_contains (ht_decodes, field->decode_table2))
+						{
+							g_warning (_("Table «%s» is already in the query: decode of field «%s.%s» uses it without join."),
+							           field->decode_table2, field->table_name, field->name);
+						}
+
+					if (!for_count)
+						{
+							gda_sql_builder_select_add_field (sqlbuilder, field->decode_field_to_show,
+							                                  field->decode_table2,
+							                                  g_strcmp0 (show->alias, "") != 0 ? show->alias : field->decode_field_alias);
+						}
+				}
+			else if (!for_count)
+				{
+					gda_sql_builder_select_add_field (sqlbuilder, field->name, field->table_name,
+					                                  g_strcmp0 (show->alias, "") != 0 ? show->alias : field->alias);
+				}
+		}
+	g_hash_table_destroy (ht_decodes);
+
+	/* the decode joins are kept: an inner one can filter rows */
+	if (for_count)
+		{
+			gda_sql_builder_add_field_value_id (sqlbuilder,
+			                                    gda_sql_builder_add_expr (sqlbuilder, NULL, G_TYPE_INT, 1),
+			                                    0);
+		}
+	g_hash_table_destroy (ht_targets);
+
+	/* WHERE */
+	id_cond = gdaex_query_editor_model_sql_where (model, sqlbuilder, priv->where, values);
+	if (id_cond != 0)
+		{
+			gda_sql_builder_set_where (sqlbuilder, id_cond);
+		}
+
+	/* ORDER */
+	for (i = 0; !for_count && i < priv->order->len; i++)
+		{
+			order = (GdaExQueryEditorOrderChoice *)g_ptr_array_index (priv->order, i);
+
+			field = gdaex_query_editor_model_get_field (model, order->table_name, order->field_name);
+			if (field == NULL)
+				{
+					continue;
+				}
+
+			gda_sql_builder_select_order_by (sqlbuilder,
+			                                 gda_sql_builder_add_id (sqlbuilder, field->name),
+			                                 order->order == GDAEX_QE_ORDER_ASC,
+			                                 NULL);
+		}
+
+	return sqlbuilder;
+}
+
+/**
+ * gdaex_query_editor_model_get_sql_as_gdasqlbuilder:
+ * @model: a #GdaExQueryEditorModel object.
+ *
+ * Every table is added once to the FROM clause. Tables are joined along
+ * the shortest path of relations, and only the tables with shown, filtered
+ * or ordered fields (and the ones between them) are joined.
+ *
+ * Returns: (transfer full): a #GdaSqlBuilder with the SELECT of the current
+ * choices; #NULL if the tables can't be joined.
+ */
+GdaSqlBuilder
+*gdaex_query_editor_model_get_sql_as_gdasqlbuilder (GdaExQueryEditorModel *model)
+{
+	g_return_val_if_fail (GDAEX_IS_QUERY_EDITOR_MODEL (model), NULL);
+
+	return gdaex_query_editor_model_build_sql (model, NULL, FALSE);
+}
+
+/* the statement of sqlbuilder and its parameters set with values */
+static GdaStatement
+*gdaex_query_editor_model_builder_get_statement (GdaSqlBuilder *sqlbuilder,
+                                                 GPtrArray *values,
+                                                 GdaSet **params)
+{
+	GdaStatement *stmt;
+	GdaHolder *holder;
+	GError *error;
+
+	gchar *param_name;
+	guint i;
+
+	*params = NULL;
+
+	error = NULL;
+	stmt = gda_sql_builder_get_statement (sqlbuilder, &error);
+	if (stmt == NULL || error != NULL)
+		{
+			g_warning (_("Unable to create GdaStatement: %s."),
+			           error != NULL && error->message != NULL ? error->message : _("no details"));
+			g_clear_error (&error);
+			return NULL;
+		}
+
+	if (values->len > 0)
+		{
+			if (!gda_statement_get_parameters (stmt, params, &error)
+			    || *params == NULL)
+				{
+					g_warning (_("Unable to get the parameters of the statement: %s"),
+					           error != NULL && error->message != NULL ? error->message : _("no details"));
+					g_clear_error (&error);
+					g_object_unref (stmt);
+					return NULL;
+				}
+
+			for (i = 0; i < values->len; i++)
+				{
+					param_name = g_strdup_printf ("gdaex_qe_%u", i);
+					holder = gda_set_get_holder (*params, param_name);
+					g_free (param_name);
+
+					if (holder == NULL
+					    || !gda_holder_set_value (holder, (GValue *)g_ptr_array_index (values, i), &error))
+						{
+							g_warning (_("Unable to set the value of parameter %u: %s"), i,
+							           error != NULL && error->message != NULL ? error->message : _("no details"));
+							g_clear_error (&error);
+						}
+				}
+		}
+
+	return stmt;
+}
+
+/**
+ * gdaex_query_editor_model_get_statement:
+ * @model: a #GdaExQueryEditorModel object.
+ * @params: (out) (transfer full): the parameters of the statement, already
+ * set with the values of the conditions; #NULL if the statement has none.
+ *
+ * Like gdaex_query_editor_model_get_sql_as_gdasqlbuilder(), but every value
+ * of the conditions is a parameter, typed from the type of its field,
+ * instead of a literal.
+ * The same choices with different values give the same #GdaStatement
+ * object, so once prepared (see gdaex_prepare_statement()) its plan is
+ * reused by the database.
+ *
+ * Returns: (transfer full): a #GdaStatement; #NULL on error.
+ */
+GdaStatement
+*gdaex_query_editor_model_get_statement (GdaExQueryEditorModel *model, GdaSet **params)
+{
+	GdaSqlBuilder *sqlbuilder;
+	GdaStatement *stmt;
+	GdaStatement *stmt_cached;
+	GPtrArray *values;
+	gchar *key;
+
+	g_return_val_if_fail (GDAEX_IS_QUERY_EDITOR_MODEL (model), NULL);
+	g_return_val_if_fail (params != NULL, NULL);
+
+	GdaExQueryEditorModelPrivate *priv = GDAEX_QUERY_EDITOR_MODEL_GET_PRIVATE (model);
+
+	values = g_ptr_array_new_with_free_func ((GDestroyNotify)gda_value_free);
+	sqlbuilder = gdaex_query_editor_model_build_sql (model, values, FALSE);
+	if (sqlbuilder == NULL)
+		{
+			g_ptr_array_unref (values);
+			*params = NULL;
+			return NULL;
+		}
+
+	stmt = gdaex_query_editor_model_builder_get_statement (sqlbuilder, values, params);
+
+	g_object_unref (sqlbuilder);
+	g_ptr_array_unref (values);
+
+	if (stmt == NULL)
+		{
+			return NULL;
+		}
+
+	/* the parameters have the same names and types: they fit the cached one */
+	key = gda_statement_serialize (stmt);
+	stmt_cached = (GdaStatement *)g_hash_table_lookup (priv->statements, key);
+	if (stmt_cached != NULL)
+		{
+			g_object_unref (stmt);
+			stmt = g_object_ref (stmt_cached);
+			g_free (key);
+		}
+	else
+		{
+			if (g_hash_table_size (priv->statements) >= GDAEX_QE_STATEMENTS_CACHE_SIZE)
+				{
+					g_hash_table_remove_all (priv->statements);
+				}
+			g_hash_table_insert (priv->statements, key, g_object_ref (stmt));
+		}
+
+	return stmt;
+}
+
+struct _GdaExQueryEditorValuesCacheEntry
+	{
+		GPtrArray *values;	/* GdaExQueryEditorValue */
+		gint64 expires;
+	};
+
+static void
+gdaex_query_editor_model_value_free (GdaExQueryEditorValue *value)
+{
+	g_free (value->value);
+	gda_value_free (value->gval);
+	g_free (value);
+}
+
+static void
+gdaex_query_editor_model_values_cache_entry_free (GdaExQueryEditorValuesCacheEntry *entry)
+{
+	g_ptr_array_unref (entry->values);
+	g_free (entry);
+}
+
+/* must be called with values_lock held */
+static void
+gdaex_query_editor_model_values_cache_put (GdaExQueryEditorModel *model,
+                                           const gchar *key,
+                                           GPtrArray *values)
+{
+	GHashTableIter iter;
+	GdaExQueryEditorValuesCacheEntry *entry;
+	gint64 oldest;
+	gint64 now;
+
+	GdaExQueryEditorModelPrivate *priv = GDAEX_QUERY_EDITOR_MODEL_GET_PRIVATE (model);
+
+	if (priv->values_ttl == 0)
+		{
+			return;
+		}
+
+	now = g_get_monotonic_time ();
+
+	/* drop the expired lists, then the oldest one if still full */
+	oldest = G_MAXINT64;
+	g_hash_table_iter_init (&iter, priv->values_cache);
+	while (g_hash_table_iter_next (&iter, NULL, (gpointer *)&entry))
+		{
+			if (entry->expires <= now)
+				{
+					g_hash_table_iter_remove (&iter);
+				}
+		}
+	if (g_hash_table_size (priv->values_cache) >= GDAEX_QE_VALUES_CACHE_SIZE)
+		{
+			g_hash_table_iter_init (&iter, priv->values_cache);
+			while (g_hash_table_iter_next (&iter, NULL, (gpointer *)&entry))
+				{
+					oldest = MIN (oldest, entry->expires);
+				}
+			g_hash_table_iter_init (&iter, priv->values_cache);
+			while (g_hash_table_iter_next (&iter, NULL, (gpointer *)&entry))
+				{
+					if (entry->expires == oldest)
+						{
+							g_hash_table_iter_remove (&iter);
+							break;
+						}
+				}
+		}
+
+	entry = g_new0 (GdaExQueryEditorValuesCacheEntry, 1);
+	entry->values = g_ptr_array_ref (values);
+	entry->expires = now + (gint64)priv->values_ttl * G_USEC_PER_SEC;
+	g_hash_table_replace (priv->values_cache, g_strdup (key), entry);
+}
+
+/* must be called with values_lock held */
+static GPtrArray
+*gdaex_query_editor_model_values_cache_get (GdaExQueryEditorModel *model,
+                                            const gchar *key)
+{
+	GdaExQueryEditorValuesCacheEntry *entry;
+
+	GdaExQueryEditorModelPrivate *priv = GDAEX_QUERY_EDITOR_MODEL_GET_PRIVATE (model);
+
+	entry = (GdaExQueryEditorValuesCacheEntry *)g_hash_table_lookup (priv->values_cache, key);
+	if (entry == NULL)
+		{
+			return NULL;
+		}
+	if (entry->expires <= g_get_monotonic_time ())
+		{
+			g_hash_table_remove (priv->values_cache, key);
+			return NULL;
+		}
+
+	return g_ptr_array_ref (entry->values);
+}
+
+/**
+ * gdaex_query_editor_model_set_values_cache_ttl:
+ * @model: a #GdaExQueryEditorModel object.
+ * @seconds: how long a list of values is reused; 0 disables the cache.
+ */
+void
+gdaex_query_editor_model_set_values_cache_ttl (GdaExQueryEditorModel *model,
+                                               guint seconds)
+{
+	g_return_if_fail (GDAEX_IS_QUERY_EDITOR_MODEL (model));
+
+	GdaExQueryEditorModelPrivate *priv = GDAEX_QUERY_EDITOR_MODEL_GET_PRIVATE (model);
+
+	g_mutex_lock (&priv->values_lock);
+	priv->values_ttl = seconds;
+	g_hash_table_remove_all (priv->values_cache);
+	g_mutex_unlock (&priv->values_lock);
+}
+
+/**
+ * gdaex_query_editor_model_get_values_cache_ttl:
+ * @model: a #GdaExQueryEditorModel object.
+ *
+ * Returns: the seconds a list of values is reused.
+ */
+guint
+gdaex_query_editor_model_get_values_cache_ttl (GdaExQueryEditorModel *model)
+{
+	g_return_val_if_fail (GDAEX_IS_QUERY_EDITOR_MODEL (model), 0);
+
+	GdaExQueryEditorModelPrivate *priv = GDAEX_QUERY_EDITOR_MODEL_GET_PRIVATE (model);
+
+	return priv->values_ttl;
+}
+
+typedef struct
+	{
+		gchar *key;
+		GdaStatement *stmt;
+		GdaSet *params;
+	} GdaExQueryEditorValuesData;
+
+static void
+gdaex_query_editor_model_values_data_free (GdaExQueryEditorValuesData *data)
+{
+	g_free (data->key);
+	if (data->stmt != NULL)
+		{
+			g_object_unref (data->stmt);
+		}
+	if (data->params != NULL)
+		{
+			g_object_unref (data->params);
+		}
+	g_free (data);
+}
+
+/* SELECT field, COUNT(*) FROM table [WHERE field ILIKE %filter%]
+ * GROUP BY field ORDER BY field LIMIT limit OFFSET offset */
+static GdaSqlBuilder
+*gdaex_query_editor_model_build_values_sql (GdaExQueryEditorModel *model,
+                                            const GdaExQueryEditorField *field,
+                                            const gchar *filter,
+                                            guint offset,
+                                            guint limit,
+                                            GPtrArray *values)
+{
+	GdaSqlBuilder *sqlbuilder;
+	GdaExQueryEditorWhereChoice choice;
+
+	guint id_field;
+	guint id_cond;
+	gchar *str;
+
+	sqlbuilder = gda_sql_builder_new (GDA_SQL_STATEMENT_SELECT);
+
+	gda_sql_builder_select_add_target_id (sqlbuilder,
+	                                      gda_sql_builder_add_id (sqlbuilder, field->table_name),
+	                                      NULL);
+
+	str = g_strconcat (field->table_name, ".", field->name, NULL);
+	id_field = gda_sql_builder_add_id (sqlbuilder, str);
+	g_free (str);
+
+	gda_sql_builder_add_field_value_id (sqlbuilder, id_field, 0);
+	gda_sql_builder_add_field_value_id (sqlbuilder,
+	                                    gda_sql_builder_add_function (sqlbuilder, "COUNT",
+	                                                                  gda_sql_builder_add_id (sqlbuilder, "*"),
+	                                                                  0),
+	                                    0);
+
+	/* the same condition of the where page, so it uses the same index */
+	if (field->type == GDAEX_QE_FIELD_TYPE_TEXT
+	    && filter != NULL
+	    && g_strcmp0 (filter, "") != 0)
+		{
+			memset (&choice, 0, sizeof (GdaExQueryEditorWhereChoice));
+			choice.table_name = field->table_name;
+			choice.field_name = field->name;
+			choice.where_type = GDAEX_QE_WHERE_TYPE_ICONTAINS;
+			choice.from_sql = (gchar *)filter;
+
+			id_cond = gdaex_query_editor_model_sql_where_cond (model, sqlbuilder, &choice, values);
+			if (id_cond != 0)
+				{
+					gda_sql_builder_set_where (sqlbuilder, id_cond);
+				}
+		}
+
+	gda_sql_builder_select_group_by (sqlbuilder, id_field);
+	gda_sql_builder_select_order_by (sqlbuilder, id_field, TRUE, NULL);
+	gda_sql_builder_select_set_limit (sqlbuilder,
+	                                  gda_sql_builder_add_expr (sqlbuilder, NULL, G_TYPE_UINT, limit),
+	                                  offset > 0 ? gda_sql_builder_add_expr (sqlbuilder, NULL, G_TYPE_UINT, offset) : 0);
+
+	return sqlbuilder;
+}
+
+/* a read only connection of its own for the worker threads, that never
+ * touch the one of the application; to be called in the main thread, as
+ * gdaex_new_from_connection() */
+static GdaEx
+*gdaex_query_editor_model_open_gdaex (GdaExQueryEditorModel *model, GError **error)
+{
+	GdaConnection *cnc;
+	GdaConnection *cnc_new;
+	GdaEx *gdaex;
+	gchar *prefix;
+
+	GdaExQueryEditorModelPrivate *priv = GDAEX_QUERY_EDITOR_MODEL_GET_PRIVATE (model);
+
+	cnc = (GdaConnection *)gdaex_get_gdaconnection (priv->gdaex);
+	cnc_new = gda_connection_open_from_string (gda_connection_get_provider_name (cnc),
+	                                           gda_connection_get_cnc_string (cnc),
+	                                           gda_connection_get_authentication (cnc),
+	                                           GDA_CONNECTION_OPTIONS_READ_ONLY,
+	                                           error);
+	if (cnc_new == NULL)
+		{
+			return NULL;
+		}
+
+	/* the tables of the application: its statements are prepared with the
+	 * prefix (see gdaex_prepare_statement()); the raw SET and EXPLAIN of
+	 * the count go to the GdaConnection, untouched */
+	gdaex = gdaex_new_from_connection (cnc_new);
+	prefix = gdaex_get_tables_name_prefix (priv->gdaex);
+	gdaex_set_tables_name_prefix (gdaex, prefix);
+	g_free (prefix);
+
+	return gdaex;
+}
+
+/* worker thread */
+static void
+gdaex_query_editor_model_values_thread (GTask *task,
+                                        gpointer source_object,
+                                        gpointer task_data,
+                                        GCancellable *cancellable)
+{
+	GdaExQueryEditorModel *model;
+	GdaExQueryEditorValuesData *data;
+
+	GdaStatement *stmt;
+	GdaDataModel *dm;
+	GdaDataModelIter *gda_iter;
+	const GValue *gval;
+
+	GPtrArray *ar_values;
+	GdaExQueryEditorValue *value;
+
+	model = GDAEX_QUERY_EDITOR_MODEL (source_object);
+	data = (GdaExQueryEditorValuesData *)task_data;
+
+	GdaExQueryEditorModelPrivate *priv = GDAEX_QUERY_EDITOR_MODEL_GET_PRIVATE (model);
+
+	if (g_task_return_error_if_cancelled (task))
+		{
+			return;
+		}
+
+	/* with the tables name prefix of the application */
+	stmt = gdaex_prepare_statement (priv->values_gdaex, data->stmt);
+	dm = (stmt != NULL ? gdaex_query_statement (priv->values_gdaex, stmt, data->params) : NULL);
+	if (stmt != NULL)
+		{
+			g_object_unref (stmt);
+		}
+	if (dm == NULL)
+		{
+			g_task_return_new_error (task, G_IO_ERROR, G_IO_ERROR_FAILED,
+			                         _("Unable to read the values of the field."));
+			return;
+		}
+
+	gda_iter = gda_data_model_create_iter (dm);
+	if (gda_iter == NULL)
+		{
+			g_object_unref (dm);
+			g_task_return_new_error (task, G_IO_ERROR, G_IO_ERROR_FAILED,
+			                         _("Unable to create an iterator over the data model."));
+			return;
+		}
+
+	ar_values = g_ptr_array_new_with_free_func ((GDestroyNotify)gdaex_query_editor_model_value_free);
+	while (gda_data_model_iter_move_next (gda_iter))
+		{
+			if (g_task_return_error_if_cancelled (task))
+				{
+					g_ptr_array_unref (ar_values);
+					g_object_unref (gda_iter);
+					g_object_unref (dm);
+					return;
+				}
+
+			gval = gda_data_model_iter_get_value_at (gda_iter, 0);
+			if (gval == NULL || gda_value_is_null (gval))
+				{
+					continue;
+				}
+
+			value = g_new0 (GdaExQueryEditorValue, 1);
+			value->value = gda_value_stringify (gval);
+			value->gval = gda_value_copy (gval);
+			value->count = gdaex_data_model_iter_get_value_integer_at (gda_iter, 1);
+			g_ptr_array_add (ar_values, value);
+		}
+
+	g_object_unref (gda_iter);
+	g_object_unref (dm);
+
+	g_mutex_lock (&priv->values_lock);
+	gdaex_query_editor_model_values_cache_put (model, data->key, ar_values);
+	g_mutex_unlock (&priv->values_lock);
+
+	g_task_return_pointer (task, ar_values, (GDestroyNotify)g_ptr_array_unref);
+}
+
+/**
+ * gdaex_query_editor_model_get_values_async:
+ * @model: a #GdaExQueryEditorModel object.
+ * @table_name: the name of the table.
+ * @field_name: the name of the field.
+ * @filter: (allow-none): for a text field, only the values containing it
+ * (case insensitive).
+ * @offset: the number of values to skip.
+ * @limit: the maximum number of values.
+ * @cancellable: (allow-none): a #GCancellable.
+ * @callback: called when the values are read.
+ * @user_data: data for @callback.
+ *
+ * Reads a page of the distinct values of a field, with the number of rows
+ * of each one, in a worker thread, on a read only connection of its own
+ * opened at the first call. Filtering is done by the database.
+ * Pages already read are reused for gdaex_query_editor_model_get_values_cache_ttl()
+ * seconds.
+ */
+void
+gdaex_query_editor_model_get_values_async (GdaExQueryEditorModel *model,
+                                           const gchar *table_name,
+                                           const gchar *field_name,
+                                           const gchar *filter,
+                                           guint offset,
+                                           guint limit,
+                                           GCancellable *cancellable,
+                                           GAsyncReadyCallback callback,
+                                           gpointer user_data)
+{
+	GTask *task;
+	GdaExQueryEditorValuesData *data;
+	const GdaExQueryEditorField *field;
+	GdaSqlBuilder *sqlbuilder;
+	GPtrArray *values;
+	GPtrArray *ar_values;
+	GError *error;
+
+	g_return_if_fail (GDAEX_IS_QUERY_EDITOR_MODEL (model));
+	g_return_if_fail (table_name != NULL);
+	g_return_if_fail (field_name != NULL);
+	g_return_if_fail (limit > 0);
+
+	GdaExQueryEditorModelPrivate *priv = GDAEX_QUERY_EDITOR_MODEL_GET_PRIVATE (model);
+
+	task = g_task_new (model, cancellable, callback, user_data);
+	g_task_set_source_tag (task, gdaex_query_editor_model_get_values_async);
+
+	field = gdaex_query_editor_model_get_field (model, table_name, field_name);
+	if (field == NULL)
+		{
+			g_task_return_new_error (task, G_IO_ERROR, G_IO_ERROR_NOT_FOUND,
+			                         _("Field «%s» not found in table «%s»."), field_name, table_name);
+			g_object_unref (task);
+			return;
+		}
+
+	data = g_new0 (GdaExQueryEditorValuesData, 1);
+	data->key = g_strdup_printf ("%s.%s\n%u\n%u\n%s", table_name, field_name, offset, limit,
+	                             field->type == GDAEX_QE_FIELD_TYPE_TEXT && filter != NULL ? filter : "");
+	g_task_set_task_data (task, data, (GDestroyNotify)gdaex_query_editor_model_values_data_free);
+
+	g_mutex_lock (&priv->values_lock);
+	ar_values = gdaex_query_editor_model_values_cache_get (model, data->key);
+	g_mutex_unlock (&priv->values_lock);
+	if (ar_values != NULL)
+		{
+			g_task_return_pointer (task, ar_values, (GDestroyNotify)g_ptr_array_unref);
+			g_object_unref (task);
+			return;
+		}
+
+	/* the statement is built here: the schema is not thread safe */
+	values = g_ptr_array_new_with_free_func ((GDestroyNotify)gda_value_free);
+	sqlbuilder = gdaex_query_editor_model_build_values_sql (model, field, filter, offset, limit, values);
+	data->stmt = gdaex_query_editor_model_builder_get_statement (sqlbuilder, values, &data->params);
+	g_object_unref (sqlbuilder);
+	g_ptr_array_unref (values);
+
+	if (data->stmt == NULL)
+		{
+			g_task_return_new_error (task, G_IO_ERROR, G_IO_ERROR_FAILED,
+			                         _("Unable to create GdaStatement."));
+			g_object_unref (task);
+			return;
+		}
+
+	/* the readings of many pickers can overlap: they share the connection
+	 * in thread-safe mode */
+	if (priv->values_gdaex == NULL)
+		{
+			error = NULL;
+			priv->values_gdaex = gdaex_query_editor_model_open_gdaex (model, &error);
+			if (priv->values_gdaex == NULL)
+				{
+					g_task_return_error (task, error);
+					g_object_unref (task);
+					return;
+				}
+			gdaex_set_thread_safe (priv->values_gdaex, TRUE);
+		}
+
+	g_task_run_in_thread (task, gdaex_query_editor_model_values_thread);
+
+	g_object_unref (task);
+}
+
+/**
+ * gdaex_query_editor_model_get_values_finish:
+ * @model: a #GdaExQueryEditorModel object.
+ * @result: the #GAsyncResult passed to the callback.
+ * @error: (allow-none): return location for a #GError.
+ *
+ * Returns: (transfer full) (element-type GdaExQueryEditorValue): the
+ * values, that must not be modified; #NULL on error. Fewer than the
+ * requested limit means that there are no more values.
+ */
+GPtrArray
+*gdaex_query_editor_model_get_values_finish (GdaExQueryEditorModel *model,
+                                             GAsyncResult *result,
+                                             GError **error)
+{
+	g_return_val_if_fail (g_task_is_valid (result, model), NULL);
+
+	return (GPtrArray *)g_task_propagate_pointer (G_TASK (result), error);
+}
+
+typedef struct
+	{
+		GdaStatement *stmt_inner;	/* counted as SELECT COUNT(*) FROM (inner) */
+		GdaSet *params;
+		guint budget;
+
+		GSource *timeout;
+		gboolean timed_out;
+
+		gboolean estimated;
+	} GdaExQueryEditorCountData;
+
+static void
+gdaex_query_editor_model_count_data_free (GdaExQueryEditorCountData *data)
+{
+	g_object_unref (data->stmt_inner);
+	if (data->params != NULL)
+		{
+			g_object_unref (data->params);
+		}
+	if (data->timeout != NULL)
+		{
+			g_source_destroy (data->timeout);
+			g_source_unref (data->timeout);
+		}
+	g_free (data);
+}
+
+static gboolean
+gdaex_query_editor_model_count_on_timeout (gpointer user_data)
+{
+	GTask *task;
+	GdaExQueryEditorCountData *data;
+
+	task = G_TASK (user_data);
+	data = (GdaExQueryEditorCountData *)g_task_get_task_data (task);
+
+	data->timed_out = TRUE;
+	g_cancellable_cancel (g_task_get_cancellable (task));
+
+	return G_SOURCE_REMOVE;
+}
+
+static gint64
+gdaex_query_editor_model_count_get_int64 (GdaDataModel *dm, gint col, gint row)
+{
+	const GValue *gval;
+	GValue gval64 = G_VALUE_INIT;
+	gchar *str;
+	gint64 ret;
+
+	gval = gda_data_model_get_value_at (dm, col, row, NULL);
+	if (gval == NULL || gda_value_is_null (gval))
+		{
+			return -1;
+		}
+
+	g_value_init (&gval64, G_TYPE_INT64);
+	if (g_value_transform (gval, &gval64))
+		{
+			ret = g_value_get_int64 (&gval64);
+		}
+	else
+		{
+			str = gda_value_stringify (gval);
+			ret = g_ascii_strtoll (str, NULL, 10);
+			g_free (str);
+		}
+	g_value_unset (&gval64);
+
+	return ret;
+}
+
+/* the rows of the plan of the provider; -1 if it doesn't give them */
+static gint64
+gdaex_query_editor_model_count_estimate (GdaEx *gdaex,
+                                         GdaStatement *stmt,
+                                         GdaSet *params)
+{
+	const gchar *provider;
+	gchar *sql;
+	gchar *str;
+	const gchar *p;
+
+	GdaDataModel *dm;
+	gint col;
+	gint row;
+	gint64 rows;
+	gint64 ret;
+
+	provider = gdaex_get_provider (gdaex);
+	if (g_ascii_strcasecmp (provider, "PostgreSQL") != 0
+	    && g_ascii_strcasecmp (provider, "MySQL") != 0)
+		{
+			return -1;
+		}
+
+	sql = gda_statement_to_sql_extended (stmt,
+	                                     (GdaConnection *)gdaex_get_gdaconnection (gdaex),
+	                                     params, 0, NULL, NULL);
+	if (sql == NULL)
+		{
+			return -1;
+		}
+	/* executed as it is, as the count: the parser of GdaEx would give an
+	 * unknown statement, not to be touched by the tables name prefix */
+	str = g_strconcat ("EXPLAIN ", sql, NULL);
+	dm = gda_connection_execute_select_command ((GdaConnection *)gdaex_get_gdaconnection (gdaex),
+	                                            str, NULL);
+	g_free (str);
+	g_free (sql);
+	if (gdaex_data_model_is_empty (dm))
+		{
+			if (dm != NULL)
+				{
+					g_object_unref (dm);
+				}
+			return -1;
+		}
+
+	ret = -1;
+	if (g_ascii_strcasecmp (provider, "PostgreSQL") == 0)
+		{
+			/* the first line is the top node: "... (cost=... rows=N width=...)" */
+			str = gdaex_data_model_get_value_stringify_at (dm, 0, 0);
+			p = (str != NULL ? strstr (str, " rows=") : NULL);
+			if (p != NULL)
+				{
+					ret = g_ascii_strtoll (p + 6, NULL, 10);
+				}
+			g_free (str);
+		}
+	else
+		{
+			/* a line for each table joined */
+			col = gda_data_model_get_column_index (dm, "rows");
+			if (col >= 0)
+				{
+					ret = 1;
+					for (row = 0; row < gda_data_model_get_n_rows (dm); row++)
+						{
+							rows = gdaex_query_editor_model_count_get_int64 (dm, col, row);
+							if (rows > 0)
+								{
+									ret = (ret > G_MAXINT64 / rows ? G_MAXINT64 : ret * rows);
+								}
+						}
+				}
+		}
+
+	g_object_unref (dm);
+
+	return ret;
+}
+
+/* whether the database can stop a statement after a time limit */
+static gboolean
+gdaex_query_editor_model_count_has_timeout (GdaEx *gdaex)
+{
+	const gchar *provider;
+
+	provider = gdaex_get_provider (gdaex);
+
+	return (g_ascii_strcasecmp (provider, "PostgreSQL") == 0
+	        || g_ascii_strcasecmp (provider, "MySQL") == 0);
+}
+
+/* the time limit enforced by the database, on the connection of the count */
+static void
+gdaex_query_editor_model_count_set_timeout (GdaEx *gdaex, guint msec)
+{
+	const gchar *provider;
+	gchar *sql;
+
+	provider = gdaex_get_provider (gdaex);
+	if (g_ascii_strcasecmp (provider, "PostgreSQL") == 0)
+		{
+			sql = g_strdup_printf ("SET statement_timeout TO %u", msec);
+		}
+	else if (g_ascii_strcasecmp (provider, "MySQL") == 0)
+		{
+			sql = g_strdup_printf ("SET SESSION max_execution_time = %u", msec);
+		}
+	else
+		{
+			return;
+		}
+
+	/* straight to the connection: GdaEx would apply the tables name prefix */
+	gda_connection_execute_non_select_command ((GdaConnection *)gdaex_get_gdaconnection (gdaex), sql, NULL);
+	g_free (sql);
+}
+
+/* SELECT COUNT(*) FROM (stmt_inner) */
+static GdaStatement
+*gdaex_query_editor_model_count_statement (GdaStatement *stmt_inner)
+{
+	GdaSqlBuilder *sqlbuilder_count;
+	GdaSqlStatement *sqlst;
+	GdaStatement *ret;
+	GError *error;
+
+	g_object_get (G_OBJECT (stmt_inner), "structure", &sqlst, NULL);
+	if (sqlst == NULL)
+		{
+			return NULL;
+		}
+
+	sqlbuilder_count = gda_sql_builder_new (GDA_SQL_STATEMENT_SELECT);
+	gda_sql_builder_select_add_target_id (sqlbuilder_count,
+	                                      gda_sql_builder_add_sub_select (sqlbuilder_count, sqlst),
+	                                      "gdaex_qe_count");
+	gda_sql_statement_free (sqlst);
+	gda_sql_builder_add_field_value_id (sqlbuilder_count,
+	                                    gda_sql_builder_add_function (sqlbuilder_count, "COUNT",
+	                                                                  gda_sql_builder_add_id (sqlbuilder_count, "*"),
+	                                                                  0),
+	                                    0);
+
+	error = NULL;
+	ret = gda_sql_builder_get_statement (sqlbuilder_count, &error);
+	if (ret == NULL)
+		{
+			g_warning (_("Unable to create GdaStatement: %s."),
+			           error != NULL && error->message != NULL ? error->message : _("no details"));
+			g_clear_error (&error);
+		}
+	g_object_unref (sqlbuilder_count);
+
+	return ret;
+}
+
+static void
+gdaex_query_editor_model_count_run (GTask *task,
+                                    gpointer source_object,
+                                    gpointer task_data)
+{
+	GdaExQueryEditorModel *model;
+	GdaExQueryEditorCountData *data;
+
+	GdaStatement *stmt_inner;
+	GdaStatement *stmt;
+	GdaDataModel *dm;
+
+	gint64 estimate;
+	gint64 rows;
+
+	model = GDAEX_QUERY_EDITOR_MODEL (source_object);
+	data = (GdaExQueryEditorCountData *)task_data;
+
+	GdaExQueryEditorModelPrivate *priv = GDAEX_QUERY_EDITOR_MODEL_GET_PRIVATE (model);
+
+	if (g_task_return_error_if_cancelled (task))
+		{
+			return;
+		}
+
+	/* one count at a time: a thread of the pool doesn't wait for the
+	 * previous one to be stopped by the database */
+	if (!g_mutex_trylock (&priv->count_lock))
+		{
+			g_task_return_new_error (task, G_IO_ERROR, G_IO_ERROR_BUSY,
+			                         _("Another count is still running."));
+			return;
+		}
+
+	/* the tables of the application, with its tables name prefix */
+	stmt_inner = gdaex_prepare_statement (priv->count_gdaex, data->stmt_inner);
+	stmt = (stmt_inner != NULL ? gdaex_query_editor_model_count_statement (stmt_inner) : NULL);
+	if (stmt == NULL)
+		{
+			g_mutex_unlock (&priv->count_lock);
+			if (stmt_inner != NULL)
+				{
+					g_object_unref (stmt_inner);
+				}
+			g_task_return_new_error (task, G_IO_ERROR, G_IO_ERROR_FAILED,
+			                         _("Unable to create GdaStatement."));
+			return;
+		}
+
+	estimate = gdaex_query_editor_model_count_estimate (priv->count_gdaex, stmt_inner, data->params);
+	g_object_unref (stmt_inner);
+	if (estimate > GDAEX_QE_COUNT_EXACT_MAX)
+		{
+			g_mutex_unlock (&priv->count_lock);
+			g_object_unref (stmt);
+			data->estimated = TRUE;
+			g_task_return_int (task, estimate);
+			return;
+		}
+
+	/* the budget is over: the exact count is not even started */
+	if (g_task_return_error_if_cancelled (task))
+		{
+			g_mutex_unlock (&priv->count_lock);
+			g_object_unref (stmt);
+			return;
+		}
+
+	gdaex_query_editor_model_count_set_timeout (priv->count_gdaex, data->budget);
+	dm = gdaex_query_statement (priv->count_gdaex, stmt, data->params);
+	gdaex_query_editor_model_count_set_timeout (priv->count_gdaex, 0);
+
+	g_mutex_unlock (&priv->count_lock);
+	g_object_unref (stmt);
+
+	/* without a time limit of the database the count is awaited and its
+	 * result kept even after the budget, but not after a cancellation */
+	if (!data->timed_out
+	    && g_task_return_error_if_cancelled (task))
+		{
+			if (dm != NULL)
+				{
+					g_object_unref (dm);
+				}
+			return;
+		}
+
+	rows = -1;
+	if (!gdaex_data_model_is_empty (dm))
+		{
+			rows = gdaex_query_editor_model_count_get_int64 (dm, 0, 0);
+		}
+	if (dm != NULL)
+		{
+			g_object_unref (dm);
+		}
+
+	if (rows > GDAEX_QE_COUNT_EXACT_MAX)
+		{
+			/* stopped at the limit of the inner query */
+			data->estimated = TRUE;
+			g_task_return_int (task, rows);
+		}
+	else if (rows >= 0)
+		{
+			g_task_return_int (task, rows);
+		}
+	else if (estimate >= 0)
+		{
+			/* the count has been stopped by the database */
+			data->estimated = TRUE;
+			g_task_return_int (task, estimate);
+		}
+	else
+		{
+			g_task_return_new_error (task, G_IO_ERROR, G_IO_ERROR_TIMED_OUT,
+			                         _("Unable to count the rows in the time allowed."));
+		}
+}
+
+/* worker thread */
+static void
+gdaex_query_editor_model_count_thread (GTask *task,
+                                       gpointer source_object,
+                                       gpointer task_data,
+                                       GCancellable *cancellable)
+{
+	GdaExQueryEditorCountData *data;
+
+	data = (GdaExQueryEditorCountData *)task_data;
+
+	gdaex_query_editor_model_count_run (task, source_object, task_data);
+
+	/* the budget is no more needed, nor its reference to the task */
+	g_source_destroy (data->timeout);
+}
+
+/**
+ * gdaex_query_editor_model_count_async:
+ * @model: a #GdaExQueryEditorModel object.
+ * @budget: the maximum time in milliseconds.
+ * @cancellable: (allow-none): a #GCancellable.
+ * @callback: called with the number of rows.
+ * @user_data: data for @callback.
+ *
+ * Counts the rows of the current choices in a worker thread, on a read only
+ * connection of its own opened at the first call.
+ *
+ * PostgreSQL and MySQL give a plan estimate, returned instead of the count
+ * when it is too big or when the count doesn't finish within @budget: the
+ * database itself stops the count after @budget, and @callback gets a
+ * G_IO_ERROR_TIMED_OUT error after @budget if there is no estimate.
+ *
+ * Other providers (e.g. SQLite) can't stop a running statement: the count
+ * is not started once @budget is over (@callback gets G_IO_ERROR_TIMED_OUT),
+ * otherwise it stops after a million rows, returned as an estimate, and
+ * @callback gets its result when it ends, even after @budget.
+ *
+ * While a previous count is still running on the database @callback gets
+ * a G_IO_ERROR_BUSY error: try again later.
+ */
+void
+gdaex_query_editor_model_count_async (GdaExQueryEditorModel *model,
+                                      guint budget,
+                                      GCancellable *cancellable,
+                                      GAsyncReadyCallback callback,
+                                      gpointer user_data)
+{
+	GTask *task;
+	GCancellable *task_cancellable;
+	GdaExQueryEditorCountData *data;
+
+	GdaSqlBuilder *sqlbuilder;
+	GPtrArray *values;
+	gboolean server_timeout;
+	GError *error;
+
+	g_return_if_fail (GDAEX_IS_QUERY_EDITOR_MODEL (model));
+	g_return_if_fail (budget > 0);
+
+	GdaExQueryEditorModelPrivate *priv = GDAEX_QUERY_EDITOR_MODEL_GET_PRIVATE (model);
+
+	/* the budget also cancels the task, but not the caller's cancellable */
+	task_cancellable = g_cancellable_new ();
+	if (cancellable != NULL)
+		{
+			g_signal_connect_object (cancellable, "cancelled",
+			                         G_CALLBACK (g_cancellable_cancel), task_cancellable,
+			                         G_CONNECT_SWAPPED);
+			if (g_cancellable_is_cancelled (cancellable))
+				{
+					g_cancellable_cancel (task_cancellable);
+				}
+		}
+
+	task = g_task_new (model, task_cancellable, callback, user_data);
+	g_task_set_source_tag (task, gdaex_query_editor_model_count_async);
+	g_object_unref (task_cancellable);
+
+	/* a worker is left behind only when the database stops it soon */
+	server_timeout = gdaex_query_editor_model_count_has_timeout (priv->gdaex);
+	g_task_set_return_on_cancel (task, server_timeout);
+	g_task_set_check_cancellable (task, server_timeout);
+
+	/* the statements are built here: the schema is not thread safe */
+	values = g_ptr_array_new_with_free_func ((GDestroyNotify)gda_value_free);
+	sqlbuilder = gdaex_query_editor_model_build_sql (model, values, TRUE);
+	if (sqlbuilder == NULL)
+		{
+			g_ptr_array_unref (values);
+			g_task_return_new_error (task, G_IO_ERROR, G_IO_ERROR_FAILED,
+			                         _("Unable to create GdaStatement."));
+			g_object_unref (task);
+			return;
+		}
+
+	if (!server_timeout)
+		{
+			gda_sql_builder_select_set_limit (sqlbuilder,
+			                                  gda_sql_builder_add_expr (sqlbuilder, NULL, G_TYPE_UINT, GDAEX_QE_COUNT_EXACT_MAX + 1),
+			                                  0);
+		}
+
+	/* the count is built in the worker, around the inner statement
+	 * with the tables name prefix: they have the same parameters */
+	data = g_new0 (GdaExQueryEditorCountData, 1);
+	data->budget = budget;
+	data->stmt_inner = gdaex_query_editor_model_builder_get_statement (sqlbuilder, values, &data->params);
+
+	g_object_unref (sqlbuilder);
+	g_ptr_array_unref (values);
+
+	if (data->stmt_inner == NULL)
+		{
+			g_free (data);
+
+			g_task_return_new_error (task, G_IO_ERROR, G_IO_ERROR_FAILED,
+			                         _("Unable to create GdaStatement."));
+			g_object_unref (task);
+			return;
+		}
+
+	g_task_set_task_data (task, data, (GDestroyNotify)gdaex_query_editor_model_count_data_free);
+
+	/* a long count doesn't hold the connection of the application */
+	if (priv->count_gdaex == NULL)
+		{
+			error = NULL;
+			priv->count_gdaex = gdaex_query_editor_model_open_gdaex (model, &error);
+			if (priv->count_gdaex == NULL)
+				{
+					g_task_return_error (task, error);
+					g_object_unref (task);
+					return;
+				}
+		}
+
+	data->timeout = g_timeout_source_new (budget);
+	g_source_set_callback (data->timeout, gdaex_query_editor_model_count_on_timeout,
+	                       g_object_ref (task), g_object_unref);
+	g_source_attach (data->timeout, g_task_get_context (task));
+
+	g_task_run_in_thread (task, gdaex_query_editor_model_count_thread);
+	g_object_unref (task);
+}
+
+/**
+ * gdaex_query_editor_model_count_finish:
+ * @model: a #GdaExQueryEditorModel object.
+ * @result: the #GAsyncResult passed to the callback.
+ * @estimated: (out) (allow-none): whether the number is a plan estimate.
+ * @error: (allow-none): return location for a #GError.
+ *
+ * Returns: the number of rows; -1 on error.
+ */
+gint64
+gdaex_query_editor_model_count_finish (GdaExQueryEditorModel *model,
+                                       GAsyncResult *result,
+                                       gboolean *estimated,
+                                       GError **error)
+{
+	GdaExQueryEditorCountData *data;
+	GError *my_error;
+	gint64 ret;
+
+	g_return_val_if_fail (g_task_is_valid (result, model), -1);
+
+	data = (GdaExQueryEditorCountData *)g_task_get_task_data (G_TASK (result));
+
+	my_error = NULL;
+	ret = g_task_propagate_int (G_TASK (result), &my_error);
+	if (my_error != NULL)
+		{
+			if (data != NULL
+			    && data->timed_out
+			    && g_error_matches (my_error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+				{
+					g_clear_error (&my_error);
+					g_set_error (&my_error, G_IO_ERROR, G_IO_ERROR_TIMED_OUT,
+					             _("Unable to count the rows in the time allowed."));
+				}
+			g_propagate_error (error, my_error);
+			return -1;
+		}
+
+	if (estimated != NULL)
+		{
+			*estimated = (data != NULL && data->estimated);
+		}
+
+	return ret;
+}
+
+/**
+ * gdaex_query_editor_model_get_sql:
+ * @model: a #GdaExQueryEditorModel object.
+ *
+ * Returns: (transfer full): the sql of the current choices, rendered for the
+ * connection of the #GdaEx; #NULL on error.
+ */
+gchar
+*gdaex_query_editor_model_get_sql (GdaExQueryEditorModel *model)
+{
+	gchar *ret;
+
+	GdaSqlBuilder *sqlbuilder;
+	GdaStatement *stmt;
+	GError *error;
+
+	g_return_val_if_fail (GDAEX_IS_QUERY_EDITOR_MODEL (model), NULL);
+
+	GdaExQueryEditorModelPrivate *priv = GDAEX_QUERY_EDITOR_MODEL_GET_PRIVATE (model);
+
+	sqlbuilder = gdaex_query_editor_model_get_sql_as_gdasqlbuilder (model);
+	if (sqlbuilder == NULL)
+		{
+			return NULL;
+		}
+
+	error = NULL;
+	stmt = gda_sql_builder_get_statement (sqlbuilder, &error);
+	g_object_unref (sqlbuilder);
+	if (stmt == NULL || error != NULL)
+		{
+			g_warning (_("Unable to create GdaStatement: %s."),
+			           error != NULL && error->message != NULL ? error->message : _("no details"));
+			return NULL;
+		}
+
+	error = NULL;
+	ret = gda_statement_to_sql_extended (stmt,
+	                                     (GdaConnection *)gdaex_get_gdaconnection (priv->gdaex),
+	                                     NULL, 0, NULL, &error);
+	g_object_unref (stmt);
+	if (error != NULL)
+		{
+			g_warning (_("Unable to create sql: %s."),
+			           error->message != NULL ? error->message : _("no details"));
+			g_free (ret);
+			ret = NULL;
+		}
+
+	return ret;
+}
+
+static const gchar
+*gdaex_query_editor_model_where_type_to_str (GdaExQueryEditorWhereType where_type)
+{
+	switch (where_type)
+		{
+			case GDAEX_QE_WHERE_TYPE_EQUAL:
+				return "EQUAL";
+
+			case GDAEX_QE_WHERE_TYPE_STARTS:
+				return "STARTS";
+
+			case GDAEX_QE_WHERE_TYPE_CONTAINS:
+				return "CONTAINS";
+
+			case GDAEX_QE_WHERE_TYPE_ENDS:
+				return "ENDS";
+
+			case GDAEX_QE_WHERE_TYPE_ISTARTS:
+				return "ISTARTS";
+
+			case GDAEX_QE_WHERE_TYPE_ICONTAINS:
+				return "ICONTAINS";
+
+			case GDAEX_QE_WHERE_TYPE_IENDS:
+				return "IENDS";
+
+			case GDAEX_QE_WHERE_TYPE_GREAT:
+				return "GREAT";
+
+			case GDAEX_QE_WHERE_TYPE_GREAT_EQUAL:
+				return "GREAT_EQUAL";
+
+			case GDAEX_QE_WHERE_TYPE_LESS:
+				return "LESS";
+
+			case GDAEX_QE_WHERE_TYPE_LESS_EQUAL:
+				return "LESS_EQUAL";
+
+			case GDAEX_QE_WHERE_TYPE_BETWEEN:
+				return "BETWEEN";
+
+			case GDAEX_QE_WHERE_TYPE_IS_NULL:
+				return "IS_NULL";
+		}
+
+	return NULL;
+}
+
+static GdaExQueryEditorWhereType
+gdaex_query_editor_model_str_to_where_choice_type (const gchar *str)
+{
+	GdaExQueryEditorWhereType where_type;
+
+	for (where_type = GDAEX_QE_WHERE_TYPE_EQUAL; where_type <= GDAEX_QE_WHERE_TYPE_IS_NULL; where_type <<= 1)
+		{
+			if (g_strcmp0 (gdaex_query_editor_model_where_type_to_str (where_type), str) == 0)
+				{
+					return where_type;
+				}
+		}
+
+	return 0;
+}
+
+static void
+gdaex_query_editor_model_xml_where (GNode *node, xmlNode *xnode_parent)
+{
+	GNode *child;
+	GdaExQueryEditorWhereChoice *choice;
+
+	const gchar *str_link;
+	const gchar *str_op;
+
+	xmlNode *xnode;
+
+	for (child = node->children; child != NULL; child = child->next)
+		{
+			choice = (GdaExQueryEditorWhereChoice *)child->data;
+
+			switch (choice->link_type)
+				{
+					case GDAEX_QE_LINK_TYPE_AND:
+						str_link = "AND";
+						break;
+
+					case GDAEX_QE_LINK_TYPE_OR:
+						str_link = "OR";
+						break;
+
+					default:
+						if (child != node->children)
+							{
+								g_warning (_("Link type «%d» not valid."), choice->link_type);
+								continue;
+							}
+						str_link = "";
+						break;
+				}
+
+			if (choice->is_group)
+				{
+					if (child->children != NULL)
+						{
+							xnode = xmlNewChild (xnode_parent, NULL, (const xmlChar *)"group", NULL);
+							xmlNewProp (xnode, (const xmlChar *)"link_type", (const xmlChar *)str_link);
+							xmlNewProp (xnode, (const xmlChar *)"not", (const xmlChar *)(choice->not ? "y" : "n"));
+
+							gdaex_query_editor_model_xml_where (child, xnode);
+						}
+				}
+			else
+				{
+					str_op = gdaex_query_editor_model_where_type_to_str (choice->where_type);
+					if (str_op == NULL)
+						{
+							g_warning (_("Where type «%d» not valid."), choice->where_type);
+							continue;
+						}
+
+					xnode = xmlNewChild (xnode_parent, NULL, (const xmlChar *)"field", NULL);
+					xmlNewProp (xnode, (const xmlChar *)"table", (const xmlChar *)choice->table_name);
+					xmlNewProp (xnode, (const xmlChar *)"field", (const xmlChar *)choice->field_name);
+					xmlNewProp (xnode, (const xmlChar *)"link_type", (const xmlChar *)str_link);
+					xmlNewProp (xnode, (const xmlChar *)"not", (const xmlChar *)(choice->not ? "y" : "n"));
+					xmlNewProp (xnode, (const xmlChar *)"where_type", (const xmlChar *)str_op);
+					xmlNewProp (xnode, (const xmlChar *)"from", (const xmlChar *)choice->from_sql);
+					xmlNewProp (xnode, (const xmlChar *)"to", (const xmlChar *)choice->to_sql);
+					xmlNewProp (xnode, (const xmlChar *)"from_visible", (const xmlChar *)choice->from_visible);
+					xmlNewProp (xnode, (const xmlChar *)"to_visible", (const xmlChar *)choice->to_visible);
+				}
+		}
+}
+
+/**
+ * gdaex_query_editor_model_get_sql_as_xml:
+ * @model: a #GdaExQueryEditorModel object.
+ *
+ * Returns: a new gdaex_query_editor_choices #xmlNode with the current
+ * choices.
+ */
+xmlNode
+*gdaex_query_editor_model_get_sql_as_xml (GdaExQueryEditorModel *model)
+{
+	xmlNode *ret;
+	xmlNode *xnode_part;
+	xmlNode *xnode;
+
+	GdaExQueryEditorShowChoice *show;
+	GdaExQueryEditorOrderChoice *order;
+	const GdaExQueryEditorField *field;
+
+	guint i;
+
+	g_return_val_if_fail (GDAEX_IS_QUERY_EDITOR_MODEL (model), NULL);
+
+	GdaExQueryEditorModelPrivate *priv = GDAEX_QUERY_EDITOR_MODEL_GET_PRIVATE (model);
+
+	ret = xmlNewNode (NULL, (const xmlChar *)"gdaex_query_editor_choices");
+
+	/* SHOW */
+	if (priv->show->len > 0)
+		{
+			xnode_part = xmlNewChild (ret, NULL, (const xmlChar *)"show", NULL);
+			for (i = 0; i < priv->show->len; i++)
+				{
+					show = (GdaExQueryEditorShowChoice *)g_ptr_array_index (priv->show, i);
+					field = gdaex_query_editor_model_get_field (model, show->table_name, show->field_name);
+
+					xnode = xmlNewChild (xnode_part, NULL, (const xmlChar *)"field", NULL);
+					xmlNewProp (xnode, (const xmlChar *)"table", (const xmlChar *)show->table_name);
+					xmlNewProp (xnode, (const xmlChar *)"field", (const xmlChar *)show->field_name);
+					xmlNewProp (xnode, (const xmlChar *)"alias",
+					            (const xmlChar *)(g_strcmp0 (show->alias, "") != 0 || field == NULL ? show->alias : field->alias));
+				}
+		}
+
+	/* WHERE */
+	if (priv->where->children != NULL)
+		{
+			xnode_part = xmlNewChild (ret, NULL, (const xmlChar *)"where", NULL);
+			gdaex_query_editor_model_xml_where (priv->where, xnode_part);
+		}
+
+	/* ORDER */
+	if (priv->order->len > 0)
+		{
+			xnode_part = xmlNewChild (ret, NULL, (const xmlChar *)"order", NULL);
+			for (i = 0; i < priv->order->len; i++)
+				{
+					order = (GdaExQueryEditorOrderChoice *)g_ptr_array_index (priv->order, i);
+
+					xnode = xmlNewChild (xnode_part, NULL, (const xmlChar *)"field", NULL);
+					xmlNewProp (xnode, (const xmlChar *)"table", (const xmlChar *)order->table_name);
+					xmlNewProp (xnode, (const xmlChar *)"field", (const xmlChar *)order->field_name);
+					xmlNewProp (xnode, (const xmlChar *)"asc_desc",
+					            (const xmlChar *)(order->order == GDAEX_QE_ORDER_ASC ? "ASC" : "DESC"));
+				}
+		}
+
+	return ret;
+}
+
+/* the value exchanged with the iwidgets, from the sql one */
+static gchar
+*gdaex_query_editor_model_value_from_sql (const GdaExQueryEditorField *field,
+                                          const gchar *sql)
+{
+	gchar *ret;
+
+	GDate *gdate;
+	GdaTimestamp *gdatimestamp;
+
+	ret = NULL;
+
+	if (field->type == GDAEX_QE_FIELD_TYPE_DATE)
+		{
+			gdate = gdaex_query_editor_model_get_gdate_from_sql (sql);
+			if (gdate != NULL)
+				{
+					ret = g_strdup_printf ("%02d/%02d/%04d",
+					                       g_date_get_day (gdate),
+					                       g_date_get_month (gdate),
+					                       g_date_get_year (gdate));
+					g_date_free (gdate);
+				}
+		}
+	else if (field->type == GDAEX_QE_FIELD_TYPE_DATETIME)
+		{
+			gdatimestamp = gdaex_query_editor_model_get_gdatimestamp_from_sql (sql);
+			if (gdatimestamp != NULL)
+				{
+					ret = g_strdup_printf ("%02d/%02d/%04d %02d:%02d:%02d",
+					                       gdatimestamp->day,
+					                       gdatimestamp->month,
+					                       gdatimestamp->year,
+					                       gdatimestamp->hour,
+					                       gdatimestamp->minute,
+					                       gdatimestamp->second);
+					g_free (gdatimestamp);
+				}
+		}
+
+	if (ret == NULL)
+		{
+			ret = g_strdup (sql != NULL ? sql : "");
+		}
+
+	return ret;
+}
+
+static void
+gdaex_query_editor_model_load_where_from_xml (GdaExQueryEditorModel *model,
+                                              xmlNode *xnode_parent,
+                                              GNode *parent)
+{
+	xmlNode *xnode;
+
+	GdaExQueryEditorWhereChoice choice;
+	const GdaExQueryEditorField *field;
+	GNode *node;
+
+	xmlChar *link;
+	xmlChar *not;
+	xmlChar *condition;
+	xmlChar *table_name;
+	xmlChar *field_name;
+	xmlChar *from_sql;
+	xmlChar *to_sql;
+	xmlChar *from_visible;
+	xmlChar *to_visible;
+
+	for (xnode = xnode_parent->children; xnode != NULL; xnode = xnode->next)
+		{
+			if (!xmlStrEqual (xnode->name, (const xmlChar *)"field")
+			    && !xmlStrEqual (xnode->name, (const xmlChar *)"group"))
+				{
+					continue;
+				}
+
+			memset (&choice, 0, sizeof (GdaExQueryEditorWhereChoice));
+
+			link = xmlGetProp (xnode, (const xmlChar *)"link_type");
+			not = xmlGetProp (xnode, (const xmlChar *)"not");
+
+			if (xmlStrEqual (link, (const xmlChar *)"AND"))
+				{
+					choice.link_type = GDAEX_QE_LINK_TYPE_AND;
+				}
+			else if (xmlStrEqual (link, (const xmlChar *)"OR"))
+				{
+					choice.link_type = GDAEX_QE_LINK_TYPE_OR;
+				}
+			choice.not = (not != NULL && !xmlStrEqual (not, (const xmlChar *)"n"));
+
+			xmlFree (link);
+			xmlFree (not);
+
+			if (xmlStrEqual (xnode->name, (const xmlChar *)"group"))
+				{
+					choice.is_group = TRUE;
+					node = gdaex_query_editor_model_add_where (model, parent, &choice);
+					if (node != NULL)
+						{
+							gdaex_query_editor_model_load_where_from_xml (model, xnode, node);
+						}
+					continue;
+				}
+
+			table_name = xmlGetProp (xnode, (const xmlChar *)"table");
+			field_name = xmlGetProp (xnode, (const xmlChar *)"field");
+			field = gdaex_query_editor_model_get_field (model, (gchar *)table_name, (gchar *)field_name);
+			if (field == NULL)
+				{
+					g_warning (_("Field «%s» not found in table «%s»."), field_name, table_name);
+					xmlFree (table_name);
+					xmlFree (field_name);
+					continue;
+				}
+
+			condition = xmlGetProp (xnode, (const xmlChar *)"where_type");
+			choice.where_type = gdaex_query_editor_model_str_to_where_choice_type ((gchar *)condition);
+			xmlFree (condition);
+
+			if (choice.where_type != 0)
+				{
+					from_sql = xmlGetProp (xnode, (const xmlChar *)"from");
+					to_sql = xmlGetProp (xnode, (const xmlChar *)"to");
+					from_visible = xmlGetProp (xnode, (const xmlChar *)"from_visible");
+					to_visible = xmlGetProp (xnode, (const xmlChar *)"to_visible");
+
+					choice.table_name = (gchar *)table_name;
+					choice.field_name = (gchar *)field_name;
+					choice.from_sql = (gchar *)from_sql;
+					choice.from = gdaex_query_editor_model_value_from_sql (field, (gchar *)from_sql);
+					choice.from_visible = (from_visible != NULL ? (gchar *)from_visible : choice.from);
+					if (choice.where_type == GDAEX_QE_WHERE_TYPE_BETWEEN)
+						{
+							choice.to_sql = (gchar *)to_sql;
+							choice.to = gdaex_query_editor_model_value_from_sql (field, (gchar *)to_sql);
+							choice.to_visible = (to_visible != NULL ? (gchar *)to_visible : choice.to);
+						}
+					else
+						{
+							choice.to_sql = "";
+							choice.to = g_strdup ("");
+							choice.to_visible = "";
+						}
+
+					gdaex_query_editor_model_add_where (model, parent, &choice);
+
+					g_free (choice.from);
+					g_free (choice.to);
+					xmlFree (from_sql);
+					xmlFree (to_sql);
+					xmlFree (from_visible);
+					xmlFree (to_visible);
+				}
+
+			xmlFree (table_name);
+			xmlFree (field_name);
+		}
+}
+
+/**
+ * gdaex_query_editor_model_load_choices_from_xml:
+ * @model: a #GdaExQueryEditorModel object.
+ * @root: a gdaex_query_editor_choices #xmlNode.
+ * @clean: whether to replace the current choices; if #TRUE, the fields
+ * always showed and always ordered are added back before the loaded ones.
+ *
+ */
+void
+gdaex_query_editor_model_load_choices_from_xml (GdaExQueryEditorModel *model,
+                                                xmlNode *root,
+                                                gboolean clean)
+{
+	xmlNode *xnode;
+	xmlNode *xnode_field;
+
+	xmlChar *table_name;
+	xmlChar *field_name;
+	xmlChar *prop;
+
+	g_return_if_fail (GDAEX_IS_QUERY_EDITOR_MODEL (model));
+	g_return_if_fail (root != NULL);
+	g_return_if_fail (xmlStrEqual (root->name, (const xmlChar *)"gdaex_query_editor_choices"));
+
+	if (clean)
+		{
+			gdaex_query_editor_model_clean_choices (model);
+			gdaex_query_editor_model_add_always_choices (model);
+		}
+
+	for (xnode = root->children; xnode != NULL; xnode = xnode->next)
+		{
+			if (xmlStrEqual (xnode->name, (const xmlChar *)"where"))
+				{
+					gdaex_query_editor_model_load_where_from_xml (model, xnode, NULL);
+					continue;
+				}
+
+			if (!xmlStrEqual (xnode->name, (const xmlChar *)"show")
+			    && !xmlStrEqual (xnode->name, (const xmlChar *)"order"))
+				{
+					continue;
+				}
+
+			for (xnode_field = xnode->children; xnode_field != NULL; xnode_field = xnode_field->next)
+				{
+					if (!xmlStrEqual (xnode_field->name, (const xmlChar *)"field"))
+						{
+							continue;
+						}
+
+					table_name = xmlGetProp (xnode_field, (const xmlChar *)"table");
+					field_name = xmlGetProp (xnode_field, (const xmlChar *)"field");
+
+					if (xmlStrEqual (xnode->name, (const xmlChar *)"show"))
+						{
+							prop = xmlGetProp (xnode_field, (const xmlChar *)"alias");
+							gdaex_query_editor_model_add_show (model, (gchar *)table_name, (gchar *)field_name, (gchar *)prop);
+						}
+					else
+						{
+							prop = xmlGetProp (xnode_field, (const xmlChar *)"asc_desc");
+							if (xmlStrEqual (prop, (const xmlChar *)"ASC")
+							    || xmlStrEqual (prop, (const xmlChar *)"DESC"))
+								{
+									gdaex_query_editor_model_add_order (model, (gchar *)table_name, (gchar *)field_name,
+									                                    xmlStrEqual (prop, (const xmlChar *)"ASC") ? GDAEX_QE_ORDER_ASC : GDAEX_QE_ORDER_DESC);
+								}
+						}
+
+					xmlFree (prop);
+					xmlFree (table_name);
+					xmlFree (field_name);
+				}
+		}
+}
+
+/* PRIVATE */
+static void
+gdaex_query_editor_model_show_choice_free (GdaExQueryEditorShowChoice *choice)
+{
+	g_free (choice->table_name);
+	g_free (choice->field_name);
+	g_free (choice->alias);
+	g_free (choice);
+}
+
+static void
+gdaex_query_editor_model_order_choice_free (GdaExQueryEditorOrderChoice *choice)
+{
+	g_free (choice->table_name);
+	g_free (choice->field_name);
+	g_free (choice);
+}
+
+static gboolean
+gdaex_query_editor_model_where_choice_free (GNode *node, gpointer user_data)
+{
+	GdaExQueryEditorWhereChoice *choice;
+
+	choice = (GdaExQueryEditorWhereChoice *)node->data;
+	if (choice != NULL)
+		{
+			g_free (choice->table_name);
+			g_free (choice->field_name);
+			g_free (choice->from);
+			g_free (choice->from_visible);
+			g_free (choice->from_sql);
+			g_free (choice->to);
+			g_free (choice->to_visible);
+			g_free (choice->to_sql);
+			g_free (choice);
+			node->data = NULL;
+		}
+
+	return FALSE;
+}
+
+static void
+gdaex_query_editor_model_finalize (GObject *object)
+{
+	GdaExQueryEditorModel *gdaex_query_editor_model = GDAEX_QUERY_EDITOR_MODEL (object);
+	GdaExQueryEditorModelPrivate *priv = GDAEX_QUERY_EDITOR_MODEL_GET_PRIVATE (gdaex_query_editor_model);
+
+	gdaex_query_editor_model_clean_choices (gdaex_query_editor_model);
+
+	g_node_destroy (priv->where);
+	g_ptr_array_unref (priv->show);
+	g_ptr_array_unref (priv->order);
+	g_hash_table_destroy (priv->ht_show);
+	g_hash_table_destroy (priv->ht_order);
+	g_object_unref (priv->schema);
+
+	if (priv->widgets != NULL)
+		{
+			g_variant_unref (priv->widgets);
+		}
+
+	g_hash_table_destroy (priv->values_cache);
+	g_mutex_clear (&priv->values_lock);
+	if (priv->values_gdaex != NULL)
+		{
+			gdaex_free (priv->values_gdaex);
+			g_object_unref (priv->values_gdaex);
+		}
+
+	if (priv->count_gdaex != NULL)
+		{
+			gdaex_free (priv->count_gdaex);
+			g_object_unref (priv->count_gdaex);
+		}
+	g_mutex_clear (&priv->count_lock);
+
+	g_hash_table_destroy (priv->statements);
+
+	if (priv->gdaex != NULL)
+		{
+			g_object_unref (priv->gdaex);
+		}
+
+	G_OBJECT_CLASS (gdaex_query_editor_model_parent_class)->finalize (object);
+}
+
+static void
+gdaex_query_editor_model_set_property (GObject *object, guint property_id, const GValue *value, GParamSpec *pspec)
+{
+	GdaExQueryEditorModel *gdaex_query_editor_model = GDAEX_QUERY_EDITOR_MODEL (object);
+	GdaExQueryEditorModelPrivate *priv = GDAEX_QUERY_EDITOR_MODEL_GET_PRIVATE (gdaex_query_editor_model);
+
+	switch (property_id)
+		{
+			default:
+				G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+				break;
+		}
+}
+
+static void
+gdaex_query_editor_model_get_property (GObject *object, guint property_id, GValue *value, GParamSpec *pspec)
+{
+	GdaExQueryEditorModel *gdaex_query_editor_model = GDAEX_QUERY_EDITOR_MODEL (object);
+	GdaExQueryEditorModelPrivate *priv = GDAEX_QUERY_EDITOR_MODEL_GET_PRIVATE (gdaex_query_editor_model);
+
+	switch (property_id)
+		{
+			default:
+				G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+				break;
+		}
+}
@@ -0,0 +1,193 @@
+/*
+ * Copyright (C) 2011-2016 Andrea Zagli <azagli@libero.it>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef __GDAEX_QUERY_EDITOR_MODEL_H__
+#define __GDAEX_QUERY_EDITOR_MODEL_H__
+
+#include <glib.h>
+#include <glib-object.h>
+
+#include <libxml/tree.h>
+
+#include "gdaex.h"
+#include "queryeditorschema.h"
+
+
+G_BEGIN_DECLS
+
+
+typedef struct
+	{
+		gchar *table_name;
+		gchar *field_name;
+		gchar *alias;
+	} GdaExQueryEditorShowChoice;
+
+typedef struct
+	{
+		GdaExQueryEditorLinkType link_type;	/* 0 only for the first choice of a level */
+		gboolean is_group;
+		gchar *table_name;
+		gchar *field_name;
+		gboolean not;
+		GdaExQueryEditorWhereType where_type;
+		gchar *from;
+		gchar *from_visible;
+		gchar *from_sql;
+		gchar *to;
+		gchar *to_visible;
+		gchar *to_sql;
+	} GdaExQueryEditorWhereChoice;
+
+typedef struct
+	{
+		gchar *table_name;
+		gchar *field_name;
+		GdaExQueryEditorOrderType order;
+	} GdaExQueryEditorOrderChoice;
+
+typedef struct
+	{
+		gchar *value;	/* as sql text */
+		GValue *gval;	/* as read, to be formatted for the iwidgets */
+		gint count;	/* rows with the value */
+	} GdaExQueryEditorValue;
+
+
+#define GDAEX_TYPE_QUERY_EDITOR_MODEL                 (gdaex_query_editor_model_get_type ())
+#define GDAEX_QUERY_EDITOR_MODEL(obj)                 (G_TYPE_CHECK_INSTANCE_CAST ((obj), GDAEX_TYPE_QUERY_EDITOR_MODEL, GdaExQueryEditorModel))
+#define GDAEX_QUERY_EDITOR_MODEL_CLASS(klass)         (G_TYPE_CHECK_CLASS_CAST ((klass), GDAEX_TYPE_QUERY_EDITOR_MODEL, GdaExQueryEditorModelClass))
+#define GDAEX_IS_QUERY_EDITOR_MODEL(obj)              (G_TYPE_CHECK_INSTANCE_TYPE ((obj), GDAEX_TYPE_QUERY_EDITOR_MODEL))
+#define GDAEX_IS_QUERY_EDITOR_MODEL_CLASS(klass)      (G_TYPE_CHECK_CLASS_TYPE ((klass), GDAEX_TYPE_QUERY_EDITOR_MODEL))
+#define GDAEX_QUERY_EDITOR_MODEL_GET_CLASS(obj)       (G_TYPE_INSTANCE_GET_CLASS ((obj), GDAEX_TYPE_QUERY_EDITOR_MODEL, GdaExQueryEditorModelClass))
+
+typedef struct _GdaExQueryEditorModel GdaExQueryEditorModel;
+typedef struct _GdaExQueryEditorModelClass GdaExQueryEditorModelClass;
+
+struct _GdaExQueryEditorModel
+	{
+		GObject parent;
+	};
+
+struct _GdaExQueryEditorModelClass
+	{
+		GObjectClass parent_class;
+	};
+
+GType gdaex_query_editor_model_get_type (void) G_GNUC_CONST;
+
+
+GdaExQueryEditorModel *gdaex_query_editor_model_new (GdaEx *gdaex);
+
+GdaEx *gdaex_query_editor_model_get_gdaex (GdaExQueryEditorModel *model);
+
+GdaExQueryEditorSchema *gdaex_query_editor_model_get_schema (GdaExQueryEditorModel *model);
+void gdaex_query_editor_model_set_schema (GdaExQueryEditorModel *model,
+                                          GdaExQueryEditorSchema *schema);
+
+gboolean gdaex_query_editor_model_add_table (GdaExQueryEditorModel *model,
+                                             const gchar *table_name,
+                                             const gchar *table_name_visible);
+gboolean gdaex_query_editor_model_table_add_field (GdaExQueryEditorModel *model,
+                                                   const gchar *table_name,
+                                                   GdaExQueryEditorField field);
+gboolean gdaex_query_editor_model_table_set_visible (GdaExQueryEditorModel *model,
+                                                     const gchar *table_name,
+                                                     gboolean visible);
+gboolean gdaex_query_editor_model_add_relation_slist (GdaExQueryEditorModel *model,
+                                                      const gchar *table1,
+                                                      const gchar *table2,
+                                                      GdaExQueryEditorJoinType join_type,
+                                                      GSList *fields_joined);
+
+GHashTable *gdaex_query_editor_model_get_tables (GdaExQueryEditorModel *model);
+const GdaExQueryEditorTable *gdaex_query_editor_model_get_table (GdaExQueryEditorModel *model,
+                                                                 const gchar *table_name);
+const GdaExQueryEditorField *gdaex_query_editor_model_get_field (GdaExQueryEditorModel *model,
+                                                                 const gchar *table_name,
+                                                                 const gchar *field_name);
+
+void gdaex_query_editor_model_clean (GdaExQueryEditorModel *model);
+
+void gdaex_query_editor_model_load_tables_from_xml (GdaExQueryEditorModel *model,
+                                                    xmlNode *root,
+                                                    gboolean clean);
+void gdaex_query_editor_model_load_tables_from_file (GdaExQueryEditorModel *model,
+                                                     const gchar *filename,
+                                                     gboolean clean);
+GVariant *gdaex_query_editor_model_get_widgets (GdaExQueryEditorModel *model);
+
+void gdaex_query_editor_model_clean_choices (GdaExQueryEditorModel *model);
+void gdaex_query_editor_model_add_always_choices (GdaExQueryEditorModel *model);
+
+gboolean gdaex_query_editor_model_add_show (GdaExQueryEditorModel *model,
+                                            const gchar *table_name,
+                                            const gchar *field_name,
+                                            const gchar *alias);
+GNode *gdaex_query_editor_model_add_where (GdaExQueryEditorModel *model,
+                                           GNode *parent,
+                                           const GdaExQueryEditorWhereChoice *choice);
+gboolean gdaex_query_editor_model_add_order (GdaExQueryEditorModel *model,
+                                             const gchar *table_name,
+                                             const gchar *field_name,
+                                             GdaExQueryEditorOrderType order);
+
+GPtrArray *gdaex_query_editor_model_get_show (GdaExQueryEditorModel *model);
+GNode *gdaex_query_editor_model_get_where (GdaExQueryEditorModel *model);
+GPtrArray *gdaex_query_editor_model_get_order (GdaExQueryEditorModel *model);
+
+GdaSqlBuilder *gdaex_query_editor_model_get_sql_as_gdasqlbuilder (GdaExQueryEditorModel *model);
+GdaStatement *gdaex_query_editor_model_get_statement (GdaExQueryEditorModel *model, GdaSet **params);
+gchar *gdaex_query_editor_model_get_sql (GdaExQueryEditorModel *model);
+
+void gdaex_query_editor_model_set_values_cache_ttl (GdaExQueryEditorModel *model,
+                                                    guint seconds);
+guint gdaex_query_editor_model_get_values_cache_ttl (GdaExQueryEditorModel *model);
+void gdaex_query_editor_model_get_values_async (GdaExQueryEditorModel *model,
+                                                const gchar *table_name,
+                                                const gchar *field_name,
+                                                const gchar *filter,
+                                                guint offset,
+                                                guint limit,
+                                                GCancellable *cancellable,
+                                                GAsyncReadyCallback callback,
+                                                gpointer user_data);
+GPtrArray *gdaex_query_editor_model_get_values_finish (GdaExQueryEditorModel *model,
+                                                       GAsyncResult *result,
+                                                       GError **error);
+
+void gdaex_query_editor_model_count_async (GdaExQueryEditorModel *model,
+                                           guint budget,
+                                           GCancellable *cancellable,
+                                           GAsyncReadyCallback callback,
+                                           gpointer user_data);
+gint64 gdaex_query_editor_model_count_finish (GdaExQueryEditorModel *model,
+                                              GAsyncResult *result,
+                                              gboolean *estimated,
+                                              GError **error);
+
+xmlNode *gdaex_query_editor_model_get_sql_as_xml (GdaExQueryEditorModel *model);
+void gdaex_query_editor_model_load_choices_from_xml (GdaExQueryEditorModel *model,
+                                                     xmlNode *root,
+                                                     gboolean clean);
+
+
+G_END_DECLS
+
+
+#endif /* __GDAEX_QUERY_EDITOR_MODEL_H__ */
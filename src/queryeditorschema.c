@@ -0,0 +1,1697 @@
+/*
+ * Copyright (C) 2011-2016 Andrea Zagli <azagli@libero.it>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifdef HAVE_CONFIG_H
+	#include <config.h>
+#endif
+
+#include <string.h>
+
+#include <glib/gi18n-lib.h>
+
+#include <libxml/parser.h>
+
+#include "queryeditorschema.h"
+
+static void gdaex_query_editor_schema_class_init (GdaExQueryEditorSchemaClass *klass);
+static void gdaex_query_editor_schema_init (GdaExQueryEditorSchema *gdaex_query_editor_schema);
+
+static void gdaex_query_editor_schema_finalize (GObject *object);
+
+static void gdaex_query_editor_schema_table_free (GdaExQueryEditorTable *table);
+static void gdaex_query_editor_schema_field_free (GdaExQueryEditorField *field);
+static void gdaex_query_editor_schema_relation_free (GdaExQueryEditorRelation *relation);
+static void gdaex_query_editor_schema_table_free_mapped (GdaExQueryEditorTable *table);
+
+#define GDAEX_QUERY_EDITOR_SCHEMA_GET_PRIVATE(obj) (G_TYPE_INSTANCE_GET_PRIVATE ((obj), GDAEX_TYPE_QUERY_EDITOR_SCHEMA, GdaExQueryEditorSchemaPrivate))
+
+typedef struct _GdaExQueryEditorSchemaPrivate GdaExQueryEditorSchemaPrivate;
+struct _GdaExQueryEditorSchemaPrivate
+	{
+		GHashTable *tables;	/* GdaExQueryEditorTable */
+		GSList *relations;	/* GdaExQueryEditorRelation */
+
+		GVariant *widgets;	/* a(sss) of the xml loaded */
+		GVariant *mapped;	/* the cache the strings of the tables and fields point into */
+
+		gboolean sealed;	/* shared: no more changes */
+	};
+
+G_DEFINE_TYPE (GdaExQueryEditorSchema, gdaex_query_editor_schema, G_TYPE_OBJECT)
+
+static void
+gdaex_query_editor_schema_class_init (GdaExQueryEditorSchemaClass *klass)
+{
+	GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+	g_type_class_add_private (object_class, sizeof (GdaExQueryEditorSchemaPrivate));
+
+	object_class->finalize = gdaex_query_editor_schema_finalize;
+}
+
+static void
+gdaex_query_editor_schema_init (GdaExQueryEditorSchema *gdaex_query_editor_schema)
+{
+	GdaExQueryEditorSchemaPrivate *priv = GDAEX_QUERY_EDITOR_SCHEMA_GET_PRIVATE (gdaex_query_editor_schema);
+
+	priv->tables = g_hash_table_new_full (g_str_hash, g_str_equal,
+	                                      NULL, (GDestroyNotify)gdaex_query_editor_schema_table_free);
+	priv->relations = NULL;
+	priv->widgets = NULL;
+	priv->mapped = NULL;
+	priv->sealed = FALSE;
+}
+
+/**
+ * gdaex_query_editor_schema_new:
+ *
+ * Creates an empty schema, the tables, fields and relations that a query
+ * editor can choose from.
+ *
+ * Returns: the newly created #GdaExQueryEditorSchema object.
+ */
+GdaExQueryEditorSchema
+*gdaex_query_editor_schema_new (void)
+{
+	return GDAEX_QUERY_EDITOR_SCHEMA (g_object_new (gdaex_query_editor_schema_get_type (), NULL));
+}
+
+/**
+ * gdaex_query_editor_schema_is_sealed:
+ * @schema: a #GdaExQueryEditorSchema object.
+ *
+ * Returns: #TRUE if @schema is shared and can't be changed; see
+ * gdaex_query_editor_schema_copy().
+ */
+gboolean
+gdaex_query_editor_schema_is_sealed (GdaExQueryEditorSchema *schema)
+{
+	g_return_val_if_fail (GDAEX_IS_QUERY_EDITOR_SCHEMA (schema), FALSE);
+
+	GdaExQueryEditorSchemaPrivate *priv = GDAEX_QUERY_EDITOR_SCHEMA_GET_PRIVATE (schema);
+
+	return priv->sealed;
+}
+
+gboolean
+gdaex_query_editor_schema_add_table (GdaExQueryEditorSchema *schema,
+                                    const gchar *table_name,
+                                    const gchar *table_name_visible)
+{
+	GdaExQueryEditorSchemaPrivate *priv;
+	GdaExQueryEditorTable *table;
+
+	gchar *_table_name;
+
+	g_return_val_if_fail (GDAEX_IS_QUERY_EDITOR_SCHEMA (schema), FALSE);
+	g_return_val_if_fail (table_name != NULL, FALSE);
+
+	priv = GDAEX_QUERY_EDITOR_SCHEMA_GET_PRIVATE (schema);
+
+	g_return_val_if_fail (!priv->sealed, FALSE);
+
+	_table_name = g_strstrip (g_strdup (table_name));
+	if (g_strcmp0 (_table_name, "") == 0)
+		{
+			g_free (_table_name);
+			return FALSE;
+		}
+
+	table = g_new0 (GdaExQueryEditorTable, 1);
+	table->name = _table_name;
+
+	if (table_name_visible != NULL)
+		{
+			table->name_visible = g_strstrip (g_strdup (table_name_visible));
+		}
+	if (table->name_visible == NULL
+	    || g_strcmp0 (table->name_visible, "") == 0)
+		{
+			g_free (table->name_visible);
+			table->name_visible = g_strdup (table->name);
+		}
+
+	table->fields = g_hash_table_new_full (g_str_hash, g_str_equal,
+	                                       NULL, (GDestroyNotify)gdaex_query_editor_schema_field_free);
+	table->visible = TRUE;
+
+	g_hash_table_replace (priv->tables, table->name, table);
+
+	return TRUE;
+}
+
+/**
+ * gdaex_query_editor_schema_table_add_field:
+ * @schema: a #GdaExQueryEditorSchema object.
+ * @table_name:
+ * @field:
+ *
+ * Adds a copy of @field to @table_name; the strings of @field are copied,
+ * the iwidgets are ignored.
+ *
+ * Returns: #TRUE on success.
+ */
+gboolean
+gdaex_query_editor_schema_table_add_field (GdaExQueryEditorSchema *schema,
+                                          const gchar *table_name,
+                                          GdaExQueryEditorField field)
+{
+	GdaExQueryEditorSchemaPrivate *priv;
+	GdaExQueryEditorTable *table;
+	GdaExQueryEditorField *_field;
+
+	g_return_val_if_fail (GDAEX_IS_QUERY_EDITOR_SCHEMA (schema), FALSE);
+	g_return_val_if_fail (table_name != NULL, FALSE);
+
+	priv = GDAEX_QUERY_EDITOR_SCHEMA_GET_PRIVATE (schema);
+
+	g_return_val_if_fail (!priv->sealed, FALSE);
+
+	table = g_hash_table_lookup (priv->tables, table_name);
+	if (table == NULL)
+		{
+			g_warning (_("Table «%s» doesn't exists."), table_name);
+			return FALSE;
+		}
+
+	if (field.name == NULL)
+		{
+			g_warning (_("No field added: the field must have a name."));
+			return FALSE;
+		}
+
+	_field = g_memdup (&field, sizeof (GdaExQueryEditorField));
+	_field->table_name = g_strdup (table->name);
+	_field->name = g_strstrip (g_strdup (field.name));
+	if (g_strcmp0 (_field->name, "") == 0)
+		{
+			g_warning (_("No field added: the field must have a name."));
+			g_free (_field->table_name);
+			g_free (_field->name);
+			g_free (_field);
+			return FALSE;
+		}
+
+	_field->name_visible = (field.name_visible != NULL ? g_strstrip (g_strdup (field.name_visible)) : NULL);
+	if (_field->name_visible == NULL
+	    || g_strcmp0 (_field->name_visible, "") == 0)
+		{
+			g_free (_field->name_visible);
+			_field->name_visible = g_strdup (_field->name);
+		}
+
+	_field->description = g_strdup (field.description);
+	_field->alias = g_strdup (field.alias);
+	_field->where_default_from = g_strdup (field.where_default_from);
+	_field->where_default_from_visible = g_strdup (field.where_default_from_visible);
+	_field->where_default_from_sql = g_strdup (field.where_default_from_sql);
+	_field->where_default_to = g_strdup (field.where_default_to);
+	_field->where_default_to_visible = g_strdup (field.where_default_to_visible);
+	_field->where_default_to_sql = g_strdup (field.where_default_to_sql);
+	_field->decode_table2 = g_strdup (field.decode_table2);
+	_field->decode_field2 = g_strdup (field.decode_field2);
+	_field->decode_field_to_show = g_strdup (field.decode_field_to_show);
+	_field->decode_field_alias = g_strdup (field.decode_field_alias);
+	_field->normalized = g_strdup (field.normalized);
+	_field->iwidget_from = NULL;
+	_field->iwidget_to = NULL;
+
+	g_hash_table_replace (table->fields, _field->name, _field);
+
+	return TRUE;
+}
+
+/**
+ * gdaex_query_editor_schema_add_relation_slist:
+ * @schema: a #GdaExQueryEditorSchema object.
+ * @table1: relation's left part.
+ * @table2: relation's right part.
+ * @join_type:
+ * @fields_joined: couples of fields name, one from @table1 and one from @table2.
+ *
+ */
+gboolean
+gdaex_query_editor_schema_add_relation_slist (GdaExQueryEditorSchema *schema,
+                                             const gchar *table1,
+                                             const gchar *table2,
+                                             GdaExQueryEditorJoinType join_type,
+                                             GSList *fields_joined)
+{
+	GdaExQueryEditorSchemaPrivate *priv;
+
+	GdaExQueryEditorRelation *relation;
+	GdaExQueryEditorField *field1;
+	GdaExQueryEditorField *field2;
+
+	g_return_val_if_fail (GDAEX_IS_QUERY_EDITOR_SCHEMA (schema), FALSE);
+	g_return_val_if_fail (fields_joined != NULL, FALSE);
+
+	priv = GDAEX_QUERY_EDITOR_SCHEMA_GET_PRIVATE (schema);
+
+	g_return_val_if_fail (!priv->sealed, FALSE);
+
+	relation = g_new0 (GdaExQueryEditorRelation, 1);
+
+	/* check if table exists */
+	relation->table1 = g_hash_table_lookup (priv->tables, table1);
+	if (relation->table1 == NULL)
+		{
+			g_warning (_("Table «%s» doesn't exists."), table1);
+			g_free (relation);
+			return FALSE;
+		}
+
+	relation->table2 = g_hash_table_lookup (priv->tables, table2);
+	if (relation->table2 == NULL)
+		{
+			g_warning (_("Table «%s» doesn't exists."), table2);
+			g_free (relation);
+			return FALSE;
+		}
+
+	while (fields_joined != NULL && g_slist_next (fields_joined) != NULL)
+		{
+			field1 = g_hash_table_lookup (relation->table1->fields, (gchar *)fields_joined->data);
+			fields_joined = g_slist_next (fields_joined);
+			field2 = g_hash_table_lookup (relation->table2->fields, (gchar *)fields_joined->data);
+			fields_joined = g_slist_next (fields_joined);
+
+			if (field1 != NULL && field2 != NULL)
+				{
+					relation->fields1 = g_slist_append (relation->fields1, field1);
+					relation->fields2 = g_slist_append (relation->fields2, field2);
+				}
+		}
+
+	if (relation->fields1 == NULL)
+		{
+			g_warning (_("Relation not created: no field added to the relation."));
+			g_free (relation);
+			return FALSE;
+		}
+
+	relation->join_type = join_type;
+	priv->relations = g_slist_append (priv->relations, relation);
+
+	return TRUE;
+}
+
+/**
+ * gdaex_query_editor_schema_table_set_visible:
+ * @schema: a not sealed #GdaExQueryEditorSchema object.
+ * @table_name:
+ * @visible:
+ *
+ * Returns: #TRUE on success.
+ */
+gboolean
+gdaex_query_editor_schema_table_set_visible (GdaExQueryEditorSchema *schema,
+                                            const gchar *table_name,
+                                            gboolean visible)
+{
+	GdaExQueryEditorSchemaPrivate *priv;
+	GdaExQueryEditorTable *table;
+
+	g_return_val_if_fail (GDAEX_IS_QUERY_EDITOR_SCHEMA (schema), FALSE);
+	g_return_val_if_fail (table_name != NULL, FALSE);
+
+	priv = GDAEX_QUERY_EDITOR_SCHEMA_GET_PRIVATE (schema);
+
+	g_return_val_if_fail (!priv->sealed, FALSE);
+
+	table = g_hash_table_lookup (priv->tables, table_name);
+	if (table == NULL)
+		{
+			g_warning (_("Table «%s» doesn't exists."), table_name);
+			return FALSE;
+		}
+
+	table->visible = visible;
+
+	return TRUE;
+}
+
+/**
+ * gdaex_query_editor_schema_get_tables:
+ * @schema: a #GdaExQueryEditorSchema object.
+ *
+ * Returns: (transfer none): the tables of @schema, keyed by name.
+ */
+GHashTable
+*gdaex_query_editor_schema_get_tables (GdaExQueryEditorSchema *schema)
+{
+	g_return_val_if_fail (GDAEX_IS_QUERY_EDITOR_SCHEMA (schema), NULL);
+
+	GdaExQueryEditorSchemaPrivate *priv = GDAEX_QUERY_EDITOR_SCHEMA_GET_PRIVATE (schema);
+
+	return priv->tables;
+}
+
+/**
+ * gdaex_query_editor_schema_get_table:
+ * @schema: a #GdaExQueryEditorSchema object.
+ * @table_name:
+ *
+ * Returns: (transfer none): the table named @table_name, or #NULL; it
+ * must not be changed, the schema can be shared.
+ */
+const GdaExQueryEditorTable
+*gdaex_query_editor_schema_get_table (GdaExQueryEditorSchema *schema,
+                                     const gchar *table_name)
+{
+	g_return_val_if_fail (GDAEX_IS_QUERY_EDITOR_SCHEMA (schema), NULL);
+
+	GdaExQueryEditorSchemaPrivate *priv = GDAEX_QUERY_EDITOR_SCHEMA_GET_PRIVATE (schema);
+
+	if (table_name == NULL)
+		{
+			return NULL;
+		}
+
+	return g_hash_table_lookup (priv->tables, table_name);
+}
+
+/**
+ * gdaex_query_editor_schema_get_field:
+ * @schema: a #GdaExQueryEditorSchema object.
+ * @table_name:
+ * @field_name:
+ *
+ * Returns: (transfer none): the field, or #NULL; it must not be changed,
+ * the schema can be shared.
+ */
+const GdaExQueryEditorField
+*gdaex_query_editor_schema_get_field (GdaExQueryEditorSchema *schema,
+                                     const gchar *table_name,
+                                     const gchar *field_name)
+{
+	const GdaExQueryEditorTable *table;
+
+	table = gdaex_query_editor_schema_get_table (schema, table_name);
+	if (table == NULL || field_name == NULL)
+		{
+			return NULL;
+		}
+
+	return g_hash_table_lookup (table->fields, field_name);
+}
+
+static GdaExQueryEditorFieldType
+gdaex_query_editor_schema_str_to_field_type (const gchar *str)
+{
+	GdaExQueryEditorFieldType ret;
+
+	g_return_val_if_fail (str != NULL, 0);
+
+	ret = 0;
+
+	if (g_strcmp0 (str, "text") == 0
+		|| g_strcmp0 (str, "string") == 0)
+		{
+			ret = GDAEX_QE_FIELD_TYPE_TEXT;
+		}
+	else if (g_strcmp0 (str, "integer") == 0
+			 || g_strcmp0 (str, "int") == 0)
+		{
+			ret = GDAEX_QE_FIELD_TYPE_INTEGER;
+		}
+	else if (g_strcmp0 (str, "boolean") == 0
+			 || g_strcmp0 (str, "bool") == 0)
+		{
+			ret = GDAEX_QE_FIELD_TYPE_BOOLEAN;
+		}
+	else if (g_strcmp0 (str, "double") == 0
+			 || g_strcmp0 (str, "float") == 0)
+		{
+			ret = GDAEX_QE_FIELD_TYPE_DOUBLE;
+		}
+	else if (g_strcmp0 (str, "date") == 0)
+		{
+			ret = GDAEX_QE_FIELD_TYPE_DATE;
+		}
+	else if (g_strcmp0 (str, "datetime") == 0)
+		{
+			ret = GDAEX_QE_FIELD_TYPE_DATETIME;
+		}
+	else if (g_strcmp0 (str, "time") == 0)
+		{
+			ret = GDAEX_QE_FIELD_TYPE_TIME;
+		}
+
+	return ret;
+}
+
+static guint
+gdaex_query_editor_schema_str_to_where_type (const gchar *str)
+{
+	guint ret;
+
+	gchar **types;
+
+	guint i;
+	guint l;
+
+	g_return_val_if_fail (str != NULL, 0);
+
+	ret = 0;
+
+	types = g_strsplit (str, "|", 0);
+
+	l = g_strv_length (types);
+	for (i = 0; i < l; i++)
+		{
+			if (g_strcmp0 (types[i], "equal") == 0)
+				{
+					ret |= GDAEX_QE_WHERE_TYPE_EQUAL;
+				}
+			else if (g_strcmp0 (types[i], "starts") == 0)
+				{
+					ret |= GDAEX_QE_WHERE_TYPE_STARTS;
+				}
+			else if (g_strcmp0 (types[i], "contains") == 0)
+				{
+					ret |= GDAEX_QE_WHERE_TYPE_CONTAINS;
+				}
+			else if (g_strcmp0 (types[i], "ends") == 0)
+				{
+					ret |= GDAEX_QE_WHERE_TYPE_ENDS;
+				}
+			else if (g_strcmp0 (types[i], "istarts") == 0)
+				{
+					ret |= GDAEX_QE_WHERE_TYPE_ISTARTS;
+				}
+			else if (g_strcmp0 (types[i], "icontains") == 0)
+				{
+					ret |= GDAEX_QE_WHERE_TYPE_ICONTAINS;
+				}
+			else if (g_strcmp0 (types[i], "iends") == 0)
+				{
+					ret |= GDAEX_QE_WHERE_TYPE_IENDS;
+				}
+			else if (g_strcmp0 (types[i], "great") == 0)
+				{
+					ret |= GDAEX_QE_WHERE_TYPE_GREAT;
+				}
+			else if (g_strcmp0 (types[i], "great_equal") == 0)
+				{
+					ret |= GDAEX_QE_WHERE_TYPE_GREAT_EQUAL;
+				}
+			else if (g_strcmp0 (types[i], "less") == 0)
+				{
+					ret |= GDAEX_QE_WHERE_TYPE_LESS;
+				}
+			else if (g_strcmp0 (types[i], "less_equal") == 0)
+				{
+					ret |= GDAEX_QE_WHERE_TYPE_LESS_EQUAL;
+				}
+			else if (g_strcmp0 (types[i], "between") == 0)
+				{
+					ret |= GDAEX_QE_WHERE_TYPE_BETWEEN;
+				}
+			else if (g_strcmp0 (types[i], "is_null") == 0)
+				{
+					ret |= GDAEX_QE_WHERE_TYPE_IS_NULL;
+				}
+			else if (g_strcmp0 (types[i], "string") == 0)
+				{
+					ret |= GDAEX_QE_WHERE_TYPE_STRING;
+				}
+			else if (g_strcmp0 (types[i], "number") == 0)
+				{
+					ret |= GDAEX_QE_WHERE_TYPE_NUMBER;
+				}
+			else if (g_strcmp0 (types[i], "datetime") == 0)
+				{
+					ret |= GDAEX_QE_WHERE_TYPE_DATETIME;
+				}
+		}
+
+	g_strfreev (types);
+
+	return ret;
+}
+
+static GdaExQueryEditorJoinType
+gdaex_query_editor_schema_str_to_join_type (const gchar *str)
+{
+	GdaExQueryEditorJoinType ret;
+
+	g_return_val_if_fail (str != NULL, 0);
+
+	ret = 0;
+
+	if (g_strcmp0 (str, "inner") == 0)
+		{
+			ret = GDAEX_QE_JOIN_TYPE_INNER;
+		}
+	else if (g_strcmp0 (str, "left") == 0)
+		{
+			ret = GDAEX_QE_JOIN_TYPE_LEFT;
+		}
+
+	return ret;
+}
+
+/* returns the stripped content of @xnode, to be freed with g_free */
+static gchar
+*gdaex_query_editor_schema_xml_get_content (xmlNode *xnode)
+{
+	xmlChar *content;
+	gchar *ret;
+
+	content = xmlNodeGetContent (xnode);
+	if (content == NULL)
+		{
+			return NULL;
+		}
+
+	ret = g_strstrip (g_strdup ((gchar *)content));
+	xmlFree (content);
+
+	return ret;
+}
+
+static gboolean
+gdaex_query_editor_schema_xml_get_boolean (xmlNode *xnode)
+{
+	gchar *content;
+	gboolean ret;
+
+	content = gdaex_query_editor_schema_xml_get_content (xnode);
+	ret = zak_utils_string_to_boolean (content);
+	g_free (content);
+
+	return ret;
+}
+
+static void
+gdaex_query_editor_schema_xml_get_where_default (xmlNode *xnode,
+                                                gchar **value,
+                                                gchar **visible,
+                                                gchar **sql)
+{
+	xmlNode *cur;
+
+	cur = xnode->children;
+	while (cur != NULL)
+		{
+			if (xmlStrcmp (cur->name, (const xmlChar *)"w_value") == 0)
+				{
+					g_free (*value);
+					*value = gdaex_query_editor_schema_xml_get_content (cur);
+				}
+			else if (xmlStrcmp (cur->name, (const xmlChar *)"w_visible") == 0)
+				{
+					g_free (*visible);
+					*visible = gdaex_query_editor_schema_xml_get_content (cur);
+				}
+			else if (xmlStrcmp (cur->name, (const xmlChar *)"w_sql") == 0)
+				{
+					g_free (*sql);
+					*sql = gdaex_query_editor_schema_xml_get_content (cur);
+				}
+
+			cur = cur->next;
+		}
+}
+
+/* frees the strings of a field read from xml, not the field itself */
+static void
+gdaex_query_editor_schema_field_free_strings (GdaExQueryEditorField *field)
+{
+	g_free (field->table_name);
+	g_free (field->name);
+	g_free (field->name_visible);
+	g_free (field->description);
+	g_free (field->alias);
+	g_free (field->where_default_from);
+	g_free (field->where_default_from_visible);
+	g_free (field->where_default_from_sql);
+	g_free (field->where_default_to);
+	g_free (field->where_default_to_visible);
+	g_free (field->where_default_to_sql);
+	g_free (field->decode_table2);
+	g_free (field->decode_field2);
+	g_free (field->decode_field_to_show);
+	g_free (field->decode_field_alias);
+	g_free (field->normalized);
+}
+
+static void
+gdaex_query_editor_schema_load_table_from_xml (GdaExQueryEditorSchema *schema,
+                                              xmlNode *xtable)
+{
+	xmlNode *cur;
+
+	gchar *table_name;
+	gchar *name_visible;
+
+	table_name = NULL;
+	name_visible = NULL;
+
+	cur = xtable->children;
+	while (cur != NULL)
+		{
+			if (xmlStrcmp (cur->name, (const xmlChar *)"name") == 0)
+				{
+					g_free (table_name);
+					table_name = gdaex_query_editor_schema_xml_get_content (cur);
+				}
+			else if (xmlStrcmp (cur->name, (const xmlChar *)"name_visible") == 0)
+				{
+					g_free (name_visible);
+					name_visible = gdaex_query_editor_schema_xml_get_content (cur);
+				}
+
+			cur = cur->next;
+		}
+
+	if (table_name != NULL)
+		{
+			gdaex_query_editor_schema_add_table (schema, table_name, name_visible);
+		}
+
+	g_free (table_name);
+	g_free (name_visible);
+}
+
+static void
+gdaex_query_editor_schema_load_field_from_xml (GdaExQueryEditorSchema *schema,
+                                              const gchar *table_name,
+                                              xmlNode *xfield)
+{
+	GdaExQueryEditorField field;
+
+	xmlNode *cur;
+	xmlNode *xdecode;
+	gchar *content;
+
+	memset (&field, 0, sizeof (GdaExQueryEditorField));
+	field.for_show = TRUE;
+	field.for_where = TRUE;
+	field.for_order = TRUE;
+
+	field.where_default_from = g_strdup ("");
+	field.where_default_from_visible = g_strdup ("");
+	field.where_default_from_sql = g_strdup ("");
+	field.where_default_to = g_strdup ("");
+	field.where_default_to_visible = g_strdup ("");
+	field.where_default_to_sql = g_strdup ("");
+
+	cur = xfield->children;
+	while (cur != NULL)
+		{
+			if (xmlStrcmp (cur->name, (const xmlChar *)"name") == 0)
+				{
+					g_free (field.name);
+					field.name = gdaex_query_editor_schema_xml_get_content (cur);
+				}
+			else if (xmlStrcmp (cur->name, (const xmlChar *)"name_visible") == 0)
+				{
+					g_free (field.name_visible);
+					field.name_visible = gdaex_query_editor_schema_xml_get_content (cur);
+				}
+			else if (xmlStrcmp (cur->name, (const xmlChar *)"description") == 0)
+				{
+					g_free (field.description);
+					field.description = gdaex_query_editor_schema_xml_get_content (cur);
+				}
+			else if (xmlStrcmp (cur->name, (const xmlChar *)"alias") == 0)
+				{
+					g_free (field.alias);
+					field.alias = gdaex_query_editor_schema_xml_get_content (cur);
+				}
+			else if (xmlStrcmp (cur->name, (const xmlChar *)"type") == 0)
+				{
+					content = gdaex_query_editor_schema_xml_get_content (cur);
+					field.type = gdaex_query_editor_schema_str_to_field_type (content);
+					g_free (content);
+				}
+			else if (xmlStrcmp (cur->name, (const xmlChar *)"for_show") == 0)
+				{
+					field.for_show = gdaex_query_editor_schema_xml_get_boolean (cur);
+				}
+			else if (xmlStrcmp (cur->name, (const xmlChar *)"always_showed") == 0)
+				{
+					field.always_showed = gdaex_query_editor_schema_xml_get_boolean (cur);
+				}
+			else if (xmlStrcmp (cur->name, (const xmlChar *)"for_where") == 0)
+				{
+					field.for_where = gdaex_query_editor_schema_xml_get_boolean (cur);
+				}
+			else if (xmlStrcmp (cur->name, (const xmlChar *)"available_where_type") == 0)
+				{
+					content = gdaex_query_editor_schema_xml_get_content (cur);
+					field.available_where_type = gdaex_query_editor_schema_str_to_where_type (content);
+					g_free (content);
+				}
+			else if (xmlStrcmp (cur->name, (const xmlChar *)"where_default_not") == 0)
+				{
+					field.where_default_not = gdaex_query_editor_schema_xml_get_boolean (cur);
+				}
+			else if (xmlStrcmp (cur->name, (const xmlChar *)"where_default_type") == 0)
+				{
+					content = gdaex_query_editor_schema_xml_get_content (cur);
+					field.where_default_type = gdaex_query_editor_schema_str_to_where_type (content);
+					g_free (content);
+				}
+			else if (xmlStrcmp (cur->name, (const xmlChar *)"where_default_from") == 0)
+				{
+					gdaex_query_editor_schema_xml_get_where_default (cur,
+					                                                &field.where_default_from,
+					                                                &field.where_default_from_visible,
+					                                                &field.where_default_from_sql);
+				}
+			else if (xmlStrcmp (cur->name, (const xmlChar *)"where_default_to") == 0)
+				{
+					gdaex_query_editor_schema_xml_get_where_default (cur,
+					                                                &field.where_default_to,
+					                                                &field.where_default_to_visible,
+					                                                &field.where_default_to_sql);
+				}
+			else if (xmlStrcmp (cur->name, (const xmlChar *)"for_order") == 0)
+				{
+					field.for_order = gdaex_query_editor_schema_xml_get_boolean (cur);
+				}
+			else if (xmlStrcmp (cur->name, (const xmlChar *)"always_ordered") == 0)
+				{
+					field.always_ordered = gdaex_query_editor_schema_xml_get_boolean (cur);
+				}
+			else if (xmlStrcmp (cur->name, (const xmlChar *)"order_default") == 0)
+				{
+					content = gdaex_query_editor_schema_xml_get_content (cur);
+					field.order_default = (g_strcmp0 (content, "ASC") == 0 ? GDAEX_QE_ORDER_ASC : GDAEX_QE_ORDER_DESC);
+					g_free (content);
+				}
+			else if (xmlStrcmp (cur->name, (const xmlChar *)"normalized") == 0)
+				{
+					g_free (field.normalized);
+					field.normalized = gdaex_query_editor_schema_xml_get_content (cur);
+				}
+			else if (xmlStrcmp (cur->name, (const xmlChar *)"decode") == 0)
+				{
+					xdecode = cur->children;
+					while (xdecode != NULL)
+						{
+							if (xmlStrcmp (xdecode->name, (const xmlChar *)"table_name") == 0)
+								{
+									g_free (field.decode_table2);
+									field.decode_table2 = gdaex_query_editor_schema_xml_get_content (xdecode);
+								}
+							else if (xmlStrcmp (xdecode->name, (const xmlChar *)"join_type") == 0)
+								{
+									content = gdaex_query_editor_schema_xml_get_content (xdecode);
+									field.decode_join_type = gdaex_query_editor_schema_str_to_join_type (content);
+									g_free (content);
+								}
+							else if (xmlStrcmp (xdecode->name, (const xmlChar *)"field_name_to_join") == 0)
+								{
+									g_free (field.decode_field2);
+									field.decode_field2 = gdaex_query_editor_schema_xml_get_content (xdecode);
+								}
+							else if (xmlStrcmp (xdecode->name, (const xmlChar *)"field_name_to_show") == 0)
+								{
+									g_free (field.decode_field_to_show);
+									field.decode_field_to_show = gdaex_query_editor_schema_xml_get_content (xdecode);
+								}
+							else if (xmlStrcmp (xdecode->name, (const xmlChar *)"alias") == 0)
+								{
+									g_free (field.decode_field_alias);
+									field.decode_field_alias = gdaex_query_editor_schema_xml_get_content (xdecode);
+								}
+
+							xdecode = xdecode->next;
+						}
+				}
+
+			cur = cur->next;
+		}
+
+	gdaex_query_editor_schema_table_add_field (schema, table_name, field);
+	gdaex_query_editor_schema_field_free_strings (&field);
+}
+
+static void
+gdaex_query_editor_schema_load_relation_from_xml (GdaExQueryEditorSchema *schema,
+                                                 xmlNode *xrelation)
+{
+	xmlNode *cur;
+	xmlNode *xfields_joined;
+
+	gchar *table_left;
+	gchar *table_right;
+	gchar *name;
+	gchar *content;
+	GdaExQueryEditorJoinType join_type;
+	GSList *fields_joined;
+
+	table_left = NULL;
+	table_right = NULL;
+	join_type = 0;
+	fields_joined = NULL;
+
+	cur = xrelation->children;
+	while (cur != NULL)
+		{
+			if (xmlStrcmp (cur->name, (const xmlChar *)"table_left") == 0)
+				{
+					g_free (table_left);
+					table_left = gdaex_query_editor_schema_xml_get_content (cur);
+				}
+			else if (xmlStrcmp (cur->name, (const xmlChar *)"table_right") == 0)
+				{
+					g_free (table_right);
+					table_right = gdaex_query_editor_schema_xml_get_content (cur);
+				}
+			else if (xmlStrcmp (cur->name, (const xmlChar *)"join_type") == 0)
+				{
+					content = gdaex_query_editor_schema_xml_get_content (cur);
+					join_type = gdaex_query_editor_schema_str_to_join_type (content);
+					g_free (content);
+				}
+			else if (xmlStrcmp (cur->name, (const xmlChar *)"fields_joined") == 0)
+				{
+					xfields_joined = cur->children;
+					while (xfields_joined != NULL)
+						{
+							if (xmlStrcmp (xfields_joined->name, (const xmlChar *)"field_left") == 0
+							    || xmlStrcmp (xfields_joined->name, (const xmlChar *)"field_right") == 0)
+								{
+									name = gdaex_query_editor_schema_xml_get_content (xfields_joined);
+									if (name != NULL)
+										{
+											fields_joined = g_slist_append (fields_joined, name);
+										}
+								}
+
+							xfields_joined = xfields_joined->next;
+						}
+				}
+
+			cur = cur->next;
+		}
+
+	if (table_left != NULL
+	    && table_right != NULL
+	    && fields_joined != NULL)
+		{
+			gdaex_query_editor_schema_add_relation_slist (schema, table_left, table_right, join_type, fields_joined);
+		}
+
+	g_free (table_left);
+	g_free (table_right);
+	g_slist_free_full (fields_joined, g_free);
+}
+
+/**
+ * gdaex_query_editor_schema_load_tables_from_xml:
+ * @schema: a #GdaExQueryEditorSchema object.
+ * @root: a gdaex_query_editor #xmlNode.
+ *
+ * Adds the tables, fields and relations of @root to @schema; widget nodes
+ * are ignored.
+ */
+void
+gdaex_query_editor_schema_load_tables_from_xml (GdaExQueryEditorSchema *schema,
+                                                xmlNode *root)
+{
+	xmlNode *xnode;
+	xmlNode *xchild;
+
+	xmlChar *table_name;
+
+	gboolean tables_found;
+	gboolean fields_found;
+
+	g_return_if_fail (GDAEX_IS_QUERY_EDITOR_SCHEMA (schema));
+	g_return_if_fail (!gdaex_query_editor_schema_is_sealed (schema));
+	g_return_if_fail (root != NULL);
+	g_return_if_fail (xmlStrcmp (root->name, (const xmlChar *)"gdaex_query_editor") == 0);
+
+	tables_found = FALSE;
+	fields_found = FALSE;
+
+	/* tables before fields before relations, whatever the order in the file */
+	for (xnode = root->children; xnode != NULL; xnode = xnode->next)
+		{
+			if (xmlStrcmp (xnode->name, (const xmlChar *)"tables") == 0)
+				{
+					tables_found = TRUE;
+					for (xchild = xnode->children; xchild != NULL; xchild = xchild->next)
+						{
+							if (xmlStrcmp (xchild->name, (const xmlChar *)"table") == 0)
+								{
+									gdaex_query_editor_schema_load_table_from_xml (schema, xchild);
+								}
+						}
+				}
+		}
+	if (!tables_found)
+		{
+			g_warning (_("No table's definitions on xml file."));
+		}
+
+	for (xnode = root->children; xnode != NULL; xnode = xnode->next)
+		{
+			if (xmlStrcmp (xnode->name, (const xmlChar *)"fields") == 0)
+				{
+					fields_found = TRUE;
+					table_name = xmlGetProp (xnode, (const xmlChar *)"table");
+					for (xchild = xnode->children; xchild != NULL; xchild = xchild->next)
+						{
+							if (xmlStrcmp (xchild->name, (const xmlChar *)"field") == 0)
+								{
+									gdaex_query_editor_schema_load_field_from_xml (schema, (gchar *)table_name, xchild);
+								}
+						}
+					xmlFree (table_name);
+				}
+		}
+	if (!fields_found)
+		{
+			g_warning (_("No field's definitions on xml file."));
+		}
+
+	for (xnode = root->children; xnode != NULL; xnode = xnode->next)
+		{
+			if (xmlStrcmp (xnode->name, (const xmlChar *)"relations") == 0)
+				{
+					for (xchild = xnode->children; xchild != NULL; xchild = xchild->next)
+						{
+							if (xmlStrcmp (xchild->name, (const xmlChar *)"relation") == 0)
+								{
+									gdaex_query_editor_schema_load_relation_from_xml (schema, xchild);
+								}
+						}
+				}
+		}
+}
+
+
+/* binary cache of the parsed definitions, a GVariant of type
+ * GDAEX_QE_CACHE_TYPE saved as <user cache dir>/libgdaex/queryeditor/<sha256 of the xml>
+ * and mapped directly on later loads */
+#define GDAEX_QE_CACHE_VERSION 2
+#define GDAEX_QE_CACHE_FIELD_TYPE "(smsmsmsubbbubumsmsmsmsmsmsbbumsumsmsmsms)"
+#define GDAEX_QE_CACHE_TYPE "(uua(smsba" GDAEX_QE_CACHE_FIELD_TYPE ")a(ssuas)a(sss))"
+
+/* the schemas loaded from file, shared by the whole process */
+G_LOCK_DEFINE_STATIC (registry);
+static GHashTable *registry = NULL;	/* sha256 => GdaExQueryEditorSchema */
+
+static GVariant
+*gdaex_query_editor_schema_widgets_from_xml (xmlNode *root)
+{
+	GVariantBuilder builder;
+
+	xmlNode *xfields;
+	xmlNode *xfield;
+	xmlNode *cur;
+	xmlChar *table_name;
+	gchar *field_name;
+	xmlBuffer *xbuf;
+
+	g_variant_builder_init (&builder, G_VARIANT_TYPE ("a(sss)"));
+
+	for (xfields = root->children; xfields != NULL; xfields = xfields->next)
+		{
+			if (xmlStrcmp (xfields->name, (const xmlChar *)"fields") != 0)
+				{
+					continue;
+				}
+
+			table_name = xmlGetProp (xfields, (const xmlChar *)"table");
+			for (xfield = xfields->children; xfield != NULL; xfield = xfield->next)
+				{
+					if (xmlStrcmp (xfield->name, (const xmlChar *)"field") != 0)
+						{
+							continue;
+						}
+
+					field_name = NULL;
+					for (cur = xfield->children; cur != NULL; cur = cur->next)
+						{
+							if (xmlStrcmp (cur->name, (const xmlChar *)"name") == 0)
+								{
+									field_name = gdaex_query_editor_schema_xml_get_content (cur);
+									break;
+								}
+						}
+					if (field_name == NULL)
+						{
+							continue;
+						}
+
+					for (cur = xfield->children; cur != NULL; cur = cur->next)
+						{
+							if (xmlStrcmp (cur->name, (const xmlChar *)"widget") == 0
+							    || xmlStrcmp (cur->name, (const xmlChar *)"widget_from") == 0
+							    || xmlStrcmp (cur->name, (const xmlChar *)"widget_to") == 0)
+								{
+									xbuf = xmlBufferCreate ();
+									xmlNodeDump (xbuf, cur->doc, cur, 0, 0);
+									g_variant_builder_add (&builder, "(sss)",
+									                       table_name != NULL ? (const gchar *)table_name : "",
+									                       field_name,
+									                       (const gchar *)xmlBufferContent (xbuf));
+									xmlBufferFree (xbuf);
+								}
+						}
+					g_free (field_name);
+				}
+			xmlFree (table_name);
+		}
+
+	return g_variant_ref_sink (g_variant_builder_end (&builder));
+}
+
+static GVariant
+*gdaex_query_editor_schema_to_variant (GdaExQueryEditorSchema *schema)
+{
+	GVariantBuilder builder;
+	GHashTableIter hiter_table;
+	GHashTableIter hiter_field;
+	gpointer key;
+	gpointer value;
+	GdaExQueryEditorTable *table;
+	GdaExQueryEditorField *f;
+	GdaExQueryEditorRelation *relation;
+	GSList *relations;
+	GSList *fields1;
+	GSList *fields2;
+
+	GdaExQueryEditorSchemaPrivate *priv = GDAEX_QUERY_EDITOR_SCHEMA_GET_PRIVATE (schema);
+
+	g_variant_builder_init (&builder, G_VARIANT_TYPE (GDAEX_QE_CACHE_TYPE));
+	g_variant_builder_add (&builder, "u", GDAEX_QE_CACHE_VERSION);
+	g_variant_builder_add (&builder, "u", G_BYTE_ORDER);
+
+	g_variant_builder_open (&builder, G_VARIANT_TYPE ("a(smsba" GDAEX_QE_CACHE_FIELD_TYPE ")"));
+	g_hash_table_iter_init (&hiter_table, priv->tables);
+	while (g_hash_table_iter_next (&hiter_table, &key, &value))
+		{
+			table = (GdaExQueryEditorTable *)value;
+
+			g_variant_builder_open (&builder, G_VARIANT_TYPE ("(smsba" GDAEX_QE_CACHE_FIELD_TYPE ")"));
+			g_variant_builder_add (&builder, "s", table->name);
+			g_variant_builder_add (&builder, "ms", table->name_visible);
+			g_variant_builder_add (&builder, "b", table->visible);
+
+			g_variant_builder_open (&builder, G_VARIANT_TYPE ("a" GDAEX_QE_CACHE_FIELD_TYPE));
+			g_hash_table_iter_init (&hiter_field, table->fields);
+			while (g_hash_table_iter_next (&hiter_field, &key, &value))
+				{
+					f = (GdaExQueryEditorField *)value;
+					g_variant_builder_add (&builder, GDAEX_QE_CACHE_FIELD_TYPE,
+					                       f->name, f->name_visible, f->description, f->alias,
+					                       f->type, f->for_show, f->always_showed, f->for_where,
+					                       f->available_where_type, f->where_default_not, f->where_default_type,
+					                       f->where_default_from, f->where_default_from_visible, f->where_default_from_sql,
+					                       f->where_default_to, f->where_default_to_visible, f->where_default_to_sql,
+					                       f->for_order, f->always_ordered, f->order_default,
+					                       f->decode_table2, f->decode_join_type, f->decode_field2,
+					                       f->decode_field_to_show, f->decode_field_alias,
+					                       f->normalized);
+				}
+			g_variant_builder_close (&builder);
+
+			g_variant_builder_close (&builder);
+		}
+	g_variant_builder_close (&builder);
+
+	g_variant_builder_open (&builder, G_VARIANT_TYPE ("a(ssuas)"));
+	for (relations = priv->relations; relations != NULL; relations = g_slist_next (relations))
+		{
+			relation = (GdaExQueryEditorRelation *)relations->data;
+
+			g_variant_builder_open (&builder, G_VARIANT_TYPE ("(ssuas)"));
+			g_variant_builder_add (&builder, "s", relation->table1->name);
+			g_variant_builder_add (&builder, "s", relation->table2->name);
+			g_variant_builder_add (&builder, "u", relation->join_type);
+			g_variant_builder_open (&builder, G_VARIANT_TYPE ("as"));
+			for (fields1 = relation->fields1, fields2 = relation->fields2;
+			     fields1 != NULL && fields2 != NULL;
+			     fields1 = g_slist_next (fields1), fields2 = g_slist_next (fields2))
+				{
+					g_variant_builder_add (&builder, "s", ((GdaExQueryEditorField *)fields1->data)->name);
+					g_variant_builder_add (&builder, "s", ((GdaExQueryEditorField *)fields2->data)->name);
+				}
+			g_variant_builder_close (&builder);
+			g_variant_builder_close (&builder);
+		}
+	g_variant_builder_close (&builder);
+
+	if (priv->widgets != NULL)
+		{
+			g_variant_builder_add_value (&builder, priv->widgets);
+		}
+	else
+		{
+			g_variant_builder_open (&builder, G_VARIANT_TYPE ("a(sss)"));
+			g_variant_builder_close (&builder);
+		}
+
+	return g_variant_ref_sink (g_variant_builder_end (&builder));
+}
+
+/* adds the tables, fields and relations of variant to schema */
+static void
+gdaex_query_editor_schema_add_variant (GdaExQueryEditorSchema *schema,
+                                       GVariant *variant)
+{
+	GVariantIter *iter_tables;
+	GVariantIter *iter_fields;
+	GVariantIter *iter_relations;
+	GVariantIter *iter_joined;
+	GdaExQueryEditorField field;
+
+	const gchar *table_name;
+	const gchar *table_name_visible;
+	const gchar *table2;
+	const gchar *str;
+	gboolean visible;
+	guint join_type;
+	GSList *fields_joined;
+
+	g_variant_get (variant, GDAEX_QE_CACHE_TYPE,
+	               NULL, NULL, &iter_tables, &iter_relations, NULL);
+
+	while (g_variant_iter_loop (iter_tables, "(&sm&sba" GDAEX_QE_CACHE_FIELD_TYPE ")", &table_name, &table_name_visible, &visible, &iter_fields))
+		{
+			/* a table already in schema is kept: the relations point to its fields */
+			if (gdaex_query_editor_schema_get_table (schema, table_name) != NULL
+			    || !gdaex_query_editor_schema_add_table (schema, table_name, table_name_visible))
+				{
+					continue;
+				}
+			gdaex_query_editor_schema_table_set_visible (schema, table_name, visible);
+
+			memset (&field, 0, sizeof (GdaExQueryEditorField));
+			while (g_variant_iter_next (iter_fields, "(&sm&sm&sm&subbbubum&sm&sm&sm&sm&sm&sbbum&sum&sm&sm&sm&s)",
+			                            &field.name, &field.name_visible, &field.description, &field.alias,
+			                            &field.type, &field.for_show, &field.always_showed, &field.for_where,
+			                            &field.available_where_type, &field.where_default_not, &field.where_default_type,
+			                            &field.where_default_from, &field.where_default_from_visible, &field.where_default_from_sql,
+			                            &field.where_default_to, &field.where_default_to_visible, &field.where_default_to_sql,
+			                            &field.for_order, &field.always_ordered, &field.order_default,
+			                            &field.decode_table2, &field.decode_join_type, &field.decode_field2,
+			                            &field.decode_field_to_show, &field.decode_field_alias,
+			                            &field.normalized))
+				{
+					/* strings are copied by gdaex_query_editor_schema_table_add_field */
+					gdaex_query_editor_schema_table_add_field (schema, table_name, field);
+				}
+		}
+	g_variant_iter_free (iter_tables);
+
+	while (g_variant_iter_loop (iter_relations, "(&s&suas)", &table_name, &table2, &join_type, &iter_joined))
+		{
+			fields_joined = NULL;
+			while (g_variant_iter_next (iter_joined, "&s", &str))
+				{
+					fields_joined = g_slist_append (fields_joined, (gpointer)str);
+				}
+			if (fields_joined != NULL)
+				{
+					gdaex_query_editor_schema_add_relation_slist (schema, table_name, table2, join_type, fields_joined);
+					g_slist_free (fields_joined);
+				}
+		}
+	g_variant_iter_free (iter_relations);
+}
+
+/* as gdaex_query_editor_schema_add_variant () on a new schema loaded from
+ * the cache, but nothing is copied: the names and the strings of the
+ * fields point into the mapped variant, kept by the schema */
+static void
+gdaex_query_editor_schema_add_variant_mapped (GdaExQueryEditorSchema *schema,
+                                              GVariant *variant)
+{
+	GVariantIter *iter_tables;
+	GVariantIter *iter_fields;
+	GVariantIter *iter_relations;
+	GVariantIter *iter_joined;
+	GdaExQueryEditorTable *table;
+	GdaExQueryEditorField *field;
+
+	const gchar *table_name;
+	const gchar *table_name_visible;
+	const gchar *table2;
+	const gchar *str;
+	gboolean visible;
+	guint join_type;
+	GSList *fields_joined;
+
+	GdaExQueryEditorSchemaPrivate *priv = GDAEX_QUERY_EDITOR_SCHEMA_GET_PRIVATE (schema);
+
+	priv->mapped = g_variant_ref (variant);
+	g_hash_table_destroy (priv->tables);
+	priv->tables = g_hash_table_new_full (g_str_hash, g_str_equal,
+	                                      NULL, (GDestroyNotify)gdaex_query_editor_schema_table_free_mapped);
+
+	g_variant_get (variant, GDAEX_QE_CACHE_TYPE,
+	               NULL, NULL, &iter_tables, &iter_relations, NULL);
+
+	while (g_variant_iter_loop (iter_tables, "(&sm&sba" GDAEX_QE_CACHE_FIELD_TYPE ")", &table_name, &table_name_visible, &visible, &iter_fields))
+		{
+			if (g_strcmp0 (table_name, "") == 0
+			    || g_hash_table_lookup (priv->tables, table_name) != NULL)
+				{
+					continue;
+				}
+
+			table = g_new0 (GdaExQueryEditorTable, 1);
+			table->name = (gchar *)table_name;
+			table->name_visible = (gchar *)(g_strcmp0 (table_name_visible, "") != 0 ? table_name_visible : table_name);
+			table->visible = visible;
+			table->fields = g_hash_table_new_full (g_str_hash, g_str_equal, NULL, g_free);
+			g_hash_table_replace (priv->tables, table->name, table);
+
+			field = g_new0 (GdaExQueryEditorField, 1);
+			while (g_variant_iter_next (iter_fields, "(&sm&sm&sm&subbbubum&sm&sm&sm&sm&sm&sbbum&sum&sm&sm&sm&s)",
+			                            &field->name, &field->name_visible, &field->description, &field->alias,
+			                            &field->type, &field->for_show, &field->always_showed, &field->for_where,
+			                            &field->available_where_type, &field->where_default_not, &field->where_default_type,
+			                            &field->where_default_from, &field->where_default_from_visible, &field->where_default_from_sql,
+			                            &field->where_default_to, &field->where_default_to_visible, &field->where_default_to_sql,
+			                            &field->for_order, &field->always_ordered, &field->order_default,
+			                            &field->decode_table2, &field->decode_join_type, &field->decode_field2,
+			                            &field->decode_field_to_show, &field->decode_field_alias,
+			                            &field->normalized))
+				{
+					if (g_strcmp0 (field->name, "") == 0)
+						{
+							continue;
+						}
+
+					field->table_name = table->name;
+					if (g_strcmp0 (field->name_visible, "") == 0)
+						{
+							field->name_visible = field->name;
+						}
+					g_hash_table_replace (table->fields, field->name, field);
+
+					field = g_new0 (GdaExQueryEditorField, 1);
+				}
+			g_free (field);
+		}
+	g_variant_iter_free (iter_tables);
+
+	while (g_variant_iter_loop (iter_relations, "(&s&suas)", &table_name, &table2, &join_type, &iter_joined))
+		{
+			fields_joined = NULL;
+			while (g_variant_iter_next (iter_joined, "&s", &str))
+				{
+					fields_joined = g_slist_append (fields_joined, (gpointer)str);
+				}
+			if (fields_joined != NULL)
+				{
+					gdaex_query_editor_schema_add_relation_slist (schema, table_name, table2, join_type, fields_joined);
+					g_slist_free (fields_joined);
+				}
+		}
+	g_variant_iter_free (iter_relations);
+}
+
+static gchar
+*gdaex_query_editor_schema_cache_get_filename (const gchar *checksum)
+{
+	return g_build_filename (g_get_user_cache_dir (), "libgdaex", "queryeditor", checksum, NULL);
+}
+
+/* maps the cache of checksum; NULL if missing or not valid */
+static GVariant
+*gdaex_query_editor_schema_cache_get (const gchar *checksum)
+{
+	GVariant *variant;
+	GMappedFile *mfile;
+	GBytes *bytes;
+	gchar *filename;
+	guint32 version;
+	guint32 byte_order;
+
+	filename = gdaex_query_editor_schema_cache_get_filename (checksum);
+	mfile = g_mapped_file_new (filename, FALSE, NULL);
+	g_free (filename);
+	if (mfile == NULL)
+		{
+			return NULL;
+		}
+
+	bytes = g_mapped_file_get_bytes (mfile);
+	g_mapped_file_unref (mfile);
+
+	/* a truncated or corrupted file gives default values, never a crash */
+	variant = g_variant_ref_sink (g_variant_new_from_bytes (G_VARIANT_TYPE (GDAEX_QE_CACHE_TYPE), bytes, FALSE));
+	g_bytes_unref (bytes);
+
+	g_variant_get_child (variant, 0, "u", &version);
+	g_variant_get_child (variant, 1, "u", &byte_order);
+	if (version != GDAEX_QE_CACHE_VERSION
+	    || byte_order != G_BYTE_ORDER)
+		{
+			g_variant_unref (variant);
+			return NULL;
+		}
+
+	return variant;
+}
+
+static void
+gdaex_query_editor_schema_cache_put (const gchar *checksum,
+                                     GVariant *variant)
+{
+	gchar *filename;
+	gchar *dirname;
+	GError *error;
+
+	filename = gdaex_query_editor_schema_cache_get_filename (checksum);
+	dirname = g_path_get_dirname (filename);
+
+	error = NULL;
+	if (g_mkdir_with_parents (dirname, 0700) != 0
+	    || !g_file_set_contents (filename,
+	                             g_variant_get_data (variant),
+	                             g_variant_get_size (variant),
+	                             &error))
+		{
+			g_warning (_("Unable to save the cache «%s»: %s"), filename,
+			           error != NULL && error->message != NULL ? error->message : _("no details"));
+			g_clear_error (&error);
+		}
+
+	g_free (dirname);
+	g_free (filename);
+}
+
+/**
+ * gdaex_query_editor_schema_new_from_file:
+ * @filename: the xml file with the definitions.
+ *
+ * Loads the definitions of @filename once per process: later calls with the
+ * same file content return the same sealed schema. The parsed definitions
+ * are also saved in a binary cache keyed by the hash of the file, so the xml
+ * is parsed again only when it changes; a schema loaded from the cache
+ * doesn't copy its names and strings, but reads them from the mapped file.
+ *
+ * Returns: (transfer full): a sealed #GdaExQueryEditorSchema; #NULL on error.
+ */
+GdaExQueryEditorSchema
+*gdaex_query_editor_schema_new_from_file (const gchar *filename)
+{
+	GdaExQueryEditorSchema *schema;
+	GdaExQueryEditorSchema *registered;
+	GdaExQueryEditorSchemaPrivate *priv;
+	GVariant *variant;
+	gchar *content;
+	gsize length;
+	gchar *checksum;
+	xmlDoc *xdoc;
+	xmlNode *xroot;
+	GError *error;
+
+	g_return_val_if_fail (filename != NULL, NULL);
+
+	error = NULL;
+	if (!g_file_get_contents (filename, &content, &length, &error))
+		{
+			g_warning (_("Unable to read file «%s»: %s"), filename,
+			           error != NULL && error->message != NULL ? error->message : _("no details"));
+			g_clear_error (&error);
+			return NULL;
+		}
+
+	checksum = g_compute_checksum_for_data (G_CHECKSUM_SHA256, (const guchar *)content, length);
+
+	G_LOCK (registry);
+	schema = (registry != NULL ? g_hash_table_lookup (registry, checksum) : NULL);
+	if (schema != NULL)
+		{
+			g_object_ref (schema);
+		}
+	G_UNLOCK (registry);
+
+	if (schema != NULL)
+		{
+			g_free (checksum);
+			g_free (content);
+			return schema;
+		}
+
+	variant = gdaex_query_editor_schema_cache_get (checksum);
+	if (variant != NULL)
+		{
+			schema = gdaex_query_editor_schema_new ();
+			priv = GDAEX_QUERY_EDITOR_SCHEMA_GET_PRIVATE (schema);
+
+			gdaex_query_editor_schema_add_variant_mapped (schema, variant);
+			priv->widgets = g_variant_get_child_value (variant, 4);
+			g_variant_unref (variant);
+		}
+	else
+		{
+			xdoc = xmlParseMemory (content, length);
+			xroot = (xdoc != NULL ? xmlDocGetRootElement (xdoc) : NULL);
+			if (xroot != NULL
+			    && xmlStrcmp (xroot->name, (const xmlChar *)"gdaex_query_editor") == 0)
+				{
+					schema = gdaex_query_editor_schema_new ();
+					priv = GDAEX_QUERY_EDITOR_SCHEMA_GET_PRIVATE (schema);
+
+					gdaex_query_editor_schema_load_tables_from_xml (schema, xroot);
+					priv->widgets = gdaex_query_editor_schema_widgets_from_xml (xroot);
+
+					variant = gdaex_query_editor_schema_to_variant (schema);
+					gdaex_query_editor_schema_cache_put (checksum, variant);
+					g_variant_unref (variant);
+				}
+			if (xdoc != NULL)
+				{
+					xmlFreeDoc (xdoc);
+				}
+		}
+
+	g_free (content);
+
+	if (schema == NULL)
+		{
+			g_warning (_("File «%s» isn't a valid query editor definition."), filename);
+			g_free (checksum);
+			return NULL;
+		}
+
+	GDAEX_QUERY_EDITOR_SCHEMA_GET_PRIVATE (schema)->sealed = TRUE;
+
+	G_LOCK (registry);
+	if (registry == NULL)
+		{
+			registry = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_object_unref);
+		}
+	registered = g_hash_table_lookup (registry, checksum);
+	if (registered != NULL)
+		{
+			/* loaded meanwhile by another thread */
+			g_object_unref (schema);
+			schema = registered;
+			g_free (checksum);
+		}
+	else
+		{
+			g_hash_table_insert (registry, checksum, schema);
+		}
+	g_object_ref (schema);
+	G_UNLOCK (registry);
+
+	return schema;
+}
+
+static gboolean
+gdaex_query_editor_schema_registry_unused (gpointer key,
+                                           gpointer value,
+                                           gpointer user_data)
+{
+	/* under the registry lock a schema referenced only by the registry
+	 * can't be referenced by anyone else */
+	return g_atomic_int_get (&G_OBJECT (value)->ref_count) == 1;
+}
+
+/**
+ * gdaex_query_editor_schema_registry_prune:
+ *
+ * Frees the schemas loaded by gdaex_query_editor_schema_new_from_file()
+ * that are no longer referenced outside the registry, e.g. after closing
+ * the query editors; a later load of the same file uses the binary cache.
+ *
+ * Returns: the number of schemas freed.
+ */
+guint
+gdaex_query_editor_schema_registry_prune (void)
+{
+	guint ret;
+
+	G_LOCK (registry);
+	ret = (registry != NULL ? g_hash_table_foreach_remove (registry, gdaex_query_editor_schema_registry_unused, NULL) : 0);
+	G_UNLOCK (registry);
+
+	return ret;
+}
+
+/**
+ * gdaex_query_editor_schema_copy:
+ * @schema: a #GdaExQueryEditorSchema object.
+ *
+ * Returns: (transfer full): a new not sealed #GdaExQueryEditorSchema with
+ * the same tables, fields and relations of @schema.
+ */
+GdaExQueryEditorSchema
+*gdaex_query_editor_schema_copy (GdaExQueryEditorSchema *schema)
+{
+	GdaExQueryEditorSchema *copy;
+	GVariant *variant;
+
+	g_return_val_if_fail (GDAEX_IS_QUERY_EDITOR_SCHEMA (schema), NULL);
+
+	GdaExQueryEditorSchemaPrivate *priv = GDAEX_QUERY_EDITOR_SCHEMA_GET_PRIVATE (schema);
+
+	copy = gdaex_query_editor_schema_new ();
+
+	variant = gdaex_query_editor_schema_to_variant (schema);
+	gdaex_query_editor_schema_add_variant (copy, variant);
+	g_variant_unref (variant);
+
+	if (priv->widgets != NULL)
+		{
+			GDAEX_QUERY_EDITOR_SCHEMA_GET_PRIVATE (copy)->widgets = g_variant_ref (priv->widgets);
+		}
+
+	return copy;
+}
+
+/**
+ * gdaex_query_editor_schema_merge:
+ * @schema: a not sealed #GdaExQueryEditorSchema object.
+ * @other: a #GdaExQueryEditorSchema object.
+ *
+ * Adds to @schema a copy of the tables, fields and relations of @other;
+ * the tables already in @schema are not replaced.
+ */
+void
+gdaex_query_editor_schema_merge (GdaExQueryEditorSchema *schema,
+                                 GdaExQueryEditorSchema *other)
+{
+	GVariant *variant;
+
+	g_return_if_fail (GDAEX_IS_QUERY_EDITOR_SCHEMA (schema));
+	g_return_if_fail (GDAEX_IS_QUERY_EDITOR_SCHEMA (other));
+	g_return_if_fail (!gdaex_query_editor_schema_is_sealed (schema));
+
+	variant = gdaex_query_editor_schema_to_variant (other);
+	gdaex_query_editor_schema_add_variant (schema, variant);
+	g_variant_unref (variant);
+}
+
+/**
+ * gdaex_query_editor_schema_get_relations:
+ * @schema: a #GdaExQueryEditorSchema object.
+ *
+ * Returns: (transfer none) (element-type GdaExQueryEditorRelation): the
+ * relations of @schema.
+ */
+GSList
+*gdaex_query_editor_schema_get_relations (GdaExQueryEditorSchema *schema)
+{
+	g_return_val_if_fail (GDAEX_IS_QUERY_EDITOR_SCHEMA (schema), NULL);
+
+	GdaExQueryEditorSchemaPrivate *priv = GDAEX_QUERY_EDITOR_SCHEMA_GET_PRIVATE (schema);
+
+	return priv->relations;
+}
+
+/**
+ * gdaex_query_editor_schema_get_widgets:
+ * @schema: a #GdaExQueryEditorSchema object.
+ *
+ * Returns: (transfer none): a #GVariant of type a(sss) with table name,
+ * field name and xml of every widget node of the file @schema was loaded
+ * from; #NULL if none.
+ */
+GVariant
+*gdaex_query_editor_schema_get_widgets (GdaExQueryEditorSchema *schema)
+{
+	g_return_val_if_fail (GDAEX_IS_QUERY_EDITOR_SCHEMA (schema), NULL);
+
+	GdaExQueryEditorSchemaPrivate *priv = GDAEX_QUERY_EDITOR_SCHEMA_GET_PRIVATE (schema);
+
+	return priv->widgets;
+}
+
+/* PRIVATE */
+static void
+gdaex_query_editor_schema_table_free (GdaExQueryEditorTable *table)
+{
+	g_hash_table_destroy (table->fields);
+	g_free (table->name);
+	g_free (table->name_visible);
+	g_free (table);
+}
+
+/* the strings belong to the mapped cache */
+static void
+gdaex_query_editor_schema_table_free_mapped (GdaExQueryEditorTable *table)
+{
+	g_hash_table_destroy (table->fields);
+	g_free (table);
+}
+
+static void
+gdaex_query_editor_schema_field_free (GdaExQueryEditorField *field)
+{
+	/* the iwidgets belong to the gui */
+	gdaex_query_editor_schema_field_free_strings (field);
+	g_free (field);
+}
+
+static void
+gdaex_query_editor_schema_relation_free (GdaExQueryEditorRelation *relation)
+{
+	g_slist_free (relation->fields1);
+	g_slist_free (relation->fields2);
+	g_free (relation);
+}
+
+static void
+gdaex_query_editor_schema_finalize (GObject *object)
+{
+	GdaExQueryEditorSchema *gdaex_query_editor_schema = GDAEX_QUERY_EDITOR_SCHEMA (object);
+	GdaExQueryEditorSchemaPrivate *priv = GDAEX_QUERY_EDITOR_SCHEMA_GET_PRIVATE (gdaex_query_editor_schema);
+
+	/* relations before tables: they point to the fields */
+	g_slist_free_full (priv->relations, (GDestroyNotify)gdaex_query_editor_schema_relation_free);
+	g_hash_table_destroy (priv->tables);
+
+	if (priv->widgets != NULL)
+		{
+			g_variant_unref (priv->widgets);
+		}
+	if (priv->mapped != NULL)
+		{
+			g_variant_unref (priv->mapped);
+		}
+
+	G_OBJECT_CLASS (gdaex_query_editor_schema_parent_class)->finalize (object);
+}
@@ -0,0 +1,216 @@
+/*
+ * Copyright (C) 2011-2016 Andrea Zagli <azagli@libero.it>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef __GDAEX_QUERY_EDITOR_SCHEMA_H__
+#define __GDAEX_QUERY_EDITOR_SCHEMA_H__
+
+#include <glib.h>
+#include <glib-object.h>
+
+#include <libxml/tree.h>
+
+#include "queryeditor_widget_interface.h"
+
+
+G_BEGIN_DECLS
+
+
+typedef enum
+	{
+		GDAEX_QE_FIELD_TYPE_TEXT = 1,
+		GDAEX_QE_FIELD_TYPE_INTEGER,
+		GDAEX_QE_FIELD_TYPE_BOOLEAN,
+		GDAEX_QE_FIELD_TYPE_DOUBLE,
+		GDAEX_QE_FIELD_TYPE_DATE,
+		GDAEX_QE_FIELD_TYPE_DATETIME,
+		GDAEX_QE_FIELD_TYPE_TIME
+	} GdaExQueryEditorFieldType;
+
+typedef enum
+	{
+		GDAEX_QE_WHERE_TYPE_EQUAL = 1,
+		GDAEX_QE_WHERE_TYPE_STARTS = 2,
+		GDAEX_QE_WHERE_TYPE_CONTAINS = 4,
+		GDAEX_QE_WHERE_TYPE_ENDS = 8,
+		GDAEX_QE_WHERE_TYPE_ISTARTS = 16,
+		GDAEX_QE_WHERE_TYPE_ICONTAINS = 32,
+		GDAEX_QE_WHERE_TYPE_IENDS = 64,
+		GDAEX_QE_WHERE_TYPE_GREAT = 128,
+		GDAEX_QE_WHERE_TYPE_GREAT_EQUAL = 256,
+		GDAEX_QE_WHERE_TYPE_LESS = 512,
+		GDAEX_QE_WHERE_TYPE_LESS_EQUAL = 1024,
+		GDAEX_QE_WHERE_TYPE_BETWEEN = 2048,
+		GDAEX_QE_WHERE_TYPE_IS_NULL = 4096
+	} GdaExQueryEditorWhereType;
+
+typedef enum
+	{
+		GDAEX_QE_JOIN_TYPE_INNER,
+		GDAEX_QE_JOIN_TYPE_LEFT
+	} GdaExQueryEditorJoinType;
+
+typedef enum
+	{
+		GDAEX_QE_ORDER_ASC,
+		GDAEX_QE_ORDER_DESC
+	} GdaExQueryEditorOrderType;
+
+typedef enum
+	{
+		GDAEX_QE_LINK_TYPE_AND = 1,
+		GDAEX_QE_LINK_TYPE_OR
+	} GdaExQueryEditorLinkType;
+
+#define GDAEX_QE_WHERE_TYPE_STRING GDAEX_QE_WHERE_TYPE_STARTS | GDAEX_QE_WHERE_TYPE_CONTAINS | GDAEX_QE_WHERE_TYPE_ENDS | GDAEX_QE_WHERE_TYPE_ISTARTS | GDAEX_QE_WHERE_TYPE_ICONTAINS | GDAEX_QE_WHERE_TYPE_IENDS
+
+#define GDAEX_QE_WHERE_TYPE_NUMBER GDAEX_QE_WHERE_TYPE_EQUAL | GDAEX_QE_WHERE_TYPE_GREAT | GDAEX_QE_WHERE_TYPE_GREAT_EQUAL | GDAEX_QE_WHERE_TYPE_LESS | GDAEX_QE_WHERE_TYPE_LESS_EQUAL | GDAEX_QE_WHERE_TYPE_BETWEEN
+
+#define GDAEX_QE_WHERE_TYPE_DATETIME GDAEX_QE_WHERE_TYPE_NUMBER
+
+typedef struct
+	{
+		gchar *table_name;
+
+		gchar *name;
+		gchar *name_visible;
+		gchar *description;
+		gchar *alias;
+		GdaExQueryEditorFieldType type;
+		gboolean for_show;
+		gboolean always_showed;
+		gboolean for_where;
+		guint available_where_type;
+		gboolean where_default_not;
+		GdaExQueryEditorWhereType where_default_type;
+		gchar *where_default_from;
+		gchar *where_default_from_visible;
+		gchar *where_default_from_sql;
+		gchar *where_default_to;
+		gchar *where_default_to_visible;
+		gchar *where_default_to_sql;
+		gboolean for_order;
+		gboolean always_ordered;
+		GdaExQueryEditorOrderType order_default;
+
+		/* only used to pass the widgets to gdaex_query_editor_table_add_field ():
+		 * the fields of a #GdaExQueryEditorSchema never have them */
+		GdaExQueryEditorIWidget *iwidget_from;
+		GdaExQueryEditorIWidget *iwidget_to;
+
+		/* TODO
+		 * to refactor
+		 */
+		gchar *decode_table2;
+		GdaExQueryEditorJoinType decode_join_type;
+		/* TODO
+		GSList *decode_fields1;
+		GSList *decode_fields2;
+		*/
+		gchar *decode_field2;
+		gchar *decode_field_to_show;
+		gchar *decode_field_alias;
+
+		gchar *normalized;	/* column with the lower-cased value, for case insensitive conditions */
+	} GdaExQueryEditorField;
+
+typedef struct
+	{
+		gchar *name;
+		gchar *name_visible;
+		gboolean visible;
+
+		GHashTable *fields;	/* GdaExQueryEditorField */
+	} GdaExQueryEditorTable;
+
+typedef struct
+	{
+		GdaExQueryEditorTable *table1;
+		GdaExQueryEditorTable *table2;
+
+		GdaExQueryEditorJoinType join_type;
+
+		GSList *fields1;
+		GSList *fields2;
+	} GdaExQueryEditorRelation;
+
+
+#define GDAEX_TYPE_QUERY_EDITOR_SCHEMA                 (gdaex_query_editor_schema_get_type ())
+#define GDAEX_QUERY_EDITOR_SCHEMA(obj)                 (G_TYPE_CHECK_INSTANCE_CAST ((obj), GDAEX_TYPE_QUERY_EDITOR_SCHEMA, GdaExQueryEditorSchema))
+#define GDAEX_QUERY_EDITOR_SCHEMA_CLASS(klass)         (G_TYPE_CHECK_CLASS_CAST ((klass), GDAEX_TYPE_QUERY_EDITOR_SCHEMA, GdaExQueryEditorSchemaClass))
+#define GDAEX_IS_QUERY_EDITOR_SCHEMA(obj)              (G_TYPE_CHECK_INSTANCE_TYPE ((obj), GDAEX_TYPE_QUERY_EDITOR_SCHEMA))
+#define GDAEX_IS_QUERY_EDITOR_SCHEMA_CLASS(klass)      (G_TYPE_CHECK_CLASS_TYPE ((klass), GDAEX_TYPE_QUERY_EDITOR_SCHEMA))
+#define GDAEX_QUERY_EDITOR_SCHEMA_GET_CLASS(obj)       (G_TYPE_INSTANCE_GET_CLASS ((obj), GDAEX_TYPE_QUERY_EDITOR_SCHEMA, GdaExQueryEditorSchemaClass))
+
+typedef struct _GdaExQueryEditorSchema GdaExQueryEditorSchema;
+typedef struct _GdaExQueryEditorSchemaClass GdaExQueryEditorSchemaClass;
+
+struct _GdaExQueryEditorSchema
+	{
+		GObject parent;
+	};
+
+struct _GdaExQueryEditorSchemaClass
+	{
+		GObjectClass parent_class;
+	};
+
+GType gdaex_query_editor_schema_get_type (void) G_GNUC_CONST;
+
+
+GdaExQueryEditorSchema *gdaex_query_editor_schema_new (void);
+GdaExQueryEditorSchema *gdaex_query_editor_schema_new_from_file (const gchar *filename);
+GdaExQueryEditorSchema *gdaex_query_editor_schema_copy (GdaExQueryEditorSchema *schema);
+guint gdaex_query_editor_schema_registry_prune (void);
+
+gboolean gdaex_query_editor_schema_is_sealed (GdaExQueryEditorSchema *schema);
+
+gboolean gdaex_query_editor_schema_add_table (GdaExQueryEditorSchema *schema,
+                                              const gchar *table_name,
+                                              const gchar *table_name_visible);
+gboolean gdaex_query_editor_schema_table_add_field (GdaExQueryEditorSchema *schema,
+                                                    const gchar *table_name,
+                                                    GdaExQueryEditorField field);
+gboolean gdaex_query_editor_schema_add_relation_slist (GdaExQueryEditorSchema *schema,
+                                                       const gchar *table1,
+                                                       const gchar *table2,
+                                                       GdaExQueryEditorJoinType join_type,
+                                                       GSList *fields_joined);
+gboolean gdaex_query_editor_schema_table_set_visible (GdaExQueryEditorSchema *schema,
+                                                      const gchar *table_name,
+                                                      gboolean visible);
+
+void gdaex_query_editor_schema_load_tables_from_xml (GdaExQueryEditorSchema *schema,
+                                                     xmlNode *root);
+void gdaex_query_editor_schema_merge (GdaExQueryEditorSchema *schema,
+                                      GdaExQueryEditorSchema *other);
+
+GHashTable *gdaex_query_editor_schema_get_tables (GdaExQueryEditorSchema *schema);
+const GdaExQueryEditorTable *gdaex_query_editor_schema_get_table (GdaExQueryEditorSchema *schema,
+                                                                  const gchar *table_name);
+const GdaExQueryEditorField *gdaex_query_editor_schema_get_field (GdaExQueryEditorSchema *schema,
+                                                                  const gchar *table_name,
+                                                                  const gchar *field_name);
+GSList *gdaex_query_editor_schema_get_relations (GdaExQueryEditorSchema *schema);
+
+GVariant *gdaex_query_editor_schema_get_widgets (GdaExQueryEditorSchema *schema);
+
+
+G_END_DECLS
+
+
+#endif /* __GDAEX_QUERY_EDITOR_SCHEMA_H__ */
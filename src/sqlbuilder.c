@@ -26,14 +26,19 @@
 #endif
 
 #include <stdarg.h>
+#include <string.h>
 
 #include <glib/gi18n-lib.h>
 
+#include <libgda/sql-parser/gda-sql-parser.h>
+
 #include "sqlbuilder.h"
 
 static void gdaex_sql_builder_class_init (GdaExSqlBuilderClass *klass);
 static void gdaex_sql_builder_init (GdaExSqlBuilder *gdaex_sql_builder);
 
+static void gdaex_sql_builder_finalize (GObject *object);
+
 static void gdaex_sql_builder_set_property (GObject *object,
                                guint property_id,
                                const GValue *value,
@@ -43,6 +48,9 @@ static void gdaex_sql_builder_get_property (GObject *object,
                                GValue *value,
                                GParamSpec *pspec);
 
+static GdaStatement *gdaex_sql_builder_get_statement (GdaExSqlBuilder *sqlb);
+static gchar *gdaex_sql_builder_value_to_sql (GdaConnection *cnc, const GValue *gval);
+
 
 #define GDAEX_SQLBUILDER_GET_PRIVATE(obj) (G_TYPE_INSTANCE_GET_PRIVATE ((obj), GDAEX_TYPE_SQLBUILDER, GdaExSqlBuilderPrivate))
 
@@ -63,6 +71,67 @@ struct _GdaExSqlBuilderTable
 	GHashTable *ht_fields;
 };
 
+typedef struct _GdaExSqlBuilderOrder GdaExSqlBuilderOrder;
+struct _GdaExSqlBuilderOrder
+{
+	GdaExSqlBuilderField *field;
+	gboolean asc;
+};
+
+typedef enum
+{
+	GDAEX_SQLBUILDER_CLAUSE_SELECT,
+	GDAEX_SQLBUILDER_CLAUSE_FROM,
+	GDAEX_SQLBUILDER_CLAUSE_WHERE,
+	GDAEX_SQLBUILDER_CLAUSE_GROUP,
+	GDAEX_SQLBUILDER_CLAUSE_HAVING,
+	GDAEX_SQLBUILDER_CLAUSE_ORDER,
+	GDAEX_SQLBUILDER_CLAUSE_LIMIT,
+	GDAEX_SQLBUILDER_N_CLAUSES
+} GdaExSqlBuilderClause;
+
+static const gchar *clauses_keywords[GDAEX_SQLBUILDER_N_CLAUSES] =
+{
+	"SELECT",
+	"FROM",
+	"WHERE",
+	"GROUP BY",
+	"HAVING",
+	"ORDER BY",
+	"LIMIT"
+};
+
+static const gchar *aggregates_names[] =
+{
+	"COUNT",
+	"SUM",
+	"MIN",
+	"MAX",
+	"AVG"
+};
+
+/* a list of keys staged into a temporary table */
+typedef struct _GdaExSqlBuilderInList GdaExSqlBuilderInList;
+struct _GdaExSqlBuilderInList
+{
+	gchar *table_name;
+	GType gtype;
+	GArray *keys;
+};
+
+#define GDAEX_SQLBUILDER_IN_LIST_THRESHOLD 1000
+#define GDAEX_SQLBUILDER_IN_LIST_CHUNK 500
+
+static gint in_lists_serial = 0;
+
+typedef enum
+{
+	GDAEX_SQLBUILDER_UPSERT_NONE,
+	GDAEX_SQLBUILDER_UPSERT_ON_CONFLICT,        /* SQLite, PostgreSQL */
+	GDAEX_SQLBUILDER_UPSERT_ON_DUPLICATE_KEY,   /* MySQL */
+	GDAEX_SQLBUILDER_UPSERT_UPDATE_INSERT       /* no native syntax */
+} GdaExSqlBuilderUpsertStyle;
+
 typedef struct _GdaExSqlBuilderPrivate GdaExSqlBuilderPrivate;
 struct _GdaExSqlBuilderPrivate
 {
@@ -70,10 +139,73 @@ struct _GdaExSqlBuilderPrivate
 	GdaSqlBuilder *sqlb;
 	GHashTable *ht_tables;
 	GdaSqlBuilderId id_where;
+	GdaSqlBuilderId id_having;
+
+	/* INSERT and UPDATE: the target table and, for INSERT, the fields
+	 * with the values (or the parameters' names) of the first row, the other
+	 * rows and the upsert keys */
+	gchar *target_table;
+	GPtrArray *insert_fields;
+	GPtrArray *insert_values;
+	GPtrArray *insert_params;
+	GPtrArray *rows;
+	gchar **upsert_keys;
+
+	/* SELECT: the ORDER BY fields, used by the keyset continuation */
+	GPtrArray *order_fields;
+	gboolean keyset;
+	GdaSqlBuilderId keyset_id_where;
+	GdaSet *keyset_params;
+
+	/* values of the builder's own parameters (IN lists), merged
+	 * with the caller's ones into bound_params */
+	guint in_list_threshold;
+	guint n_in_lists;
+	GHashTable *bound_values;
+	GdaSet *bound_params;
+	GPtrArray *in_lists;
+
+	/* cache of the last rendering, dropped on every change of the builder */
+	GdaStatement *stmt;
+	gchar *sql;
+	GdaConnection *sql_cnc;
+	GdaSet *sql_params;
+	gulong sql_params_changed;
+	gint clauses_start[GDAEX_SQLBUILDER_N_CLAUSES];
+	gint clauses_end[GDAEX_SQLBUILDER_N_CLAUSES];
+
+	/* the statement prepared for execution on exec_gdaex, with its tables prefix */
+	GdaStatement *exec_stmt;
+	GdaEx *exec_gdaex;
+	gchar *exec_prefix;
+
+	/* once the GdaSqlBuilder is given out it can change behind our back:
+	 * the caches are checked against its serialized statement */
+	gboolean exposed;
+	gchar *fingerprint;
 };
 
 G_DEFINE_TYPE (GdaExSqlBuilder, gdaex_sql_builder, G_TYPE_OBJECT)
 
+static void
+gdaex_sql_builder_value_free (gpointer gval)
+{
+	if (gval != NULL)
+		{
+			gda_value_free ((GValue *)gval);
+		}
+}
+
+static void
+gdaex_sql_builder_in_list_free (gpointer data)
+{
+	GdaExSqlBuilderInList *l = (GdaExSqlBuilderInList *)data;
+
+	g_free (l->table_name);
+	g_array_unref (l->keys);
+	g_free (l);
+}
+
 static void
 gdaex_sql_builder_class_init (GdaExSqlBuilderClass *klass)
 {
@@ -83,6 +215,7 @@ gdaex_sql_builder_class_init (GdaExSqlBuilderClass *klass)
 
 	object_class->set_property = gdaex_sql_builder_set_property;
 	object_class->get_property = gdaex_sql_builder_get_property;
+	object_class->finalize = gdaex_sql_builder_finalize;
 }
 
 static void
@@ -90,6 +223,94 @@ gdaex_sql_builder_init (GdaExSqlBuilder *gdaex_sql_builder)
 {
 	GdaExSqlBuilderPrivate *priv = GDAEX_SQLBUILDER_GET_PRIVATE (gdaex_sql_builder);
 
+	priv->target_table = NULL;
+	priv->insert_fields = g_ptr_array_new_with_free_func (g_free);
+	priv->insert_values = g_ptr_array_new_with_free_func (gdaex_sql_builder_value_free);
+	priv->insert_params = g_ptr_array_new_with_free_func (g_free);
+	priv->rows = g_ptr_array_new_with_free_func ((GDestroyNotify)g_ptr_array_unref);
+	priv->upsert_keys = NULL;
+
+	priv->order_fields = g_ptr_array_new_with_free_func (g_free);
+	priv->keyset = FALSE;
+	priv->keyset_id_where = 0;
+	priv->keyset_params = NULL;
+
+	priv->in_list_threshold = GDAEX_SQLBUILDER_IN_LIST_THRESHOLD;
+	priv->n_in_lists = 0;
+	priv->bound_values = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, gdaex_sql_builder_value_free);
+	priv->bound_params = NULL;
+	priv->in_lists = g_ptr_array_new_with_free_func (gdaex_sql_builder_in_list_free);
+
+	priv->stmt = NULL;
+	priv->sql = NULL;
+	priv->sql_cnc = NULL;
+	priv->sql_params = NULL;
+	priv->sql_params_changed = 0;
+	priv->exec_stmt = NULL;
+	priv->exec_gdaex = NULL;
+	priv->exec_prefix = NULL;
+	priv->exposed = FALSE;
+	priv->fingerprint = NULL;
+}
+
+static void
+gdaex_sql_builder_invalidate_sql (GdaExSqlBuilder *sqlb)
+{
+	GdaExSqlBuilderPrivate *priv = GDAEX_SQLBUILDER_GET_PRIVATE (sqlb);
+
+	if (priv->sql_params != NULL)
+		{
+			g_signal_handler_disconnect (priv->sql_params, priv->sql_params_changed);
+			g_object_unref (priv->sql_params);
+			priv->sql_params = NULL;
+			priv->sql_params_changed = 0;
+		}
+
+	g_free (priv->sql);
+	priv->sql = NULL;
+	priv->sql_cnc = NULL;
+}
+
+/* every change of the builder drops the cached statement and rendering */
+static void
+gdaex_sql_builder_changed (GdaExSqlBuilder *sqlb)
+{
+	GdaExSqlBuilderPrivate *priv = GDAEX_SQLBUILDER_GET_PRIVATE (sqlb);
+
+	gdaex_sql_builder_invalidate_sql (sqlb);
+
+	if (priv->keyset_params != NULL)
+		{
+			g_object_unref (priv->keyset_params);
+			priv->keyset_params = NULL;
+		}
+
+	if (priv->bound_params != NULL)
+		{
+			g_object_unref (priv->bound_params);
+			priv->bound_params = NULL;
+		}
+
+	if (priv->stmt != NULL)
+		{
+			g_object_unref (priv->stmt);
+			priv->stmt = NULL;
+		}
+
+	if (priv->exec_stmt != NULL)
+		{
+			g_object_unref (priv->exec_stmt);
+			priv->exec_stmt = NULL;
+		}
+	priv->exec_gdaex = NULL;
+	g_free (priv->exec_prefix);
+	priv->exec_prefix = NULL;
+}
+
+static void
+gdaex_sql_builder_on_params_changed (GdaSet *set, GdaHolder *holder, gpointer user_data)
+{
+	gdaex_sql_builder_invalidate_sql ((GdaExSqlBuilder *)user_data);
 }
 
 /**
@@ -109,6 +330,7 @@ GdaExSqlBuilder
 	priv->sqlb = gda_sql_builder_new (priv->stmt_type);
 	priv->ht_tables = g_hash_table_new (g_str_hash, g_str_equal);
 	priv->id_where = 0;
+	priv->id_having = 0;
 
 	return gdaex_sql_builder;
 }
@@ -134,6 +356,12 @@ static GdaExSqlBuilderField
 					if (gval != NULL)
 						{
 							gda_sql_builder_add_field_value_as_gvalue (priv->sqlb, g_strcmp0 (field_alias, "") != 0 ? field_alias : field_name, gval);
+							if (priv->stmt_type == GDA_SQL_STATEMENT_INSERT)
+								{
+									g_ptr_array_add (priv->insert_fields, g_strdup (g_strcmp0 (field_alias, "") != 0 ? field_alias : field_name));
+									g_ptr_array_add (priv->insert_values, gda_value_copy (gval));
+									g_ptr_array_add (priv->insert_params, NULL);
+								}
 						}
 				}
 			f->name = g_strdup (field_name);
@@ -146,6 +374,8 @@ static GdaExSqlBuilderField
 					f->alias = NULL;
 				}
 			g_hash_table_insert (table->ht_fields, g_strdup (field_name), f);
+
+			gdaex_sql_builder_changed (sqlb);
 		}
 
 	return f;
@@ -176,6 +406,8 @@ static GdaExSqlBuilderTable
 						{
 							t->id = 0;
 							gda_sql_builder_set_table (priv->sqlb, table_name);
+							g_free (priv->target_table);
+							priv->target_table = g_strdup (table_name);
 						}
 				}
 			t->name = g_strdup (table_name);
@@ -189,6 +421,8 @@ static GdaExSqlBuilderTable
 				}
 			t->ht_fields = g_hash_table_new (g_str_hash, g_str_equal);
 			g_hash_table_insert (priv->ht_tables, g_strdup (t->name), t);
+
+			gdaex_sql_builder_changed (sqlb);
 		}
 
 	return t;
@@ -348,6 +582,7 @@ gdaex_sql_builder_join (GdaExSqlBuilder *sqlb,
 
 			GdaSqlBuilderId jid = gda_sql_builder_add_cond (priv->sqlb, op, f_right->id, f_left->id, 0);
 			gda_sql_builder_select_join_targets (priv->sqlb, t_left->id, t_right->id, join_type, jid);
+			gdaex_sql_builder_changed (sqlb);
 		} while (TRUE);
 	va_end (ap);
 }
@@ -429,459 +664,2393 @@ gdaex_sql_builder_fields (GdaExSqlBuilder *sqlb, ...)
 	va_end (ap);
 }
 
+static void
+gdaex_sql_builder_add_where_cond (GdaExSqlBuilder *sqlb, GdaSqlOperatorType op, GdaSqlBuilderId id_cond)
+{
+	GdaExSqlBuilderPrivate *priv = GDAEX_SQLBUILDER_GET_PRIVATE (sqlb);
+
+	if (priv->id_where != 0)
+		{
+			priv->id_where = gda_sql_builder_add_cond (priv->sqlb, op, priv->id_where, id_cond, 0);
+		}
+	else
+		{
+			priv->id_where = id_cond;
+		}
+	gda_sql_builder_set_where (priv->sqlb, priv->id_where);
+	gdaex_sql_builder_changed (sqlb);
+}
+
 /**
- * gdaex_sql_builder_where:
+ * gdaex_sql_builder_field_param:
  * @sqlb:
- * @op:
- * @...:
+ * @table_name:
+ * @field_name:
+ * @field_alias:
+ * @param_name: the name of the parameter; if NULL, @field_name is used.
+ * @gtype: the type of the parameter's value.
  *
- * Returns:
+ * As gdaex_sql_builder_field() for INSERT and UPDATE statements, but the
+ * value is a placeholder bound at execution time (see gdaex_sql_builder_compile()).
  */
-GdaSqlBuilderId
-gdaex_sql_builder_where (GdaExSqlBuilder *sqlb, GdaSqlOperatorType op, ...)
+void
+gdaex_sql_builder_field_param (GdaExSqlBuilder *sqlb, const gchar *table_name, const gchar *field_name, const gchar *field_alias, const gchar *param_name, GType gtype)
 {
-	va_list ap;
-
-	gchar *table_name;
-	gchar *field_name;
-	gchar *field_alias;
-	GValue *gval;
-
 	GdaExSqlBuilderTable *t;
 	GdaExSqlBuilderField *f;
 
-	GdaSqlOperatorType op_expr;
-
-	GdaSqlBuilderId id_expr1;
-	GdaSqlBuilderId id_expr2;
-	GdaSqlBuilderId id_cond;
+	g_return_if_fail (GDAEX_IS_SQLBUILDER (sqlb));
 
 	GdaExSqlBuilderPrivate *priv = GDAEX_SQLBUILDER_GET_PRIVATE (sqlb);
 
-	if (priv->stmt_type == GDA_SQL_STATEMENT_INSERT)
+	if (priv->stmt_type != GDA_SQL_STATEMENT_INSERT
+	    && priv->stmt_type != GDA_SQL_STATEMENT_UPDATE)
 		{
-			return -1;
+			g_warning (_("Parameter fields are allowed only on INSERT and UPDATE statements."));
+			return;
 		}
 
-	va_start (ap, op);
-	do
+	t = gdaex_sql_builder_get_table (sqlb, table_name, NULL, TRUE);
+	f = gdaex_sql_builder_get_field (sqlb, t, field_name, field_alias, NULL, TRUE);
+	gda_sql_builder_add_field_value_id (priv->sqlb,
+	                                    f->id,
+	                                    gda_sql_builder_add_param (priv->sqlb, param_name != NULL ? param_name : field_name, gtype, TRUE));
+	if (priv->stmt_type == GDA_SQL_STATEMENT_INSERT)
 		{
-			table_name = va_arg (ap, gchar *);
-			if (table_name != NULL)
-				{
-					field_name = va_arg (ap, gchar *);
-					if (field_name != NULL)
-						{
-							field_alias = va_arg (ap, gchar *);
-							if (field_alias != NULL)
-								{
-									t = gdaex_sql_builder_get_table (sqlb, table_name, NULL, TRUE);
-									f = gdaex_sql_builder_get_field (sqlb, t, field_name, field_alias, NULL, TRUE);
-								}
-							else
-								{
-									break;
-								}
-						}
-					else
-						{
-							break;
-						}
-				}
-			else
-				{
-					break;
-				}
-
-			op_expr = va_arg (ap, guint);
-
-			id_expr1 = 0;
-			id_expr2 = 0;
-			switch (op_expr)
-				{
-				case GDA_SQL_OPERATOR_TYPE_EQ:
-				case GDA_SQL_OPERATOR_TYPE_IS:
-				case GDA_SQL_OPERATOR_TYPE_LIKE:
-				case GDA_SQL_OPERATOR_TYPE_NOTLIKE:
-				case GDA_SQL_OPERATOR_TYPE_ILIKE:
-				case GDA_SQL_OPERATOR_TYPE_NOTILIKE:
-				case GDA_SQL_OPERATOR_TYPE_GT:
-				case GDA_SQL_OPERATOR_TYPE_LT:
-				case GDA_SQL_OPERATOR_TYPE_GEQ:
-				case GDA_SQL_OPERATOR_TYPE_LEQ:
-				case GDA_SQL_OPERATOR_TYPE_DIFF:
-				case GDA_SQL_OPERATOR_TYPE_REGEXP:
-				case GDA_SQL_OPERATOR_TYPE_REGEXP_CI:
-				case GDA_SQL_OPERATOR_TYPE_NOT_REGEXP:
-				case GDA_SQL_OPERATOR_TYPE_NOT_REGEXP_CI:
-				case GDA_SQL_OPERATOR_TYPE_SIMILAR:
-				case GDA_SQL_OPERATOR_TYPE_REM:
-				case GDA_SQL_OPERATOR_TYPE_DIV:
-				case GDA_SQL_OPERATOR_TYPE_BITAND:
-				case GDA_SQL_OPERATOR_TYPE_BITOR:
-					gval = va_arg (ap, GValue *);
-					if (gval != NULL)
-						{
-							id_expr1 = gda_sql_builder_add_expr_value (priv->sqlb, NULL, gval);
-						}
-					break;
-
-				case GDA_SQL_OPERATOR_TYPE_ISNULL:
-				case GDA_SQL_OPERATOR_TYPE_ISNOTNULL:
-					break;
-
-				case GDA_SQL_OPERATOR_TYPE_BETWEEN:
-					gval = va_arg (ap, GValue *);
-					if (gval != NULL)
-						{
-							id_expr1 = gda_sql_builder_add_expr_value (priv->sqlb, NULL, gval);
-						}
-					gval = va_arg (ap, GValue *);
-					if (gval != NULL)
-						{
-							id_expr2 = gda_sql_builder_add_expr_value (priv->sqlb, NULL, gval);
-						}
-					break;
-				}
-
-			id_cond = gda_sql_builder_add_cond (priv->sqlb, op_expr, f->id, id_expr1, id_expr2);
-			if (priv->id_where != 0)
-				{
-					priv->id_where = gda_sql_builder_add_cond (priv->sqlb, op, priv->id_where, id_cond, 0);
-				}
-			else
-				{
-					priv->id_where = id_cond;
-				}
-			gda_sql_builder_set_where (priv->sqlb, priv->id_where);
-		} while (TRUE);
-	va_end (ap);
-
-	return priv->id_where;
+			/* its value is known only on execution */
+			g_ptr_array_add (priv->insert_fields, g_strdup (g_strcmp0 (field_alias, "") != 0 ? field_alias : field_name));
+			g_ptr_array_add (priv->insert_values, NULL);
+			g_ptr_array_add (priv->insert_params, g_strdup (param_name != NULL ? param_name : field_name));
+		}
+	gdaex_sql_builder_changed (sqlb);
 }
 
 /**
- * gdaex_sql_builder_order:
+ * gdaex_sql_builder_add_row:
  * @sqlb:
- * @...:
+ * @...: a #NULL terminated list of couples field_name - #GValue.
+ *
+ * Appends a row to an INSERT statement: the first row is the one given
+ * with gdaex_sql_builder_field() and gdaex_sql_builder_fields(), which also
+ * decide the fields of the statement; fields missing from the list are NULL.
  */
 void
-gdaex_sql_builder_order (GdaExSqlBuilder *sqlb, ...)
+gdaex_sql_builder_add_row (GdaExSqlBuilder *sqlb, ...)
 {
 	va_list ap;
-
-	gchar *table_name;
+	GPtrArray *row;
 	gchar *field_name;
-	gchar *field_alias;
-	gboolean asc;
+	GValue *gval;
+	guint i;
 
-	GdaExSqlBuilderTable *t;
-	GdaExSqlBuilderField *f;
+	g_return_if_fail (GDAEX_IS_SQLBUILDER (sqlb));
 
 	GdaExSqlBuilderPrivate *priv = GDAEX_SQLBUILDER_GET_PRIVATE (sqlb);
 
+	if (priv->stmt_type != GDA_SQL_STATEMENT_INSERT)
+		{
+			g_warning (_("Rows can be added only to INSERT statements."));
+			return;
+		}
+
+	row = g_ptr_array_new_with_free_func (gdaex_sql_builder_value_free);
+	g_ptr_array_set_size (row, priv->insert_fields->len);
+
 	va_start (ap, sqlb);
-	do
+	while ((field_name = va_arg (ap, gchar *)) != NULL)
 		{
-			table_name = NULL;
-			field_name = NULL;
-			field_alias = NULL;
+			gval = va_arg (ap, GValue *);
 
-			table_name = va_arg (ap, gchar *);
-			if (table_name != NULL)
+			for (i = 0; i < priv->insert_fields->len; i++)
 				{
-				    field_name = va_arg (ap, gchar *);
-					if (field_name != NULL)
-						{
-							field_alias = va_arg (ap, gchar *);
-							if (field_alias != NULL)
-								{
-									asc = va_arg (ap, gboolean);
-
-									t = gdaex_sql_builder_get_table (sqlb, table_name, NULL, TRUE);
-								    f = gdaex_sql_builder_get_field (sqlb, t, field_name, field_alias, NULL, TRUE);
-									gda_sql_builder_select_order_by (priv->sqlb, f->id, asc, NULL);
-								}
-							else
-								{
-									break;
-								}
-						}
-					else
+					if (g_strcmp0 (field_name, g_ptr_array_index (priv->insert_fields, i)) == 0)
 						{
 							break;
 						}
 				}
-			else
+			if (i == priv->insert_fields->len)
 				{
-					break;
+					g_warning (_("Field «%s» is not one of the fields of the INSERT statement."), field_name);
+					continue;
 				}
-		} while (TRUE);
+
+			gdaex_sql_builder_value_free (g_ptr_array_index (row, i));
+			g_ptr_array_index (row, i) = gval != NULL ? gda_value_copy (gval) : NULL;
+		}
 	va_end (ap);
+
+	g_ptr_array_add (priv->rows, row);
+	gdaex_sql_builder_changed (sqlb);
 }
 
 /**
- * gaex_sql_builder_get_gda_sql_builder:
+ * gdaex_sql_builder_upsert:
  * @sqlb:
+ * @...: a #NULL terminated list of the fields of the unique key.
  *
- * Returns:
+ * Turns an INSERT statement into an upsert: rows whose key already exists
+ * update the other fields. It is rendered as ON CONFLICT ... DO UPDATE on
+ * SQLite and PostgreSQL, as ON DUPLICATE KEY UPDATE on MySQL; on other
+ * providers gdaex_sql_builder_execute() tries an UPDATE and then an INSERT
+ * for every row, under the lock of the #GdaEx and inside the caller's
+ * transaction or its own one (it fails if the connection can't open it),
+ * and the statement can't be compiled (see gdaex_sql_builder_compile()).
  */
-GdaSqlBuilder
-*gdaex_sql_builder_get_gda_sql_builder (GdaExSqlBuilder *sqlb)
+void
+gdaex_sql_builder_upsert (GdaExSqlBuilder *sqlb, ...)
 {
+	va_list ap;
+	GPtrArray *keys;
+	gchar *field_name;
+
+	g_return_if_fail (GDAEX_IS_SQLBUILDER (sqlb));
+
 	GdaExSqlBuilderPrivate *priv = GDAEX_SQLBUILDER_GET_PRIVATE (sqlb);
 
-	return priv->sqlb;
-}
+	if (priv->stmt_type != GDA_SQL_STATEMENT_INSERT)
+		{
+			g_warning (_("Upsert is allowed only on INSERT statements."));
+			return;
+		}
+
+	keys = g_ptr_array_new ();
+	va_start (ap, sqlb);
+	while ((field_name = va_arg (ap, gchar *)) != NULL)
+		{
+			g_ptr_array_add (keys, g_strdup (field_name));
+		}
+	va_end (ap);
+	g_ptr_array_add (keys, NULL);
+
+	g_strfreev (priv->upsert_keys);
+	priv->upsert_keys = (gchar **)g_ptr_array_free (keys, FALSE);
+	if (priv->upsert_keys[0] == NULL)
+		{
+			g_strfreev (priv->upsert_keys);
+			priv->upsert_keys = NULL;
+		}
+
+	gdaex_sql_builder_changed (sqlb);
+}
+
+/**
+ * gdaex_sql_builder_set_in_list_threshold:
+ * @sqlb:
+ * @threshold: the number of keys above which gdaex_sql_builder_where_in()
+ * stages them into a temporary table.
+ *
+ */
+void
+gdaex_sql_builder_set_in_list_threshold (GdaExSqlBuilder *sqlb, guint threshold)
+{
+	g_return_if_fail (GDAEX_IS_SQLBUILDER (sqlb));
+
+	GdaExSqlBuilderPrivate *priv = GDAEX_SQLBUILDER_GET_PRIVATE (sqlb);
+
+	priv->in_list_threshold = threshold;
+}
+
+static gboolean
+gdaex_sql_builder_in_list_get_value (GArray *keys, GType gtype, guint i, GValue *gval)
+{
+	g_value_init (gval, gtype);
+	switch (gtype)
+		{
+			case G_TYPE_INT:
+				g_value_set_int (gval, g_array_index (keys, gint, i));
+				break;
+
+			case G_TYPE_UINT:
+				g_value_set_uint (gval, g_array_index (keys, guint, i));
+				break;
+
+			case G_TYPE_LONG:
+				g_value_set_long (gval, g_array_index (keys, glong, i));
+				break;
+
+			case G_TYPE_INT64:
+				g_value_set_int64 (gval, g_array_index (keys, gint64, i));
+				break;
+
+			case G_TYPE_UINT64:
+				g_value_set_uint64 (gval, g_array_index (keys, guint64, i));
+				break;
+
+			case G_TYPE_STRING:
+				g_value_set_string (gval, g_array_index (keys, gchar *, i));
+				break;
+
+			default:
+				g_value_unset (gval);
+				return FALSE;
+		}
+
+	return TRUE;
+}
+
+/**
+ * gdaex_sql_builder_where_in:
+ * @sqlb:
+ * @op: the operator linking the condition to the previous ones.
+ * @table_name:
+ * @field_name:
+ * @field_alias:
+ * @gtype: the type of the elements of @keys: G_TYPE_INT, G_TYPE_UINT,
+ * G_TYPE_LONG, G_TYPE_INT64, G_TYPE_UINT64 or G_TYPE_STRING (gchar *).
+ * @keys: the keys.
+ *
+ * Adds the condition field IN (@keys). Up to the threshold (see
+ * gdaex_sql_builder_set_in_list_threshold()) the keys are parameters of the
+ * statement; above it they are loaded, at every execution, into a temporary
+ * table of the session of the #GdaEx, dropped afterwards, and the condition
+ * becomes field IN (SELECT k FROM temporary_table).
+ *
+ * Returns:
+ */
+GdaSqlBuilderId
+gdaex_sql_builder_where_in (GdaExSqlBuilder *sqlb, GdaSqlOperatorType op,
+                            const gchar *table_name, const gchar *field_name, const gchar *field_alias,
+                            GType gtype, GArray *keys)
+{
+	GdaExSqlBuilderTable *t;
+	GdaExSqlBuilderField *f;
+	GdaExSqlBuilderInList *l;
+	GdaSqlBuilderId *ids;
+	GdaSqlBuilderId id_cond;
+	GdaSqlBuilder *b;
+	GdaSqlStatement *sqlst;
+	GValue gval = G_VALUE_INIT;
+	gchar *param_name;
+	guint i;
+
+	g_return_val_if_fail (GDAEX_IS_SQLBUILDER (sqlb), -1);
+	g_return_val_if_fail (keys != NULL, -1);
+
+	GdaExSqlBuilderPrivate *priv = GDAEX_SQLBUILDER_GET_PRIVATE (sqlb);
+
+	if (priv->stmt_type == GDA_SQL_STATEMENT_INSERT)
+		{
+			return -1;
+		}
+
+	if (keys->len > 0
+	    && !gdaex_sql_builder_in_list_get_value (keys, gtype, 0, &gval))
+		{
+			g_warning (_("Type «%s» not supported for IN lists."), g_type_name (gtype));
+			return -1;
+		}
+	if (G_IS_VALUE (&gval))
+		{
+			g_value_unset (&gval);
+		}
+
+	t = gdaex_sql_builder_get_table (sqlb, table_name, NULL, TRUE);
+	f = gdaex_sql_builder_get_field (sqlb, t, field_name, field_alias, NULL, TRUE);
+
+	if (keys->len == 0)
+		{
+			/* nothing can be in an empty list */
+			id_cond = gda_sql_builder_add_cond (priv->sqlb, GDA_SQL_OPERATOR_TYPE_EQ,
+			                                    gda_sql_builder_add_expr (priv->sqlb, NULL, G_TYPE_INT, 1),
+			                                    gda_sql_builder_add_expr (priv->sqlb, NULL, G_TYPE_INT, 0),
+			                                    0);
+		}
+	else if (keys->len <= priv->in_list_threshold)
+		{
+			ids = g_new0 (GdaSqlBuilderId, keys->len + 1);
+			ids[0] = f->id;
+			for (i = 0; i < keys->len; i++)
+				{
+					param_name = g_strdup_printf ("gdaex_in_%u_%u", priv->n_in_lists, i);
+					ids[i + 1] = gda_sql_builder_add_param (priv->sqlb, param_name, gtype, FALSE);
+
+					gdaex_sql_builder_in_list_get_value (keys, gtype, i, &gval);
+					g_hash_table_replace (priv->bound_values, param_name, gda_value_copy (&gval));
+					g_value_unset (&gval);
+				}
+			id_cond = gda_sql_builder_add_cond_v (priv->sqlb, GDA_SQL_OPERATOR_TYPE_IN, ids, keys->len + 1);
+			g_free (ids);
+		}
+	else
+		{
+			l = g_new0 (GdaExSqlBuilderInList, 1);
+			l->table_name = g_strdup_printf ("gdaex_in_%d", g_atomic_int_add (&in_lists_serial, 1));
+			l->gtype = gtype;
+			l->keys = g_array_ref (keys);
+			g_ptr_array_add (priv->in_lists, l);
+
+			b = gda_sql_builder_new (GDA_SQL_STATEMENT_SELECT);
+			gda_sql_builder_select_add_field (b, "k", NULL, NULL);
+			gda_sql_builder_select_add_target_id (b, gda_sql_builder_add_id (b, l->table_name), NULL);
+			sqlst = gda_sql_builder_get_sql_statement (b);
+			id_cond = gda_sql_builder_add_cond (priv->sqlb, GDA_SQL_OPERATOR_TYPE_IN,
+			                                    f->id,
+			                                    gda_sql_builder_add_sub_select (priv->sqlb, sqlst),
+			                                    0);
+			gda_sql_statement_free (sqlst);
+			g_object_unref (b);
+		}
+	priv->n_in_lists++;
+
+	gdaex_sql_builder_add_where_cond (sqlb, op, id_cond);
+
+	return priv->id_where;
+}
+
+/**
+ * gdaex_sql_builder_where_param:
+ * @sqlb:
+ * @op: the operator linking the condition to the previous ones.
+ * @table_name:
+ * @field_name:
+ * @field_alias:
+ * @op_expr: the condition's operator.
+ * @param_name: the name of the parameter; if NULL, @field_name is used.
+ * @gtype: the type of the parameter's value.
+ *
+ * As gdaex_sql_builder_where() with a single condition whose value
+ * is a placeholder bound at execution time.
+ *
+ * Returns:
+ */
+GdaSqlBuilderId
+gdaex_sql_builder_where_param (GdaExSqlBuilder *sqlb, GdaSqlOperatorType op,
+                               const gchar *table_name, const gchar *field_name, const gchar *field_alias,
+                               GdaSqlOperatorType op_expr,
+                               const gchar *param_name, GType gtype)
+{
+	GdaExSqlBuilderTable *t;
+	GdaExSqlBuilderField *f;
+	GdaSqlBuilderId id_param;
+
+	g_return_val_if_fail (GDAEX_IS_SQLBUILDER (sqlb), -1);
+
+	GdaExSqlBuilderPrivate *priv = GDAEX_SQLBUILDER_GET_PRIVATE (sqlb);
+
+	if (priv->stmt_type == GDA_SQL_STATEMENT_INSERT)
+		{
+			return -1;
+		}
+
+	t = gdaex_sql_builder_get_table (sqlb, table_name, NULL, TRUE);
+	f = gdaex_sql_builder_get_field (sqlb, t, field_name, field_alias, NULL, TRUE);
+
+	id_param = gda_sql_builder_add_param (priv->sqlb, param_name != NULL ? param_name : field_name, gtype, TRUE);
+	gdaex_sql_builder_add_where_cond (sqlb, op,
+	                                  gda_sql_builder_add_cond (priv->sqlb, op_expr, f->id, id_param, 0));
+
+	return priv->id_where;
+}
+
+/**
+ * gdaex_sql_builder_where:
+ * @sqlb:
+ * @op:
+ * @...:
+ *
+ * Returns:
+ */
+GdaSqlBuilderId
+gdaex_sql_builder_where (GdaExSqlBuilder *sqlb, GdaSqlOperatorType op, ...)
+{
+	va_list ap;
+
+	gchar *table_name;
+	gchar *field_name;
+	gchar *field_alias;
+	GValue *gval;
+
+	GdaExSqlBuilderTable *t;
+	GdaExSqlBuilderField *f;
+
+	GdaSqlOperatorType op_expr;
+
+	GdaSqlBuilderId id_expr1;
+	GdaSqlBuilderId id_expr2;
+	GdaSqlBuilderId id_cond;
+
+	GdaExSqlBuilderPrivate *priv = GDAEX_SQLBUILDER_GET_PRIVATE (sqlb);
+
+	if (priv->stmt_type == GDA_SQL_STATEMENT_INSERT)
+		{
+			return -1;
+		}
+
+	va_start (ap, op);
+	do
+		{
+			table_name = va_arg (ap, gchar *);
+			if (table_name != NULL)
+				{
+					field_name = va_arg (ap, gchar *);
+					if (field_name != NULL)
+						{
+							field_alias = va_arg (ap, gchar *);
+							if (field_alias != NULL)
+								{
+									t = gdaex_sql_builder_get_table (sqlb, table_name, NULL, TRUE);
+									f = gdaex_sql_builder_get_field (sqlb, t, field_name, field_alias, NULL, TRUE);
+								}
+							else
+								{
+									break;
+								}
+						}
+					else
+						{
+							break;
+						}
+				}
+			else
+				{
+					break;
+				}
+
+			op_expr = va_arg (ap, guint);
+
+			id_expr1 = 0;
+			id_expr2 = 0;
+			switch (op_expr)
+				{
+				case GDA_SQL_OPERATOR_TYPE_EQ:
+				case GDA_SQL_OPERATOR_TYPE_IS:
+				case GDA_SQL_OPERATOR_TYPE_LIKE:
+				case GDA_SQL_OPERATOR_TYPE_NOTLIKE:
+				case GDA_SQL_OPERATOR_TYPE_ILIKE:
+				case GDA_SQL_OPERATOR_TYPE_NOTILIKE:
+				case GDA_SQL_OPERATOR_TYPE_GT:
+				case GDA_SQL_OPERATOR_TYPE_LT:
+				case GDA_SQL_OPERATOR_TYPE_GEQ:
+				case GDA_SQL_OPERATOR_TYPE_LEQ:
+				case GDA_SQL_OPERATOR_TYPE_DIFF:
+				case GDA_SQL_OPERATOR_TYPE_REGEXP:
+				case GDA_SQL_OPERATOR_TYPE_REGEXP_CI:
+				case GDA_SQL_OPERATOR_TYPE_NOT_REGEXP:
+				case GDA_SQL_OPERATOR_TYPE_NOT_REGEXP_CI:
+				case GDA_SQL_OPERATOR_TYPE_SIMILAR:
+				case GDA_SQL_OPERATOR_TYPE_REM:
+				case GDA_SQL_OPERATOR_TYPE_DIV:
+				case GDA_SQL_OPERATOR_TYPE_BITAND:
+				case GDA_SQL_OPERATOR_TYPE_BITOR:
+					gval = va_arg (ap, GValue *);
+					if (gval != NULL)
+						{
+							id_expr1 = gda_sql_builder_add_expr_value (priv->sqlb, NULL, gval);
+						}
+					break;
+
+				case GDA_SQL_OPERATOR_TYPE_ISNULL:
+				case GDA_SQL_OPERATOR_TYPE_ISNOTNULL:
+					break;
+
+				case GDA_SQL_OPERATOR_TYPE_BETWEEN:
+					gval = va_arg (ap, GValue *);
+					if (gval != NULL)
+						{
+							id_expr1 = gda_sql_builder_add_expr_value (priv->sqlb, NULL, gval);
+						}
+					gval = va_arg (ap, GValue *);
+					if (gval != NULL)
+						{
+							id_expr2 = gda_sql_builder_add_expr_value (priv->sqlb, NULL, gval);
+						}
+					break;
+				}
+
+			id_cond = gda_sql_builder_add_cond (priv->sqlb, op_expr, f->id, id_expr1, id_expr2);
+			gdaex_sql_builder_add_where_cond (sqlb, op, id_cond);
+		} while (TRUE);
+	va_end (ap);
+
+	return priv->id_where;
+}
+
+/**
+ * gdaex_sql_builder_order:
+ * @sqlb:
+ * @...:
+ */
+void
+gdaex_sql_builder_order (GdaExSqlBuilder *sqlb, ...)
+{
+	va_list ap;
+
+	gchar *table_name;
+	gchar *field_name;
+	gchar *field_alias;
+	gboolean asc;
+
+	GdaExSqlBuilderTable *t;
+	GdaExSqlBuilderField *f;
+	GdaExSqlBuilderOrder *o;
+
+	GdaExSqlBuilderPrivate *priv = GDAEX_SQLBUILDER_GET_PRIVATE (sqlb);
+
+	va_start (ap, sqlb);
+	do
+		{
+			table_name = NULL;
+			field_name = NULL;
+			field_alias = NULL;
+
+			table_name = va_arg (ap, gchar *);
+			if (table_name != NULL)
+				{
+				    field_name = va_arg (ap, gchar *);
+					if (field_name != NULL)
+						{
+							field_alias = va_arg (ap, gchar *);
+							if (field_alias != NULL)
+								{
+									asc = va_arg (ap, gboolean);
+
+									t = gdaex_sql_builder_get_table (sqlb, table_name, NULL, TRUE);
+								    f = gdaex_sql_builder_get_field (sqlb, t, field_name, field_alias, NULL, TRUE);
+									gda_sql_builder_select_order_by (priv->sqlb, f->id, asc, NULL);
+
+									o = g_new0 (GdaExSqlBuilderOrder, 1);
+									o->field = f;
+									o->asc = asc;
+									g_ptr_array_add (priv->order_fields, o);
+
+									gdaex_sql_builder_changed (sqlb);
+								}
+							else
+								{
+									break;
+								}
+						}
+					else
+						{
+							break;
+						}
+				}
+			else
+				{
+					break;
+				}
+		} while (TRUE);
+	va_end (ap);
+}
+
+static GdaSqlBuilderId
+gdaex_sql_builder_get_aggregate_id (GdaExSqlBuilder *sqlb, GdaExSqlBuilderAggregate aggregate, const gchar *table_name, const gchar *field_name)
+{
+	GdaExSqlBuilderTable *t;
+	GdaSqlBuilderId id_arg;
+	gchar *expr;
+
+	GdaExSqlBuilderPrivate *priv = GDAEX_SQLBUILDER_GET_PRIVATE (sqlb);
+
+	if (field_name == NULL
+	    || g_strcmp0 (field_name, "") == 0)
+		{
+			id_arg = gda_sql_builder_add_id (priv->sqlb, "*");
+		}
+	else
+		{
+			t = gdaex_sql_builder_get_table (sqlb, table_name, NULL, TRUE);
+			expr = g_strdup_printf ("%s.%s", g_strcmp0 (t->alias, "") != 0 && t->alias != NULL ? t->alias : t->name, field_name);
+			id_arg = gda_sql_builder_add_id (priv->sqlb, expr);
+			g_free (expr);
+		}
+
+	return gda_sql_builder_add_function (priv->sqlb, aggregates_names[aggregate], id_arg, 0);
+}
+
+/**
+ * gdaex_sql_builder_aggregate:
+ * @sqlb:
+ * @aggregate:
+ * @table_name:
+ * @field_name: the field to aggregate; #NULL for COUNT(*).
+ * @alias: (allow-none): the name of the column in the result.
+ *
+ * Adds an aggregate function to the fields of a SELECT statement.
+ */
+void
+gdaex_sql_builder_aggregate (GdaExSqlBuilder *sqlb, GdaExSqlBuilderAggregate aggregate,
+                             const gchar *table_name, const gchar *field_name, const gchar *alias)
+{
+	g_return_if_fail (GDAEX_IS_SQLBUILDER (sqlb));
+	g_return_if_fail (aggregate <= GDAEX_SQLBUILDER_AGGREGATE_AVG);
+
+	GdaExSqlBuilderPrivate *priv = GDAEX_SQLBUILDER_GET_PRIVATE (sqlb);
+
+	if (priv->stmt_type != GDA_SQL_STATEMENT_SELECT)
+		{
+			g_warning (_("Aggregate functions are allowed only on SELECT statements."));
+			return;
+		}
+
+	gda_sql_builder_add_field_value_id (priv->sqlb,
+	                                    gdaex_sql_builder_get_aggregate_id (sqlb, aggregate, table_name, field_name),
+	                                    g_strcmp0 (alias, "") != 0 && alias != NULL ? gda_sql_builder_add_id (priv->sqlb, alias) : 0);
+	gdaex_sql_builder_changed (sqlb);
+}
+
+/**
+ * gdaex_sql_builder_group:
+ * @sqlb:
+ * @...: a #NULL terminated list of couples table_name - field_name.
+ *
+ * Adds the fields to the GROUP BY and to the fields of the statement.
+ */
+void
+gdaex_sql_builder_group (GdaExSqlBuilder *sqlb, ...)
+{
+	va_list ap;
+
+	gchar *table_name;
+	gchar *field_name;
+
+	GdaExSqlBuilderTable *t;
+	GdaExSqlBuilderField *f;
+
+	g_return_if_fail (GDAEX_IS_SQLBUILDER (sqlb));
+
+	GdaExSqlBuilderPrivate *priv = GDAEX_SQLBUILDER_GET_PRIVATE (sqlb);
+
+	if (priv->stmt_type != GDA_SQL_STATEMENT_SELECT)
+		{
+			g_warning (_("GROUP BY is allowed only on SELECT statements."));
+			return;
+		}
+
+	va_start (ap, sqlb);
+	while ((table_name = va_arg (ap, gchar *)) != NULL)
+		{
+			field_name = va_arg (ap, gchar *);
+			if (field_name == NULL)
+				{
+					break;
+				}
+
+			t = gdaex_sql_builder_get_table (sqlb, table_name, NULL, TRUE);
+			f = gdaex_sql_builder_get_field (sqlb, t, field_name, NULL, NULL, TRUE);
+			gda_sql_builder_select_group_by (priv->sqlb, f->id);
+			gdaex_sql_builder_changed (sqlb);
+		}
+	va_end (ap);
+}
+
+/**
+ * gdaex_sql_builder_having:
+ * @sqlb:
+ * @op: the operator linking the condition to the previous ones.
+ * @aggregate:
+ * @table_name:
+ * @field_name: the aggregated field; #NULL for COUNT(*).
+ * @op_expr: the condition's operator.
+ * @gval: the value to compare with.
+ *
+ * Returns:
+ */
+GdaSqlBuilderId
+gdaex_sql_builder_having (GdaExSqlBuilder *sqlb, GdaSqlOperatorType op,
+                          GdaExSqlBuilderAggregate aggregate, const gchar *table_name, const gchar *field_name,
+                          GdaSqlOperatorType op_expr, GValue *gval)
+{
+	GdaSqlBuilderId id_cond;
+
+	g_return_val_if_fail (GDAEX_IS_SQLBUILDER (sqlb), -1);
+	g_return_val_if_fail (aggregate <= GDAEX_SQLBUILDER_AGGREGATE_AVG, -1);
+
+	GdaExSqlBuilderPrivate *priv = GDAEX_SQLBUILDER_GET_PRIVATE (sqlb);
+
+	if (priv->stmt_type != GDA_SQL_STATEMENT_SELECT)
+		{
+			g_warning (_("HAVING is allowed only on SELECT statements."));
+			return -1;
+		}
+
+	id_cond = gda_sql_builder_add_cond (priv->sqlb, op_expr,
+	                                    gdaex_sql_builder_get_aggregate_id (sqlb, aggregate, table_name, field_name),
+	                                    gval != NULL ? gda_sql_builder_add_expr_value (priv->sqlb, NULL, gval) : 0,
+	                                    0);
+	if (priv->id_having != 0)
+		{
+			priv->id_having = gda_sql_builder_add_cond (priv->sqlb, op, priv->id_having, id_cond, 0);
+		}
+	else
+		{
+			priv->id_having = id_cond;
+		}
+	gda_sql_builder_select_set_having (priv->sqlb, priv->id_having);
+	gdaex_sql_builder_changed (sqlb);
+
+	return priv->id_having;
+}
+
+/**
+ * gdaex_sql_builder_limit:
+ * @sqlb:
+ * @limit: the maximum number of rows; 0 or less removes the limit.
+ * @offset: the number of rows to skip.
+ *
+ */
+void
+gdaex_sql_builder_limit (GdaExSqlBuilder *sqlb, gint limit, gint offset)
+{
+	g_return_if_fail (GDAEX_IS_SQLBUILDER (sqlb));
+
+	GdaExSqlBuilderPrivate *priv = GDAEX_SQLBUILDER_GET_PRIVATE (sqlb);
+
+	if (priv->stmt_type != GDA_SQL_STATEMENT_SELECT)
+		{
+			g_warning (_("LIMIT is allowed only on SELECT statements."));
+			return;
+		}
+
+	gda_sql_builder_select_set_limit (priv->sqlb,
+	                                  limit > 0 ? gda_sql_builder_add_expr (priv->sqlb, NULL, G_TYPE_INT, limit) : 0,
+	                                  limit > 0 && offset > 0 ? gda_sql_builder_add_expr (priv->sqlb, NULL, G_TYPE_INT, offset) : 0);
+	gdaex_sql_builder_changed (sqlb);
+}
+
+/**
+ * gdaex_sql_builder_limit_params:
+ * @sqlb:
+ * @limit_param: the name of the parameter of the maximum number of rows.
+ * @offset_param: (nullable): the name of the parameter of the number of rows to skip.
+ *
+ * As gdaex_sql_builder_limit(), but LIMIT and OFFSET are #G_TYPE_INT
+ * parameters bound at execution time: changing only their values, the
+ * prepared statement is reused for every page.
+ */
+void
+gdaex_sql_builder_limit_params (GdaExSqlBuilder *sqlb, const gchar *limit_param, const gchar *offset_param)
+{
+	g_return_if_fail (GDAEX_IS_SQLBUILDER (sqlb));
+	g_return_if_fail (limit_param != NULL);
+
+	GdaExSqlBuilderPrivate *priv = GDAEX_SQLBUILDER_GET_PRIVATE (sqlb);
+
+	if (priv->stmt_type != GDA_SQL_STATEMENT_SELECT)
+		{
+			g_warning (_("LIMIT is allowed only on SELECT statements."));
+			return;
+		}
+
+	gda_sql_builder_select_set_limit (priv->sqlb,
+	                                  gda_sql_builder_add_param (priv->sqlb, limit_param, G_TYPE_INT, FALSE),
+	                                  offset_param != NULL ? gda_sql_builder_add_param (priv->sqlb, offset_param, G_TYPE_INT, FALSE) : 0);
+	gdaex_sql_builder_changed (sqlb);
+}
+
+static gint
+gdaex_sql_builder_keyset_get_column (GdaExSqlBuilderOrder *o, GdaDataModel *dm)
+{
+	gint col;
+
+	col = gda_data_model_get_column_index (dm, g_strcmp0 (o->field->alias, "") != 0 && o->field->alias != NULL ? o->field->alias : o->field->name);
+	if (col < 0)
+		{
+			g_warning (_("The ORDER BY field «%s» is not in the selected fields."), o->field->name);
+		}
+
+	return col;
+}
+
+/**
+ * gdaex_sql_builder_keyset:
+ * @sqlb:
+ * @dm: the last page returned by the statement.
+ * @row: the row of @dm to continue from, usually the last one.
+ *
+ * Keyset pagination: the first call adds to the WHERE the continuation
+ * predicate on the ORDER BY fields (k1 > ?) OR (k1 = ? AND k2 > ?)...
+ * (< for descending fields), as parameters; every call binds the values of
+ * @row, so the prepared statement is reused for every page.
+ * The ORDER BY fields must be selected, must identify a row and must not be NULL.
+ * The predicate stays in the WHERE until gdaex_sql_builder_keyset_reset().
+ * The returned #GdaSet holds every parameter of the statement: the values of
+ * the caller's ones must be set into it too.
+ *
+ * Returns: (transfer none): the #GdaSet to pass to gdaex_sql_builder_query(),
+ * or #NULL on error.
+ */
+GdaSet
+*gdaex_sql_builder_keyset (GdaExSqlBuilder *sqlb, GdaDataModel *dm, gint row)
+{
+	GdaExSqlBuilderOrder *o;
+	GdaSqlBuilderId id_or;
+	GdaSqlBuilderId id_and;
+	GdaSqlBuilderId id_cond;
+	GdaStatement *stmt;
+	GdaHolder *holder;
+	const GValue *gval;
+	GError *error;
+	gchar *param_name;
+	gint col;
+	guint i;
+	guint j;
+
+	g_return_val_if_fail (GDAEX_IS_SQLBUILDER (sqlb), NULL);
+	g_return_val_if_fail (GDA_IS_DATA_MODEL (dm), NULL);
+
+	GdaExSqlBuilderPrivate *priv = GDAEX_SQLBUILDER_GET_PRIVATE (sqlb);
+
+	if (priv->stmt_type != GDA_SQL_STATEMENT_SELECT
+	    || priv->order_fields->len == 0)
+		{
+			g_warning (_("Keyset pagination needs a SELECT statement with an ORDER BY."));
+			return NULL;
+		}
+
+	if (!priv->keyset)
+		{
+			id_or = 0;
+			for (i = 0; i < priv->order_fields->len; i++)
+				{
+					id_and = 0;
+					for (j = 0; j <= i; j++)
+						{
+							o = g_ptr_array_index (priv->order_fields, j);
+							col = gdaex_sql_builder_keyset_get_column (o, dm);
+							if (col < 0)
+								{
+									return NULL;
+								}
+
+							param_name = g_strdup_printf ("gdaex_keyset_%u", j);
+							id_cond = gda_sql_builder_add_cond (priv->sqlb,
+							                                    j < i ? GDA_SQL_OPERATOR_TYPE_EQ : (o->asc ? GDA_SQL_OPERATOR_TYPE_GT : GDA_SQL_OPERATOR_TYPE_LT),
+							                                    o->field->id,
+							                                    gda_sql_builder_add_param (priv->sqlb, param_name,
+							                                                               gda_column_get_g_type (gda_data_model_describe_column (dm, col)),
+							                                                               FALSE),
+							                                    0);
+							g_free (param_name);
+
+							id_and = id_and != 0 ? gda_sql_builder_add_cond (priv->sqlb, GDA_SQL_OPERATOR_TYPE_AND, id_and, id_cond, 0) : id_cond;
+						}
+					id_or = id_or != 0 ? gda_sql_builder_add_cond (priv->sqlb, GDA_SQL_OPERATOR_TYPE_OR, id_or, id_and, 0) : id_and;
+				}
+
+			priv->keyset_id_where = priv->id_where;
+			gdaex_sql_builder_add_where_cond (sqlb, GDA_SQL_OPERATOR_TYPE_AND, id_or);
+			priv->keyset = TRUE;
+		}
+
+	if (priv->keyset_params == NULL)
+		{
+			stmt = gdaex_sql_builder_get_statement (sqlb);
+			error = NULL;
+			if (stmt == NULL
+			    || !gda_statement_get_parameters (stmt, &priv->keyset_params, &error)
+			    || priv->keyset_params == NULL)
+				{
+					g_warning (_("Unable to get the parameters of the statement: %s"),
+					           error != NULL && error->message != NULL ? error->message : _("no details"));
+					g_clear_error (&error);
+					return NULL;
+				}
+		}
+
+	for (i = 0; i < priv->order_fields->len; i++)
+		{
+			o = g_ptr_array_index (priv->order_fields, i);
+			col = gdaex_sql_builder_keyset_get_column (o, dm);
+			if (col < 0)
+				{
+					return NULL;
+				}
+
+			error = NULL;
+			gval = gda_data_model_get_value_at (dm, col, row, &error);
+			param_name = g_strdup_printf ("gdaex_keyset_%u", i);
+			holder = gda_set_get_holder (priv->keyset_params, param_name);
+			g_free (param_name);
+			if (gval == NULL
+			    || holder == NULL
+			    || !gda_holder_set_value (holder, gval, &error))
+				{
+					g_warning (_("Unable to bind the keyset value of the field «%s»: %s"),
+					           o->field->name,
+					           error != NULL && error->message != NULL ? error->message : _("no details"));
+					g_clear_error (&error);
+					return NULL;
+				}
+		}
+
+	return priv->keyset_params;
+}
+
+/**
+ * gdaex_sql_builder_keyset_reset:
+ * @sqlb:
+ *
+ * Removes from the WHERE the predicate added by gdaex_sql_builder_keyset()
+ * (and the conditions added after it), to read again from the first page.
+ */
+void
+gdaex_sql_builder_keyset_reset (GdaExSqlBuilder *sqlb)
+{
+	g_return_if_fail (GDAEX_IS_SQLBUILDER (sqlb));
+
+	GdaExSqlBuilderPrivate *priv = GDAEX_SQLBUILDER_GET_PRIVATE (sqlb);
+
+	if (!priv->keyset)
+		{
+			return;
+		}
+
+	priv->id_where = priv->keyset_id_where;
+	gda_sql_builder_set_where (priv->sqlb, priv->id_where);
+	priv->keyset = FALSE;
+	priv->keyset_id_where = 0;
+	gdaex_sql_builder_changed (sqlb);
+}
+
+/**
+ * gaex_sql_builder_get_gda_sql_builder:
+ * @sqlb:
+ *
+ * Returns:
+ */
+GdaSqlBuilder
+*gdaex_sql_builder_get_gda_sql_builder (GdaExSqlBuilder *sqlb)
+{
+	GdaExSqlBuilderPrivate *priv = GDAEX_SQLBUILDER_GET_PRIVATE (sqlb);
+
+	priv->exposed = TRUE;
+
+	return priv->sqlb;
+}
+
+/* drops the caches if the given out GdaSqlBuilder has been changed since
+ * they were built */
+static void
+gdaex_sql_builder_check_exposed (GdaExSqlBuilder *sqlb)
+{
+	GdaSqlStatement *sqlst;
+	gchar *fingerprint;
+
+	GdaExSqlBuilderPrivate *priv = GDAEX_SQLBUILDER_GET_PRIVATE (sqlb);
+
+	if (!priv->exposed)
+		{
+			return;
+		}
+
+	sqlst = gda_sql_builder_get_sql_statement (priv->sqlb);
+	fingerprint = sqlst != NULL ? gda_sql_statement_serialize (sqlst) : NULL;
+	if (sqlst != NULL)
+		{
+			gda_sql_statement_free (sqlst);
+		}
+
+	if (fingerprint == NULL
+	    || g_strcmp0 (fingerprint, priv->fingerprint) != 0)
+		{
+			gdaex_sql_builder_changed (sqlb);
+			g_free (priv->fingerprint);
+			priv->fingerprint = fingerprint;
+		}
+	else
+		{
+			g_free (fingerprint);
+		}
+}
+
+static gboolean
+gdaex_sql_builder_is_identifier_char (gchar c)
+{
+	return (g_ascii_isalnum (c) || c == '_' || c == '$' || c == '.' || (guchar)c >= 0x80);
+}
+
+/* records where each top level clause starts and ends into the rendered sql,
+ * skipping quoted strings, quoted identifiers and parenthesized expressions */
+static void
+gdaex_sql_builder_find_clauses (GdaExSqlBuilderPrivate *priv)
+{
+	const gchar *sql;
+	gint len;
+	gint i;
+	gint k;
+	gint depth;
+	gchar quote;
+	gint last;
+	gint kwlen;
+
+	for (k = 0; k < GDAEX_SQLBUILDER_N_CLAUSES; k++)
+		{
+			priv->clauses_start[k] = -1;
+			priv->clauses_end[k] = -1;
+		}
+
+	sql = priv->sql;
+	len = strlen (sql);
+	depth = 0;
+	quote = 0;
+	last = -1;
+
+	for (i = 0; i < len; i++)
+		{
+			if (quote != 0)
+				{
+					if (sql[i] == quote)
+						{
+							if (i + 1 < len && sql[i + 1] == quote)
+								{
+									i++;
+								}
+							else
+								{
+									quote = 0;
+								}
+						}
+					continue;
+				}
+
+			switch (sql[i])
+				{
+					case '\'':
+					case '"':
+					case '`':
+						quote = sql[i];
+						continue;
+
+					case '(':
+						depth++;
+						continue;
+
+					case ')':
+						depth--;
+						continue;
+				}
+
+			if (depth != 0
+			    || (i > 0 && gdaex_sql_builder_is_identifier_char (sql[i - 1]))
+			    || !g_ascii_isalpha (sql[i]))
+				{
+					continue;
+				}
+
+			for (k = 0; k < GDAEX_SQLBUILDER_N_CLAUSES; k++)
+				{
+					kwlen = strlen (clauses_keywords[k]);
+					if (priv->clauses_start[k] < 0
+					    && g_ascii_strncasecmp (sql + i, clauses_keywords[k], kwlen) == 0
+					    && !gdaex_sql_builder_is_identifier_char (sql[i + kwlen]))
+						{
+							if (last >= 0)
+								{
+									priv->clauses_end[last] = i;
+								}
+
+							i += kwlen;
+							while (i < len && g_ascii_isspace (sql[i]))
+								{
+									i++;
+								}
+							priv->clauses_start[k] = i;
+							last = k;
+							i--;
+							break;
+						}
+				}
+		}
+
+	if (last >= 0)
+		{
+			priv->clauses_end[last] = len;
+		}
+
+	/* trailing blanks before the next keyword */
+	for (k = 0; k < GDAEX_SQLBUILDER_N_CLAUSES; k++)
+		{
+			while (priv->clauses_end[k] > priv->clauses_start[k]
+			       && g_ascii_isspace (sql[priv->clauses_end[k] - 1]))
+				{
+					priv->clauses_end[k]--;
+				}
+		}
+}
+
+/* the type of the parameters of the column @i of the rows */
+static GType
+gdaex_sql_builder_row_column_type (GdaExSqlBuilderPrivate *priv, guint i)
+{
+	GPtrArray *row;
+	GValue *gval;
+	guint r;
+
+	gval = i < priv->insert_values->len ? g_ptr_array_index (priv->insert_values, i) : NULL;
+	for (r = 0; r < priv->rows->len
+	            && (gval == NULL || G_VALUE_HOLDS (gval, GDA_TYPE_NULL)); r++)
+		{
+			row = g_ptr_array_index (priv->rows, r);
+			gval = i < row->len ? g_ptr_array_index (row, i) : NULL;
+		}
+
+	return gval != NULL && !G_VALUE_HOLDS (gval, GDA_TYPE_NULL) ? G_VALUE_TYPE (gval) : G_TYPE_STRING;
+}
+
+/* GdaSqlBuilder knows only the first row of an INSERT: the others are
+ * added to the structure of the statement as parameters, whose values
+ * are bound with the builder's own ones (see gdaex_sql_builder_bind_params()) */
+static void
+gdaex_sql_builder_add_rows_to_statement (GdaExSqlBuilderPrivate *priv, GdaStatement *stmt)
+{
+	GdaSqlStatement *sqlst;
+	GdaSqlStatementInsert *insert;
+	GdaSqlExpr *expr;
+	GSList *values;
+	GPtrArray *row;
+	GValue *gval;
+	const GValue *value;
+	GType *types;
+	gchar *param_name;
+	guint r;
+	guint i;
+
+	g_object_get (G_OBJECT (stmt), "structure", &sqlst, NULL);
+	if (sqlst == NULL)
+		{
+			return;
+		}
+
+	types = g_new0 (GType, priv->insert_fields->len);
+	for (i = 0; i < priv->insert_fields->len; i++)
+		{
+			types[i] = gdaex_sql_builder_row_column_type (priv, i);
+		}
+
+	insert = (GdaSqlStatementInsert *)sqlst->contents;
+	for (r = 0; r < priv->rows->len; r++)
+		{
+			row = g_ptr_array_index (priv->rows, r);
+			values = NULL;
+			for (i = 0; i < priv->insert_fields->len; i++)
+				{
+					param_name = g_strdup_printf ("gdaex_row_%u_%u", r, i);
+
+					expr = gda_sql_expr_new (GDA_SQL_ANY_PART (insert));
+					expr->param_spec = g_new0 (GdaSqlParamSpec, 1);
+					expr->param_spec->name = g_strdup (param_name);
+					expr->param_spec->is_param = TRUE;
+					expr->param_spec->nullok = TRUE;
+					expr->param_spec->g_type = types[i];
+					values = g_slist_append (values, expr);
+
+					gval = i < row->len ? g_ptr_array_index (row, i) : NULL;
+					if (gval == NULL
+					    || G_VALUE_HOLDS (gval, GDA_TYPE_NULL))
+						{
+							gval = NULL;
+						}
+					else if (G_VALUE_TYPE (gval) == types[i])
+						{
+							gval = gda_value_copy (gval);
+						}
+					else
+						{
+							/* the parameters of a column share its type */
+							value = gval;
+							gval = gda_value_new (types[i]);
+							if (!g_value_transform (value, gval))
+								{
+									g_warning (_("Unable to convert a value of type «%s» to «%s»: stored as NULL."),
+									           g_type_name (G_VALUE_TYPE (value)), g_type_name (types[i]));
+									gda_value_free (gval);
+									gval = NULL;
+								}
+						}
+					g_hash_table_replace (priv->bound_values, param_name, gval);
+				}
+			insert->values_list = g_slist_append (insert->values_list, values);
+		}
+	g_free (types);
+
+	g_object_set (G_OBJECT (stmt), "structure", sqlst, NULL);
+	gda_sql_statement_free (sqlst);
+}
+
+/* the statement is built once and kept until the builder changes */
+static GdaStatement
+*gdaex_sql_builder_get_statement (GdaExSqlBuilder *sqlb)
+{
+	GError *error;
+
+	GdaExSqlBuilderPrivate *priv = GDAEX_SQLBUILDER_GET_PRIVATE (sqlb);
+
+	gdaex_sql_builder_check_exposed (sqlb);
+
+	if (priv->stmt == NULL)
+		{
+			error = NULL;
+			priv->stmt = gda_sql_builder_get_statement (priv->sqlb, &error);
+			if (priv->stmt == NULL)
+				{
+					g_warning ("Error on creating GdaStatement: %s.",
+							   error != NULL && error->message != NULL ? error->message : "no details");
+				}
+			else if (priv->rows->len > 0)
+				{
+					gdaex_sql_builder_add_rows_to_statement (priv, priv->stmt);
+				}
+		}
+
+	return priv->stmt;
+}
+
+static GdaExSqlBuilderUpsertStyle
+gdaex_sql_builder_get_upsert_style (GdaExSqlBuilderPrivate *priv, GdaConnection *cnc)
+{
+	const gchar *provider;
+
+	if (priv->upsert_keys == NULL)
+		{
+			return GDAEX_SQLBUILDER_UPSERT_NONE;
+		}
+
+	/* without a connection the standard-like syntax is shown */
+	if (cnc == NULL)
+		{
+			return GDAEX_SQLBUILDER_UPSERT_ON_CONFLICT;
+		}
+
+	provider = gda_connection_get_provider_name (cnc);
+	if (g_ascii_strcasecmp (provider, "SQLite") == 0
+	    || g_ascii_strcasecmp (provider, "SQLCipher") == 0
+	    || g_ascii_strcasecmp (provider, "PostgreSQL") == 0)
+		{
+			return GDAEX_SQLBUILDER_UPSERT_ON_CONFLICT;
+		}
+	else if (g_ascii_strcasecmp (provider, "MySQL") == 0)
+		{
+			return GDAEX_SQLBUILDER_UPSERT_ON_DUPLICATE_KEY;
+		}
+
+	return GDAEX_SQLBUILDER_UPSERT_UPDATE_INSERT;
+}
+
+static gboolean
+gdaex_sql_builder_is_upsert_key (GdaExSqlBuilderPrivate *priv, const gchar *field_name)
+{
+	guint i;
+
+	if (priv->upsert_keys != NULL)
+		{
+			for (i = 0; priv->upsert_keys[i] != NULL; i++)
+				{
+					if (g_strcmp0 (priv->upsert_keys[i], field_name) == 0)
+						{
+							return TRUE;
+						}
+				}
+		}
+
+	return FALSE;
+}
+
+static gchar
+*gdaex_sql_builder_value_to_sql (GdaConnection *cnc, const GValue *gval)
+{
+	GdaDataHandler *dh;
+	gchar *ret;
+
+	if (gval == NULL
+	    || G_VALUE_HOLDS (gval, GDA_TYPE_NULL))
+		{
+			return g_strdup ("NULL");
+		}
+
+	if (cnc != NULL)
+		{
+			dh = gda_server_provider_get_data_handler_g_type (gda_connection_get_provider (cnc), cnc, G_VALUE_TYPE (gval));
+		}
+	else
+		{
+			dh = gda_data_handler_get_default (G_VALUE_TYPE (gval));
+		}
+
+	ret = dh != NULL ? gda_data_handler_get_sql_from_value (dh, gval) : NULL;
+	if (ret == NULL)
+		{
+			g_warning (_("Unable to render a value of type «%s»."), g_type_name (G_VALUE_TYPE (gval)));
+			ret = g_strdup ("NULL");
+		}
+
+	return ret;
+}
+
+/* appends to a rendered INSERT the upsert clause */
+static void
+gdaex_sql_builder_render_upsert (GdaExSqlBuilderPrivate *priv, GdaConnection *cnc, GString *sql)
+{
+	guint i;
+	gchar *value;
+	const gchar *field_name;
+	gboolean first;
+
+	switch (gdaex_sql_builder_get_upsert_style (priv, cnc))
+		{
+			case GDAEX_SQLBUILDER_UPSERT_ON_CONFLICT:
+				value = g_strjoinv (", ", priv->upsert_keys);
+				g_string_append_printf (sql, " ON CONFLICT (%s) DO", value);
+				g_free (value);
+
+				first = TRUE;
+				for (i = 0; i < priv->insert_fields->len; i++)
+					{
+						field_name = g_ptr_array_index (priv->insert_fields, i);
+						if (gdaex_sql_builder_is_upsert_key (priv, field_name))
+							{
+								continue;
+							}
+						g_string_append_printf (sql, "%s%s = EXCLUDED.%s", first ? " UPDATE SET " : ", ", field_name, field_name);
+						first = FALSE;
+					}
+				if (first)
+					{
+						g_string_append (sql, " NOTHING");
+					}
+				break;
+
+			case GDAEX_SQLBUILDER_UPSERT_ON_DUPLICATE_KEY:
+				g_string_append (sql, " ON DUPLICATE KEY UPDATE ");
+
+				first = TRUE;
+				for (i = 0; i < priv->insert_fields->len; i++)
+					{
+						field_name = g_ptr_array_index (priv->insert_fields, i);
+						if (gdaex_sql_builder_is_upsert_key (priv, field_name))
+							{
+								continue;
+							}
+						g_string_append_printf (sql, "%s%s = VALUES(%s)", first ? "" : ", ", field_name, field_name);
+						first = FALSE;
+					}
+				if (first)
+					{
+						g_string_append_printf (sql, "%s = %s", priv->upsert_keys[0], priv->upsert_keys[0]);
+					}
+				break;
+
+			default:
+				break;
+		}
+}
+
+/* the builder's own parameters (IN lists) are merged with the caller's ones */
+static GdaSet
+*gdaex_sql_builder_bind_params (GdaExSqlBuilder *sqlb, GdaStatement *stmt, GdaSet *params)
+{
+	GHashTableIter iter;
+	gpointer key;
+	gpointer value;
+	GdaHolder *holder;
+	GSList *holders;
+
+	GdaExSqlBuilderPrivate *priv = GDAEX_SQLBUILDER_GET_PRIVATE (sqlb);
+
+	if (g_hash_table_size (priv->bound_values) == 0)
+		{
+			return params;
+		}
+
+	if (priv->bound_params == NULL)
+		{
+			if (!gda_statement_get_parameters (stmt, &priv->bound_params, NULL)
+			    || priv->bound_params == NULL)
+				{
+					return params;
+				}
+
+			g_hash_table_iter_init (&iter, priv->bound_values);
+			while (g_hash_table_iter_next (&iter, &key, &value))
+				{
+					holder = gda_set_get_holder (priv->bound_params, (const gchar *)key);
+					if (holder != NULL)
+						{
+							gda_holder_set_value (holder, (const GValue *)value, NULL);
+						}
+				}
+		}
+
+	if (params != NULL)
+		{
+			for (holders = params->holders; holders != NULL; holders = g_slist_next (holders))
+				{
+					/* only the values the caller really set */
+					if (!gda_holder_is_valid ((GdaHolder *)holders->data))
+						{
+							continue;
+						}
+					holder = gda_set_get_holder (priv->bound_params, gda_holder_get_id ((GdaHolder *)holders->data));
+					if (holder != NULL)
+						{
+							gda_holder_set_value (holder, gda_holder_get_value ((GdaHolder *)holders->data), NULL);
+						}
+				}
+		}
+
+	return priv->bound_params;
+}
+
+/* renders the sql once for @cnc and @params and keeps it until
+ * the builder or the values of @params change */
+static const gchar
+*gdaex_sql_builder_render (GdaExSqlBuilder *sqlb, GdaConnection *cnc, GdaSet *params)
+{
+	GError *error;
+	GdaStatement *stmt;
+
+	GdaExSqlBuilderPrivate *priv = GDAEX_SQLBUILDER_GET_PRIVATE (sqlb);
+
+	gdaex_sql_builder_check_exposed (sqlb);
+
+	if (priv->sql != NULL
+	    && priv->sql_cnc == cnc
+	    && priv->sql_params == params)
+		{
+			return priv->sql;
+		}
+
+	gdaex_sql_builder_invalidate_sql (sqlb);
+
+	stmt = gdaex_sql_builder_get_statement (sqlb);
+	if (stmt == NULL)
+		{
+			return NULL;
+		}
+
+	error = NULL;
+	priv->sql = gda_statement_to_sql_extended (stmt,
+											   cnc,
+											   gdaex_sql_builder_bind_params (sqlb, stmt, params),
+											   GDA_STATEMENT_SQL_PARAMS_AS_VALUES,
+											   NULL,
+											   &error);
+	if (priv->sql == NULL
+		|| error != NULL)
+		{
+			g_warning ("Error on creating sql statement: %s.",
+					   error != NULL && error->message != NULL ? error->message : "no details");
+			g_free (priv->sql);
+			priv->sql = NULL;
+			return NULL;
+		}
+
+	if (priv->upsert_keys != NULL)
+		{
+			GString *str;
+
+			str = g_string_new (priv->sql);
+			gdaex_sql_builder_render_upsert (priv, cnc, str);
+			g_free (priv->sql);
+			priv->sql = g_string_free (str, FALSE);
+		}
+
+	priv->sql_cnc = cnc;
+	if (params != NULL)
+		{
+			priv->sql_params = g_object_ref (params);
+			priv->sql_params_changed = g_signal_connect (params, "holder-changed",
+			                                             G_CALLBACK (gdaex_sql_builder_on_params_changed), sqlb);
+		}
+
+	gdaex_sql_builder_find_clauses (priv);
+
+	return priv->sql;
+}
+
+static gchar
+*gdaex_sql_builder_get_sql_clause (GdaExSqlBuilder *sqlb, GdaConnection *cnc, GdaSet *params, GdaExSqlBuilderClause clause)
+{
+	GdaExSqlBuilderPrivate *priv = GDAEX_SQLBUILDER_GET_PRIVATE (sqlb);
+
+	if (gdaex_sql_builder_render (sqlb, cnc, params) == NULL
+	    || priv->clauses_start[clause] < 0)
+		{
+			return NULL;
+		}
+
+	return g_strndup (priv->sql + priv->clauses_start[clause],
+	                  priv->clauses_end[clause] - priv->clauses_start[clause]);
+}
+
+/**
+ * gdaex_sql_builder_get_sql:
+ * @sqlb:
+ * @cnc:
+ * @params:
+ *
+ * The sql is rendered once and reused, also by the gdaex_sql_builder_get_sql_*
+ * functions, until @sqlb or the values of @params change.
+ *
+ * Returns:
+ */
+gchar
+*gdaex_sql_builder_get_sql (GdaExSqlBuilder *sqlb, GdaConnection *cnc, GdaSet *params)
+{
+	return g_strdup (gdaex_sql_builder_render (sqlb, cnc, params));
+}
+
+/**
+ * gdaex_sql_builder_get_sql_select:
+ * @sqlb:
+ * @cnc:
+ * @params:
+ *
+ */
+gchar
+*gdaex_sql_builder_get_sql_select (GdaExSqlBuilder *sqlb, GdaConnection *cnc, GdaSet *params)
+{
+	GdaExSqlBuilderPrivate *priv = GDAEX_SQLBUILDER_GET_PRIVATE (sqlb);
+
+	/* the select list ends where the FROM starts */
+	if (gdaex_sql_builder_render (sqlb, cnc, params) == NULL
+	    || priv->clauses_start[GDAEX_SQLBUILDER_CLAUSE_FROM] < 0)
+		{
+			return NULL;
+		}
+
+	return gdaex_sql_builder_get_sql_clause (sqlb, cnc, params, GDAEX_SQLBUILDER_CLAUSE_SELECT);
+}
+
+/**
+ * gdaex_sql_builder_get_sql_from:
+ * @sqlb:
+ * @cnc:
+ * @params:
+ *
+ */
+gchar
+*gdaex_sql_builder_get_sql_from (GdaExSqlBuilder *sqlb, GdaConnection *cnc, GdaSet *params)
+{
+	return gdaex_sql_builder_get_sql_clause (sqlb, cnc, params, GDAEX_SQLBUILDER_CLAUSE_FROM);
+}
+
+/**
+ * gdaex_sql_builder_get_sql_where:
+ * @sqlb:
+ * @cnc:
+ * @params:
+ *
+ */
+gchar
+*gdaex_sql_builder_get_sql_where (GdaExSqlBuilder *sqlb, GdaConnection *cnc, GdaSet *params)
+{
+	return gdaex_sql_builder_get_sql_clause (sqlb, cnc, params, GDAEX_SQLBUILDER_CLAUSE_WHERE);
+}
+
+/**
+ * gdaex_sql_builder_get_sql_group:
+ * @sqlb:
+ * @cnc:
+ * @params:
+ *
+ */
+gchar
+*gdaex_sql_builder_get_sql_group (GdaExSqlBuilder *sqlb, GdaConnection *cnc, GdaSet *params)
+{
+	return gdaex_sql_builder_get_sql_clause (sqlb, cnc, params, GDAEX_SQLBUILDER_CLAUSE_GROUP);
+}
+
+/**
+ * gdaex_sql_builder_get_sql_having:
+ * @sqlb:
+ * @cnc:
+ * @params:
+ *
+ */
+gchar
+*gdaex_sql_builder_get_sql_having (GdaExSqlBuilder *sqlb, GdaConnection *cnc, GdaSet *params)
+{
+	return gdaex_sql_builder_get_sql_clause (sqlb, cnc, params, GDAEX_SQLBUILDER_CLAUSE_HAVING);
+}
+
+/**
+ * gdaex_sql_builder_get_sql_order:
+ * @sqlb:
+ * @cnc:
+ * @params:
+ *
+ */
+gchar
+*gdaex_sql_builder_get_sql_order (GdaExSqlBuilder *sqlb, GdaConnection *cnc, GdaSet *params)
+{
+	return gdaex_sql_builder_get_sql_clause (sqlb, cnc, params, GDAEX_SQLBUILDER_CLAUSE_ORDER);
+}
+
+/* the statement to execute on @gdaex, with its tables prefix, shared by
+ * the execution and the templates. The upsert clause, that GdaSqlBuilder
+ * can't express, is appended to the sql rendered with the parameters as
+ * placeholders: the parser gives an unknown statement, that is executed as
+ * it is, the prefix being already applied */
+static GdaStatement
+*gdaex_sql_builder_prepare (GdaExSqlBuilder *sqlb, GdaEx *gdaex)
+{
+	GdaStatement *stmt;
+	GdaStatement *pstmt;
+	GdaConnection *cnc;
+	GString *sql;
+	gchar *str;
+	GError *error;
+
+	GdaExSqlBuilderPrivate *priv = GDAEX_SQLBUILDER_GET_PRIVATE (sqlb);
+
+	stmt = gdaex_sql_builder_get_statement (sqlb);
+	if (stmt == NULL)
+		{
+			return NULL;
+		}
+
+	/* a private copy, the builder can go on changing */
+	stmt = gda_statement_copy (stmt);
+	pstmt = gdaex_prepare_statement (gdaex, stmt);
+	g_object_unref (stmt);
+	if (pstmt == NULL
+	    || priv->upsert_keys == NULL)
+		{
+			return pstmt;
+		}
+
+	cnc = (GdaConnection *)gdaex_get_gdaconnection (gdaex);
+
+	error = NULL;
+	str = gda_statement_to_sql_extended (pstmt, cnc, NULL, GDA_STATEMENT_SQL_PARAMS_LONG, NULL, &error);
+	g_object_unref (pstmt);
+	if (str == NULL)
+		{
+			g_warning ("Error on creating sql statement: %s.",
+			           error != NULL && error->message != NULL ? error->message : "no details");
+			g_clear_error (&error);
+			return NULL;
+		}
+
+	sql = g_string_new (str);
+	g_free (str);
+	gdaex_sql_builder_render_upsert (priv, cnc, sql);
+
+	pstmt = gda_sql_parser_parse_string ((GdaSqlParser *)gdaex_get_sql_parser (gdaex), sql->str, NULL, &error);
+	if (pstmt == NULL)
+		{
+			g_warning (_("Unable to parse the statement: %s"),
+			           error != NULL && error->message != NULL ? error->message : _("no details"));
+			g_clear_error (&error);
+		}
+	g_string_free (sql, TRUE);
+
+	return pstmt;
+}
+
+/* the statement prepared on @gdaex is kept until the builder,
+ * the #GdaEx or its tables prefix change */
+static GdaStatement
+*gdaex_sql_builder_get_exec_statement (GdaExSqlBuilder *sqlb, GdaEx *gdaex)
+{
+	gchar *prefix;
+
+	GdaExSqlBuilderPrivate *priv = GDAEX_SQLBUILDER_GET_PRIVATE (sqlb);
+
+	gdaex_sql_builder_check_exposed (sqlb);
+
+	prefix = (gchar *)gdaex_get_tables_name_prefix (gdaex);
+
+	if (priv->exec_stmt != NULL
+	    && priv->exec_gdaex == gdaex
+	    && g_strcmp0 (priv->exec_prefix, prefix) == 0)
+		{
+			g_free (prefix);
+			return priv->exec_stmt;
+		}
+
+	if (priv->exec_stmt != NULL)
+		{
+			g_object_unref (priv->exec_stmt);
+			priv->exec_stmt = NULL;
+		}
+	g_free (priv->exec_prefix);
+	priv->exec_prefix = NULL;
+
+	priv->exec_stmt = gdaex_sql_builder_prepare (sqlb, gdaex);
+	if (priv->exec_stmt == NULL)
+		{
+			g_free (prefix);
+			return NULL;
+		}
+	priv->exec_gdaex = gdaex;
+	priv->exec_prefix = prefix;
+
+	return priv->exec_stmt;
+}
+
+/* the housekeeping of the temporary tables runs on the connection
+ * directly: it isn't an execution of the application, so it doesn't emit
+ * the before/after execute signals, nor takes the tables name prefix */
+static gint
+gdaex_sql_builder_execute_sql (GdaEx *gdaex, const gchar *sql)
+{
+	GError *error;
+	gint ret;
+
+	error = NULL;
+	ret = gda_connection_execute_non_select_command ((GdaConnection *)gdaex_get_gdaconnection (gdaex), sql, &error);
+	if (error != NULL)
+		{
+			g_warning (_("Error executing command query: %s\n%s"),
+			           error->message != NULL ? error->message : _("no details"), sql);
+			g_clear_error (&error);
+			return -1;
+		}
+
+	return ret;
+}
+
+/* loads the big IN lists into temporary tables of the session of @gdaex;
+ * to be called with the lock of @gdaex held until they are dropped */
+static gboolean
+gdaex_sql_builder_stage_in_lists (GdaExSqlBuilder *sqlb, GdaEx *gdaex)
+{
+	GdaExSqlBuilderInList *l;
+	GdaConnection *cnc;
+	const gchar *dbms_type;
+	GString *sql;
+	GValue gval = G_VALUE_INIT;
+	gchar *value;
+	gboolean ok;
+	guint i;
+	guint j;
+
+	GdaExSqlBuilderPrivate *priv = GDAEX_SQLBUILDER_GET_PRIVATE (sqlb);
+
+	cnc = (GdaConnection *)gdaex_get_gdaconnection (gdaex);
+	for (i = 0; i < priv->in_lists->len; i++)
+		{
+			l = g_ptr_array_index (priv->in_lists, i);
+
+			dbms_type = gda_server_provider_get_default_dbms_type (gda_connection_get_provider (cnc), cnc, l->gtype);
+
+			sql = g_string_new ("");
+			g_string_printf (sql, "CREATE TEMPORARY TABLE IF NOT EXISTS %s (k %s)", l->table_name, dbms_type != NULL ? dbms_type : "text");
+			ok = gdaex_sql_builder_execute_sql (gdaex, sql->str) >= 0;
+			if (ok)
+				{
+					g_string_printf (sql, "DELETE FROM %s", l->table_name);
+					ok = gdaex_sql_builder_execute_sql (gdaex, sql->str) >= 0;
+				}
+
+			for (j = 0; ok && j < l->keys->len; j++)
+				{
+					if (j % GDAEX_SQLBUILDER_IN_LIST_CHUNK == 0)
+						{
+							g_string_printf (sql, "INSERT INTO %s (k) VALUES ", l->table_name);
+						}
+					else
+						{
+							g_string_append (sql, ", ");
+						}
+
+					gdaex_sql_builder_in_list_get_value (l->keys, l->gtype, j, &gval);
+					value = gdaex_sql_builder_value_to_sql (cnc, &gval);
+					g_string_append_printf (sql, "(%s)", value);
+					g_free (value);
+					g_value_unset (&gval);
+
+					if ((j + 1) % GDAEX_SQLBUILDER_IN_LIST_CHUNK == 0
+					    || j + 1 == l->keys->len)
+						{
+							ok = gdaex_sql_builder_execute_sql (gdaex, sql->str) >= 0;
+						}
+				}
+			g_string_free (sql, TRUE);
+
+			if (!ok)
+				{
+					g_warning (_("Unable to load the keys into the temporary table «%s»."), l->table_name);
+					return FALSE;
+				}
+		}
+
+	return TRUE;
+}
+
+/* the temporary tables live only for an execution: nothing is left in the
+ * session, nor has to be remembered about it */
+static void
+gdaex_sql_builder_drop_in_lists (GdaExSqlBuilder *sqlb, GdaEx *gdaex)
+{
+	GdaExSqlBuilderInList *l;
+	gchar *sql;
+	guint i;
+
+	GdaExSqlBuilderPrivate *priv = GDAEX_SQLBUILDER_GET_PRIVATE (sqlb);
+
+	for (i = 0; i < priv->in_lists->len; i++)
+		{
+			l = g_ptr_array_index (priv->in_lists, i);
+
+			sql = g_strdup_printf ("DROP TABLE IF EXISTS %s", l->table_name);
+			gdaex_sql_builder_execute_sql (gdaex, sql);
+			g_free (sql);
+		}
+}
 
 /**
- * gdaex_sql_builder_get_sql:
+ * gdaex_sql_builder_query:
  * @sqlb:
- * @cnc:
- * @params:
+ * @gdaex:
+ * @params: the values for the parameters of the statement.
  *
- * Returns:
+ * The statement is executed directly with @params, without rendering it;
+ * it is prepared once and reused until @sqlb changes.
+ *
+ * Returns: a #GdaDataModel.
  */
-gchar
-*gdaex_sql_builder_get_sql (GdaExSqlBuilder *sqlb, GdaConnection *cnc, GdaSet *params)
+GdaDataModel
+*gdaex_sql_builder_query (GdaExSqlBuilder *sqlb, GdaEx *gdaex, GdaSet *params)
 {
-	gchar *ret;
-
-	GError *error;
 	GdaStatement *stmt;
+	GdaDataModel *dm;
+
+	g_return_val_if_fail (GDAEX_IS_SQLBUILDER (sqlb), NULL);
+	g_return_val_if_fail (IS_GDAEX (gdaex), NULL);
 
 	GdaExSqlBuilderPrivate *priv = GDAEX_SQLBUILDER_GET_PRIVATE (sqlb);
 
-	ret = NULL;
+	stmt = gdaex_sql_builder_get_exec_statement (sqlb, gdaex);
+	if (stmt == NULL)
+		{
+			return NULL;
+		}
 
-	error = NULL;
-	stmt = gda_sql_builder_get_statement (priv->sqlb, &error);
-	if (stmt != NULL)
+	/* no other thread can use the session between the staging of the IN
+	 * lists and their drop */
+	gdaex_lock (gdaex);
+	dm = NULL;
+	if (gdaex_sql_builder_stage_in_lists (sqlb, gdaex))
 		{
-			error = NULL;
-			ret = gda_statement_to_sql_extended (stmt,
-												 cnc,
-												 params,
-												 GDA_STATEMENT_SQL_PARAMS_AS_VALUES,
-												 NULL,
-												 &error);
-			if (ret == NULL
-				|| error != NULL)
-				{
-					g_warning ("Error on creating sql statement: %s.",
-							   error != NULL && error->message != NULL ? error->message : "no details");
+			dm = gdaex_query_statement (gdaex, stmt, gdaex_sql_builder_bind_params (sqlb, stmt, params));
+			if (dm != NULL
+			    && priv->in_lists->len > 0)
+				{
+					/* every row is read before the tables go */
+					gda_data_model_get_n_rows (dm);
 				}
 		}
-	else
+	gdaex_sql_builder_drop_in_lists (sqlb, gdaex);
+	gdaex_unlock (gdaex);
+
+	return dm;
+}
+
+static gint
+gdaex_sql_builder_execute_statement_from_builder (GdaEx *gdaex, GdaSqlBuilder *b, GdaSet *params)
+{
+	GError *error;
+	GdaStatement *stmt;
+	GdaStatement *pstmt;
+	gint ret;
+
+	error = NULL;
+	stmt = gda_sql_builder_get_statement (b, &error);
+	if (stmt == NULL)
 		{
 			g_warning ("Error on creating GdaStatement: %s.",
 					   error != NULL && error->message != NULL ? error->message : "no details");
+			g_clear_error (&error);
+			return -1;
 		}
 
+	pstmt = gdaex_prepare_statement (gdaex, stmt);
+	ret = gdaex_execute_statement (gdaex, pstmt, params);
+	g_object_unref (pstmt);
+	g_object_unref (stmt);
+
 	return ret;
 }
 
-/**
- * gdaex_sql_builder_get_sql_select:
- * @sqlb:
- * @cnc:
- * @params:
- *
- */
-gchar
-*gdaex_sql_builder_get_sql_select (GdaExSqlBuilder *sqlb, GdaConnection *cnc, GdaSet *params)
+/* the value of the field @i of a row of the fallback upsert: the
+ * parameters of the first row are taken from @params */
+static const GValue
+*gdaex_sql_builder_update_insert_get_value (GdaExSqlBuilderPrivate *priv, GPtrArray *row, guint i, GdaSet *params)
 {
-	gchar *ret;
-	gchar *sql;
+	const gchar *param_name;
 
-	gchar *start;
-	gchar *end;
-
-	ret = NULL;
+	if (i < row->len
+	    && g_ptr_array_index (row, i) != NULL)
+		{
+			return g_ptr_array_index (row, i);
+		}
 
-	sql = gdaex_sql_builder_get_sql (sqlb, cnc, params);
-	if (sql == NULL)
+	param_name = (row == priv->insert_values ? g_ptr_array_index (priv->insert_params, i) : NULL);
+	if (param_name != NULL
+	    && params != NULL)
 		{
-			return ret;
+			return gda_set_get_holder_value (params, param_name);
 		}
 
-	start = g_strstr_len (sql, -1, "SELECT");
-	if (start == NULL)
+	return NULL;
+}
+
+/* upsert for providers without a native syntax: an UPDATE and,
+ * if it doesn't touch any record, an INSERT for every row */
+static gint
+gdaex_sql_builder_update_insert_rows (GdaExSqlBuilder *sqlb, GdaEx *gdaex, GdaSet *params)
+{
+	GdaSqlBuilder *b;
+	GdaSqlBuilderId id_where;
+	GdaSqlBuilderId id_cond;
+	GPtrArray *row;
+	const gchar *field_name;
+	const GValue *gval;
+	gboolean has_values;
+	gint r;
+	guint i;
+	gint nrecs;
+	gint ret;
+
+	GdaExSqlBuilderPrivate *priv = GDAEX_SQLBUILDER_GET_PRIVATE (sqlb);
+
+	ret = 0;
+	for (r = -1; r < (gint)priv->rows->len; r++)
 		{
-			return ret;
+			row = r < 0 ? priv->insert_values : g_ptr_array_index (priv->rows, r);
+
+			/* when every field is a key, the keys are updated to themselves
+			 * to know whether the record exists */
+			has_values = FALSE;
+			for (i = 0; i < priv->insert_fields->len; i++)
+				{
+					if (!gdaex_sql_builder_is_upsert_key (priv, g_ptr_array_index (priv->insert_fields, i)))
+						{
+							has_values = TRUE;
+							break;
+						}
+				}
+
+			b = gda_sql_builder_new (GDA_SQL_STATEMENT_UPDATE);
+			gda_sql_builder_set_table (b, priv->target_table);
+			id_where = 0;
+			for (i = 0; i < priv->insert_fields->len; i++)
+				{
+					field_name = g_ptr_array_index (priv->insert_fields, i);
+					gval = gdaex_sql_builder_update_insert_get_value (priv, row, i, params);
+					if (gdaex_sql_builder_is_upsert_key (priv, field_name))
+						{
+							if (gval == NULL
+							    || G_VALUE_HOLDS (gval, GDA_TYPE_NULL))
+								{
+									id_cond = gda_sql_builder_add_cond (b, GDA_SQL_OPERATOR_TYPE_ISNULL,
+									                                    gda_sql_builder_add_id (b, field_name), 0, 0);
+								}
+							else
+								{
+									id_cond = gda_sql_builder_add_cond (b, GDA_SQL_OPERATOR_TYPE_EQ,
+									                                    gda_sql_builder_add_id (b, field_name),
+									                                    gda_sql_builder_add_expr_value (b, NULL, gval), 0);
+								}
+							id_where = id_where != 0 ? gda_sql_builder_add_cond (b, GDA_SQL_OPERATOR_TYPE_AND, id_where, id_cond, 0) : id_cond;
+							if (has_values)
+								{
+									continue;
+								}
+						}
+					gda_sql_builder_add_field_value_as_gvalue (b, field_name, gval);
+				}
+			if (id_where != 0)
+				{
+					gda_sql_builder_set_where (b, id_where);
+				}
+			nrecs = gdaex_sql_builder_execute_statement_from_builder (gdaex, b, NULL);
+			g_object_unref (b);
+
+			if (nrecs == 0)
+				{
+					b = gda_sql_builder_new (GDA_SQL_STATEMENT_INSERT);
+					gda_sql_builder_set_table (b, priv->target_table);
+					for (i = 0; i < priv->insert_fields->len; i++)
+						{
+							gda_sql_builder_add_field_value_as_gvalue (b, g_ptr_array_index (priv->insert_fields, i),
+							                                           gdaex_sql_builder_update_insert_get_value (priv, row, i, params));
+						}
+					nrecs = gdaex_sql_builder_execute_statement_from_builder (gdaex, b, NULL);
+					g_object_unref (b);
+				}
+
+			if (nrecs < 0)
+				{
+					return -1;
+				}
+			ret += nrecs;
 		}
 
-	end = g_strstr_len (sql, -1, "FROM");
-	if (end == NULL)
+	return ret;
+}
+
+/* the UPDATEs and the INSERTs are a single unit: no other thread can use
+ * the session in between and, out of a caller's transaction, they run
+ * in their own one */
+static gint
+gdaex_sql_builder_execute_update_insert (GdaExSqlBuilder *sqlb, GdaEx *gdaex, GdaSet *params)
+{
+	GdaConnection *cnc;
+	GError *error;
+	gboolean own;
+	gint ret;
+
+	cnc = (GdaConnection *)gdaex_get_gdaconnection (gdaex);
+
+	gdaex_lock (gdaex);
+
+	own = (gda_connection_get_transaction_status (cnc) == NULL);
+	if (own)
 		{
-			return ret;
+			error = NULL;
+			if (!gda_connection_supports_feature (cnc, GDA_CONNECTION_FEATURE_TRANSACTIONS)
+			    || !gda_connection_begin_transaction (cnc, "gdaex_upsert",
+			                                          GDA_TRANSACTION_ISOLATION_SERIALIZABLE,
+			                                          &error))
+				{
+					g_warning (_("The upsert on this provider needs a transaction, that can't be opened: %s"),
+					           error != NULL && error->message != NULL ? error->message : _("no details"));
+					g_clear_error (&error);
+					gdaex_unlock (gdaex);
+					return -1;
+				}
 		}
 
-	ret = g_strndup (start + 7, strlen (sql) - 8 - strlen (end));
+	ret = gdaex_sql_builder_update_insert_rows (sqlb, gdaex, params);
+
+	if (own)
+		{
+			error = NULL;
+			if (ret < 0)
+				{
+					gda_connection_rollback_transaction (cnc, "gdaex_upsert", NULL);
+				}
+			else if (!gda_connection_commit_transaction (cnc, "gdaex_upsert", &error))
+				{
+					g_warning (_("Error committing transaction: %s"),
+					           error != NULL && error->message != NULL ? error->message : _("no details"));
+					g_clear_error (&error);
+					gda_connection_rollback_transaction (cnc, "gdaex_upsert", NULL);
+					ret = -1;
+				}
+		}
 
-	g_free (sql);
+	gdaex_unlock (gdaex);
 
 	return ret;
 }
 
 /**
- * gdaex_sql_builder_get_sql_from:
+ * gdaex_sql_builder_execute:
  * @sqlb:
- * @cnc:
- * @params:
+ * @gdaex:
+ * @params: the values for the parameters of the statement.
  *
+ * The statement is executed directly with @params, without rendering it;
+ * it is prepared once and reused until @sqlb changes.
+ *
+ * Returns: number of records affected by the execution.
  */
-gchar
-*gdaex_sql_builder_get_sql_from (GdaExSqlBuilder *sqlb, GdaConnection *cnc, GdaSet *params)
+gint
+gdaex_sql_builder_execute  (GdaExSqlBuilder *sqlb, GdaEx *gdaex, GdaSet *params)
 {
-	gchar *ret;
-	gchar *sql;
+	GdaStatement *stmt;
+	gint ret;
 
-	gchar *start;
-	gchar *end;
+	g_return_val_if_fail (GDAEX_IS_SQLBUILDER (sqlb), -1);
+	g_return_val_if_fail (IS_GDAEX (gdaex), -1);
 
-	ret = NULL;
+	GdaExSqlBuilderPrivate *priv = GDAEX_SQLBUILDER_GET_PRIVATE (sqlb);
 
-	sql = gdaex_sql_builder_get_sql (sqlb, cnc, params);
-	if (sql == NULL)
+	if (gdaex_sql_builder_get_upsert_style (priv, (GdaConnection *)gdaex_get_gdaconnection (gdaex)) == GDAEX_SQLBUILDER_UPSERT_UPDATE_INSERT)
 		{
-			return ret;
+			return gdaex_sql_builder_execute_update_insert (sqlb, gdaex, params);
 		}
 
-	start = g_strstr_len (sql, -1, "FROM");
-	if (start == NULL)
+	stmt = gdaex_sql_builder_get_exec_statement (sqlb, gdaex);
+	if (stmt == NULL)
 		{
-			return ret;
+			return -1;
 		}
 
-	end = g_strstr_len (sql, -1, "WHERE");
-	if (end == NULL)
+	gdaex_lock (gdaex);
+	ret = -1;
+	if (gdaex_sql_builder_stage_in_lists (sqlb, gdaex))
 		{
-			end = g_strstr_len (sql, -1, "ORDER BY");
+			ret = gdaex_execute_statement (gdaex, stmt, gdaex_sql_builder_bind_params (sqlb, stmt, params));
 		}
-
-	ret = g_strndup (start + 5, strlen (start) - (end != NULL ? 6 : 5) - (end != NULL ? strlen (end) : 0));
-
-	g_free (sql);
+	gdaex_sql_builder_drop_in_lists (sqlb, gdaex);
+	gdaex_unlock (gdaex);
 
 	return ret;
 }
 
+struct _GdaExSqlTemplate
+{
+	volatile gint ref_count;
+
+	GdaEx *gdaex;
+	GdaStatement *stmt;
+	GdaSet *params;
+};
+
 /**
- * gdaex_sql_builder_get_sql_where:
+ * gdaex_sql_builder_compile:
  * @sqlb:
- * @cnc:
- * @params:
+ * @gdaex:
+ *
+ * Turns @sqlb into an immutable template prepared on @gdaex (with its tables
+ * prefix). The template doesn't depend on @sqlb anymore and can be shared
+ * between threads: each caller binds its own #GdaSet, obtained with
+ * gdaex_sql_template_new_params(), for every execution.
  *
+ * A builder with IN lists staged into temporary tables (see
+ * gdaex_sql_builder_where_in()) can't be compiled: the template would refer
+ * to tables that exist only during gdaex_sql_builder_query() and
+ * gdaex_sql_builder_execute().
+ *
+ * Returns: a new #GdaExSqlTemplate, or #NULL on error.
  */
-gchar
-*gdaex_sql_builder_get_sql_where (GdaExSqlBuilder *sqlb, GdaConnection *cnc, GdaSet *params)
+GdaExSqlTemplate
+*gdaex_sql_builder_compile (GdaExSqlBuilder *sqlb, GdaEx *gdaex)
 {
-	gchar *ret;
-	gchar *sql;
+	GdaExSqlTemplate *tmpl;
+	GdaStatement *stmt;
+	GError *error;
+	GSList *holders;
+	GdaHolder *holder;
 
-	gchar *start;
-	gchar *end;
+	g_return_val_if_fail (GDAEX_IS_SQLBUILDER (sqlb), NULL);
+	g_return_val_if_fail (IS_GDAEX (gdaex), NULL);
 
-	ret = NULL;
+	GdaExSqlBuilderPrivate *priv = GDAEX_SQLBUILDER_GET_PRIVATE (sqlb);
 
-	sql = gdaex_sql_builder_get_sql (sqlb, cnc, params);
-	if (sql == NULL)
+	if (gdaex_sql_builder_get_upsert_style (priv, (GdaConnection *)gdaex_get_gdaconnection (gdaex)) == GDAEX_SQLBUILDER_UPSERT_UPDATE_INSERT)
+		{
+			g_warning (_("The upsert on this provider is not a single statement: it can't be compiled."));
+			return NULL;
+		}
+	if (priv->in_lists->len > 0)
 		{
-			return ret;
+			g_warning (_("IN lists staged into temporary tables can't be compiled."));
+			return NULL;
 		}
 
-	start = g_strstr_len (sql, -1, "WHERE");
-	if (start == NULL)
+	/* the same statement executed by gdaex_sql_builder_execute() */
+	stmt = gdaex_sql_builder_prepare (sqlb, gdaex);
+	if (stmt == NULL)
 		{
-			return ret;
+			return NULL;
 		}
 
-	end = g_strstr_len (sql, -1, "ORDER BY");
+	tmpl = g_new0 (GdaExSqlTemplate, 1);
+	tmpl->ref_count = 1;
+	tmpl->gdaex = g_object_ref (gdaex);
+	tmpl->stmt = stmt;
 
-	ret = g_strndup (start + 6, strlen (start) - (end != NULL ? 7 : 6) - (end != NULL ? strlen (end) : 0));
+	error = NULL;
+	if (!gda_statement_get_parameters (tmpl->stmt, &tmpl->params, &error))
+		{
+			g_warning (_("Unable to get the parameters of the statement: %s"),
+			           error != NULL && error->message != NULL ? error->message : _("no details"));
+			gdaex_sql_template_unref (tmpl);
+			return NULL;
+		}
 
-	g_free (sql);
+	/* the values of the IN lists become the defaults of every execution */
+	if (tmpl->params != NULL)
+		{
+			gdaex_sql_builder_bind_params (sqlb, tmpl->stmt, NULL);
+			if (priv->bound_params != NULL)
+				{
+					for (holders = priv->bound_params->holders; holders != NULL; holders = g_slist_next (holders))
+						{
+							holder = gda_set_get_holder (tmpl->params, gda_holder_get_id ((GdaHolder *)holders->data));
+							if (holder != NULL)
+								{
+									gda_holder_set_value (holder, gda_holder_get_value ((GdaHolder *)holders->data), NULL);
+								}
+						}
+				}
+		}
 
-	return ret;
+	return tmpl;
 }
 
 /**
- * gdaex_sql_builder_get_sql_order:
- * @sqlb:
- * @cnc:
- * @params:
+ * gdaex_sql_template_ref:
+ * @tmpl:
  *
+ * Returns: @tmpl.
  */
-gchar
-*gdaex_sql_builder_get_sql_order (GdaExSqlBuilder *sqlb, GdaConnection *cnc, GdaSet *params)
+GdaExSqlTemplate
+*gdaex_sql_template_ref (GdaExSqlTemplate *tmpl)
 {
-	gchar *ret;
-	gchar *sql;
+	g_return_val_if_fail (tmpl != NULL, NULL);
+
+	g_atomic_int_inc (&tmpl->ref_count);
 
-	gchar *start;
+	return tmpl;
+}
 
-	ret = NULL;
+/**
+ * gdaex_sql_template_unref:
+ * @tmpl:
+ *
+ */
+void
+gdaex_sql_template_unref (GdaExSqlTemplate *tmpl)
+{
+	g_return_if_fail (tmpl != NULL);
 
-	sql = gdaex_sql_builder_get_sql (sqlb, cnc, params);
-	if (sql == NULL)
+	if (g_atomic_int_dec_and_test (&tmpl->ref_count))
 		{
-			return ret;
+			if (tmpl->params != NULL)
+				{
+					g_object_unref (tmpl->params);
+				}
+			g_object_unref (tmpl->stmt);
+			g_object_unref (tmpl->gdaex);
+			g_free (tmpl);
 		}
+}
+
+/**
+ * gdaex_sql_template_new_params:
+ * @tmpl:
+ *
+ * Returns: a new #GdaSet with a holder for every parameter of @tmpl,
+ * or #NULL if @tmpl doesn't have parameters.
+ */
+GdaSet
+*gdaex_sql_template_new_params (GdaExSqlTemplate *tmpl)
+{
+	g_return_val_if_fail (tmpl != NULL, NULL);
+
+	return tmpl->params != NULL ? gda_set_copy (tmpl->params) : NULL;
+}
+
+static gboolean
+gdaex_sql_template_bind_valist (GdaSet *params, va_list ap)
+{
+	gchar *param_name;
+	GValue *gval;
+	GdaHolder *holder;
+	GError *error;
 
-	start = g_strstr_len (sql, -1, "ORDER BY");
-	if (start == NULL)
+	while ((param_name = va_arg (ap, gchar *)) != NULL)
 		{
-			return ret;
-		}
+			gval = va_arg (ap, GValue *);
 
-	ret = g_strndup (start + 9, strlen (start) - 9);
+			holder = gda_set_get_holder (params, param_name);
+			if (holder == NULL)
+				{
+					g_warning (_("No parameter named «%s»."), param_name);
+					return FALSE;
+				}
 
-	g_free (sql);
+			error = NULL;
+			if (!gda_holder_set_value (holder, gval, &error))
+				{
+					g_warning (_("Unable to set the value of the parameter «%s»: %s"),
+					           param_name,
+					           error != NULL && error->message != NULL ? error->message : _("no details"));
+					g_clear_error (&error);
+					return FALSE;
+				}
+		}
 
-	return ret;
+	return TRUE;
 }
 
 /**
- * gdaex_sql_builder_query:
- * @sqlb:
- * @gdaex:
+ * gdaex_sql_template_query:
+ * @tmpl:
+ * @params: (allow-none): a #GdaSet returned by gdaex_sql_template_new_params().
+ * @...: a #NULL terminated list of couples param_name - #GValue to bind into @params.
  *
- * Returns: a #GdaDataModel.
+ * Returns: a #GdaDataModel, or #NULL if query fails.
  */
 GdaDataModel
-*gdaex_sql_builder_query (GdaExSqlBuilder *sqlb, GdaEx *gdaex, GdaSet *params)
+*gdaex_sql_template_query (GdaExSqlTemplate *tmpl, GdaSet *params, ...)
 {
-	gchar *sql;
-	GdaDataModel *dm;
-
-	g_return_val_if_fail (IS_GDAEX (gdaex), NULL);
+	va_list ap;
+	gboolean ok;
 
-	sql = gdaex_sql_builder_get_sql (sqlb, (GdaConnection *)gdaex_get_gdaconnection (gdaex), params);
+	g_return_val_if_fail (tmpl != NULL, NULL);
 
-	dm = gdaex_query (gdaex, sql);
-	g_free (sql);
+	if (params != NULL)
+		{
+			va_start (ap, params);
+			ok = gdaex_sql_template_bind_valist (params, ap);
+			va_end (ap);
+			if (!ok)
+				{
+					return NULL;
+				}
+		}
 
-	return dm;
+	return gdaex_query_statement (tmpl->gdaex, tmpl->stmt, params);
 }
 
+/**
+ * gdaex_sql_template_execute:
+ * @tmpl:
+ * @params: (allow-none): a #GdaSet returned by gdaex_sql_template_new_params().
+ * @...: a #NULL terminated list of couples param_name - #GValue to bind into @params.
+ *
+ * Returns: number of records affected by the execution.
+ */
 gint
-gdaex_sql_builder_execute  (GdaExSqlBuilder *sqlb, GdaEx *gdaex, GdaSet *params)
+gdaex_sql_template_execute (GdaExSqlTemplate *tmpl, GdaSet *params, ...)
 {
-	gchar *sql;
-	gint ret;
-
-	g_return_val_if_fail (IS_GDAEX (gdaex), -1);
+	va_list ap;
+	gboolean ok;
 
-	sql = gdaex_sql_builder_get_sql (sqlb, (GdaConnection *)gdaex_get_gdaconnection (gdaex), params);
+	g_return_val_if_fail (tmpl != NULL, -1);
 
-	ret = gdaex_execute (gdaex, sql);
-	g_free (sql);
+	if (params != NULL)
+		{
+			va_start (ap, params);
+			ok = gdaex_sql_template_bind_valist (params, ap);
+			va_end (ap);
+			if (!ok)
+				{
+					return -1;
+				}
+		}
 
-	return ret;
+	return gdaex_execute_statement (tmpl->gdaex, tmpl->stmt, params);
 }
 
 /* PRIVATE */
+static void
+gdaex_sql_builder_finalize (GObject *object)
+{
+	GdaExSqlBuilder *gdaex_sql_builder = GDAEX_SQLBUILDER (object);
+	GdaExSqlBuilderPrivate *priv = GDAEX_SQLBUILDER_GET_PRIVATE (gdaex_sql_builder);
+
+	gdaex_sql_builder_changed (gdaex_sql_builder);
+
+	if (priv->sqlb != NULL)
+		{
+			g_object_unref (priv->sqlb);
+			priv->sqlb = NULL;
+		}
+
+	g_free (priv->target_table);
+	g_ptr_array_unref (priv->insert_fields);
+	g_ptr_array_unref (priv->insert_values);
+	g_ptr_array_unref (priv->insert_params);
+	g_ptr_array_unref (priv->rows);
+	g_strfreev (priv->upsert_keys);
+	g_ptr_array_unref (priv->order_fields);
+	g_hash_table_destroy (priv->bound_values);
+	g_ptr_array_unref (priv->in_lists);
+	g_free (priv->fingerprint);
+
+	G_OBJECT_CLASS (gdaex_sql_builder_parent_class)->finalize (object);
+}
+
 static void
 gdaex_sql_builder_set_property (GObject *object, guint property_id, const GValue *value, GParamSpec *pspec)
 {
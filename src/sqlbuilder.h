@@ -55,6 +55,15 @@ struct _GdaExSqlBuilderClass
 
 GType gdaex_sql_builder_get_type (void) G_GNUC_CONST;
 
+typedef enum
+	{
+		GDAEX_SQLBUILDER_AGGREGATE_COUNT,
+		GDAEX_SQLBUILDER_AGGREGATE_SUM,
+		GDAEX_SQLBUILDER_AGGREGATE_MIN,
+		GDAEX_SQLBUILDER_AGGREGATE_MAX,
+		GDAEX_SQLBUILDER_AGGREGATE_AVG
+	} GdaExSqlBuilderAggregate;
+
 
 GdaExSqlBuilder *gdaex_sql_builder_new (GdaSqlStatementType stmt_type);
 
@@ -67,22 +76,60 @@ void gdaex_sql_builder_join (GdaExSqlBuilder *sqlb,
 
 void gdaex_sql_builder_field (GdaExSqlBuilder *sqlb, const gchar *table_name, const gchar *field_name, const gchar *field_alias, GValue *gval);
 void gdaex_sql_builder_fields (GdaExSqlBuilder *sqlb, ...);
+void gdaex_sql_builder_add_row (GdaExSqlBuilder *sqlb, ...);
+void gdaex_sql_builder_upsert (GdaExSqlBuilder *sqlb, ...);
+
+void gdaex_sql_builder_field_param (GdaExSqlBuilder *sqlb, const gchar *table_name, const gchar *field_name, const gchar *field_alias, const gchar *param_name, GType gtype);
 
 GdaSqlBuilderId gdaex_sql_builder_where (GdaExSqlBuilder *sqlb, GdaSqlOperatorType op,
 										 ...);
+void gdaex_sql_builder_set_in_list_threshold (GdaExSqlBuilder *sqlb, guint threshold);
+GdaSqlBuilderId gdaex_sql_builder_where_in (GdaExSqlBuilder *sqlb, GdaSqlOperatorType op,
+                                            const gchar *table_name, const gchar *field_name, const gchar *field_alias,
+                                            GType gtype, GArray *keys);
+GdaSqlBuilderId gdaex_sql_builder_where_param (GdaExSqlBuilder *sqlb, GdaSqlOperatorType op,
+                                               const gchar *table_name, const gchar *field_name, const gchar *field_alias,
+                                               GdaSqlOperatorType op_expr,
+                                               const gchar *param_name, GType gtype);
 
 void gdaex_sql_builder_order (GdaExSqlBuilder *sqlb, ...);
 
+void gdaex_sql_builder_aggregate (GdaExSqlBuilder *sqlb, GdaExSqlBuilderAggregate aggregate,
+                                  const gchar *table_name, const gchar *field_name, const gchar *alias);
+void gdaex_sql_builder_group (GdaExSqlBuilder *sqlb, ...);
+GdaSqlBuilderId gdaex_sql_builder_having (GdaExSqlBuilder *sqlb, GdaSqlOperatorType op,
+                                          GdaExSqlBuilderAggregate aggregate, const gchar *table_name, const gchar *field_name,
+                                          GdaSqlOperatorType op_expr, GValue *gval);
+
+void gdaex_sql_builder_limit (GdaExSqlBuilder *sqlb, gint limit, gint offset);
+void gdaex_sql_builder_limit_params (GdaExSqlBuilder *sqlb, const gchar *limit_param, const gchar *offset_param);
+GdaSet *gdaex_sql_builder_keyset (GdaExSqlBuilder *sqlb, GdaDataModel *dm, gint row);
+void gdaex_sql_builder_keyset_reset (GdaExSqlBuilder *sqlb);
+
 GdaSqlBuilder *gdaex_sql_builder_get_gda_sql_builder (GdaExSqlBuilder *sqlb);
 gchar *gdaex_sql_builder_get_sql (GdaExSqlBuilder *sqlb, GdaConnection *cnc, GdaSet *params);
 gchar *gdaex_sql_builder_get_sql_select (GdaExSqlBuilder *sqlb, GdaConnection *cnc, GdaSet *params);
 gchar *gdaex_sql_builder_get_sql_from (GdaExSqlBuilder *sqlb, GdaConnection *cnc, GdaSet *params);
 gchar *gdaex_sql_builder_get_sql_where (GdaExSqlBuilder *sqlb, GdaConnection *cnc, GdaSet *params);
+gchar *gdaex_sql_builder_get_sql_group (GdaExSqlBuilder *sqlb, GdaConnection *cnc, GdaSet *params);
+gchar *gdaex_sql_builder_get_sql_having (GdaExSqlBuilder *sqlb, GdaConnection *cnc, GdaSet *params);
 gchar *gdaex_sql_builder_get_sql_order (GdaExSqlBuilder *sqlb, GdaConnection *cnc, GdaSet *params);
 
 GdaDataModel *gdaex_sql_builder_query (GdaExSqlBuilder *sqlb, GdaEx *gdaex, GdaSet *params);
 gint gdaex_sql_builder_execute  (GdaExSqlBuilder *sqlb, GdaEx *gdaex, GdaSet *params);
 
+typedef struct _GdaExSqlTemplate GdaExSqlTemplate;
+
+GdaExSqlTemplate *gdaex_sql_builder_compile (GdaExSqlBuilder *sqlb, GdaEx *gdaex);
+
+GdaExSqlTemplate *gdaex_sql_template_ref (GdaExSqlTemplate *tmpl);
+void gdaex_sql_template_unref (GdaExSqlTemplate *tmpl);
+
+GdaSet *gdaex_sql_template_new_params (GdaExSqlTemplate *tmpl);
+
+GdaDataModel *gdaex_sql_template_query (GdaExSqlTemplate *tmpl, GdaSet *params, ...);
+gint gdaex_sql_template_execute (GdaExSqlTemplate *tmpl, GdaSet *params, ...);
+
 
 G_END_DECLS
 
@@ -0,0 +1,188 @@
+/*
+ * Copyright (C) 2016 Andrea Zagli <azagli@libero.it>
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+
+#include <libgdaex.h>
+
+static void
+set_value (GdaDataModel *dm, gint col, gint row, GValue *gval)
+{
+	GError *error;
+
+	error = NULL;
+	if (!gda_data_model_set_value_at (dm, col, row, gval, &error))
+		{
+			g_error ("Unable to fill the source model: %s.",
+			         error != NULL && error->message != NULL ? error->message : "no details");
+		}
+	gda_value_free (gval);
+}
+
+static GValue
+*new_date (GDate *date)
+{
+	GValue *gval;
+
+	gval = g_new0 (GValue, 1);
+	g_value_init (gval, G_TYPE_DATE);
+	g_value_take_boxed (gval, date);
+
+	return gval;
+}
+
+static GdaDataModel
+*source_model (void)
+{
+	GdaDataModel *dm;
+	gint row;
+
+	dm = gda_data_model_array_new_with_g_types (3, G_TYPE_INT, G_TYPE_DATE, G_TYPE_STRING);
+
+	/* 1, 2016-03-01, "a" */
+	row = gda_data_model_append_row (dm, NULL);
+	set_value (dm, 0, row, gda_value_new_from_string ("1", G_TYPE_INT));
+	set_value (dm, 1, row, new_date (g_date_new_dmy (1, G_DATE_MARCH, 2016)));
+	set_value (dm, 2, row, gda_value_new_from_string ("a", G_TYPE_STRING));
+
+	/* NULL, invalid date, "b" */
+	row = gda_data_model_append_row (dm, NULL);
+	set_value (dm, 0, row, gda_value_new_null ());
+	set_value (dm, 1, row, new_date (g_date_new ()));
+	set_value (dm, 2, row, gda_value_new_from_string ("b", G_TYPE_STRING));
+
+	/* 3, NULL, "a" */
+	row = gda_data_model_append_row (dm, NULL);
+	set_value (dm, 0, row, gda_value_new_from_string ("3", G_TYPE_INT));
+	set_value (dm, 1, row, gda_value_new_null ());
+	set_value (dm, 2, row, gda_value_new_from_string ("a", G_TYPE_STRING));
+
+	return dm;
+}
+
+static const GValue
+*get_value (GdaDataModel *dm, gint col, gint row)
+{
+	const GValue *gval;
+	GError *error;
+
+	error = NULL;
+	gval = gda_data_model_get_value_at (dm, col, row, &error);
+	if (gval == NULL)
+		{
+			g_error ("Unable to read the value at %d, %d: %s.", col, row,
+			         error != NULL && error->message != NULL ? error->message : "no details");
+		}
+
+	return gval;
+}
+
+static void
+check_null (GdaDataModel *dm, gint col, gint row)
+{
+	if (!gda_value_is_null (get_value (dm, col, row)))
+		{
+			g_error ("Value at %d, %d should be NULL.", col, row);
+		}
+}
+
+static void
+check_model (gboolean dictionary)
+{
+	GdaDataModel *src;
+	GdaDataModel *dm;
+	const GValue *gval;
+	const gchar *str0;
+	const gchar *str2;
+
+	src = source_model ();
+	dm = gdaex_compact_model_new_from_model (src, dictionary);
+	if (dm == NULL)
+		{
+			g_error ("Unable to create the compact model.");
+		}
+
+	if (gda_data_model_get_n_rows (dm) != 3
+	    || gda_data_model_get_n_columns (dm) != 3)
+		{
+			g_error ("Wrong compact model size: %d rows, %d columns.",
+			         gda_data_model_get_n_rows (dm), gda_data_model_get_n_columns (dm));
+		}
+
+	/* integer column, with a NULL */
+	gval = get_value (dm, 0, 0);
+	if (G_VALUE_TYPE (gval) != G_TYPE_INT
+	    || g_value_get_int (gval) != 1)
+		{
+			g_error ("Wrong integer at 0, 0.");
+		}
+	check_null (dm, 0, 1);
+	gval = get_value (dm, 0, 2);
+	if (G_VALUE_TYPE (gval) != G_TYPE_INT
+	    || g_value_get_int (gval) != 3)
+		{
+			g_error ("Wrong integer at 0, 2.");
+		}
+
+	/* date column: the invalid date is stored as NULL */
+	gval = get_value (dm, 1, 0);
+	if (G_VALUE_TYPE (gval) != G_TYPE_DATE
+	    || g_date_get_day ((GDate *)g_value_get_boxed (gval)) != 1
+	    || g_date_get_month ((GDate *)g_value_get_boxed (gval)) != G_DATE_MARCH
+	    || g_date_get_year ((GDate *)g_value_get_boxed (gval)) != 2016)
+		{
+			g_error ("Wrong date at 1, 0.");
+		}
+	check_null (dm, 1, 1);
+	check_null (dm, 1, 2);
+
+	/* after a NULL the date is read again, and then from the cached GDate */
+	get_value (dm, 1, 0);
+	gval = get_value (dm, 1, 0);
+	if (g_date_get_day ((GDate *)g_value_get_boxed (gval)) != 1
+	    || g_date_get_month ((GDate *)g_value_get_boxed (gval)) != G_DATE_MARCH
+	    || g_date_get_year ((GDate *)g_value_get_boxed (gval)) != 2016)
+		{
+			g_error ("Wrong cached date at 1, 0.");
+		}
+
+	/* string column: with the dictionary equal strings share the storage */
+	str0 = g_value_get_string (get_value (dm, 2, 0));
+	str2 = g_value_get_string (get_value (dm, 2, 2));
+	if (g_strcmp0 (str0, "a") != 0
+	    || g_strcmp0 (str2, "a") != 0
+	    || g_strcmp0 (g_value_get_string (get_value (dm, 2, 1)), "b") != 0)
+		{
+			g_error ("Wrong strings in column 2.");
+		}
+	if (dictionary != (str0 == str2))
+		{
+			g_error ("Strings in column 2 %s share the storage.",
+			         dictionary ? "don't" : "do");
+		}
+
+	g_object_unref (dm);
+	g_object_unref (src);
+}
+
+int
+main (int argc, char **argv)
+{
+	check_model (FALSE);
+	check_model (TRUE);
+
+	return 0;
+}
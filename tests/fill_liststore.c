@@ -47,14 +47,18 @@ main (int argc, char **argv)
 	scrolledw = gtk_scrolled_window_new (NULL, NULL);
 	gtk_container_add (GTK_CONTAINER (w), scrolledw);
 
-	lstore = gtk_list_store_new (7,
+	lstore = gtk_list_store_new (8,
 	                             G_TYPE_STRING,
 	                             G_TYPE_STRING,
 	                             G_TYPE_STRING,
 	                             G_TYPE_STRING,
 	                             G_TYPE_STRING,
 	                             G_TYPE_STRING,
-	                             G_TYPE_STRING);
+	                             G_TYPE_STRING,
+	                             G_TYPE_DOUBLE);
+
+	/* "Incoming" is shown formatted but sorted by its raw value */
+	gdaex_treemodel_set_sort_shadow_column (GTK_TREE_MODEL (lstore), 5, 7);
 
 	tview = gtk_tree_view_new_with_model (GTK_TREE_MODEL (lstore));
 
@@ -98,6 +102,7 @@ main (int argc, char **argv)
 	                                                   renderer,
 	                                                   "text", 5,
 	                                                   NULL);
+	gtk_tree_view_column_set_sort_column_id (column, 5);
 	gtk_tree_view_append_column (GTK_TREE_VIEW (tview), column);
 
 	renderer = gtk_cell_renderer_text_new ();
@@ -0,0 +1,211 @@
+/*
+ * Copyright (C) 2016 Andrea Zagli <azagli@libero.it>
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+
+#include <libgdaex.h>
+
+static const gchar *names[] = { "carlo", "anna", "bruno", NULL, "andrea" };
+static const gchar *cities[] = { "roma", "milano", "roma", "roma", "milano" };
+
+static GValue
+*new_string (const gchar *str)
+{
+	return str != NULL ? gda_value_new_from_string (str, G_TYPE_STRING) : gda_value_new_null ();
+}
+
+static GdaDataModel
+*source_model (void)
+{
+	GdaDataModel *dm;
+	GValue *gval;
+	GError *error;
+	guint i;
+	gint row;
+
+	dm = gda_data_model_array_new_with_g_types (2, G_TYPE_STRING, G_TYPE_STRING);
+	gda_column_set_name (gda_data_model_describe_column (dm, 0), "name");
+	gda_column_set_name (gda_data_model_describe_column (dm, 1), "city");
+
+	for (i = 0; i < G_N_ELEMENTS (names); i++)
+		{
+			row = gda_data_model_append_row (dm, NULL);
+
+			error = NULL;
+			gval = new_string (names[i]);
+			if (!gda_data_model_set_value_at (dm, 0, row, gval, &error))
+				{
+					g_error ("Unable to fill the source model: %s.",
+					         error != NULL && error->message != NULL ? error->message : "no details");
+				}
+			gda_value_free (gval);
+
+			gval = new_string (cities[i]);
+			if (!gda_data_model_set_value_at (dm, 1, row, gval, &error))
+				{
+					g_error ("Unable to fill the source model: %s.",
+					         error != NULL && error->message != NULL ? error->message : "no details");
+				}
+			gda_value_free (gval);
+		}
+
+	return dm;
+}
+
+/* rows must be the -1 terminated list of the expected rows */
+static void
+check_rows (const gchar *what, GArray *ret, ...)
+{
+	va_list ap;
+	gint row;
+	guint i;
+
+	if (ret == NULL)
+		{
+			g_error ("%s: no rows.", what);
+		}
+
+	i = 0;
+	va_start (ap, ret);
+	while ((row = va_arg (ap, gint)) >= 0)
+		{
+			if (i >= ret->len
+			    || g_array_index (ret, gint, i) != row)
+				{
+					g_error ("%s: expected row %d at position %u.", what, row, i);
+				}
+			i++;
+		}
+	va_end (ap);
+
+	if (i != ret->len)
+		{
+			g_error ("%s: %u rows instead of %u.", what, ret->len, i);
+		}
+
+	g_array_unref (ret);
+}
+
+static void
+check_hash (GdaDataModel *dm)
+{
+	GdaExDataModelIndex *index;
+	GValue *gval;
+
+	index = gdaex_data_model_index_new (dm, GDAEX_DATA_MODEL_INDEX_HASH, "city", NULL);
+	if (index == NULL)
+		{
+			g_error ("Unable to create the hash index.");
+		}
+
+	gval = new_string ("roma");
+	check_rows ("hash lookup", gdaex_data_model_index_lookup (index, gval), 0, 2, 3, -1);
+	gda_value_free (gval);
+
+	gval = new_string ("milano");
+	if (gdaex_data_model_index_get_row (index, gval) != 1)
+		{
+			g_error ("hash get_row: wrong row.");
+		}
+	gda_value_free (gval);
+
+	gval = new_string ("napoli");
+	check_rows ("hash lookup of a missing key", gdaex_data_model_index_lookup (index, gval), -1);
+	if (gdaex_data_model_index_get_row (index, gval) != -1)
+		{
+			g_error ("hash get_row of a missing key: found.");
+		}
+	gda_value_free (gval);
+
+	g_object_unref (index);
+}
+
+static void
+check_sorted (GdaDataModel *dm)
+{
+	GdaExDataModelIndex *index;
+	GdaDataModel *view;
+	GArray *rows;
+	GValue *from;
+	GValue *to;
+	GValue *gval;
+
+	index = gdaex_data_model_index_new (dm, GDAEX_DATA_MODEL_INDEX_SORTED, "name", NULL);
+	if (index == NULL)
+		{
+			g_error ("Unable to create the sorted index.");
+		}
+
+	/* NULLs are never in a range */
+	check_rows ("open range", gdaex_data_model_index_range (index, NULL, NULL), 4, 1, 2, 0, -1);
+
+	from = new_string ("b");
+	to = new_string ("c");
+	check_rows ("range", gdaex_data_model_index_range (index, from, to), 2, -1);
+	gda_value_free (from);
+	gda_value_free (to);
+
+	check_rows ("prefix", gdaex_data_model_index_prefix (index, "an"), 4, 1, -1);
+	check_rows ("missing prefix", gdaex_data_model_index_prefix (index, "z"), -1);
+
+	gval = new_string ("bruno");
+	check_rows ("sorted lookup", gdaex_data_model_index_lookup (index, gval), 2, -1);
+	gda_value_free (gval);
+
+	/* the whole view is in key order, NULLs first */
+	view = gdaex_data_model_index_get_view (index, NULL);
+	if (gda_data_model_get_n_rows (view) != 5
+	    || gda_data_model_get_n_columns (view) != 2)
+		{
+			g_error ("view: wrong size.");
+		}
+	if (!gda_value_is_null (gda_data_model_get_value_at (view, 0, 0, NULL))
+	    || g_strcmp0 (g_value_get_string (gda_data_model_get_value_at (view, 0, 1, NULL)), "andrea") != 0
+	    || g_strcmp0 (g_value_get_string (gda_data_model_get_value_at (view, 1, 1, NULL)), "milano") != 0
+	    || gdaex_data_model_view_get_model_row (GDAEX_DATA_MODEL_VIEW (view), 4) != 0)
+		{
+			g_error ("view: wrong values.");
+		}
+	g_object_unref (view);
+
+	/* a view over the rows of a lookup */
+	rows = gdaex_data_model_index_prefix (index, "an");
+	view = gdaex_data_model_index_get_view (index, rows);
+	g_array_unref (rows);
+	if (gda_data_model_get_n_rows (view) != 2
+	    || g_strcmp0 (g_value_get_string (gda_data_model_get_value_at (view, 0, 1, NULL)), "anna") != 0)
+		{
+			g_error ("lookup view: wrong values.");
+		}
+	g_object_unref (view);
+
+	g_object_unref (index);
+}
+
+int
+main (int argc, char **argv)
+{
+	GdaDataModel *dm;
+
+	dm = source_model ();
+
+	check_hash (dm);
+	check_sorted (dm);
+
+	g_object_unref (dm);
+
+	return 0;
+}
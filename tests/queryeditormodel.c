@@ -0,0 +1,560 @@
+/*
+ * Copyright (C) 2016 Andrea Zagli <azagli@libero.it>
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ */
+
+#include <stdarg.h>
+#include <string.h>
+
+#include <libgdaex.h>
+
+/* orders and payments are joined only through clients: from orders the
+ * planner must reach clients by shops, never from the optional side of
+ * clients LEFT orders */
+static const gchar *xml =
+"<gdaex_query_editor>"
+"<tables>"
+"<table><name>clients</name><name_visible>Clients</name_visible></table>"
+"<table><name>orders</name><name_visible>Orders</name_visible></table>"
+"<table><name>payments</name><name_visible>Payments</name_visible></table>"
+"<table><name>shops</name><name_visible>Shops</name_visible></table>"
+"<table><name>cities</name><name_visible>Cities</name_visible></table>"
+"</tables>"
+"<fields table=\"clients\">"
+"<field><name>id</name><name_visible>Id</name_visible><type>integer</type></field>"
+"<field><name>name</name><name_visible>Name</name_visible><type>text</type><normalized>name_lower</normalized></field>"
+"<field><name>id_cities</name><name_visible>City</name_visible><type>integer</type>"
+"<decode><table_name>cities</table_name><join_type>left</join_type><field_name_to_join>id</field_name_to_join>"
+"<field_name_to_show>name</field_name_to_show><alias>city_name</alias></decode></field>"
+"</fields>"
+"<fields table=\"orders\">"
+"<field><name>amount</name><name_visible>Amount</name_visible><type>double</type></field>"
+"</fields>"
+"<fields table=\"payments\">"
+"<field><name>amount</name><name_visible>Amount</name_visible><type>double</type></field>"
+"</fields>"
+"<fields table=\"shops\">"
+"<field><name>name</name><name_visible>Name</name_visible><type>text</type></field>"
+"</fields>"
+"<fields table=\"cities\">"
+"<field><name>name</name><name_visible>Name</name_visible><type>text</type></field>"
+"</fields>"
+"<relations>"
+"<relation><table_left>clients</table_left><table_right>orders</table_right><join_type>left</join_type>"
+"<fields_joined><field_left>id</field_left><field_right>id_clients</field_right></fields_joined></relation>"
+"<relation><table_left>clients</table_left><table_right>payments</table_right><join_type>left</join_type>"
+"<fields_joined><field_left>id</field_left><field_right>id_clients</field_right></fields_joined></relation>"
+"<relation><table_left>orders</table_left><table_right>shops</table_right><join_type>inner</join_type>"
+"<fields_joined><field_left>id_shops</field_left><field_right>id</field_right></fields_joined></relation>"
+"<relation><table_left>shops</table_left><table_right>clients</table_right><join_type>inner</join_type>"
+"<fields_joined><field_left>id</field_left><field_right>id_shops</field_right></fields_joined></relation>"
+"</relations>"
+"</gdaex_query_editor>";
+
+static const gchar *sqls[] =
+	{
+		"CREATE TABLE cities (id integer, name text)",
+		"CREATE TABLE shops (id integer, name text)",
+		"CREATE TABLE clients (id integer, name text, name_lower text, id_cities integer, id_shops integer)",
+		"CREATE TABLE orders (id integer, id_clients integer, id_shops integer, amount double)",
+		"CREATE TABLE payments (id integer, id_clients integer, amount double)",
+		"INSERT INTO cities VALUES (1, 'Roma')",
+		"INSERT INTO cities VALUES (2, 'Milano')",
+		"INSERT INTO shops VALUES (1, 'Centro')",
+		"INSERT INTO clients VALUES (1, 'John', 'john', 1, 1)",
+		"INSERT INTO clients VALUES (2, 'joan', 'joan', 2, 1)",
+		"INSERT INTO clients VALUES (3, 'Mary', 'mary', 1, 1)"
+	};
+
+static void
+check_sql (gchar *sql, ...)
+{
+	va_list ap;
+	const gchar *part;
+
+	g_assert (sql != NULL);
+
+	va_start (ap, sql);
+	while ((part = va_arg (ap, const gchar *)) != NULL)
+		{
+			if (strstr (sql, part) == NULL)
+				{
+					g_error ("«%s» not found in: %s", part, sql);
+				}
+		}
+	va_end (ap);
+
+	g_free (sql);
+}
+
+static void
+add_where (GdaExQueryEditorModel *model,
+           const gchar *table_name,
+           const gchar *field_name,
+           GdaExQueryEditorWhereType where_type,
+           const gchar *from_sql)
+{
+	GdaExQueryEditorWhereChoice choice;
+
+	memset (&choice, 0, sizeof (GdaExQueryEditorWhereChoice));
+	choice.table_name = (gchar *)table_name;
+	choice.field_name = (gchar *)field_name;
+	choice.where_type = where_type;
+	choice.from = (gchar *)from_sql;
+	choice.from_visible = (gchar *)from_sql;
+	choice.from_sql = (gchar *)from_sql;
+
+	if (gdaex_query_editor_model_add_where (model, NULL, &choice) == NULL)
+		{
+			g_error ("Unable to add the condition on %s.%s.", table_name, field_name);
+		}
+}
+
+static GdaEx
+*open_db (const gchar *dir)
+{
+	GdaEx *gdaex;
+	gchar *cnc_string;
+	guint i;
+
+	cnc_string = g_strdup_printf ("SQLite://DB_DIR=%s;DB_NAME=queryeditormodel", dir);
+	gdaex = gdaex_new_from_string (cnc_string);
+	g_free (cnc_string);
+	if (gdaex == NULL)
+		{
+			g_error ("Unable to open the database.");
+		}
+
+	for (i = 0; i < G_N_ELEMENTS (sqls); i++)
+		{
+			if (gdaex_execute (gdaex, sqls[i]) < 0)
+				{
+					g_error ("Unable to execute: %s", sqls[i]);
+				}
+		}
+
+	return gdaex;
+}
+
+static guint
+count_files (const gchar *dirname)
+{
+	GDir *dir;
+	guint ret;
+
+	dir = g_dir_open (dirname, 0, NULL);
+	if (dir == NULL)
+		{
+			return 0;
+		}
+
+	ret = 0;
+	while (g_dir_read_name (dir) != NULL)
+		{
+			ret++;
+		}
+	g_dir_close (dir);
+
+	return ret;
+}
+
+static void
+check_schema (GdaExQueryEditorSchema *schema)
+{
+	const GdaExQueryEditorTable *table;
+	const GdaExQueryEditorField *field;
+
+	table = gdaex_query_editor_schema_get_table (schema, "clients");
+	if (table == NULL
+	    || g_strcmp0 (table->name_visible, "Clients") != 0
+	    || g_hash_table_size (table->fields) != 3)
+		{
+			g_error ("schema: wrong table clients.");
+		}
+
+	field = gdaex_query_editor_schema_get_field (schema, "clients", "name");
+	if (field == NULL
+	    || field->type != GDAEX_QE_FIELD_TYPE_TEXT
+	    || g_strcmp0 (field->normalized, "name_lower") != 0)
+		{
+			g_error ("schema: wrong field clients.name.");
+		}
+
+	field = gdaex_query_editor_schema_get_field (schema, "clients", "id_cities");
+	if (field == NULL
+	    || g_strcmp0 (field->decode_table2, "cities") != 0
+	    || field->decode_join_type != GDAEX_QE_JOIN_TYPE_LEFT
+	    || g_strcmp0 (field->decode_field2, "id") != 0
+	    || g_strcmp0 (field->decode_field_alias, "city_name") != 0)
+		{
+			g_error ("schema: wrong decode of clients.id_cities.");
+		}
+
+	if (g_slist_length (gdaex_query_editor_schema_get_relations (schema)) != 4)
+		{
+			g_error ("schema: wrong relations.");
+		}
+}
+
+/* the first load saves the binary cache, the next ones map it */
+static void
+check_cache (const gchar *filename, const gchar *cache_dir)
+{
+	GdaExQueryEditorSchema *schema;
+	GdaExQueryEditorSchema *other;
+	gchar *dirname;
+	gchar *cache_file;
+	const gchar *name;
+	GDir *dir;
+
+	schema = gdaex_query_editor_schema_new_from_file (filename);
+	if (schema == NULL
+	    || !gdaex_query_editor_schema_is_sealed (schema))
+		{
+			g_error ("cache: the file isn't loaded as a sealed schema.");
+		}
+	check_schema (schema);
+
+	other = gdaex_query_editor_schema_new_from_file (filename);
+	if (other != schema)
+		{
+			g_error ("cache: the same file gives two schemas.");
+		}
+	g_object_unref (other);
+
+	dirname = g_build_filename (cache_dir, "libgdaex", "queryeditor", NULL);
+	if (count_files (dirname) != 1)
+		{
+			g_error ("cache: no binary cache in %s.", dirname);
+		}
+
+	g_object_unref (schema);
+	if (gdaex_query_editor_schema_registry_prune () != 1)
+		{
+			g_error ("cache: the unused schema isn't pruned.");
+		}
+
+	schema = gdaex_query_editor_schema_new_from_file (filename);
+	if (schema == NULL)
+		{
+			g_error ("cache: the binary cache isn't loaded.");
+		}
+	check_schema (schema);
+	g_object_unref (schema);
+	gdaex_query_editor_schema_registry_prune ();
+
+	/* a corrupted cache is parsed again from the xml */
+	dir = g_dir_open (dirname, 0, NULL);
+	name = g_dir_read_name (dir);
+	cache_file = g_build_filename (dirname, name, NULL);
+	g_dir_close (dir);
+	if (!g_file_set_contents (cache_file, "not a cache", -1, NULL))
+		{
+			g_error ("cache: unable to corrupt %s.", cache_file);
+		}
+	g_free (cache_file);
+
+	schema = gdaex_query_editor_schema_new_from_file (filename);
+	if (schema == NULL)
+		{
+			g_error ("cache: the corrupted cache isn't replaced.");
+		}
+	check_schema (schema);
+	g_object_unref (schema);
+	gdaex_query_editor_schema_registry_prune ();
+
+	g_free (dirname);
+}
+
+static void
+check_planner (GdaExQueryEditorModel *model)
+{
+	gdaex_query_editor_model_clean_choices (model);
+	gdaex_query_editor_model_add_show (model, "orders", "amount", NULL);
+	gdaex_query_editor_model_add_show (model, "payments", "amount", NULL);
+	check_sql (gdaex_query_editor_model_get_sql (model),
+	           "FROM orders",
+	           "INNER JOIN shops",
+	           "INNER JOIN clients",
+	           "LEFT JOIN payments",
+	           NULL);
+
+	/* only the tables of the choices */
+	gdaex_query_editor_model_clean_choices (model);
+	gdaex_query_editor_model_add_show (model, "clients", "name", NULL);
+	gdaex_query_editor_model_add_show (model, "clients", "id_cities", NULL);
+	check_sql (gdaex_query_editor_model_get_sql (model),
+	           "FROM clients",
+	           "LEFT JOIN cities",
+	           "AS city_name",
+	           NULL);
+}
+
+static void
+check_where (GdaExQueryEditorModel *model)
+{
+	gchar *sql;
+
+	/* the normalized column, with the value lower-cased */
+	gdaex_query_editor_model_clean_choices (model);
+	gdaex_query_editor_model_add_show (model, "clients", "name", NULL);
+	add_where (model, "clients", "name", GDAEX_QE_WHERE_TYPE_ICONTAINS, "JO");
+	sql = gdaex_query_editor_model_get_sql (model);
+	if (sql != NULL && strstr (sql, "LOWER") != NULL)
+		{
+			g_error ("LOWER() on a normalized column: %s", sql);
+		}
+	check_sql (sql, "clients.name_lower LIKE '%jo%'", NULL);
+
+	/* LIKE is already case insensitive on SQLite */
+	gdaex_query_editor_model_clean_choices (model);
+	gdaex_query_editor_model_add_show (model, "cities", "name", NULL);
+	add_where (model, "cities", "name", GDAEX_QE_WHERE_TYPE_ICONTAINS, "Ro");
+	sql = gdaex_query_editor_model_get_sql (model);
+	if (sql != NULL && strstr (sql, "LOWER") != NULL)
+		{
+			g_error ("LOWER() on SQLite: %s", sql);
+		}
+	check_sql (sql, "cities.name LIKE '%Ro%'", NULL);
+}
+
+static void
+check_holder (GdaSet *params, gint value)
+{
+	GdaHolder *holder;
+	const GValue *gval;
+
+	holder = (params != NULL ? gda_set_get_holder (params, "gdaex_qe_0") : NULL);
+	if (holder == NULL)
+		{
+			g_error ("statement: no parameter gdaex_qe_0.");
+		}
+
+	gval = gda_holder_get_value (holder);
+	if (gval == NULL
+	    || G_VALUE_TYPE (gval) != G_TYPE_INT
+	    || g_value_get_int (gval) != value)
+		{
+			g_error ("statement: wrong value of gdaex_qe_0.");
+		}
+}
+
+/* the values are bound: the same choices share one statement */
+static void
+check_statement (GdaExQueryEditorModel *model)
+{
+	GdaStatement *stmt;
+	GdaStatement *other;
+	GdaSet *params;
+
+	gdaex_query_editor_model_clean_choices (model);
+	gdaex_query_editor_model_add_show (model, "clients", "name", NULL);
+	add_where (model, "clients", "id", GDAEX_QE_WHERE_TYPE_EQUAL, "1");
+	stmt = gdaex_query_editor_model_get_statement (model, &params);
+	if (stmt == NULL)
+		{
+			g_error ("statement: no statement.");
+		}
+	check_holder (params, 1);
+	g_object_unref (params);
+
+	gdaex_query_editor_model_clean_choices (model);
+	gdaex_query_editor_model_add_show (model, "clients", "name", NULL);
+	add_where (model, "clients", "id", GDAEX_QE_WHERE_TYPE_EQUAL, "2");
+	other = gdaex_query_editor_model_get_statement (model, &params);
+	if (other != stmt)
+		{
+			g_error ("statement: not reused for another value.");
+		}
+	check_holder (params, 2);
+	g_object_unref (params);
+	g_object_unref (other);
+
+	/* a change of the shared schema copies it and empties the cache */
+	if (!gdaex_query_editor_model_add_table (model, "extra", "Extra"))
+		{
+			g_error ("statement: unable to add a table.");
+		}
+	other = gdaex_query_editor_model_get_statement (model, &params);
+	if (other == NULL
+	    || other == stmt)
+		{
+			g_error ("statement: the cache is not emptied on a schema change.");
+		}
+	check_holder (params, 2);
+	g_object_unref (params);
+	g_object_unref (other);
+
+	g_object_unref (stmt);
+}
+
+static void
+on_values (GObject *source, GAsyncResult *res, gpointer user_data)
+{
+	GPtrArray **values;
+	GError *error;
+
+	values = (GPtrArray **)user_data;
+
+	error = NULL;
+	*values = gdaex_query_editor_model_get_values_finish (GDAEX_QUERY_EDITOR_MODEL (source), res, &error);
+	if (*values == NULL)
+		{
+			g_error ("values: %s.", error != NULL && error->message != NULL ? error->message : "no details");
+		}
+}
+
+static void
+on_count (GObject *source, GAsyncResult *res, gpointer user_data)
+{
+	gint64 *count;
+	gboolean estimated;
+	GError *error;
+
+	count = (gint64 *)user_data;
+
+	error = NULL;
+	*count = gdaex_query_editor_model_count_finish (GDAEX_QUERY_EDITOR_MODEL (source), res, &estimated, &error);
+	if (*count < 0)
+		{
+			g_error ("count: %s.", error != NULL && error->message != NULL ? error->message : "no details");
+		}
+	if (estimated)
+		{
+			g_error ("count: estimated on SQLite.");
+		}
+}
+
+static void
+check_value (GPtrArray *values, guint i, const gchar *value, gint count)
+{
+	GdaExQueryEditorValue *v;
+
+	v = (GdaExQueryEditorValue *)g_ptr_array_index (values, i);
+	if (g_strcmp0 (v->value, value) != 0
+	    || g_strcmp0 (g_value_get_string (v->gval), value) != 0
+	    || v->count != count)
+		{
+			g_error ("values: expected «%s» (%d) at position %u.", value, count, i);
+		}
+}
+
+/* the values and count statements run in the worker threads */
+static void
+check_async (GdaExQueryEditorModel *model)
+{
+	GMainContext *context;
+	GPtrArray *values;
+	gint64 count;
+
+	context = g_main_context_default ();
+
+	values = NULL;
+	gdaex_query_editor_model_get_values_async (model, "clients", "name", "JO", 0, 10,
+	                                           NULL, on_values, &values);
+	while (values == NULL)
+		{
+			g_main_context_iteration (context, TRUE);
+		}
+	if (values->len != 2)
+		{
+			g_error ("values: %u values instead of 2.", values->len);
+		}
+	check_value (values, 0, "John", 1);
+	check_value (values, 1, "joan", 1);
+	g_ptr_array_unref (values);
+
+	gdaex_query_editor_model_clean_choices (model);
+	gdaex_query_editor_model_add_show (model, "clients", "name", NULL);
+	add_where (model, "clients", "name", GDAEX_QE_WHERE_TYPE_ICONTAINS, "JO");
+
+	count = -1;
+	gdaex_query_editor_model_count_async (model, 60000, NULL, on_count, &count);
+	while (count < 0)
+		{
+			g_main_context_iteration (context, TRUE);
+		}
+	if (count != 2)
+		{
+			g_error ("count: %" G_GINT64_FORMAT " rows instead of 2.", count);
+		}
+
+	/* the decode join doesn't change the count */
+	gdaex_query_editor_model_clean_choices (model);
+	gdaex_query_editor_model_add_show (model, "clients", "id_cities", NULL);
+
+	count = -1;
+	gdaex_query_editor_model_count_async (model, 60000, NULL, on_count, &count);
+	while (count < 0)
+		{
+			g_main_context_iteration (context, TRUE);
+		}
+	if (count != 3)
+		{
+			g_error ("count: %" G_GINT64_FORMAT " rows instead of 3.", count);
+		}
+}
+
+int
+main (int argc, char **argv)
+{
+	GdaEx *gdaex;
+	GdaExQueryEditorModel *model;
+	GError *error;
+	gchar *dir;
+	gchar *cache_dir;
+	gchar *filename;
+
+	error = NULL;
+	dir = g_dir_make_tmp ("libgdaex-XXXXXX", &error);
+	if (dir == NULL)
+		{
+			g_error ("Unable to create the temporary directory: %s.",
+			         error != NULL && error->message != NULL ? error->message : "no details");
+		}
+
+	/* before anything reads the user cache dir */
+	cache_dir = g_build_filename (dir, "cache", NULL);
+	g_setenv ("XDG_CACHE_HOME", cache_dir, TRUE);
+
+	filename = g_build_filename (dir, "queryeditormodel.xml", NULL);
+	if (!g_file_set_contents (filename, xml, -1, &error))
+		{
+			g_error ("Unable to write %s: %s.", filename,
+			         error != NULL && error->message != NULL ? error->message : "no details");
+		}
+
+	gdaex = open_db (dir);
+
+	check_cache (filename, cache_dir);
+
+	model = gdaex_query_editor_model_new (gdaex);
+	gdaex_query_editor_model_load_tables_from_file (model, filename, TRUE);
+
+	check_planner (model);
+	check_where (model);
+	check_async (model);
+	check_statement (model);
+
+	g_object_unref (model);
+	gdaex_free (gdaex);
+
+	g_free (filename);
+	g_free (cache_dir);
+	g_free (dir);
+
+	return 0;
+}
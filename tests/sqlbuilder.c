@@ -16,8 +16,33 @@
  *  Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
  */
 
+#include <stdarg.h>
+#include <string.h>
+
 #include <libgdaex.h>
 
+/* sql must have every part of the NULL terminated list; it is freed */
+static void
+check_sql (gchar *sql, ...)
+{
+	va_list ap;
+	const gchar *part;
+
+	g_assert (sql != NULL);
+
+	va_start (ap, sql);
+	while ((part = va_arg (ap, const gchar *)) != NULL)
+		{
+			if (strstr (sql, part) == NULL)
+				{
+					g_error ("«%s» not found in: %s", part, sql);
+				}
+		}
+	va_end (ap);
+
+	g_free (sql);
+}
+
 int
 main (int argc, char **argv)
 {
@@ -71,7 +96,16 @@ main (int argc, char **argv)
 							 "pippo", "id", "", FALSE,
 							 NULL);
 
-	g_message ("sql: %s", gdaex_sql_builder_get_sql (sqlb, NULL, NULL));
+	check_sql (gdaex_sql_builder_get_sql (sqlb, NULL, NULL),
+	           "SELECT ", " FROM ", " WHERE ", " ORDER BY ", NULL);
+	check_sql (gdaex_sql_builder_get_sql_select (sqlb, NULL, NULL),
+	           "id", "the_name", "income", NULL);
+	check_sql (gdaex_sql_builder_get_sql_from (sqlb, NULL, NULL),
+	           "pippo", "topolino", "JOIN", NULL);
+	check_sql (gdaex_sql_builder_get_sql_where (sqlb, NULL, NULL),
+	           "44", "'ichichc'", " OR ", NULL);
+	check_sql (gdaex_sql_builder_get_sql_order (sqlb, NULL, NULL),
+	           "name", "DESC", NULL);
 
 	g_object_unref (sqlb);
 
@@ -108,7 +142,8 @@ main (int argc, char **argv)
 	g_value_unset (gval);
 	g_value_unset (gval2);
 
-	g_message ("sql: %s", gdaex_sql_builder_get_sql (sqlb, NULL, NULL));
+	check_sql (gdaex_sql_builder_get_sql (sqlb, NULL, NULL),
+	           "IS NULL", "BETWEEN 44 AND 8877", NULL);
 
 	g_object_unref (sqlb);
 
@@ -129,7 +164,8 @@ main (int argc, char **argv)
 							 NULL);
 	g_value_unset (gval);
 
-	g_message ("sql: %s", gdaex_sql_builder_get_sql (sqlb, NULL, NULL));
+	check_sql (gdaex_sql_builder_get_sql (sqlb, NULL, NULL),
+	           "DELETE FROM pippo", " WHERE ", NULL);
 
 	g_object_unref (sqlb);
 
@@ -157,7 +193,8 @@ main (int argc, char **argv)
 							 NULL);
 	g_value_unset (gval);
 
-	g_message ("sql: %s", gdaex_sql_builder_get_sql (sqlb, NULL, NULL));
+	check_sql (gdaex_sql_builder_get_sql (sqlb, NULL, NULL),
+	           "UPDATE pippo", " SET ", "'il nome di pippo'", " WHERE ", NULL);
 
 	g_object_unref (sqlb);
 
@@ -185,7 +222,82 @@ main (int argc, char **argv)
 							 NULL);
 	g_value_unset (gval);
 
-	g_message ("sql: %s", gdaex_sql_builder_get_sql (sqlb, NULL, NULL));
+	check_sql (gdaex_sql_builder_get_sql (sqlb, NULL, NULL),
+	           "INSERT INTO pippo", "'il nome di pippo'", NULL);
+
+	g_object_unref (sqlb);
+
+	sqlb = gdaex_sql_builder_new (GDA_SQL_STATEMENT_INSERT);
+
+	gdaex_sql_builder_from (sqlb, "pippo", "");
+
+	gval = g_new0 (GValue, 1);
+	g_value_init (gval, G_TYPE_INT);
+	g_value_set_int (gval, 1);
+	gval2 = g_new0 (GValue, 1);
+	g_value_init (gval2, G_TYPE_STRING);
+	g_value_set_string (gval2, "il nome di pippo");
+	gdaex_sql_builder_fields (sqlb,
+							  "pippo", "id", "", gval,
+							  "pippo", "name", "", gval2,
+							  NULL);
+
+	g_value_set_int (gval, 2);
+	g_value_set_string (gval2, "il nome di pluto");
+	gdaex_sql_builder_add_row (sqlb,
+							   "id", gval,
+							   "name", gval2,
+							   NULL);
+	g_value_unset (gval);
+	g_value_unset (gval2);
+
+	gdaex_sql_builder_upsert (sqlb, "id", NULL);
+
+	/* both the rows, in one statement */
+	check_sql (gdaex_sql_builder_get_sql (sqlb, NULL, NULL),
+	           "INSERT INTO pippo", "'il nome di pippo'", "'il nome di pluto'", "ON CONFLICT", NULL);
+
+	g_object_unref (sqlb);
+
+	sqlb = gdaex_sql_builder_new (GDA_SQL_STATEMENT_SELECT);
+
+	gdaex_sql_builder_from (sqlb, "pippo", "");
+
+	gdaex_sql_builder_group (sqlb,
+							 "pippo", "name",
+							 NULL);
+	gdaex_sql_builder_aggregate (sqlb, GDAEX_SQLBUILDER_AGGREGATE_COUNT, "pippo", NULL, "how_many");
+	gdaex_sql_builder_aggregate (sqlb, GDAEX_SQLBUILDER_AGGREGATE_SUM, "pippo", "income", "total_income");
+
+	gval = g_new0 (GValue, 1);
+	g_value_init (gval, G_TYPE_INT);
+	g_value_set_int (gval, 1);
+	gdaex_sql_builder_having (sqlb, 0,
+							  GDAEX_SQLBUILDER_AGGREGATE_COUNT, "pippo", NULL,
+							  GDA_SQL_OPERATOR_TYPE_GT,
+							  gval);
+	g_value_unset (gval);
+
+	check_sql (gdaex_sql_builder_get_sql (sqlb, NULL, NULL),
+	           "how_many", "total_income", " GROUP BY ", " HAVING ", NULL);
+	check_sql (gdaex_sql_builder_get_sql_group (sqlb, NULL, NULL),
+	           "name", NULL);
+	check_sql (gdaex_sql_builder_get_sql_having (sqlb, NULL, NULL),
+	           "> 1", NULL);
+
+	g_object_unref (sqlb);
+
+	/* the changes made through the GdaSqlBuilder reach the sql */
+	sqlb = gdaex_sql_builder_new (GDA_SQL_STATEMENT_SELECT);
+
+	gdaex_sql_builder_from (sqlb, "pippo", "");
+	gdaex_sql_builder_field (sqlb, "pippo", "id", NULL, NULL);
+
+	check_sql (gdaex_sql_builder_get_sql (sqlb, NULL, NULL), "id", NULL);
+
+	gda_sql_builder_select_add_field (gdaex_sql_builder_get_gda_sql_builder (sqlb), "income", "pippo", NULL);
+
+	check_sql (gdaex_sql_builder_get_sql (sqlb, NULL, NULL), "income", NULL);
 
 	g_object_unref (sqlb);
 